@@ -0,0 +1,523 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define HST_LOG_TAG "AsyncLog"
+#define MEDIA_LOG_DEBUG 1
+
+#include "async_log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <vector>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include "foundation/log.h"
+#include "foundation/osal/thread/condition_variable.h"
+#include "foundation/osal/thread/mutex.h"
+#include "foundation/osal/thread/scoped_lock.h"
+#include "foundation/osal/thread/thread.h"
+
+#ifndef HST_LOG_RATE_LIMIT
+#define HST_LOG_RATE_LIMIT 20
+#endif
+
+namespace OHOS {
+namespace Media {
+namespace {
+constexpr size_t RING_CAPACITY = 256;
+constexpr int64_t NS_PER_SECOND = 1000000000;
+constexpr size_t MESSAGE_SIZE = 512;
+constexpr size_t SPEC_SIZE = 32;
+constexpr int LOG_THREAD_NICE = 10;
+
+std::atomic<bool> g_loggerDestroyed {false};
+
+int64_t NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t CurrentThreadId()
+{
+#if defined(__linux__)
+    return static_cast<uint32_t>(syscall(SYS_gettid));
+#else
+    static std::atomic<uint32_t> nextId {1};
+    return nextId.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+class LogRing {
+public:
+    LogRing() : threadId(CurrentThreadId())
+    {
+    }
+
+    bool Init()
+    {
+        records = std::unique_ptr<AsyncLogRecord[]>(new (std::nothrow) AsyncLogRecord[RING_CAPACITY]);
+        return records != nullptr;
+    }
+
+    AsyncLogRecord* Reserve()
+    {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) >= RING_CAPACITY) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &records[tail % RING_CAPACITY];
+    }
+
+    // returns whether the ring just got half full, the writer thread should come now
+    bool Commit()
+    {
+        uint64_t tail = tail_.load(std::memory_order_relaxed) + 1;
+        tail_.store(tail, std::memory_order_release);
+        return tail - head_.load(std::memory_order_relaxed) == RING_CAPACITY / 2; // 2: half full
+    }
+
+    const uint32_t threadId;
+    std::unique_ptr<AsyncLogRecord[]> records {};
+    std::atomic<uint64_t> head_ {0};
+    std::atomic<uint64_t> tail_ {0};
+    std::atomic<uint32_t> dropped {0};
+    std::atomic<bool> orphan {false};
+};
+
+struct RingHolder {
+    ~RingHolder()
+    {
+        if (ring) {
+            ring->orphan.store(true, std::memory_order_release);
+        }
+    }
+    std::shared_ptr<LogRing> ring {};
+};
+
+thread_local RingHolder g_ringHolder;
+
+void DefaultSink(uint8_t level, const char* tag, uint32_t threadId, const char* message)
+{
+#ifdef MEDIA_OHOS
+#define HST_ASYNC_LOG_OUT(op) op(LOG_CORE, PUBLIC_LOG_S "[" PUBLIC_LOG_U32 "]:" PUBLIC_LOG_S, tag, threadId, message)
+#else
+#define HST_ASYNC_LOG_OUT(op) op(PUBLIC_LOG_S "[" PUBLIC_LOG_U32 "]:" PUBLIC_LOG_S, tag, threadId, message)
+#endif
+    switch (level) {
+        case ASYNC_LOG_DEBUG:
+#ifdef MEDIA_OHOS
+            HST_ASYNC_LOG_OUT(HILOG_DEBUG);
+#else
+            HST_ASYNC_LOG_OUT(MEDIA_LOG_D);
+#endif
+            break;
+        case ASYNC_LOG_INFO:
+#ifdef MEDIA_OHOS
+            HST_ASYNC_LOG_OUT(HILOG_INFO);
+#else
+            HST_ASYNC_LOG_OUT(MEDIA_LOG_I);
+#endif
+            break;
+        case ASYNC_LOG_WARN:
+#ifdef MEDIA_OHOS
+            HST_ASYNC_LOG_OUT(HILOG_WARN);
+#else
+            HST_ASYNC_LOG_OUT(MEDIA_LOG_W);
+#endif
+            break;
+        case ASYNC_LOG_ERROR:
+#ifdef MEDIA_OHOS
+            HST_ASYNC_LOG_OUT(HILOG_ERROR);
+#else
+            HST_ASYNC_LOG_OUT(MEDIA_LOG_E);
+#endif
+            break;
+        default:
+#ifdef MEDIA_OHOS
+            HST_ASYNC_LOG_OUT(HILOG_FATAL);
+#else
+            HST_ASYNC_LOG_OUT(MEDIA_LOG_F);
+#endif
+            break;
+    }
+#undef HST_ASYNC_LOG_OUT
+}
+
+class AsyncLogger {
+public:
+    static AsyncLogger& Instance()
+    {
+        static AsyncLogger instance;
+        return instance;
+    }
+
+    ~AsyncLogger()
+    {
+        shutdown_.store(true, std::memory_order_release);
+        {
+            OSAL::ScopedLock lock(mutex_);
+            stopping_ = true;
+            cond_.NotifyAll();
+        }
+        worker_.reset(); // joins
+        Drain();
+        g_loggerDestroyed.store(true, std::memory_order_release);
+    }
+
+    bool IsAvailable() const
+    {
+        return !shutdown_.load(std::memory_order_acquire);
+    }
+
+    LogRing* GetRing()
+    {
+        if (g_ringHolder.ring) {
+            return g_ringHolder.ring.get();
+        }
+        auto ring = std::make_shared<LogRing>();
+        if (!ring->Init()) {
+            return nullptr;
+        }
+        {
+            OSAL::ScopedLock lock(mutex_);
+            rings_.push_back(ring);
+        }
+        g_ringHolder.ring = ring;
+        EnsureStarted(); // may log itself, the ring of this thread is in place by now
+        return ring.get();
+    }
+
+    bool Admit(AsyncLogSite& site, int64_t nowNs, uint32_t& suppressed)
+    {
+        uint32_t limit = rateLimit_.load(std::memory_order_relaxed);
+        if (limit > 0 && site.level < ASYNC_LOG_ERROR) { // errors are never suppressed
+            int64_t start = site.windowStartNs.load(std::memory_order_relaxed);
+            if (nowNs - start >= NS_PER_SECOND &&
+                site.windowStartNs.compare_exchange_strong(start, nowNs, std::memory_order_relaxed)) {
+                site.windowCount.store(0, std::memory_order_relaxed);
+            }
+            if (site.windowCount.fetch_add(1, std::memory_order_relaxed) >= limit) {
+                site.suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        if (site.suppressed.load(std::memory_order_relaxed) != 0) {
+            suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    void Wake()
+    {
+        OSAL::ScopedLock lock(mutex_);
+        wakeUp_ = true;
+        cond_.NotifyOne();
+    }
+
+    void SetRateLimit(uint32_t messagesPerSecond)
+    {
+        rateLimit_.store(messagesPerSecond, std::memory_order_relaxed);
+    }
+
+    void SetSink(AsyncLogSink sink)
+    {
+        OSAL::ScopedLock lock(drainMutex_);
+        sink_ = sink ? std::move(sink) : AsyncLogSink(DefaultSink);
+    }
+
+    void Drain()
+    {
+        OSAL::ScopedLock drainLock(drainMutex_);
+        std::vector<std::shared_ptr<LogRing>> rings;
+        {
+            OSAL::ScopedLock lock(mutex_);
+            rings = rings_;
+        }
+        pending_.clear();
+        tails_.clear();
+        char message[MESSAGE_SIZE];
+        for (auto& ring : rings) {
+            uint64_t tail = ring->tail_.load(std::memory_order_acquire);
+            for (uint64_t i = ring->head_.load(std::memory_order_relaxed); i < tail; ++i) {
+                pending_.push_back(&ring->records[i % RING_CAPACITY]);
+            }
+            tails_.push_back(tail);
+            uint32_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0) {
+                (void)snprintf(message, sizeof(message), "%u messages dropped, log ring full", dropped);
+                sink_(ASYNC_LOG_WARN, HST_LOG_TAG, ring->threadId, message);
+            }
+        }
+        std::stable_sort(pending_.begin(), pending_.end(), [](const AsyncLogRecord* lhs, const AsyncLogRecord* rhs) {
+            return lhs->timeNs < rhs->timeNs;
+        });
+        for (auto record : pending_) {
+            (void)AsyncLogBackend::Format(*record, message, sizeof(message));
+            sink_(record->site->level, record->site->tag, record->threadId, message);
+        }
+        for (size_t i = 0; i < rings.size(); ++i) {
+            rings[i]->head_.store(tails_[i], std::memory_order_release);
+        }
+        OSAL::ScopedLock lock(mutex_);
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [](const std::shared_ptr<LogRing>& ring) {
+            return ring->orphan.load(std::memory_order_acquire) &&
+                ring->head_.load(std::memory_order_relaxed) == ring->tail_.load(std::memory_order_acquire);
+        }), rings_.end());
+    }
+
+private:
+    AsyncLogger() = default;
+
+    void EnsureStarted()
+    {
+        bool expected = false;
+        if (!starting_.compare_exchange_strong(expected, true)) {
+            return; // started, or being started by this or another thread
+        }
+        auto worker = std::unique_ptr<OSAL::Thread>(new OSAL::Thread(OSAL::ThreadPriority::LOW));
+        worker->SetName("HstLogWriter");
+        OSAL::ThreadSchedule schedule;
+        schedule.policy = OSAL::SchedPolicy::OTHER; // never compete with the real time media threads
+        schedule.nice = LOG_THREAD_NICE;
+        (void)worker->SetSchedule(schedule);
+        if (!worker->CreateThread([this] { Loop(); })) {
+            return; // the messages are still written by Flush()
+        }
+        OSAL::ScopedLock lock(mutex_);
+        worker_ = std::move(worker);
+    }
+
+    void Loop()
+    {
+        for (;;) {
+            {
+                OSAL::ScopedLock lock(mutex_);
+                cond_.WaitFor(lock, AsyncLogBackend::FLUSH_INTERVAL_MS, [this] { return wakeUp_ || stopping_; });
+                wakeUp_ = false;
+                if (stopping_) {
+                    break;
+                }
+            }
+            Drain();
+        }
+    }
+
+    std::atomic<bool> shutdown_ {false};
+    std::atomic<bool> starting_ {false};
+    std::atomic<uint32_t> rateLimit_ {HST_LOG_RATE_LIMIT};
+    OSAL::Mutex mutex_ {};
+    OSAL::ConditionVariable cond_ {};
+    bool wakeUp_ {false};
+    bool stopping_ {false};
+    std::vector<std::shared_ptr<LogRing>> rings_ {};
+    std::unique_ptr<OSAL::Thread> worker_ {};
+    OSAL::Mutex drainMutex_ {};
+    AsyncLogSink sink_ {DefaultSink};
+    std::vector<const AsyncLogRecord*> pending_ {};
+    std::vector<uint64_t> tails_ {};
+};
+
+// formats one argument of the record following the conversion in spec, which ends with the conversion character
+int FormatArg(const AsyncLogRecord& record, size_t index, char* spec, size_t specLen, char* out, size_t size)
+{
+    char conv = spec[specLen - 1];
+    auto type = record.types[index];
+    uint64_t word = record.args[index];
+    auto setConv = [spec, &specLen](const char* normalized) {
+        specLen--; // drop the conversion character, then append the normalized length and conversion
+        while (*normalized != '\0' && specLen + 1 < SPEC_SIZE) {
+            spec[specLen++] = *normalized++;
+        }
+        spec[specLen] = '\0';
+    };
+    if (type == AsyncLogArgType::STRING) {
+        setConv("s");
+        return snprintf(out, size, spec, record.text + (word >> 32)); // 32: see AsyncLogArgType::STRING
+    }
+    if (type == AsyncLogArgType::DOUBLE) {
+        double number = 0.0;
+        std::memcpy(&number, &word, sizeof(number));
+        if (std::strchr("fFeEgGaA", conv) == nullptr) {
+            setConv("f");
+        }
+        return snprintf(out, size, spec, number);
+    }
+    if (conv == 'p' || type == AsyncLogArgType::POINTER) {
+        setConv("p");
+        return snprintf(out, size, spec, reinterpret_cast<void*>(static_cast<uintptr_t>(word)));
+    }
+    if (conv == 'c') {
+        return snprintf(out, size, spec, static_cast<int>(word));
+    }
+    if (std::strchr("fFeEgGaA", conv) != nullptr) {
+        return snprintf(out, size, spec, type == AsyncLogArgType::SIGNED ?
+            static_cast<double>(static_cast<int64_t>(word)) : static_cast<double>(word));
+    }
+    if (conv == 'd' || conv == 'i') {
+        setConv("lld");
+        return snprintf(out, size, spec, static_cast<long long>(word));
+    }
+    char intConv[] = {'l', 'l', std::strchr("uxXo", conv) != nullptr ? conv : 'u', '\0'}; // 'u': %s of a number
+    setConv(intConv);
+    return snprintf(out, size, spec, static_cast<unsigned long long>(word));
+}
+} // namespace
+
+AsyncLogWriter::AsyncLogWriter(AsyncLogSite& site)
+{
+    int64_t now = NowNs();
+    uint32_t suppressed = 0;
+    LogRing* ring = nullptr;
+    if (!g_loggerDestroyed.load(std::memory_order_acquire) && AsyncLogger::Instance().IsAvailable()) {
+        auto& logger = AsyncLogger::Instance();
+        if (!logger.Admit(site, now, suppressed)) {
+            return;
+        }
+        ring = logger.GetRing();
+    }
+    if (ring != nullptr) {
+        record_ = ring->Reserve();
+        if (record_ == nullptr) {
+            return;
+        }
+        ring_ = ring;
+    } else {
+        record_ = &fallbackRecord_; // formatted and written by the destructor
+    }
+    record_->site = &site;
+    record_->timeNs = now;
+    record_->threadId = ring != nullptr ? ring->threadId : CurrentThreadId();
+    record_->suppressed = suppressed;
+    record_->argCount = 0;
+    record_->textSize = 0;
+    record_->text[sizeof(record_->text) - 1] = '\0';
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+    if (record_ == nullptr) {
+        return;
+    }
+    if (record_ == &fallbackRecord_) {
+        char message[MESSAGE_SIZE];
+        (void)AsyncLogBackend::Format(*record_, message, sizeof(message));
+        DefaultSink(record_->site->level, record_->site->tag, record_->threadId, message);
+        return;
+    }
+    bool urgent = record_->site->level >= ASYNC_LOG_ERROR;
+    if (static_cast<LogRing*>(ring_)->Commit() || urgent) {
+        AsyncLogger::Instance().Wake();
+    }
+}
+
+void AsyncLogWriter::AddString(const char* str)
+{
+    if (str == nullptr) {
+        str = "(null)";
+    }
+    // every string is copied with its terminator, the last byte of text stays '\0' for those that don't fit
+    constexpr size_t last = sizeof(record_->text) - 1;
+    size_t offset = std::min<size_t>(record_->textSize, last);
+    size_t length = strnlen(str, last - offset);
+    std::memcpy(record_->text + offset, str, length);
+    record_->text[offset + length] = '\0';
+    record_->textSize = static_cast<uint8_t>(std::min(offset + length + 1, last));
+    AddWord(AsyncLogArgType::STRING, (static_cast<uint64_t>(offset) << 32) | length); // 32: offset in the high half
+}
+
+void AsyncLogBackend::SetRateLimit(uint32_t messagesPerSecond)
+{
+    AsyncLogger::Instance().SetRateLimit(messagesPerSecond);
+}
+
+void AsyncLogBackend::SetSink(AsyncLogSink sink)
+{
+    AsyncLogger::Instance().SetSink(std::move(sink));
+}
+
+void AsyncLogBackend::Flush()
+{
+    AsyncLogger::Instance().Drain();
+}
+
+size_t AsyncLogBackend::Format(const AsyncLogRecord& record, char* out, size_t size)
+{
+    if (out == nullptr || size == 0) {
+        return 0;
+    }
+    size_t pos = 0;
+    auto advance = [&pos, size](int written) {
+        if (written > 0) {
+            pos = std::min(pos + static_cast<size_t>(written), size - 1);
+        }
+    };
+    if (record.site->file != nullptr) {
+        const char* file = std::strrchr(record.site->file, '/');
+        advance(snprintf(out, size, "(%s, %d): ", file ? file + 1 : record.site->file, record.site->line));
+    }
+    size_t argIndex = 0;
+    for (const char* fmt = record.site->format; *fmt != '\0' && pos + 1 < size; ++fmt) {
+        if (*fmt != '%') {
+            out[pos++] = *fmt;
+            continue;
+        }
+        if (fmt[1] == '%') {
+            out[pos++] = '%';
+            ++fmt;
+            continue;
+        }
+        ++fmt;
+        if (*fmt == '{') { // hilog privacy flag, e.g. %{public}s
+            const char* end = std::strchr(fmt, '}');
+            fmt = end ? end + 1 : fmt;
+        }
+        char spec[SPEC_SIZE] = {'%'};
+        size_t specLen = 1;
+        for (; *fmt != '\0' && std::strchr("-+ #0123456789.*", *fmt) != nullptr; ++fmt) {
+            if (*fmt == '*' && argIndex < record.argCount) { // width or precision taken from the arguments
+                specLen += static_cast<size_t>(snprintf(spec + specLen, SPEC_SIZE - specLen, "%d",
+                    static_cast<int>(record.args[argIndex++])));
+            } else if (specLen + 2 < SPEC_SIZE) { // 2: room for the conversion and the terminator
+                spec[specLen++] = *fmt;
+            }
+        }
+        while (*fmt != '\0' && std::strchr("hlLqjzt", *fmt) != nullptr) {
+            ++fmt; // the length follows from the recorded type
+        }
+        if (*fmt == '\0') {
+            break;
+        }
+        spec[specLen++] = *fmt;
+        spec[specLen] = '\0';
+        if (argIndex >= record.argCount) {
+            advance(snprintf(out + pos, size - pos, "%s", "<?>"));
+            continue;
+        }
+        advance(FormatArg(record, argIndex++, spec, specLen, out + pos, size - pos));
+    }
+    if (record.suppressed > 0 && pos + 1 < size) {
+        advance(snprintf(out + pos, size - pos, " (%u suppressed)", record.suppressed));
+    }
+    out[pos] = '\0';
+    return pos;
+}
+} // namespace Media
+} // namespace OHOS
@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HISTREAMER_FOUNDATION_ASYNC_LOG_H
+#define HISTREAMER_FOUNDATION_ASYNC_LOG_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+namespace OHOS {
+namespace Media {
+enum AsyncLogLevel : uint8_t {
+    ASYNC_LOG_DEBUG = 0,
+    ASYNC_LOG_INFO = 1,
+    ASYNC_LOG_WARN = 2,
+    ASYNC_LOG_ERROR = 3,
+    ASYNC_LOG_FATAL = 4,
+};
+
+constexpr size_t ASYNC_LOG_MAX_ARGS = 12;
+constexpr size_t ASYNC_LOG_RECORD_SIZE = 256;
+
+/**
+ * One MEDIA_LOG_* call site. It is a function local static, so its address identifies the call site and it keeps
+ * the rate limit state of it.
+ */
+struct AsyncLogSite {
+    constexpr AsyncLogSite(uint8_t lvl, const char* tg, const char* fmt, const char* fl = nullptr, int ln = 0)
+        : level(lvl), tag(tg), format(fmt), file(fl), line(ln)
+    {
+    }
+
+    const uint8_t level;
+    const char* const tag;
+    const char* const format;
+    const char* const file; // set with HST_DEBUG only
+    const int line;
+    std::atomic<int64_t> windowStartNs {0};
+    std::atomic<uint32_t> windowCount {0};
+    std::atomic<uint32_t> suppressed {0};
+};
+
+enum class AsyncLogArgType : uint8_t {
+    SIGNED,
+    UNSIGNED,
+    DOUBLE,
+    STRING, // offset << 32 | length of the terminated copy in AsyncLogRecord::text
+    POINTER,
+};
+
+/**
+ * The raw form of one message: the call site, which holds the format, and the arguments as 64 bit words. Strings
+ * are copied into text because the caller may free them right after the call.
+ */
+struct AsyncLogRecord {
+    const AsyncLogSite* site;
+    int64_t timeNs;
+    uint32_t threadId;
+    uint32_t suppressed;
+    uint8_t argCount;
+    uint8_t textSize;
+    AsyncLogArgType types[ASYNC_LOG_MAX_ARGS];
+    uint64_t args[ASYNC_LOG_MAX_ARGS];
+    char text[ASYNC_LOG_RECORD_SIZE - 40 - ASYNC_LOG_MAX_ARGS * 9]; // 40, 9: the fields above
+};
+static_assert(sizeof(AsyncLogRecord) <= ASYNC_LOG_RECORD_SIZE, "async log record too large");
+
+template <typename T>
+struct IsAsyncLogArg {
+    static constexpr bool value = std::is_arithmetic<T>::value || std::is_enum<T>::value ||
+        std::is_pointer<T>::value || std::is_same<T, std::nullptr_t>::value;
+};
+
+template <typename... Args>
+struct AreAsyncLogArgs : std::true_type {
+};
+
+template <typename T, typename... Args>
+struct AreAsyncLogArgs<T, Args...>
+    : std::integral_constant<bool, IsAsyncLogArg<T>::value && AreAsyncLogArgs<Args...>::value> {
+};
+
+/**
+ * Whether AsyncLog() can record these arguments. Only declared, it is meant for decltype so that the arguments are
+ * not evaluated.
+ */
+template <typename... Args>
+std::integral_constant<bool, sizeof...(Args) <= ASYNC_LOG_MAX_ARGS &&
+    AreAsyncLogArgs<typename std::decay<Args>::type...>::value> AsyncLogArgsCheck(Args&&... args);
+
+/**
+ * Fills one record in the ring of the calling thread and publishes it when destroyed.
+ */
+class AsyncLogWriter {
+public:
+    explicit AsyncLogWriter(AsyncLogSite& site);
+
+    ~AsyncLogWriter();
+
+    AsyncLogWriter(const AsyncLogWriter&) = delete;
+    AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+    /**
+     * Whether a record was reserved, false if the message is rate limited or the ring is full.
+     */
+    bool IsReserved() const
+    {
+        return record_ != nullptr;
+    }
+
+    void Add(bool value)
+    {
+        AddWord(AsyncLogArgType::SIGNED, value ? 1 : 0);
+    }
+
+    void Add(double value)
+    {
+        uint64_t word = 0;
+        static_assert(sizeof(word) == sizeof(value), "double is not 64 bits");
+        std::memcpy(&word, &value, sizeof(word));
+        AddWord(AsyncLogArgType::DOUBLE, word);
+    }
+
+    void Add(std::nullptr_t)
+    {
+        AddWord(AsyncLogArgType::POINTER, 0);
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_enum<T>::value>::type Add(T value)
+    {
+        Add(static_cast<typename std::underlying_type<T>::type>(value));
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type Add(T value)
+    {
+        if (std::is_signed<T>::value) {
+            AddWord(AsyncLogArgType::SIGNED, static_cast<uint64_t>(static_cast<int64_t>(value)));
+        } else {
+            AddWord(AsyncLogArgType::UNSIGNED, static_cast<uint64_t>(value));
+        }
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_floating_point<T>::value && !std::is_same<T, double>::value>::type Add(T value)
+    {
+        Add(static_cast<double>(value));
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_pointer<T>::value>::type Add(T value)
+    {
+        AddPointer(value);
+    }
+
+private:
+    void AddPointer(char* value)
+    {
+        AddString(value);
+    }
+
+    void AddPointer(const char* value)
+    {
+        AddString(value);
+    }
+
+    template <typename T>
+    void AddPointer(T* value)
+    {
+        AddWord(AsyncLogArgType::POINTER, reinterpret_cast<uintptr_t>(value));
+    }
+
+    void AddWord(AsyncLogArgType type, uint64_t word)
+    {
+        record_->types[record_->argCount] = type;
+        record_->args[record_->argCount++] = word;
+    }
+
+    void AddString(const char* str);
+
+    void* ring_ {nullptr};
+    AsyncLogRecord* record_ {nullptr};
+    AsyncLogRecord fallbackRecord_; // used while the backend is not available, e.g. while the process exits
+};
+
+template <typename... Args>
+inline bool DoAsyncLog(AsyncLogSite& site, std::false_type, Args... args)
+{
+    return false;
+}
+
+template <typename... Args>
+inline bool DoAsyncLog(AsyncLogSite& site, std::true_type, Args... args)
+{
+    AsyncLogWriter writer(site);
+    if (writer.IsReserved()) {
+        int order[] = {0, (writer.Add(args), 0)...}; // 0: keeps the array non empty without arguments
+        (void)order;
+    }
+    return true;
+}
+
+/**
+ * Records one message for the background log thread. While the backend is not available, e.g. while the process
+ * exits, the message is formatted and logged synchronously.
+ *
+ * @return false if the message was not logged because some argument has a type that can't be recorded or there
+ * are too many arguments, see AsyncLogArgsCheck()
+ */
+template <typename... Args>
+inline bool AsyncLog(AsyncLogSite& site, Args... args)
+{
+    return DoAsyncLog(site, decltype(AsyncLogArgsCheck(args...))(), args...);
+}
+
+/**
+ * Output of the formatted messages, hilog by default.
+ */
+using AsyncLogSink = std::function<void(uint8_t level, const char* tag, uint32_t threadId, const char* message)>;
+
+/**
+ * Controls of the backend behind AsyncLog().
+ *
+ * Every thread records into its own ring of fixed size records, without locks and without formatting. A low
+ * priority thread collects the records of all rings, orders them by time and formats them. Errors wake it up at
+ * once, other messages are written at the latest after FLUSH_INTERVAL_MS. When a ring is full new messages of
+ * that thread are dropped and counted rather than blocking the caller.
+ */
+class AsyncLogBackend {
+public:
+    static constexpr int FLUSH_INTERVAL_MS = 50;
+
+    /**
+     * Messages per call site and second, the rest is counted and reported with the next message of that site.
+     * 0 means no limit.
+     */
+    static void SetRateLimit(uint32_t messagesPerSecond);
+
+    static void SetSink(AsyncLogSink sink);
+
+    /**
+     * Formats and writes all messages recorded so far, on the calling thread.
+     */
+    static void Flush();
+
+    /**
+     * Formats one record the way the background thread does.
+     *
+     * @return length of the message
+     */
+    static size_t Format(const AsyncLogRecord& record, char* out, size_t size);
+};
+} // namespace Media
+} // namespace OHOS
+#endif // HISTREAMER_FOUNDATION_ASYNC_LOG_H
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HISTREAMER_FOUNDATION_CPP_EXT_ARENA_H
+#define HISTREAMER_FOUNDATION_CPP_EXT_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace OHOS {
+namespace Media {
+namespace CppExt {
+/**
+ * Monotonic memory arena: allocations bump a pointer through chunks, deallocation does nothing and the memory is
+ * given back all at once by Reset().
+ *
+ * Reset() keeps one chunk as large as everything used in the last round, so an arena that is reset after every round
+ * of similar work stops touching the heap after the first round.
+ */
+class Arena {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 4096;
+
+    explicit Arena(size_t chunkSize = DEFAULT_CHUNK_SIZE) : chunkSize_(chunkSize)
+    {
+    }
+
+    ~Arena()
+    {
+        FreeChunks(nullptr);
+    }
+
+    Arena(const Arena&) = delete;
+
+    Arena& operator=(const Arena&) = delete;
+
+    void* Allocate(size_t size, size_t align = alignof(std::max_align_t))
+    {
+        auto pos = AlignUp(cur_, align);
+        if (head_ == nullptr || pos + size > end_) {
+            AddChunk(size + align);
+            pos = AlignUp(cur_, align);
+        }
+        cur_ = pos + size;
+        used_ += size;
+        return reinterpret_cast<void*>(pos);
+    }
+
+    /**
+     * Gives back all memory allocated since the last reset. Nothing allocated from the arena may be used any more.
+     */
+    void Reset()
+    {
+        if (head_ != nullptr && head_->next != nullptr) {
+            size_t total = 0;
+            for (auto chunk = head_; chunk != nullptr; chunk = chunk->next) {
+                total += chunk->size;
+            }
+            FreeChunks(nullptr);
+            AddChunk(total);
+        }
+        if (head_ != nullptr) {
+            cur_ = reinterpret_cast<uintptr_t>(head_ + 1);
+        }
+        used_ = 0;
+    }
+
+    /// Bytes allocated since the last reset.
+    size_t GetUsedSize() const
+    {
+        return used_;
+    }
+
+    /// Bytes the arena holds from the heap.
+    size_t GetReservedSize() const
+    {
+        size_t total = 0;
+        for (auto chunk = head_; chunk != nullptr; chunk = chunk->next) {
+            total += chunk->size;
+        }
+        return total;
+    }
+
+private:
+    struct alignas(std::max_align_t) Chunk {
+        Chunk* next;
+        size_t size;
+    };
+
+    static uintptr_t AlignUp(uintptr_t pos, size_t align)
+    {
+        return (pos + align - 1) & ~static_cast<uintptr_t>(align - 1);
+    }
+
+    void AddChunk(size_t minSize)
+    {
+        size_t size = minSize > chunkSize_ ? minSize : chunkSize_;
+        auto chunk = static_cast<Chunk*>(::operator new(sizeof(Chunk) + size));
+        chunk->next = head_;
+        chunk->size = size;
+        head_ = chunk;
+        cur_ = reinterpret_cast<uintptr_t>(chunk + 1);
+        end_ = cur_ + size;
+    }
+
+    void FreeChunks(Chunk* keep)
+    {
+        while (head_ != keep) {
+            auto next = head_->next;
+            ::operator delete(head_);
+            head_ = next;
+        }
+    }
+
+    size_t chunkSize_;
+    Chunk* head_ {nullptr};
+    uintptr_t cur_ {0};
+    uintptr_t end_ {0};
+    size_t used_ {0};
+};
+
+/**
+ * Allocator for standard containers that takes its memory from an arena, or from the heap if there is none. The
+ * container must not outlive the arena, or the next Reset() of it.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator(Arena* arena = nullptr) noexcept : arena_(arena) // NOLINT: implicit, like polymorphic_allocator
+    {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.GetArena()) // NOLINT: rebind
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        if (arena_ == nullptr) {
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t)
+    {
+        if (arena_ == nullptr) {
+            ::operator delete(ptr);
+        }
+    }
+
+    Arena* GetArena() const noexcept
+    {
+        return arena_;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept
+    {
+        return arena_ == other.GetArena();
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept
+    {
+        return arena_ != other.GetArena();
+    }
+
+private:
+    Arena* arena_;
+};
+} // namespace CppExt
+} // namespace Media
+} // namespace OHOS
+#endif // HISTREAMER_FOUNDATION_CPP_EXT_ARENA_H
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HISTREAMER_FOUNDATION_CPP_EXT_FLAT_MAP_H
+#define HISTREAMER_FOUNDATION_CPP_EXT_FLAT_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace OHOS {
+namespace Media {
+namespace CppExt {
+/**
+ * Associative container with the interface of std::map, kept as a vector sorted by key.
+ *
+ * Meant for the small maps keyed by Tag or MetaID: lookups are a binary search over contiguous memory and the
+ * whole map is one allocation, so copying it is cheap too. Unlike std::map, inserting or erasing invalidates
+ * iterators and references to the elements.
+ */
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class FlatMap {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using size_type = size_t;
+    using Storage = std::vector<value_type>;
+    using iterator = typename Storage::iterator;
+    using const_iterator = typename Storage::const_iterator;
+
+    FlatMap() = default;
+
+    FlatMap(std::initializer_list<value_type> init)
+    {
+        items_.reserve(init.size());
+        for (const auto& item : init) {
+            (void)insert(item);
+        }
+    }
+
+    template <typename InputIt>
+    FlatMap(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first) {
+            (void)insert(*first);
+        }
+    }
+
+    iterator begin() noexcept
+    {
+        return items_.begin();
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return items_.begin();
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return items_.cbegin();
+    }
+
+    iterator end() noexcept
+    {
+        return items_.end();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return items_.end();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return items_.cend();
+    }
+
+    bool empty() const noexcept
+    {
+        return items_.empty();
+    }
+
+    size_type size() const noexcept
+    {
+        return items_.size();
+    }
+
+    void clear() noexcept
+    {
+        items_.clear();
+    }
+
+    void reserve(size_type count)
+    {
+        items_.reserve(count);
+    }
+
+    iterator lower_bound(const Key& key)
+    {
+        return std::lower_bound(items_.begin(), items_.end(), key, KeyLess());
+    }
+
+    const_iterator lower_bound(const Key& key) const
+    {
+        return std::lower_bound(items_.begin(), items_.end(), key, KeyLess());
+    }
+
+    iterator find(const Key& key)
+    {
+        auto it = lower_bound(key);
+        return (it != items_.end() && !Compare()(key, it->first)) ? it : items_.end();
+    }
+
+    const_iterator find(const Key& key) const
+    {
+        auto it = lower_bound(key);
+        return (it != items_.end() && !Compare()(key, it->first)) ? it : items_.end();
+    }
+
+    size_type count(const Key& key) const
+    {
+        return find(key) == items_.end() ? 0 : 1;
+    }
+
+    T& at(const Key& key)
+    {
+        auto it = find(key);
+        if (it == items_.end()) {
+            throw std::out_of_range("FlatMap::at");
+        }
+        return it->second;
+    }
+
+    const T& at(const Key& key) const
+    {
+        auto it = find(key);
+        if (it == items_.end()) {
+            throw std::out_of_range("FlatMap::at");
+        }
+        return it->second;
+    }
+
+    T& operator[](const Key& key)
+    {
+        auto it = lower_bound(key);
+        if (it == items_.end() || Compare()(key, it->first)) {
+            it = items_.emplace(it, key, T());
+        }
+        return it->second;
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value)
+    {
+        auto it = lower_bound(value.first);
+        if (it != items_.end() && !Compare()(value.first, it->first)) {
+            return {it, false};
+        }
+        return {items_.insert(it, value), true};
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value)
+    {
+        auto it = lower_bound(value.first);
+        if (it != items_.end() && !Compare()(value.first, it->first)) {
+            return {it, false};
+        }
+        return {items_.insert(it, std::move(value)), true};
+    }
+
+    template <typename P, typename = typename std::enable_if<std::is_constructible<value_type, P&&>::value>::type>
+    std::pair<iterator, bool> insert(P&& value)
+    {
+        return insert(value_type(std::forward<P>(value)));
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        return insert(value_type(std::forward<Args>(args)...));
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj)
+    {
+        auto it = lower_bound(key);
+        if (it != items_.end() && !Compare()(key, it->first)) {
+            it->second = std::forward<M>(obj);
+            return {it, false};
+        }
+        return {items_.emplace(it, key, std::forward<M>(obj)), true};
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return items_.erase(pos);
+    }
+
+    iterator erase(iterator pos)
+    {
+        return items_.erase(pos);
+    }
+
+    size_type erase(const Key& key)
+    {
+        auto it = find(key);
+        if (it == items_.end()) {
+            return 0;
+        }
+        items_.erase(it);
+        return 1;
+    }
+
+    void swap(FlatMap& other) noexcept
+    {
+        items_.swap(other.items_);
+    }
+
+private:
+    struct KeyLess {
+        bool operator()(const value_type& item, const Key& key) const
+        {
+            return Compare()(item.first, key);
+        }
+    };
+
+    Storage items_ {};
+};
+} // namespace CppExt
+} // namespace Media
+} // namespace OHOS
+#endif // HISTREAMER_FOUNDATION_CPP_EXT_FLAT_MAP_H
@@ -81,12 +81,41 @@ inline std::string MediaGetFileName(std::string file)
     } while (0)
 #endif
 
+#ifdef HST_ASYNC_LOG
+// The arguments are recorded and formatted on a background thread, see async_log.h. Arguments that can't be
+// recorded, e.g. more than ASYNC_LOG_MAX_ARGS of them, make the call log synchronously as before. Which way a call
+// goes is decided from the argument types alone, so the arguments are evaluated once either way.
+#include "foundation/async_log.h"
+
+#ifndef HST_DEBUG
+#define HST_ASYNC_LOG_FILE nullptr
+#else
+#define HST_ASYNC_LOG_FILE __FILE__
+#endif
+
+#define HST_DECORATOR_ASYNC(level, op, fmt, args...)                                                                   \
+    do {                                                                                                               \
+        static OHOS::Media::AsyncLogSite hstLogSite {level, HST_LOG_TAG, fmt, HST_ASYNC_LOG_FILE, __LINE__};           \
+        if (decltype(OHOS::Media::AsyncLogArgsCheck(args))::value) {                                                   \
+            (void)OHOS::Media::AsyncLog(hstLogSite, ##args);                                                           \
+        } else {                                                                                                       \
+            HST_DECORATOR_HILOG(op, fmt, ##args);                                                                      \
+        }                                                                                                              \
+    } while (0)
+
+#define MEDIA_LOG_D(fmt, ...) HST_DECORATOR_ASYNC(OHOS::Media::ASYNC_LOG_DEBUG, HILOG_DEBUG, fmt, ##__VA_ARGS__)
+#define MEDIA_LOG_I(fmt, ...) HST_DECORATOR_ASYNC(OHOS::Media::ASYNC_LOG_INFO, HILOG_INFO, fmt, ##__VA_ARGS__)
+#define MEDIA_LOG_W(fmt, ...) HST_DECORATOR_ASYNC(OHOS::Media::ASYNC_LOG_WARN, HILOG_WARN, fmt, ##__VA_ARGS__)
+#define MEDIA_LOG_E(fmt, ...) HST_DECORATOR_ASYNC(OHOS::Media::ASYNC_LOG_ERROR, HILOG_ERROR, fmt, ##__VA_ARGS__)
+#define MEDIA_LOG_F(fmt, ...) HST_DECORATOR_ASYNC(OHOS::Media::ASYNC_LOG_FATAL, HILOG_FATAL, fmt, ##__VA_ARGS__)
+#else
 #define MEDIA_LOG_D(fmt, ...) HST_DECORATOR_HILOG(HILOG_DEBUG, fmt, ##__VA_ARGS__)
 #define MEDIA_LOG_I(fmt, ...) HST_DECORATOR_HILOG(HILOG_INFO, fmt, ##__VA_ARGS__)
 #define MEDIA_LOG_W(fmt, ...) HST_DECORATOR_HILOG(HILOG_WARN, fmt, ##__VA_ARGS__)
 #define MEDIA_LOG_E(fmt, ...) HST_DECORATOR_HILOG(HILOG_ERROR, fmt, ##__VA_ARGS__)
 #define MEDIA_LOG_F(fmt, ...) HST_DECORATOR_HILOG(HILOG_FATAL, fmt, ##__VA_ARGS__)
 #endif
+#endif
 
 
 // Control the MEDIA_LOG_D.
@@ -100,6 +129,31 @@ inline std::string MediaGetFileName(std::string file)
 #define MEDIA_LOG_D(msg, ...) ((void)0)
 #endif
 
+// Levels below HST_LOG_LEVEL_FLOOR are compiled out: 0 debug, 1 info, 2 warn, 3 error.
+#ifndef HST_LOG_LEVEL_FLOOR
+#define HST_LOG_LEVEL_FLOOR 0
+#endif
+
+#if HST_LOG_LEVEL_FLOOR > 0
+#undef MEDIA_LOG_D
+#define MEDIA_LOG_D(msg, ...) ((void)0)
+#endif
+
+#if HST_LOG_LEVEL_FLOOR > 1
+#undef MEDIA_LOG_I
+#define MEDIA_LOG_I(msg, ...) ((void)0)
+#endif
+
+#if HST_LOG_LEVEL_FLOOR > 2
+#undef MEDIA_LOG_W
+#define MEDIA_LOG_W(msg, ...) ((void)0)
+#endif
+
+#if HST_LOG_LEVEL_FLOOR > 3
+#undef MEDIA_LOG_E
+#define MEDIA_LOG_E(msg, ...) ((void)0)
+#endif
+
 #ifndef NOK_RETURN
 #define NOK_RETURN(exec)                                                                                               \
     do {                                                                                                               \
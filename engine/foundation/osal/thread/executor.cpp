@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2021-2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define HST_LOG_TAG "Executor"
+
+#include "executor.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+
+#include "foundation/log.h"
+
+namespace OHOS {
+namespace Media {
+namespace OSAL {
+namespace {
+constexpr size_t MIN_THREAD_NUM = 2;
+}
+
+Executor& Executor::Instance()
+{
+    static Executor executor(std::max(static_cast<size_t>(std::thread::hardware_concurrency()), MIN_THREAD_NUM));
+    return executor;
+}
+
+Executor::Executor(size_t threadNum)
+{
+    threadNum = std::max(threadNum, static_cast<size_t>(1));
+    for (size_t i = 0; i < threadNum; ++i) {
+        workers_.emplace_back(new Worker());
+    }
+    for (size_t i = 0; i < threadNum; ++i) {
+        auto& worker = workers_[i];
+        worker->thread = std::unique_ptr<OSAL::Thread>(new OSAL::Thread(ThreadPriority::HIGH));
+        worker->thread->SetName("Executor" + std::to_string(i));
+        if (!worker->thread->CreateThread([this, i] { WorkerLoop(i); })) {
+            MEDIA_LOG_E("executor worker " PUBLIC_LOG_ZU " create failed", i);
+        }
+    }
+    MEDIA_LOG_I("executor created with " PUBLIC_LOG_ZU " workers", threadNum);
+}
+
+Executor::~Executor()
+{
+    {
+        OSAL::ScopedLock lock(idleMutex_);
+        running_ = false;
+        idleCond_.NotifyAll();
+    }
+    // join every worker before any deque goes away, the others may still be stealing from it
+    for (auto& worker : workers_) {
+        worker->thread.reset();
+    }
+}
+
+void Executor::Submit(std::function<void()> job, ThreadPriority priority)
+{
+    FALSE_RETURN(job != nullptr);
+    size_t index = GetCurrentWorker();
+    if (index >= workers_.size()) {
+        index = nextWorker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    }
+    // counted before it is visible, a worker popping it at once must not take the count below zero
+    pendingJobs_.fetch_add(1, std::memory_order_seq_cst);
+    {
+        auto& worker = workers_[index];
+        OSAL::ScopedLock lock(worker->mutex);
+        worker->lanes[GetLane(priority)].emplace_back(std::move(job));
+    }
+    if (idleWorkers_.load(std::memory_order_seq_cst) > 0) {
+        OSAL::ScopedLock lock(idleMutex_);
+        idleCond_.NotifyOne();
+    }
+}
+
+size_t Executor::GetThreadNum() const
+{
+    return workers_.size();
+}
+
+Executor::Lane Executor::GetLane(ThreadPriority priority)
+{
+    if (priority >= ThreadPriority::HIGH) {
+        return LANE_HIGH;
+    }
+    if (priority >= ThreadPriority::NORMAL) {
+        return LANE_NORMAL;
+    }
+    return LANE_LOW;
+}
+
+size_t Executor::GetCurrentWorker() const
+{
+    auto self = pthread_self();
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        if (workers_[i]->started.load(std::memory_order_acquire) && pthread_equal(workers_[i]->id, self)) {
+            return i;
+        }
+    }
+    return workers_.size();
+}
+
+bool Executor::PopJob(size_t index, std::function<void()>& job)
+{
+    for (size_t lane = LANE_HIGH; lane < LANE_NUM; ++lane) {
+        // own deque first, then steal from the other workers in order
+        for (size_t i = 0; i < workers_.size(); ++i) {
+            auto& worker = workers_[(index + i) % workers_.size()];
+            OSAL::ScopedLock lock(worker->mutex);
+            if (!worker->lanes[lane].empty()) {
+                job = std::move(worker->lanes[lane].front());
+                worker->lanes[lane].pop_front();
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void Executor::WorkerLoop(size_t index)
+{
+    auto& self = workers_[index];
+    self->id = pthread_self();
+    self->started.store(true, std::memory_order_release);
+    std::function<void()> job;
+    while (running_.load()) {
+        if (PopJob(index, job)) {
+            pendingJobs_.fetch_sub(1, std::memory_order_relaxed);
+            job();
+            job = nullptr;
+            continue;
+        }
+        OSAL::ScopedLock lock(idleMutex_);
+        idleWorkers_.fetch_add(1, std::memory_order_seq_cst);
+        idleCond_.Wait(lock, [this] {
+            return !running_.load() || pendingJobs_.load(std::memory_order_seq_cst) > 0;
+        });
+        idleWorkers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+} // namespace OSAL
+} // namespace Media
+} // namespace OHOS
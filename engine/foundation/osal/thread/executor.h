@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2021-2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HISTREAMER_FOUNDATION_OSAL_EXECUTOR_H
+#define HISTREAMER_FOUNDATION_OSAL_EXECUTOR_H
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "foundation/osal/thread/condition_variable.h"
+#include "foundation/osal/thread/mutex.h"
+#include "foundation/osal/thread/scoped_lock.h"
+#include "foundation/osal/thread/thread.h"
+
+namespace OHOS {
+namespace Media {
+namespace OSAL {
+/**
+ * Work-stealing worker pool shared by all pooled Tasks of the process.
+ *
+ * Jobs are short cooperative units of work, e.g. one iteration of a Task loop. Each worker owns one deque per
+ * priority lane: a job submitted by a worker goes to its own deque, other submissions are spread round-robin.
+ * A worker always serves the highest non-empty lane, first from its own deques and then by stealing from the
+ * other workers, and sleeps only when there is no job left anywhere.
+ *
+ * Jobs must not block for long, since a blocked job holds one of the few worker threads.
+ */
+class Executor {
+public:
+    static Executor& Instance();
+
+    explicit Executor(size_t threadNum);
+
+    Executor(const Executor&) = delete;
+
+    Executor& operator=(const Executor&) = delete;
+
+    ~Executor();
+
+    void Submit(std::function<void()> job, ThreadPriority priority = ThreadPriority::HIGH);
+
+    size_t GetThreadNum() const;
+
+private:
+    enum Lane : size_t {
+        LANE_HIGH = 0,
+        LANE_NORMAL,
+        LANE_LOW,
+        LANE_NUM,
+    };
+
+    struct Worker {
+        OSAL::Mutex mutex {};
+        std::deque<std::function<void()>> lanes[LANE_NUM] {};
+        std::atomic<bool> started {false};
+        pthread_t id {};
+        std::unique_ptr<OSAL::Thread> thread {};
+    };
+
+    static Lane GetLane(ThreadPriority priority);
+
+    size_t GetCurrentWorker() const;
+
+    bool PopJob(size_t index, std::function<void()>& job);
+
+    void WorkerLoop(size_t index);
+
+    std::vector<std::unique_ptr<Worker>> workers_ {};
+    std::atomic<size_t> nextWorker_ {0};
+    std::atomic<size_t> pendingJobs_ {0};
+    std::atomic<int> idleWorkers_ {0};
+    std::atomic<bool> running_ {true};
+    OSAL::Mutex idleMutex_ {};
+    OSAL::ConditionVariable idleCond_ {};
+};
+} // namespace OSAL
+} // namespace Media
+} // namespace OHOS
+#endif // HISTREAMER_FOUNDATION_OSAL_EXECUTOR_H
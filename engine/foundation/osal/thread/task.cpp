@@ -17,19 +17,21 @@
 #include "task.h"
 
 #include "foundation/log.h"
+#include "foundation/osal/thread/executor.h"
 
 namespace OHOS {
 namespace Media {
 namespace OSAL {
-Task::Task(std::string name, ThreadPriority priority)
-    : name_(std::move(name)), runningState_(RunningState::STOPPED), loop_(priority)
+Task::Task(std::string name, ThreadPriority priority, bool pooled)
+    : name_(std::move(name)), priority_(priority), pooled_(pooled), runningState_(RunningState::STOPPED),
+      loop_(priority)
 {
     MEDIA_LOG_D("task " PUBLIC_LOG_S " ctor called", name_.c_str());
     loop_.SetName(name_);
 }
 
-Task::Task(std::string name, std::function<void()> handler, ThreadPriority priority)
-    : Task(std::move(name), priority)
+Task::Task(std::string name, std::function<void()> handler, ThreadPriority priority, bool pooled)
+    : Task(std::move(name), priority, pooled)
 {
     MEDIA_LOG_D("task " PUBLIC_LOG_S " ctor called", name_.c_str());
     handler_ = std::move(handler);
@@ -38,6 +40,15 @@ Task::Task(std::string name, std::function<void()> handler, ThreadPriority prior
 Task::~Task()
 {
     MEDIA_LOG_D("task " PUBLIC_LOG_S " dtor called", name_.c_str());
+    if (pooled_) {
+        // the queued iteration refers to this task, wait until it has been retired
+        OSAL::ScopedLock lock(stateMutex_);
+        if (scheduled_) {
+            runningState_ = RunningState::STOPPING;
+            syncCond_.Wait(lock, [this] { return !scheduled_; });
+        }
+    }
+    OSAL::ScopedLock lock(stateMutex_);
     runningState_ = RunningState::STOPPED;
     syncCond_.NotifyAll();
 }
@@ -47,7 +58,9 @@ void Task::Start()
 #ifndef START_FAKE_TASK
     OSAL::ScopedLock lock(stateMutex_);
     runningState_ = RunningState::STARTED;
-    if (!loop_ && !loop_.CreateThread([this] { Run(); })) {
+    if (pooled_) {
+        ScheduleOnce();
+    } else if (!loop_ && !loop_.CreateThread([this] { Run(); })) {
         MEDIA_LOG_E("task " PUBLIC_LOG_S " create failed", name_.c_str());
     } else {
         syncCond_.NotifyAll();
@@ -62,7 +75,8 @@ void Task::Stop()
                 name_.c_str(), runningState_.load());
     OSAL::ScopedLock lock(stateMutex_);
     if (runningState_.load() != RunningState::STOPPED) {
-        runningState_ = RunningState::STOPPING;
+        // a pooled task without a queued iteration has nothing left to retire
+        runningState_ = (pooled_ && !scheduled_) ? RunningState::STOPPED : RunningState::STOPPING;
         syncCond_.NotifyAll();
         syncCond_.Wait(lock, [this] { return runningState_.load() == RunningState::STOPPED; });
     }
@@ -74,7 +88,8 @@ void Task::StopAsync()
     MEDIA_LOG_D("task " PUBLIC_LOG_S " StopAsync called", name_.c_str());
     OSAL::ScopedLock lock(stateMutex_);
     if (runningState_.load() != RunningState::STOPPED) {
-        runningState_ = RunningState::STOPPING;
+        runningState_ = (pooled_ && !scheduled_) ? RunningState::STOPPED : RunningState::STOPPING;
+        syncCond_.NotifyAll();
     }
 }
 
@@ -119,6 +134,24 @@ void Task::RegisterHandler(std::function<void()> handler)
     handler_ = std::move(handler);
 }
 
+void Task::SetSchedule(const ThreadSchedule& schedule)
+{
+    if (pooled_) {
+        MEDIA_LOG_W("task " PUBLIC_LOG_S " is pooled, schedule ignored", name_.c_str());
+        return;
+    }
+    OSAL::ScopedLock lock(stateMutex_);
+    (void)loop_.SetSchedule(schedule);
+}
+
+void Task::ApplySchedulePolicy(const TaskSchedulePolicy& policy)
+{
+    auto it = policy.find(name_);
+    if (it != policy.end()) {
+        SetSchedule(it->second);
+    }
+}
+
 void Task::DoTask()
 {
     MEDIA_LOG_D("task " PUBLIC_LOG_S " not override DoTask...", name_.c_str());
@@ -130,13 +163,16 @@ void Task::Run()
         MEDIA_LOG_D("task " PUBLIC_LOG_S " is running on state : " PUBLIC_LOG_D32, name_.c_str(), runningState_.load());
         if (runningState_.load() == RunningState::STARTED) {
             handler_();
+            if (runningState_.load() == RunningState::STARTED) {
+                continue; // the state lock is only taken on transitions
+            }
         }
         OSAL::ScopedLock lock(stateMutex_);
         if (runningState_.load() == RunningState::PAUSING || runningState_.load() == RunningState::PAUSED) {
             runningState_ = RunningState::PAUSED;
             syncCond_.NotifyAll();
-            constexpr int timeoutMs = 500;
-            syncCond_.WaitFor(lock, timeoutMs, [this] { return runningState_.load() != RunningState::PAUSED; });
+            // every state change happens under stateMutex_ and notifies, so no periodic wakeup is needed
+            syncCond_.Wait(lock, [this] { return runningState_.load() != RunningState::PAUSED; });
         }
         if (runningState_.load() == RunningState::STOPPING || runningState_.load() == RunningState::STOPPED) {
             runningState_ = RunningState::STOPPED;
@@ -145,6 +181,32 @@ void Task::Run()
         }
     }
 }
+void Task::ScheduleOnce()
+{
+    if (!scheduled_) {
+        scheduled_ = true;
+        Executor::Instance().Submit([this] { RunOnce(); }, priority_);
+    }
+}
+
+void Task::RunOnce()
+{
+    if (runningState_.load() == RunningState::STARTED) {
+        handler_();
+    }
+    OSAL::ScopedLock lock(stateMutex_);
+    if (runningState_.load() == RunningState::STARTED) {
+        Executor::Instance().Submit([this] { RunOnce(); }, priority_);
+        return;
+    }
+    scheduled_ = false;
+    if (runningState_.load() == RunningState::PAUSING || runningState_.load() == RunningState::PAUSED) {
+        runningState_ = RunningState::PAUSED;
+    } else {
+        runningState_ = RunningState::STOPPED;
+    }
+    syncCond_.NotifyAll();
+}
 } // namespace OSAL
 } // namespace Media
 } // namespace OHOS
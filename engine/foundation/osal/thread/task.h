@@ -18,6 +18,7 @@
 
 #include <atomic>
 #include <functional>
+#include <map>
 #include <string>
 
 #include "foundation/osal/thread/condition_variable.h"
@@ -28,12 +29,25 @@
 namespace OHOS {
 namespace Media {
 namespace OSAL {
+/**
+ * Schedules of the tasks of one pipeline, keyed by task name.
+ */
+using TaskSchedulePolicy = std::map<std::string, ThreadSchedule>;
+
 
+/**
+ * Loop calling the handler until paused or stopped.
+ *
+ * By default every Task owns a thread. A pooled Task runs each iteration of its handler as a job on the shared
+ * Executor instead, and holds no thread at all while paused or stopped. Only handlers that return in bounded time
+ * should be pooled: a handler blocking on a queue fed by another pooled Task may starve the pool.
+ */
 class Task {
 public:
-    explicit Task(std::string name, ThreadPriority priority = ThreadPriority::HIGH);
+    explicit Task(std::string name, ThreadPriority priority = ThreadPriority::HIGH, bool pooled = false);
 
-    explicit Task(std::string name, std::function<void()> handler, ThreadPriority priority = ThreadPriority::HIGH);
+    explicit Task(std::string name, std::function<void()> handler, ThreadPriority priority = ThreadPriority::HIGH,
+                  bool pooled = false);
 
     virtual ~Task();
 
@@ -51,6 +65,22 @@ public:
 
     void RegisterHandler(std::function<void()> handler);
 
+    const std::string& GetName() const
+    {
+        return name_;
+    }
+
+    /**
+     * Sets the scheduling class, priority and cpu affinity of the task thread, see Thread::SetSchedule().
+     * Pooled tasks run on the shared executor threads and ignore it.
+     */
+    void SetSchedule(const ThreadSchedule& schedule);
+
+    /**
+     * Applies the entry of the policy named after this task, if there is one.
+     */
+    void ApplySchedulePolicy(const TaskSchedulePolicy& policy);
+
 private:
     enum class RunningState {
         STARTED,
@@ -62,7 +92,14 @@ private:
 
     void Run();
 
+    void RunOnce();
+
+    void ScheduleOnce();
+
     const std::string name_;
+    const ThreadPriority priority_;
+    const bool pooled_;
+    bool scheduled_ {false};
     std::atomic<RunningState> runningState_{RunningState::PAUSED};
     std::function<void()> handler_ = [this] { DoTask(); };
     OSAL::Thread loop_;
@@ -16,11 +16,72 @@
 #define HST_LOG_TAG "Thread"
 
 #include "thread.h"
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 #include "foundation/log.h"
+#include "foundation/osal/thread/scoped_lock.h"
 
 namespace OHOS {
 namespace Media {
 namespace OSAL {
+namespace {
+int ToNativePolicy(SchedPolicy policy)
+{
+    switch (policy) {
+        case SchedPolicy::FIFO:
+            return SCHED_FIFO;
+        case SchedPolicy::RR:
+            return SCHED_RR;
+        default:
+            return SCHED_OTHER;
+    }
+}
+
+bool ApplySchedule(pthread_t id, long tid, const ThreadSchedule& schedule, const std::string& name)
+{
+    bool ok = true;
+    if (schedule.policy != SchedPolicy::DEFAULT) {
+        int policy = ToNativePolicy(schedule.policy);
+        struct sched_param param = {policy == SCHED_OTHER ? 0 : schedule.priority};
+        int ret = pthread_setschedparam(id, policy, &param);
+        if (ret != 0) {
+            MEDIA_LOG_W("thread " PUBLIC_LOG_S " set policy " PUBLIC_LOG_D32 " priority " PUBLIC_LOG_D32
+                        " failed, ret: " PUBLIC_LOG_D32, name.c_str(), policy, param.sched_priority, ret);
+            ok = false;
+        }
+    }
+#if defined(__linux__)
+    // the nice value of a thread is set through its kernel thread id
+    if (schedule.policy == SchedPolicy::OTHER && tid > 0 &&
+        setpriority(PRIO_PROCESS, static_cast<id_t>(tid), schedule.nice) != 0) {
+        MEDIA_LOG_W("thread " PUBLIC_LOG_S " set nice " PUBLIC_LOG_D32 " failed", name.c_str(), schedule.nice);
+        ok = false;
+    }
+#endif
+#if defined(__linux__) && defined(CPU_SETSIZE)
+    if (!schedule.cpus.empty()) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (auto cpu : schedule.cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        int ret = pthread_setaffinity_np(id, sizeof(cpus), &cpus);
+        if (ret != 0) {
+            MEDIA_LOG_W("thread " PUBLIC_LOG_S " set affinity failed, ret: " PUBLIC_LOG_D32, name.c_str(), ret);
+            ok = false;
+        }
+    }
+#endif
+    return ok;
+}
+} // namespace
+
 Thread::Thread(ThreadPriority priority) noexcept : id_(), name_(), priority_(priority), state_()
 {
 }
@@ -36,6 +97,7 @@ Thread& Thread::operator=(Thread&& other) noexcept
         id_ = other.id_;
         name_ = std::move(other.name_);
         priority_ = other.priority_;
+        schedule_ = std::move(other.schedule_);
         state_ = std::move(other.state_);
     }
     return *this;
@@ -63,6 +125,7 @@ bool Thread::CreateThread(const std::function<void()>& func)
     state_ = std::unique_ptr<State>(new State);
     state_->func = func;
     state_->name = name_;
+    state_->schedule = schedule_;
     pthread_attr_t attr;
     pthread_attr_init(&attr);
     pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
@@ -89,6 +152,20 @@ bool Thread::CreateThread(const std::function<void()>& func)
     return rtv == 0;
 }
 
+bool Thread::SetSchedule(const ThreadSchedule& schedule)
+{
+    schedule_ = schedule;
+    if (!state_) {
+        return true;
+    }
+    OSAL::ScopedLock lock(state_->mutex);
+    state_->schedule = schedule;
+    if (!state_->started) {
+        return true; // the thread applies it when it starts
+    }
+    return ApplySchedule(id_, state_->tid, schedule, name_);
+}
+
 void Thread::SetNameInternal()
 {
 #ifdef SUPPORT_PTHREAD_NAME
@@ -107,6 +184,14 @@ void Thread::SetNameInternal()
 void* Thread::Run(void* arg) // NOLINT: void*
 {
     auto state = static_cast<State*>(arg);
+    if (state) {
+        OSAL::ScopedLock lock(state->mutex);
+        state->started = true;
+#if defined(__linux__)
+        state->tid = static_cast<long>(syscall(SYS_gettid));
+#endif
+        (void)ApplySchedule(pthread_self(), state->tid, state->schedule, state->name);
+    }
     if (state && state->func) {
         state->func();
     }
@@ -20,6 +20,8 @@
 #include <functional>
 #include <memory> // NOLINT
 #include <string>
+#include <vector>
+#include "foundation/osal/thread/mutex.h"
 
 namespace OHOS {
 namespace Media {
@@ -32,6 +34,23 @@ enum class ThreadPriority : int {
     HIGHEST = 39,
 };
 
+enum class SchedPolicy : int {
+    DEFAULT, // keep what the thread was created with
+    OTHER,
+    FIFO,
+    RR,
+};
+
+/**
+ * Scheduling of one thread: the scheduling class, its priority and the cpus the thread may run on.
+ */
+struct ThreadSchedule {
+    SchedPolicy policy {SchedPolicy::DEFAULT};
+    int priority {0}; // real time priority, used with FIFO and RR
+    int nice {0}; // used with OTHER
+    std::vector<int> cpus {}; // empty for no affinity change
+};
+
 class Thread {
 public:
     explicit Thread(ThreadPriority priority = ThreadPriority::HIGH) noexcept;
@@ -52,11 +71,23 @@ public:
 
     bool CreateThread(const std::function<void()>& func);
 
+    /**
+     * Sets the scheduling of the thread. Applied right away if the thread is running, otherwise by the thread
+     * itself once it starts.
+     *
+     * @return false if the running thread refused some of it, e.g. for lack of permission
+     */
+    bool SetSchedule(const ThreadSchedule& schedule);
+
 private:
     struct State {
         virtual ~State() = default;
         std::function<void()> func{};
         std::string name;
+        OSAL::Mutex mutex {};
+        ThreadSchedule schedule {};
+        bool started {false};
+        long tid {0}; // kernel thread id, for the nice value
     };
 
     void SetNameInternal();
@@ -65,6 +96,7 @@ private:
     pthread_t id_{};
     std::string name_;
     ThreadPriority priority_;
+    ThreadSchedule schedule_ {};
     std::unique_ptr<State> state_{};
 };
 } // namespace OSAL
@@ -17,12 +17,28 @@
 #define HISTREAMER_FOUNDATION_OSAL_UTILS_UTIL_H
 
 #include <string>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 namespace OHOS {
 namespace Media {
 namespace OSAL {
 void SleepFor(unsigned ms);
 bool ConvertFullPath(const std::string& partialPath, std::string& fullPath);
+
+// Hint the cpu that the caller is spinning on a shared variable.
+inline void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_ARCH) && __ARM_ARCH >= 7)
+    __asm__ __volatile__("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
 } // namespace OSAL
 } // namespace Media
 } // namespace OHOS
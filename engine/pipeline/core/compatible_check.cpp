@@ -18,11 +18,15 @@
 #include "compatible_check.h"
 
 #include <algorithm>
+#include <cctype>
 #include <functional>
 #include <map>
+#include <vector>
 
 #include "pipeline/core/plugin_attr_desc.h"
 #include "foundation/log.h"
+#include "foundation/cpp_ext/arena.h"
+#include "osal/thread/scoped_lock.h"
 
 namespace OHOS {
 namespace Media {
@@ -31,6 +35,41 @@ static constexpr uint8_t ALLOW_FIXED = 1 << 0;
 static constexpr uint8_t ALLOW_INTERVAL = 1 << 1;
 static constexpr uint8_t ALLOW_DISCRETE = 1 << 2;
 
+static thread_local CppExt::Arena* g_negotiationArena = nullptr;
+static thread_local uint32_t g_negotiationDepth = 0;
+
+template <typename T>
+using ScratchVector = std::vector<T, CppExt::ArenaAllocator<T>>;
+
+using ScratchKeyMap = std::map<Capability::Key, Plugin::ValueType, std::less<Capability::Key>,
+    CppExt::ArenaAllocator<std::pair<const Capability::Key, Plugin::ValueType>>>;
+
+static CppExt::Arena& ThreadArena()
+{
+    thread_local CppExt::Arena arena;
+    return arena;
+}
+
+NegotiationScope::NegotiationScope()
+{
+    if (g_negotiationDepth++ == 0) {
+        g_negotiationArena = &ThreadArena();
+    }
+}
+
+NegotiationScope::~NegotiationScope()
+{
+    if (--g_negotiationDepth == 0) {
+        g_negotiationArena->Reset();
+        g_negotiationArena = nullptr;
+    }
+}
+
+CppExt::Arena* NegotiationScope::GetArena()
+{
+    return g_negotiationArena;
+}
+
 static inline bool IsFixedAllowed(uint8_t flags)
 {
     return ALLOW_FIXED & flags;
@@ -237,7 +276,7 @@ template <typename T>
 bool IDCapabilityCheck(const Plugin::IntervalCapability<T>& v1, const Plugin::DiscreteCapability<T>& v2,
                        const std::function<int(T,T)>& cmpFunc, Plugin::ValueType& outValue)
 {
-    Plugin::DiscreteCapability<T> tmpOut;
+    ScratchVector<T> tmpOut(NegotiationScope::GetArena());
     for (const auto& oneValue : v2) {
         if (cmpFunc(oneValue, v1.first) >= 0 && cmpFunc(oneValue, v1.second) <= 0) {
             tmpOut.emplace_back(oneValue);
@@ -249,7 +288,7 @@ bool IDCapabilityCheck(const Plugin::IntervalCapability<T>& v1, const Plugin::Di
     if (tmpOut.size() == 1) {
         outValue = Plugin::FixedCapability<T>(tmpOut[0]);
     } else {
-        outValue = Plugin::DiscreteCapability<T>(tmpOut);
+        outValue = Plugin::DiscreteCapability<T>(tmpOut.begin(), tmpOut.end());
     }
     return true;
 }
@@ -258,7 +297,7 @@ template <typename T>
 bool DDCapabilityCheck(const Plugin::DiscreteCapability<T>& v1, const Plugin::DiscreteCapability<T>& v2,
                        const std::function<int(T,T)>& cmpFunc, Plugin::ValueType& outValue)
 {
-    Plugin::DiscreteCapability<T> tmpOut;
+    ScratchVector<T> tmpOut(NegotiationScope::GetArena());
     for (const auto& cap1 : v1) {
         if (std::any_of(v2.begin(), v2.end(), [&cap1, &cmpFunc](const T& tmp){return cmpFunc(cap1, tmp) == 0;})) {
             tmpOut.emplace_back(cap1);
@@ -270,7 +309,7 @@ bool DDCapabilityCheck(const Plugin::DiscreteCapability<T>& v1, const Plugin::Di
     if (tmpOut.size() == 1) {
         outValue = Plugin::FixedCapability<T>(tmpOut[0]);
     } else {
-        outValue = Plugin::DiscreteCapability<T>(tmpOut);
+        outValue = Plugin::DiscreteCapability<T>(tmpOut.begin(), tmpOut.end());
     }
     return true;
 }
@@ -364,14 +403,15 @@ bool CapabilityValueCheck(CapabilityID key, std::pair<const Plugin::ValueType&,
     return false;
 }
 
-bool MergeCapabilityKeys(const Capability& originCap, const Capability& otherCap, Capability& resCap)
+template <typename OriginKeys, typename OtherKeys, typename ResKeys>
+static bool MergeKeys(const OriginKeys& originKeys, const OtherKeys& otherKeys, ResKeys& resKeys)
 {
-    resCap.keys.clear();
-    for (const auto& pairKey : originCap.keys) {
-        auto oIte = otherCap.keys.find(pairKey.first);
-        if (oIte == otherCap.keys.end()) {
+    resKeys.clear();
+    for (const auto& pairKey : originKeys) {
+        auto oIte = otherKeys.find(pairKey.first);
+        if (oIte == otherKeys.end()) {
             // if key is not in otherCap, then put into resCap
-            resCap.keys.insert(pairKey);
+            resKeys.insert(pairKey);
             continue;
         }
         // if key is in otherCap, calculate the intersections
@@ -382,22 +422,27 @@ bool MergeCapabilityKeys(const Capability& originCap, const Capability& otherCap
         }
         Plugin::ValueType tmp;
         if (g_capabilityValueCheckMap.at(pairKey.first)(pairKey.first, pairKey.second, oIte->second, tmp)) {
-            resCap.keys[pairKey.first] = tmp;
+            resKeys[pairKey.first] = std::move(tmp);
         } else {
             //  if no intersections return false
-            resCap.keys.clear();
+            resKeys.clear();
             return false;
         }
     }
     // if key is otherCap but not in originCap, put into resCap
-    for (const auto& pairKey : otherCap.keys) {
-        if (resCap.keys.count(pairKey.first) == 0) {
-            resCap.keys.insert(pairKey);
+    for (const auto& pairKey : otherKeys) {
+        if (resKeys.count(pairKey.first) == 0) {
+            resKeys.insert(pairKey);
         }
     }
     return true;
 }
 
+bool MergeCapabilityKeys(const Capability& originCap, const Capability& otherCap, Capability& resCap)
+{
+    return MergeKeys(originCap.keys, otherCap.keys, resCap.keys);
+}
+
 bool MergeCapability(const Capability& originCap, const Capability& otherCap, Capability& resCap)
 {
     resCap.mime.clear();
@@ -414,9 +459,14 @@ bool MergeCapability(const Capability& originCap, const Capability& otherCap, Ca
 
 bool ApplyCapabilitySet(const Capability& originCap, const CapabilitySet& capabilitySet, Capability& resCap)
 {
-    Capability tmp;
+    resCap.mime.clear();
+    resCap.keys.clear();
+    // candidates that don't match are merged into the scratch map only, resCap is written once for the one that does
+    ScratchKeyMap scratch(NegotiationScope::GetArena());
     for (const auto& cap : capabilitySet) {
-        if (MergeCapability(originCap, cap, resCap)) {
+        if (IsSubsetMime(originCap.mime, cap.mime) && MergeKeys(originCap.keys, cap.keys, scratch)) {
+            resCap.keys.insert(scratch.begin(), scratch.end());
+            resCap.mime = originCap.mime;
             return true;
         }
     }
@@ -462,23 +512,29 @@ std::shared_ptr<Capability> MetaToCapability(const Plugin::Meta& meta)
 bool MergeMetaWithCapability(const Plugin::Meta& meta, const Capability& cap,  Plugin::Meta& resMeta)
 {
     resMeta.Clear();
-    // change meta into capability firstly
-    Capability metaCap;
-    metaCap.mime = cap.mime;
+    // the meta is merged as a capability of the mime of cap, e.g. a decoder merges the meta of its encoded input
+    // into a raw capability, so the meta mime is not compared; cap.mime only has to be of the form xx/xxx
+    size_t devLinePos = cap.mime.find_first_of('/');
+    if (devLinePos == 0 || devLinePos == std::string::npos) {
+        MEDIA_LOG_E("wrong format of capability mime, must be xx/xxx");
+        return false;
+    }
+    auto arena = NegotiationScope::GetArena();
+    ScratchKeyMap metaKeys(arena);
     for (const auto& key : g_allCapabilityId) {
         Plugin::ValueType tmp;
         if (meta.GetData(static_cast<Plugin::MetaID>(key), tmp)) {
-            metaCap.keys[key] = tmp;
+            metaKeys.emplace(key, std::move(tmp));
         }
     }
-    Capability resCap;
-    if (!MergeCapability(metaCap, cap, resCap)) {
+    ScratchKeyMap resKeys(arena);
+    if (!MergeKeys(metaKeys, cap.keys, resKeys)) {
         return false;
     }
     // merge capability
     resMeta.Update(meta);
     resMeta.SetString(Plugin::MetaID::MIME, cap.mime);
-    for (const auto& oneCap : resCap.keys) {
+    for (const auto& oneCap : resKeys) {
         if (g_capExtrMap.count(oneCap.first) == 0) {
             continue;
         }
@@ -490,6 +546,205 @@ bool MergeMetaWithCapability(const Plugin::Meta& meta, const Capability& cap,  P
     }
     return true;
 }
+
+static constexpr uint32_t MIME_WILDCARD_ID = 1;
+static constexpr int64_t MASK_BITS = 64;
+static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+static uint32_t InternMimePart(std::string part)
+{
+    static OSAL::Mutex mutex;
+    static std::map<std::string, uint32_t> ids {{"*", MIME_WILDCARD_ID}};
+    std::transform(part.begin(), part.end(), part.begin(), [](char c) { return static_cast<char>(tolower(c)); });
+    OSAL::ScopedLock lock(mutex);
+    auto id = static_cast<uint32_t>(ids.size() + 1);
+    return ids.emplace(std::move(part), id).first->second;
+}
+
+static void InternMime(const std::string& mime, uint32_t& type, uint32_t& subType)
+{
+    type = 0;
+    subType = 0;
+    if (mime == "*") {
+        type = MIME_WILDCARD_ID;
+        return;
+    }
+    size_t devLinePos = mime.find_first_of('/');
+    if (devLinePos == 0 || devLinePos == std::string::npos) {
+        return;
+    }
+    type = InternMimePart(mime.substr(0, devLinePos));
+    subType = InternMimePart(mime.substr(devLinePos + 1));
+}
+
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+    auto bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+template <typename T>
+static uint64_t HashValue(uint64_t hash, const T& value)
+{
+    return HashBytes(hash, &value, sizeof(value));
+}
+
+template <typename T, bool INTERVAL_ALLOWED>
+bool CompileCapKey(const Plugin::ValueType& value, CompiledCapability::Key& key)
+{
+    if (auto fixed = Plugin::AnyCast<Plugin::FixedCapability<T>>(&value)) {
+        key.kind = CompiledCapability::KeyKind::FIXED;
+        key.min = static_cast<int64_t>(*fixed);
+        key.max = key.min;
+        return true;
+    }
+    if (auto interval = Plugin::AnyCast<Plugin::IntervalCapability<T>>(&value)) {
+        if (!INTERVAL_ALLOWED) {
+            return false;
+        }
+        key.kind = CompiledCapability::KeyKind::INTERVAL;
+        key.min = std::min(static_cast<int64_t>(interval->first), static_cast<int64_t>(interval->second));
+        key.max = std::max(static_cast<int64_t>(interval->first), static_cast<int64_t>(interval->second));
+        return true;
+    }
+    if (auto discrete = Plugin::AnyCast<Plugin::DiscreteCapability<T>>(&value)) {
+        key.kind = CompiledCapability::KeyKind::DISCRETE;
+        key.values.reserve(discrete->size());
+        uint64_t mask = 0;
+        bool allInMask = true;
+        for (const auto& one : *discrete) {
+            auto number = static_cast<int64_t>(one);
+            key.values.push_back(number);
+            if (number >= 0 && number < MASK_BITS) {
+                mask |= 1ULL << static_cast<uint64_t>(number);
+            } else {
+                allInMask = false;
+            }
+        }
+        key.mask = allInMask ? mask : 0;
+        return true;
+    }
+    return false;
+}
+
+// the same types as g_capabilityValueCheckMap, intervals only where the check allows them
+using CompileFunc = bool (*)(const Plugin::ValueType& value, CompiledCapability::Key& key);
+static std::map<CapabilityID, CompileFunc> g_capCompileMap = {
+    {g_allCapabilityId[0], CompileCapKey<uint32_t, true>}, // 0
+    {g_allCapabilityId[1], CompileCapKey<uint32_t, true>}, // 1
+    {g_allCapabilityId[2], CompileCapKey<Plugin::AudioChannelLayout, false>}, // 2
+    {g_allCapabilityId[3], CompileCapKey<Plugin::AudioSampleFormat, false>}, // 3
+    {g_allCapabilityId[4], CompileCapKey<uint32_t, true>}, // 4
+    {g_allCapabilityId[5], CompileCapKey<uint32_t, true>}, // 5
+    {g_allCapabilityId[6], CompileCapKey<Plugin::AudioAacProfile, false>}, // 6
+    {g_allCapabilityId[7], CompileCapKey<uint32_t, true>}, // 7
+    {g_allCapabilityId[8], CompileCapKey<Plugin::AudioAacStreamFormat, false>}, // 8
+    {g_allCapabilityId[9], CompileCapKey<Plugin::VideoPixelFormat, false>}, // 9
+    {g_allCapabilityId[10], CompileCapKey<int64_t, true>}, // 10
+    {g_allCapabilityId[11], CompileCapKey<uint32_t, true>}, // 11
+};
+
+CompiledCapability CompileCapability(const Capability& cap)
+{
+    CompiledCapability res;
+    res.mime = cap.mime;
+    InternMime(cap.mime, res.mimeType, res.mimeSubType);
+    uint64_t hash = HashBytes(FNV_OFFSET_BASIS, cap.mime.data(), cap.mime.size());
+    res.keys.reserve(cap.keys.size());
+    for (const auto& pairKey : cap.keys) { // ordered by key already
+        CompiledCapability::Key key {pairKey.first, CompiledCapability::KeyKind::FIXED};
+        auto ite = g_capCompileMap.find(pairKey.first);
+        if (ite == g_capCompileMap.end() || !ite->second(pairKey.second, key)) {
+            res.complete = false;
+            continue;
+        }
+        hash = HashValue(hash, key.id);
+        hash = HashValue(hash, key.kind);
+        hash = HashValue(hash, key.min);
+        hash = HashValue(hash, key.max);
+        hash = HashBytes(hash, key.values.data(), key.values.size() * sizeof(int64_t));
+        res.keys.emplace_back(std::move(key));
+    }
+    res.hash = hash;
+    return res;
+}
+
+static bool ContainsValue(const CompiledCapability::Key& discrete, int64_t value)
+{
+    if (discrete.mask != 0) {
+        return value >= 0 && value < MASK_BITS && ((discrete.mask >> static_cast<uint64_t>(value)) & 1) != 0;
+    }
+    return std::find(discrete.values.begin(), discrete.values.end(), value) != discrete.values.end();
+}
+
+static bool MayIntersect(const CompiledCapability::Key& key1, const CompiledCapability::Key& key2)
+{
+    using KeyKind = CompiledCapability::KeyKind;
+    if (key1.kind == KeyKind::DISCRETE && key2.kind == KeyKind::DISCRETE) {
+        if (key1.mask != 0 && key2.mask != 0) {
+            return (key1.mask & key2.mask) != 0;
+        }
+        return std::any_of(key1.values.begin(), key1.values.end(),
+                           [&key2](int64_t value) { return ContainsValue(key2, value); });
+    }
+    if (key1.kind == KeyKind::DISCRETE || key2.kind == KeyKind::DISCRETE) {
+        const auto& discrete = key1.kind == KeyKind::DISCRETE ? key1 : key2;
+        const auto& range = key1.kind == KeyKind::DISCRETE ? key2 : key1; // a fixed value is a range of one value
+        return std::any_of(discrete.values.begin(), discrete.values.end(),
+                           [&range](int64_t value) { return value >= range.min && value <= range.max; });
+    }
+    return std::max(key1.min, key2.min) <= std::min(key1.max, key2.max);
+}
+
+bool MayMergeCapability(const CompiledCapability& originCap, const CompiledCapability& otherCap)
+{
+    // the rules of IsSubsetMime
+    if (originCap.mimeSubType == 0) {
+        return false;
+    }
+    if (otherCap.mimeType != MIME_WILDCARD_ID || otherCap.mimeSubType != 0) {
+        if (otherCap.mimeSubType == 0 || otherCap.mimeType != originCap.mimeType) {
+            return false;
+        }
+        if (otherCap.mimeSubType != MIME_WILDCARD_ID && otherCap.mimeSubType != originCap.mimeSubType) {
+            return false;
+        }
+    }
+    // keys in both caps must intersect, keys that could not be compiled are left to MergeCapability
+    auto ite1 = originCap.keys.begin();
+    auto ite2 = otherCap.keys.begin();
+    while (ite1 != originCap.keys.end() && ite2 != otherCap.keys.end()) {
+        if (ite1->id < ite2->id) {
+            ++ite1;
+        } else if (ite2->id < ite1->id) {
+            ++ite2;
+        } else {
+            if (!MayIntersect(*ite1, *ite2)) {
+                return false;
+            }
+            ++ite1;
+            ++ite2;
+        }
+    }
+    return true;
+}
+
+bool IsSameCapability(const CompiledCapability& cap1, const CompiledCapability& cap2)
+{
+    if (!cap1.complete || !cap2.complete || cap1.hash != cap2.hash || cap1.mime != cap2.mime ||
+        cap1.keys.size() != cap2.keys.size()) {
+        return false;
+    }
+    return std::equal(cap1.keys.begin(), cap1.keys.end(), cap2.keys.begin(),
+        [](const CompiledCapability::Key& key1, const CompiledCapability::Key& key2) {
+            return key1.id == key2.id && key1.kind == key2.kind && key1.min == key2.min && key1.max == key2.max &&
+                key1.values == key2.values;
+        });
+}
 } // namespace Pipeline
 } // namespace Media
 } // namespace OHOS
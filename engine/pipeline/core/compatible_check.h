@@ -16,7 +16,11 @@
 #ifndef HISTREAMER_PIPELINE_CORE_COMPATIBLE_CHECK_H
 #define HISTREAMER_PIPELINE_CORE_COMPATIBLE_CHECK_H
 
+#include <cstdint>
+#include <string>
+#include <vector>
 #include "type_define.h"
+#include "foundation/cpp_ext/arena.h"
 #include "plugin/common/plugin_caps.h"
 #include "plugin/core/plugin_meta.h"
 
@@ -74,6 +78,78 @@ std::shared_ptr<Capability> MetaToCapability(const Plugin::Meta& meta);
 bool MergeMetaWithCapability(const Plugin::Meta& meta, const Capability& cap, Plugin::Meta& resMeta);
 
 bool ApplyCapabilitySet(const Capability& originCap, const CapabilitySet& capabilitySet, Capability& resCap);
+
+/**
+ * Capability in a form that is quick to compare: the mime split into interned ids, and the values of the keys that
+ * take part in merging as integers, small discrete values also as a bit mask.
+ */
+struct CompiledCapability {
+    enum class KeyKind : uint8_t {
+        FIXED,
+        INTERVAL,
+        DISCRETE,
+    };
+
+    struct Key {
+        Key(Capability::Key keyId, KeyKind keyKind) : id(keyId), kind(keyKind)
+        {
+        }
+
+        Capability::Key id;
+        KeyKind kind;
+        int64_t min {0}; // FIXED: the value, INTERVAL: the lower bound
+        int64_t max {0}; // FIXED: the value, INTERVAL: the upper bound
+        uint64_t mask {0}; // DISCRETE: bit n is set for value n if all values are in [0, 64), 0 otherwise
+        std::vector<int64_t> values {}; // DISCRETE: the values in their original order
+    };
+
+    std::string mime;
+    uint32_t mimeType {0}; // 0 if the mime is not valid
+    uint32_t mimeSubType {0}; // 0 if there is none, i.e. the mime is "*" or not valid
+    std::vector<Key> keys {}; // sorted by id
+    bool complete {true}; // false if some key could not be compiled and is missing in keys
+    uint64_t hash {0};
+};
+
+CompiledCapability CompileCapability(const Capability& cap);
+
+/**
+ * Quick check before MergeCapability(originCap, otherCap, resCap), with the capabilities compiled.
+ *
+ * @return false if the merge fails for sure, true if it may succeed
+ */
+bool MayMergeCapability(const CompiledCapability& originCap, const CompiledCapability& otherCap);
+
+/**
+ * Whether two complete compiled capabilities came from equal capabilities, so that merging either of them gives the
+ * same result.
+ */
+bool IsSameCapability(const CompiledCapability& cap1, const CompiledCapability& cap2);
+
+/**
+ * Marks one negotiate or configure pass on the calling thread.
+ *
+ * While a scope is alive, the temporary key maps and value lists of the functions above are allocated from an arena
+ * of the thread instead of the heap, and they are all given back at once when the outermost scope ends. Scopes nest,
+ * so every hop of a pass may open one. Results that leave these functions are not taken from the arena.
+ */
+class NegotiationScope {
+public:
+    NegotiationScope();
+
+    ~NegotiationScope();
+
+    NegotiationScope(const NegotiationScope&) = delete;
+
+    NegotiationScope& operator=(const NegotiationScope&) = delete;
+
+    /**
+     * The arena of the pass running on the calling thread.
+     *
+     * @return nullptr if there is no pass, the heap is used then
+     */
+    static CppExt::Arena* GetArena();
+};
 }
 }
 }
@@ -26,7 +26,8 @@ static const std::map<EventType, const char*> g_EventTypeMap = {
     {EventType::EVENT_PLUGIN_EVENT, "EVENT_PLUGIN_EVENT"},
     {EventType::EVENT_BUFFERING, "EVENT_BUFFERING"},
     {EventType::EVENT_BUFFER_PROGRESS, "EVENT_BUFFER_PROGRESS"},
-    {EventType::EVENT_DECODER_ERROR, "EVENT_DECODER_ERROR"}
+    {EventType::EVENT_DECODER_ERROR, "EVENT_DECODER_ERROR"},
+    {EventType::EVENT_QUEUE_FILL_LEVEL, "EVENT_QUEUE_FILL_LEVEL"}
 };
 
 const char* GetEventName(EventType type)
@@ -34,6 +34,7 @@ enum struct EventType : uint32_t {
     EVENT_BUFFERING,
     EVENT_BUFFER_PROGRESS,
     EVENT_DECODER_ERROR,
+    EVENT_QUEUE_FILL_LEVEL, // param is Pipeline::QueueFillLevel
 };
 
 struct Event {
@@ -21,6 +21,7 @@
 
 #include "filter_callback.h"
 #include "error_code.h"
+#include "foundation/osal/thread/task.h"
 #include "utils/constants.h"
 #include "event.h"
 #include "parameter.h"
@@ -92,6 +93,12 @@ public:
     virtual ErrorCode PullData(const std::string& outPort, uint64_t offset, size_t size,
                                AVBufferPtr& data) = 0; // OutPort调用
     virtual const EventReceiver* GetOwnerPipeline() const = 0;
+
+    // InPort调用此接口获取统计其输入的计数器，nullptr表示不统计
+    virtual std::shared_ptr<TraceCounters> GetTraceCounters()
+    {
+        return nullptr;
+    }
 };
 
 class Filter : public InfoTransfer {
@@ -118,6 +125,16 @@ public:
     virtual void UnlinkPrevFilters() = 0;
     virtual std::vector<Filter*> GetNextFilters() = 0;
     virtual std::vector<Filter*> GetPreFilters() = 0;
+
+    // 设置Filter内部任务的调度策略，需在Prepare之前设置
+    virtual void SetTaskSchedulePolicy(const std::shared_ptr<const OSAL::TaskSchedulePolicy>& policy)
+    {
+    }
+
+    // 设置Filter计数器所属的pipeline范围，需在Init之前设置，见PipelineTracer
+    virtual void SetTraceScope(const std::string& scope)
+    {
+    }
 };
 } // namespace Pipeline
 } // namespace Media
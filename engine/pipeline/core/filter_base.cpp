@@ -21,12 +21,14 @@
 #include "common/plugin_utils.h"
 #include "foundation/log.h"
 #include "plugin_attr_desc.h"
+#include "utils/pipeline_tracer.h"
 
 namespace OHOS {
 namespace Media {
 namespace Pipeline {
 FilterBase::FilterBase(std::string name)
-    : name_(std::move(name)), state_(FilterState::CREATED), eventReceiver_(nullptr), callback_(nullptr)
+    : name_(std::move(name)), state_(FilterState::CREATED), eventReceiver_(nullptr), callback_(nullptr),
+      traceCounters_(std::make_shared<TraceCounters>())
 {
     inPorts_.reserve(MAX_PORT_NUMBER);
     outPorts_.reserve(MAX_PORT_NUMBER);
@@ -161,6 +163,23 @@ void FilterBase::OnEvent(const Event& event)
     }
 }
 
+void FilterBase::SetTaskSchedulePolicy(const std::shared_ptr<const OSAL::TaskSchedulePolicy>& policy)
+{
+    taskSchedulePolicy_ = policy;
+}
+
+void FilterBase::SetTraceScope(const std::string& scope)
+{
+    traceCounters_ = PipelineTracer::Instance().GetCounters(scope, name_);
+}
+
+void FilterBase::ApplyTaskSchedule(OSAL::Task& task) const
+{
+    if (taskSchedulePolicy_ != nullptr) {
+        task.ApplySchedulePolicy(*taskSchedulePolicy_);
+    }
+}
+
 void FilterBase::InitPorts()
 {
     inPorts_.clear();
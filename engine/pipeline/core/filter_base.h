@@ -92,9 +92,23 @@ public:
     // Port调用此方法向Filter报告事件
     void OnEvent(const Event& event) override;
 
+    void SetTaskSchedulePolicy(const std::shared_ptr<const OSAL::TaskSchedulePolicy>& policy) override;
+
+    void SetTraceScope(const std::string& scope) override;
+
+    std::shared_ptr<TraceCounters> GetTraceCounters() override
+    {
+        return traceCounters_;
+    }
+
 protected:
     virtual void InitPorts();
 
+    /**
+     * Applies the pipeline task schedule policy to a task of this filter.
+     */
+    void ApplyTaskSchedule(OSAL::Task& task) const;
+
     ErrorCode ConfigPluginWithMeta(Plugin::Base& plugin, const Plugin::Meta& meta);
 
     std::string NamePort(const std::string& mime);
@@ -126,6 +140,9 @@ protected:
     std::atomic<FilterState> state_;
     EventReceiver* eventReceiver_;
     FilterCallback* callback_;
+    std::shared_ptr<const OSAL::TaskSchedulePolicy> taskSchedulePolicy_ {nullptr};
+    // counters of the data flowing into this filter, they are reported once the pipeline sets the trace scope
+    std::shared_ptr<TraceCounters> traceCounters_;
     std::vector<PFilter> children_ {};
     std::vector<PInPort> inPorts_ {};
     std::vector<POutPort> outPorts_ {};
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define HST_LOG_TAG "ParallelRunner"
+
+#include "parallel_runner.h"
+#include "foundation/log.h"
+#include "foundation/osal/thread/scoped_lock.h"
+#include "utils/pipeline_tracer.h"
+
+namespace OHOS {
+namespace Media {
+namespace Pipeline {
+namespace {
+constexpr int64_t NS_PER_US = 1000;
+const char* const TRACE_CATEGORY = "prepare";
+}
+
+ParallelRunner::ParallelRunner(size_t maxThreads) : maxThreads_(maxThreads == 0 ? 1 : maxThreads)
+{
+}
+
+size_t ParallelRunner::AddJob(std::string name, std::function<ErrorCode()> job)
+{
+    jobs_.emplace_back(std::move(name), std::move(job));
+    return jobs_.size() - 1;
+}
+
+void ParallelRunner::AddDependency(size_t job, size_t dependency)
+{
+    FALSE_RETURN_MSG(job < jobs_.size() && dependency < jobs_.size() && job != dependency,
+                     "invalid dependency " PUBLIC_LOG_ZU " -> " PUBLIC_LOG_ZU, job, dependency);
+    jobs_[dependency].dependents.push_back(job);
+    jobs_[job].dependencyCnt++;
+}
+
+ErrorCode ParallelRunner::Run()
+{
+    startNs_ = PipelineTracer::NowNs();
+    {
+        OSAL::ScopedLock lock(mutex_);
+        timings_.clear();
+        ready_.clear();
+        running_ = 0;
+        idleThreads_ = 0;
+        result_ = ErrorCode::SUCCESS;
+        for (size_t i = 0; i < jobs_.size(); ++i) {
+            jobs_[i].pendingCnt = jobs_[i].dependencyCnt;
+            if (jobs_[i].pendingCnt == 0) {
+                ready_.push_back(i);
+            }
+        }
+    }
+    WorkerLoop();
+    helpers_.clear(); // they leave their loops once there is nothing left to run, this joins them
+    totalUs_ = (PipelineTracer::NowNs() - startNs_) / NS_PER_US;
+    if (result_ == ErrorCode::SUCCESS && timings_.size() != jobs_.size()) {
+        MEDIA_LOG_E("only " PUBLIC_LOG_ZU " of " PUBLIC_LOG_ZU " jobs run, the dependencies have a cycle",
+                    timings_.size(), jobs_.size());
+        result_ = ErrorCode::ERROR_INVALID_OPERATION;
+    }
+    return result_;
+}
+
+void ParallelRunner::WorkerLoop()
+{
+    OSAL::ScopedLock lock(mutex_);
+    for (;;) {
+        idleThreads_++;
+        cond_.Wait(lock, [this] { return HasWork() || IsFinished(); });
+        idleThreads_--;
+        if (!HasWork()) {
+            return;
+        }
+        auto index = ready_.front();
+        ready_.pop_front();
+        running_++;
+        StartHelperIfNeeded();
+        lock.Unlock();
+
+        auto& job = jobs_[index];
+        int64_t beginNs = PipelineTracer::NowNs();
+        auto ret = job.func();
+        int64_t endNs = PipelineTracer::NowNs();
+        auto& tracer = PipelineTracer::Instance();
+        if (tracer.IsEnabled()) {
+            tracer.Record(tracer.Intern(job.name), TRACE_CATEGORY, beginNs, endNs);
+        }
+
+        lock.Lock();
+        running_--;
+        timings_.emplace_back(job.name, (beginNs - startNs_) / NS_PER_US, (endNs - beginNs) / NS_PER_US, ret);
+        if (ret != ErrorCode::SUCCESS) {
+            if (result_ == ErrorCode::SUCCESS) {
+                result_ = ret;
+            }
+        } else {
+            for (auto dependent : job.dependents) {
+                if (--jobs_[dependent].pendingCnt == 0) {
+                    ready_.push_back(dependent);
+                }
+            }
+        }
+        cond_.NotifyAll();
+    }
+}
+
+void ParallelRunner::StartHelperIfNeeded()
+{
+    if (ready_.empty() || idleThreads_ > 0 || helpers_.size() + 1 >= maxThreads_) {
+        return;
+    }
+    auto helper = std::unique_ptr<OSAL::Thread>(new OSAL::Thread());
+    helper->SetName("HstParallelRunner");
+    if (helper->CreateThread([this] { WorkerLoop(); })) {
+        helpers_.push_back(std::move(helper));
+    }
+}
+} // namespace Pipeline
+} // namespace Media
+} // namespace OHOS
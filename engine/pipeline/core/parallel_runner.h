@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HISTREAMER_PIPELINE_CORE_PARALLEL_RUNNER_H
+#define HISTREAMER_PIPELINE_CORE_PARALLEL_RUNNER_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "error_code.h"
+#include "foundation/osal/thread/condition_variable.h"
+#include "foundation/osal/thread/mutex.h"
+#include "foundation/osal/thread/thread.h"
+
+namespace OHOS {
+namespace Media {
+namespace Pipeline {
+/**
+ * Runs a set of jobs, each one as soon as the jobs it depends on are done. Jobs that don't depend on each other,
+ * e.g. the audio and the video branch of a pipeline, run at the same time on the calling thread and on helper
+ * threads that are started when there is more than one job ready.
+ *
+ * After the first job fails no further jobs are started; Run() waits for the running ones and returns the error.
+ */
+class ParallelRunner {
+public:
+    static constexpr size_t DEFAULT_MAX_THREADS = 4;
+
+    /**
+     * Start time and duration of one job, as measured by Run().
+     */
+    struct JobTiming {
+        JobTiming(std::string jobName, int64_t begin, int64_t duration, ErrorCode ret)
+            : name(std::move(jobName)), beginUs(begin), durationUs(duration), result(ret)
+        {
+        }
+
+        std::string name;
+        int64_t beginUs {0}; // relative to the start of Run()
+        int64_t durationUs {0};
+        ErrorCode result {ErrorCode::SUCCESS};
+    };
+
+    explicit ParallelRunner(size_t maxThreads = DEFAULT_MAX_THREADS);
+
+    ~ParallelRunner() = default;
+
+    ParallelRunner(const ParallelRunner&) = delete;
+
+    ParallelRunner& operator=(const ParallelRunner&) = delete;
+
+    /**
+     * @return index of the job, to be used with AddDependency()
+     */
+    size_t AddJob(std::string name, std::function<ErrorCode()> job);
+
+    /**
+     * Makes job wait for dependency. Dependencies must not form a cycle.
+     */
+    void AddDependency(size_t job, size_t dependency);
+
+    /**
+     * Runs all jobs and returns when none is running any more.
+     *
+     * @return the error of the first job that failed, SUCCESS if all succeeded
+     */
+    ErrorCode Run();
+
+    /**
+     * Timings of the jobs of the last Run() in the order they finished. Jobs that were not started are missing.
+     */
+    const std::vector<JobTiming>& GetTimings() const
+    {
+        return timings_;
+    }
+
+    /**
+     * Time the last Run() took, in microseconds.
+     */
+    int64_t GetTotalUs() const
+    {
+        return totalUs_;
+    }
+
+private:
+    struct Job {
+        Job(std::string jobName, std::function<ErrorCode()> jobFunc)
+            : name(std::move(jobName)), func(std::move(jobFunc))
+        {
+        }
+
+        std::string name;
+        std::function<ErrorCode()> func;
+        std::vector<size_t> dependents {};
+        size_t dependencyCnt {0};
+        size_t pendingCnt {0};
+    };
+
+    void WorkerLoop();
+
+    bool HasWork() const
+    {
+        return !ready_.empty() && result_ == ErrorCode::SUCCESS;
+    }
+
+    bool IsFinished() const
+    {
+        return running_ == 0 && !HasWork();
+    }
+
+    void StartHelperIfNeeded();
+
+    size_t maxThreads_;
+    std::vector<Job> jobs_ {};
+    std::vector<JobTiming> timings_ {};
+    int64_t totalUs_ {0};
+
+    OSAL::Mutex mutex_ {};
+    OSAL::ConditionVariable cond_ {};
+    std::deque<size_t> ready_ {};
+    size_t running_ {0};
+    size_t idleThreads_ {0};
+    ErrorCode result_ {ErrorCode::SUCCESS};
+    int64_t startNs_ {0};
+    std::vector<std::unique_ptr<OSAL::Thread>> helpers_ {};
+};
+} // namespace Pipeline
+} // namespace Media
+} // namespace OHOS
+#endif // HISTREAMER_PIPELINE_CORE_PARALLEL_RUNNER_H
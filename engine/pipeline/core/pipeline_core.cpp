@@ -16,10 +16,14 @@
 #define HST_LOG_TAG "PipelineCore"
 
 #include "pipeline_core.h"
+#include <map>
 #include <queue>
 #include <stack>
+#include "foundation/cpp_ext/type_traits_ext.h"
 #include "foundation/log.h"
 #include "osal/thread/scoped_lock.h"
+#include "parallel_runner.h"
+#include "utils/pipeline_tracer.h"
 #include "utils/steady_clock.h"
 
 namespace OHOS {
@@ -64,10 +68,16 @@ void MetaBundle::UpdateTrackMeta(const Plugin::Meta& meta)
 }
 
 PipelineCore::PipelineCore(const std::string& name)
-    : name_(name), eventReceiver_(nullptr), filterCallback_(nullptr), metaBundle_(std::make_shared<MetaBundle>())
+    : name_(name), traceScope_(PipelineTracer::NewScope(name)), eventReceiver_(nullptr), filterCallback_(nullptr),
+      metaBundle_(std::make_shared<MetaBundle>())
 {
 }
 
+PipelineCore::~PipelineCore()
+{
+    PipelineTracer::Instance().RemoveCounters(traceScope_);
+}
+
 const std::string& PipelineCore::GetName()
 {
     return name_;
@@ -88,19 +98,36 @@ void PipelineCore::Init(EventReceiver* receiver, FilterCallback* callback)
 ErrorCode PipelineCore::Prepare()
 {
     state_ = FilterState::PREPARING;
-    ErrorCode rtv = ErrorCode::SUCCESS;
     OSAL::ScopedLock lock(mutex_);
+    prepareBeginNs_ = PipelineTracer::NowNs();
     ReorderFilters();
+    // each filter is prepared after the filters downstream of it, the filters of different branches concurrently
+    ParallelRunner runner;
+    std::map<Filter*, size_t> jobs;
     for (auto it = filters_.rbegin(); it != filters_.rend(); ++it) {
-        auto& filterPtr = *it;
+        auto filterPtr = *it;
         if (filterPtr) {
-            if ((rtv = filterPtr->Prepare()) != ErrorCode::SUCCESS) {
-                break;
-            }
+            jobs[filterPtr] = runner.AddJob(filterPtr->GetName() + ".Prepare", [filterPtr] {
+                return filterPtr->Prepare();
+            });
         } else {
             MEDIA_LOG_E("invalid pointer in filters.");
         }
     }
+    for (const auto& job : jobs) {
+        for (const auto& next : job.first->GetNextFilters()) {
+            auto ite = jobs.find(next);
+            if (ite != jobs.end()) {
+                runner.AddDependency(job.second, ite->second);
+            }
+        }
+    }
+    auto rtv = runner.Run();
+    for (const auto& timing : runner.GetTimings()) {
+        MEDIA_LOG_I(PUBLIC_LOG_S " at " PUBLIC_LOG_D64 " us took " PUBLIC_LOG_D64 " us, ret " PUBLIC_LOG_D32,
+                    timing.name.c_str(), timing.beginUs, timing.durationUs, CppExt::to_underlying(timing.result));
+    }
+    MEDIA_LOG_I("prepare of " PUBLIC_LOG_ZU " filters took " PUBLIC_LOG_D64 " us", jobs.size(), runner.GetTotalUs());
     return rtv;
 }
 
@@ -144,7 +171,10 @@ ErrorCode PipelineCore::Resume()
 
 ErrorCode PipelineCore::Stop()
 {
-    readyEventCnt_ = 0;
+    {
+        OSAL::ScopedLock lock(readyMutex_);
+        readyEventCnt_ = 0;
+    }
     state_ = FilterState::INITIALIZED;
     filtersToRemove_.clear();
     filtersToRemove_.reserve(filters_.size());
@@ -277,21 +307,44 @@ void PipelineCore::OnEvent(const Event& event)
         return;
     }
 
-    readyEventCnt_++;
-    MEDIA_LOG_I("OnEvent readyCnt: " PUBLIC_LOG_ZU " / " PUBLIC_LOG_ZU, readyEventCnt_, filters_.size());
-    if (readyEventCnt_ == filters_.size()) {
+    // branches configured concurrently report ready from different threads
+    bool allReady = false;
+    {
+        OSAL::ScopedLock lock(readyMutex_);
+        readyEventCnt_++;
+        MEDIA_LOG_I("OnEvent readyCnt: " PUBLIC_LOG_ZU " / " PUBLIC_LOG_ZU, readyEventCnt_, filters_.size());
+        if (readyEventCnt_ == filters_.size()) {
+            allReady = true;
+            readyEventCnt_ = 0;
+        }
+    }
+    if (allReady) {
+        MEDIA_LOG_I("all filters ready " PUBLIC_LOG_D64 " ms after prepare",
+                    (PipelineTracer::NowNs() - prepareBeginNs_) / 1000000); // 1000000: ns per ms
         NotifyEvent(event);
-        readyEventCnt_ = 0;
     }
 }
 
 void PipelineCore::InitFilters(const std::vector<Filter*>& filters)
 {
     for (auto& filter : filters) {
+        if (taskSchedulePolicy_ != nullptr) {
+            filter->SetTaskSchedulePolicy(taskSchedulePolicy_);
+        }
+        filter->SetTraceScope(traceScope_);
         filter->Init(this, filterCallback_);
     }
 }
 
+void PipelineCore::SetTaskSchedulePolicy(const std::shared_ptr<const OSAL::TaskSchedulePolicy>& policy)
+{
+    OSAL::ScopedLock lock(mutex_);
+    taskSchedulePolicy_ = policy;
+    for (auto& filter : filters_) {
+        filter->SetTaskSchedulePolicy(policy);
+    }
+}
+
 namespace {
 struct FilterNode {
     size_t inDegree {0};
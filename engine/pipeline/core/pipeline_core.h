@@ -59,7 +59,7 @@ class PipelineCore : public Pipeline {
 public:
     explicit PipelineCore(const std::string& name = "pipeline_core");
 
-    ~PipelineCore() override = default;
+    ~PipelineCore() override;
 
     const std::string& GetName() override;
 
@@ -91,6 +91,12 @@ public:
 
     void OnEvent(const Event& event) override;
 
+    /**
+     * Sets the schedules of the tasks of all filters in this pipeline, keyed by task name, e.g. to pin the render
+     * and audio tasks to some cpus. Filters added later get it too.
+     */
+    void SetTaskSchedulePolicy(const std::shared_ptr<const OSAL::TaskSchedulePolicy>& policy) override;
+
     void UnlinkPrevFilters() override
     {
     }
@@ -153,13 +159,24 @@ public:
         return metaBundle_;
     }
 
+    /**
+     * Scope of the counters of the filters of this pipeline, see PipelineTracer::GetCounterStats().
+     */
+    const std::string& GetTraceScope() const
+    {
+        return traceScope_;
+    }
+
 private:
     void ReorderFilters();
 
     void NotifyEvent(const Event& event);
 
     std::string name_;
+    std::string traceScope_;
     size_t readyEventCnt_ {0};
+    OSAL::Mutex readyMutex_ {};
+    int64_t prepareBeginNs_ {0};
     FilterState state_ {FilterState::CREATED};
     OSAL::Mutex mutex_ {};
     std::vector<Filter*> filters_ {};
@@ -167,6 +184,7 @@ private:
     FilterCallback* filterCallback_;
     std::shared_ptr<MetaBundle> metaBundle_;
     std::vector<Filter*> filtersToRemove_ {};
+    std::shared_ptr<const OSAL::TaskSchedulePolicy> taskSchedulePolicy_ {nullptr};
 };
 } // namespace Pipeline
 } // namespace Media
@@ -36,6 +36,7 @@ const Plugin::ValueType g_auSampleFmtDef = Plugin::AudioSampleFormat::U8;
 const Plugin::ValueType g_aacProfileDef = Plugin::AudioAacProfile::LC;
 const Plugin::ValueType g_aacStFmtDef = Plugin::AudioAacStreamFormat::RAW;
 const Plugin::ValueType g_vdPixelFmtDef = Plugin::VideoPixelFormat::UNKNOWN;
+const Plugin::ValueType g_vdThreadTypeDef = Plugin::VideoDecodeThreadType::AUTO;
 
 // tuple is <tagName, default_val, typeName> default_val is used for type compare
 const std::map<Plugin::Tag, std::tuple<const char*, const Plugin::ValueType&, const char*>> g_tagInfoMap = {
@@ -65,6 +66,7 @@ const std::map<Plugin::Tag, std::tuple<const char*, const Plugin::ValueType&, co
     {Plugin::Tag::MEDIA_FILE_EXTENSION, {"file_ext",           g_emptyString,      "string"}},
     {Plugin::Tag::MEDIA_CODEC_CONFIG, {"codec_config",         g_vecBufDef,        "std::vector<uint8_t>"}},
     {Plugin::Tag::MEDIA_POSITION, {"position",                 g_u64Def,           "uint64_t"}},
+    {Plugin::Tag::MEDIA_CHEAP_SEEK, {"cheap_seek",             g_u32Def,           "uint32_t"}},
     {Plugin::Tag::AUDIO_CHANNELS, {"channel",                  g_u32Def,           "uint32_t"}},
     {Plugin::Tag::AUDIO_CHANNEL_LAYOUT, {"channel_layout",     g_channelLayoutDef, "AudioChannelLayout"}},
     {Plugin::Tag::AUDIO_SAMPLE_RATE, {"sample_rate",           g_u32Def,           "uint32_t"}},
@@ -82,6 +84,8 @@ const std::map<Plugin::Tag, std::tuple<const char*, const Plugin::ValueType&, co
     {Plugin::Tag::VIDEO_SURFACE, {"surface",                   g_unknown,          "Surface"}},
     {Plugin::Tag::VIDEO_MAX_SURFACE_NUM, {"surface_num",       g_u32Def,           "uin32_t"}},
     {Plugin::Tag::VIDEO_CAPTURE_RATE, {"capture_rate",         g_doubleDef,        "double"}},
+    {Plugin::Tag::VIDEO_DECODE_THREAD_COUNT, {"video_decode_thread_count", g_u32Def,          "uint32_t"}},
+    {Plugin::Tag::VIDEO_DECODE_THREAD_TYPE, {"video_decode_thread_type",   g_vdThreadTypeDef, "VideoDecodeThreadType"}},
     {Plugin::Tag::BITS_PER_CODED_SAMPLE, {"bits_per_coded_sample", g_u32Def,       "uin32_t"}},
 };
 
@@ -17,9 +17,11 @@
 
 #include "port.h"
 #include <algorithm>
+#include "compatible_check.h"
 #include "filter.h"
 #include "foundation/log.h"
 #include "foundation/pre_defines.h"
+#include "utils/pipeline_tracer.h"
 
 namespace OHOS {
 namespace Media {
@@ -45,6 +47,10 @@ std::shared_ptr<Port> Port::GetPeerPort()
 ErrorCode InPort::Connect(const std::shared_ptr<Port>& port)
 {
     prevPort = port;
+    if (filter) {
+        traceName_ = PipelineTracer::Instance().Intern(filter->GetName() + "." + name);
+        traceCounters_ = filter->GetTraceCounters();
+    }
     return ErrorCode::SUCCESS;
 }
 
@@ -76,11 +82,13 @@ bool InPort::Negotiate(const std::shared_ptr<const Plugin::Capability>& upstream
                        const Plugin::TagMap& upstreamParams,
                        Plugin::TagMap& downstreamParams)
 {
+    NegotiationScope scope;
     return filter && filter->Negotiate(name, upstreamCap, negotiatedCap, upstreamParams, downstreamParams);
 }
 
 bool InPort::Configure(const std::shared_ptr<const Plugin::Meta>& upstreamMeta)
 {
+    NegotiationScope scope;
     return filter && filter->Configure(name, upstreamMeta);
 }
 
@@ -88,6 +96,11 @@ bool InPort::Configure(const std::shared_ptr<const Plugin::Meta>& upstreamMeta)
 void InPort::PushData(const AVBufferPtr& buffer, int64_t offset)
 {
     if (filter) {
+        uint64_t bytes = GetTraceBufferBytes(buffer);
+        if (traceCounters_ != nullptr) {
+            traceCounters_->AddBuffer(bytes);
+        }
+        PIPELINE_TRACE_BUFFER(traceName_, "port", buffer, bytes);
         filter->PushData(name, buffer, offset);
     } else {
         MEDIA_LOG_E("filter destructed");
@@ -27,6 +27,8 @@
 
 namespace OHOS {
 namespace Media {
+struct TraceCounters;
+
 namespace Pipeline {
 class InfoTransfer;
 
@@ -88,6 +90,8 @@ public:
 
 private:
     std::weak_ptr<Port> prevPort;
+    const char* traceName_ {nullptr};
+    std::shared_ptr<TraceCounters> traceCounters_ {nullptr};
 };
 
 class OutPort : public Port {
@@ -87,7 +87,12 @@ ErrorCode AsyncMode::Configure()
 ErrorCode AsyncMode::PushData(const std::string &inPort, const AVBufferPtr& buffer, int64_t offset)
 {
     DUMP_BUFFER2LOG("AsyncMode in", buffer, offset);
+    auto begin = PipelineTracer::NowNs();
     inBufQue_->Push(buffer);
+    if (traceCounters_ != nullptr) {
+        traceCounters_->AddBlocked(PipelineTracer::NowNs() - begin);
+        traceCounters_->SetQueueDepth(inBufQue_->Size());
+    }
     return ErrorCode::SUCCESS;
 }
 
@@ -151,6 +156,10 @@ ErrorCode AsyncMode::HandleFrame()
         MEDIA_LOG_W("decoder find nullptr in esBufferQ");
         return ErrorCode::ERROR_INVALID_PARAMETER_VALUE;
     }
+    if (traceCounters_ != nullptr) {
+        traceCounters_->SetQueueDepth(inBufQue_->Size());
+    }
+    PIPELINE_TRACE_BUFFER(traceInputName_, "codec", oneBuffer, GetTraceBufferBytes(oneBuffer));
     Plugin::Status status = Plugin::Status::OK;
     do {
         DUMP_BUFFER2LOG("AsyncMode QueueInput to Plugin", oneBuffer, -1);
@@ -179,6 +188,7 @@ ErrorCode AsyncMode::FinishFrame()
             auto oPort = outPorts_[0];
             if (oPort->GetWorkMode() == WorkMode::PUSH) {
                 DUMP_BUFFER2LOG("AsyncMode PushData to Sink", frameBuffer, -1);
+                PIPELINE_TRACE_BUFFER(traceOutputName_, "codec", frameBuffer, GetTraceBufferBytes(frameBuffer));
                 oPort->PushData(frameBuffer, -1);
                 isRendered = true;
                 outBufQue_.pop();
@@ -211,7 +221,7 @@ ErrorCode AsyncMode::Prepare()
 {
     MEDIA_LOG_I("AsyncMode prepare called.");
     if (!inBufQue_) {
-        inBufQue_ = std::make_shared<BlockingQueue<AVBufferPtr>>("asyncFilterInBufQue", GetInBufferPoolSize());
+        inBufQue_ = std::make_shared<LockFreeQueue<AVBufferPtr>>("asyncFilterInBufQue", GetInBufferPoolSize());
     } else {
         inBufQue_->SetActive(true);
     }
@@ -223,6 +233,10 @@ ErrorCode AsyncMode::Prepare()
         pushTask_ = std::make_shared<OSAL::Task>(codecName_ + "AsyncPush");
         pushTask_->RegisterHandler([this] { (void)FinishFrame(); });
     }
+    if (taskSchedulePolicy_ != nullptr) {
+        handleFrameTask_->ApplySchedulePolicy(*taskSchedulePolicy_);
+        pushTask_->ApplySchedulePolicy(*taskSchedulePolicy_);
+    }
     return ErrorCode::SUCCESS;
 }
 
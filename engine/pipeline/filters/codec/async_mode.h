@@ -16,9 +16,10 @@
 #ifndef HISTREAMER_PIPELINE_FILTER_ASYNC_MODE_H
 #define HISTREAMER_PIPELINE_FILTER_ASYNC_MODE_H
 
+#include <queue>
 #include "codec_mode.h"
 #include "foundation/osal/thread/task.h"
-#include "utils/blocking_queue.h"
+#include "utils/lock_free_queue.h"
 
 namespace OHOS {
 namespace Media {
@@ -60,7 +61,7 @@ private:
     // this task will dequeue from the plugin and then push to downstream
     std::shared_ptr<OHOS::Media::OSAL::Task> pushTask_ {nullptr};
 
-    std::shared_ptr<OHOS::Media::BlockingQueue<OHOS::Media::AVBufferPtr>> inBufQue_ {nullptr};
+    std::shared_ptr<OHOS::Media::LockFreeQueue<OHOS::Media::AVBufferPtr>> inBufQue_ {nullptr};
     std::queue<AVBufferPtr> outBufQue_;  // PCM data
     mutable OSAL::Mutex renderMutex_ {};
     bool stopped_ {false};
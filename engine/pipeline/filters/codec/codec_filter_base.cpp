@@ -69,6 +69,14 @@ ErrorCode CodecFilterBase::Prepare()
     return err;
 }
 
+void CodecFilterBase::SetTaskSchedulePolicy(const std::shared_ptr<const OSAL::TaskSchedulePolicy>& policy)
+{
+    FilterBase::SetTaskSchedulePolicy(policy);
+    if (codecMode_ != nullptr) {
+        codecMode_->SetTaskSchedulePolicy(policy);
+    }
+}
+
 ErrorCode CodecFilterBase::UpdateMetaFromPlugin(Plugin::Meta& meta)
 {
     auto parameterMap = PluginParameterTable::FindAllowedParameterMap(filterType_);
@@ -244,6 +252,7 @@ bool CodecFilterBase::Negotiate(const std::string& inPort,
         [](const std::string& name)-> std::shared_ptr<Plugin::Codec> {
             return Plugin::PluginManager::Instance().CreateCodecPlugin(name);
     });
+    codecMode_->SetTraceName(name_, traceCounters_);
     FALSE_RETURN_V(codecMode_->Init(plugin_, outPorts_), false);
     PROFILE_END("async codec negotiate end");
     MEDIA_LOG_D("codec filter base negotiate end");
@@ -61,6 +61,8 @@ public:
 
     void FlushEnd() override;
 
+    void SetTaskSchedulePolicy(const std::shared_ptr<const OSAL::TaskSchedulePolicy>& policy) override;
+
 protected:
     virtual uint32_t GetOutBufferPoolSize();
 
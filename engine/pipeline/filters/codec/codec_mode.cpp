@@ -21,6 +21,11 @@
 #include "foundation/cpp_ext/memory_ext.h"
 #include "utils/steady_clock.h"
 
+namespace {
+// decoders writing their output in place use aligned SIMD stores on it
+constexpr size_t OUT_BUFFER_ALIGN = 64;
+}
+
 namespace OHOS {
 namespace Media {
 namespace Pipeline {
@@ -40,6 +45,19 @@ bool CodecMode::Init(std::shared_ptr<Plugin::Codec>& plugin, std::vector<POutPor
     return true;
 }
 
+void CodecMode::SetTraceName(const std::string& filterName, const std::shared_ptr<TraceCounters>& counters)
+{
+    auto& tracer = PipelineTracer::Instance();
+    traceInputName_ = tracer.Intern(filterName + ".queueInput");
+    traceOutputName_ = tracer.Intern(filterName + ".pushOutput");
+    traceCounters_ = counters;
+}
+
+void CodecMode::SetTaskSchedulePolicy(const std::shared_ptr<const OSAL::TaskSchedulePolicy>& policy)
+{
+    taskSchedulePolicy_ = policy;
+}
+
 ErrorCode CodecMode::Configure()
 {
     FAIL_RETURN_MSG(TranslatePluginStatus(plugin_->Prepare()), "Prepare plugin fail");
@@ -80,7 +98,7 @@ void CodecMode::CreateOutBufferPool(std::shared_ptr<Allocator>& outAllocator,
     outBufPool_ = std::make_shared<BufferPool<AVBuffer>>(bufferCnt);
     if (outAllocator == nullptr) {
         MEDIA_LOG_I("plugin doest not support out allocator, using framework allocator");
-        outBufPool_->Init(bufferSize, bufferMetaType);
+        outBufPool_->Init(bufferSize, bufferMetaType, OUT_BUFFER_ALIGN);
     } else {
         MEDIA_LOG_I("using plugin output allocator");
         for (size_t cnt = 0; cnt < bufferCnt; cnt++) {
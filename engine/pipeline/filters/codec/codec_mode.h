@@ -21,6 +21,7 @@
 #include "pipeline/core/error_code.h"
 #include "pipeline/core/type_define.h"
 #include "plugin/core/codec.h"
+#include "utils/pipeline_tracer.h"
 
 namespace OHOS {
 namespace Media {
@@ -32,6 +33,16 @@ public:
 
     bool Init(std::shared_ptr<Plugin::Codec>& plugin, std::vector<POutPort>& outPorts);
 
+    /**
+     * Names the spans of this codec after its filter and counts into the counters of the filter, see PipelineTracer.
+     */
+    void SetTraceName(const std::string& filterName, const std::shared_ptr<TraceCounters>& counters);
+
+    /**
+     * Schedules of the codec tasks, applied when they are created in Prepare().
+     */
+    void SetTaskSchedulePolicy(const std::shared_ptr<const OSAL::TaskSchedulePolicy>& policy);
+
     virtual ErrorCode Configure();
 
     virtual ErrorCode PushData(const std::string &inPort, const AVBufferPtr& buffer, int64_t offset) = 0;
@@ -61,6 +72,10 @@ protected:
     std::vector<POutPort> outPorts_ {};
     std::shared_ptr<BufferPool<AVBuffer>> outBufPool_ {nullptr};
     std::string codecName_ {};
+    const char* traceInputName_ {nullptr};
+    const char* traceOutputName_ {nullptr};
+    std::shared_ptr<TraceCounters> traceCounters_ {nullptr};
+    std::shared_ptr<const OSAL::TaskSchedulePolicy> taskSchedulePolicy_ {nullptr};
 
 private:
     uint32_t inBufPoolSize_;
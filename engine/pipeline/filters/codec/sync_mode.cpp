@@ -77,6 +77,7 @@ void SyncMode::FlushEnd()
 ErrorCode SyncMode::HandleFrame(const std::shared_ptr<AVBuffer>& buffer)
 {
     MEDIA_LOG_D("SyncMode HandleFrame called");
+    PIPELINE_TRACE_BUFFER(traceInputName_, "codec", buffer, GetTraceBufferBytes(buffer));
     auto ret = TranslatePluginStatus(plugin_->QueueInputBuffer(buffer, 0));
     if (ret != ErrorCode::SUCCESS && ret != ErrorCode::ERROR_TIMED_OUT) {
         MEDIA_LOG_E("Queue input buffer to plugin fail: " PUBLIC_LOG_D32, CppExt::to_underlying(ret));
@@ -112,6 +113,7 @@ void SyncMode::OnOutputBufferDone(const std::shared_ptr<Plugin::Buffer>& buffer)
     auto oPort = outPorts_[0];
     if (oPort->GetWorkMode() == WorkMode::PUSH) {
         DUMP_BUFFER2FILE("decoder_output.data", buffer);
+        PIPELINE_TRACE_BUFFER(traceOutputName_, "codec", buffer, GetTraceBufferBytes(buffer));
         oPort->PushData(buffer, -1);
     } else {
         MEDIA_LOG_W("decoder out port works in pull mode");
@@ -35,6 +35,7 @@ const uint32_t DEFAULT_IN_BUFFER_POOL_SIZE = 8;
 const uint32_t DEFAULT_OUT_BUFFER_POOL_SIZE = 8;
 const float VIDEO_PIX_DEPTH = 1.5;
 const uint32_t VIDEO_ALIGN_SIZE = 16;
+const uint32_t VIDEO_PADDING_ROWS = 4; // room for decoders which read past the last plane of a frame
 }
 
 namespace OHOS {
@@ -172,8 +173,9 @@ uint32_t VideoDecoderFilter::CalculateBufferSize(const std::shared_ptr<const OHO
     } else {
         // need to check video sink support and calc buffer size
         MEDIA_LOG_E("Unsupported video pixel format: " PUBLIC_LOG_U32, vdecFormat);
+        return 0;
     }
-    return bufferSize;
+    return bufferSize + stride * VIDEO_PADDING_ROWS;
 }
 
 Plugin::TagMap VideoDecoderFilter::GetNegotiateParams(const Plugin::TagMap& upstreamParams)
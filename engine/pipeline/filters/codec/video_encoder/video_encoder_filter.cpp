@@ -127,6 +127,7 @@ ErrorCode VideoEncoderFilter::Prepare()
     if (!pushTask_) {
         pushTask_ = std::make_shared<OSAL::Task>("vecPushThread");
         pushTask_->RegisterHandler([this] { FinishFrame(); });
+        ApplyTaskSchedule(*pushTask_);
     }
     if (!inBufQue_) {
         inBufQue_ = std::make_shared<BlockingQueue<AVBufferPtr>>("vecFilterInBufQue", DEFAULT_IN_BUFFER_POOL_SIZE);
@@ -136,6 +137,7 @@ ErrorCode VideoEncoderFilter::Prepare()
     if (!handleFrameTask_) {
         handleFrameTask_ = std::make_shared<OSAL::Task>("vecHandleFrameThread");
         handleFrameTask_->RegisterHandler([this] { HandleFrame(); });
+        ApplyTaskSchedule(*handleFrameTask_);
     }
     return FilterBase::Prepare();
 }
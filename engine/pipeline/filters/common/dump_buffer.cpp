@@ -41,6 +41,7 @@ std::string GetDumpFileDir()
 
 void DumpBufferToFile(const std::string& fileName, const std::shared_ptr<Plugin::Buffer>& buffer)
 {
+    FALSE_RETURN(buffer != nullptr && !buffer->IsEmpty());
     size_t bufferSize = buffer->GetMemory()->GetSize();
     FALSE_RETURN(bufferSize != 0);
 
@@ -48,8 +49,10 @@ void DumpBufferToFile(const std::string& fileName, const std::shared_ptr<Plugin:
     auto filePtr = fopen(filePath.c_str(), "ab+");
     FALSE_RETURN_MSG(filePtr != nullptr, "Open file(" PUBLIC_LOG_S ") failed(" PUBLIC_LOG_S ").", filePath.c_str(),
                      strerror(errno));
-    (void)fwrite(reinterpret_cast<const char*>(buffer->GetMemory()->GetReadOnlyData()),
-                 1, bufferSize, filePtr);
+    for (uint32_t i = 0; i < buffer->GetMemoryCount(); ++i) { // zero copy buffers may have several memories
+        auto memory = buffer->GetMemory(i);
+        (void)fwrite(reinterpret_cast<const char*>(memory->GetReadOnlyData()), 1, memory->GetSize(), filePtr);
+    }
     (void)fclose(filePtr);
 }
 
@@ -18,9 +18,11 @@
 #include "plugin_utils.h"
 
 #include <cstdarg>
+#include <list>
 #include <sstream>
 
 #include "foundation/log.h"
+#include "foundation/osal/thread/scoped_lock.h"
 #include "pipeline/core/plugin_attr_desc.h"
 
 namespace {
@@ -267,6 +269,7 @@ std::map<Plugin::MetaID, CapStrnessFunc> g_metaStrnessMap = {
     {Plugin::MetaID::MEDIA_BITRATE, MetaIDStringiness<int64_t>},
     {Plugin::MetaID::MEDIA_FILE_EXTENSION, MetaIDStringiness<std::string>},
     {Plugin::MetaID::MEDIA_FILE_SIZE , MetaIDStringiness<uint64_t>},
+    {Plugin::MetaID::MEDIA_CHEAP_SEEK, MetaIDStringiness<uint32_t>},
     {Plugin::MetaID::AUDIO_MPEG_VERSION, MetaIDStringiness<uint32_t>},
     {Plugin::MetaID::AUDIO_MPEG_LAYER ,MetaIDStringiness<uint32_t>},
     {Plugin::MetaID::AUDIO_AAC_PROFILE, MetaIDStringiness<Plugin::AudioAacProfile>},
@@ -351,18 +354,115 @@ bool TranslateIntoParameter(const int& key, OHOS::Media::Plugin::Tag& tag)
     return true;
 }
 
+namespace {
+using AvailablePlugins = std::vector<std::pair<std::shared_ptr<Plugin::PluginInfo>, Plugin::Capability>>;
+
+struct CompiledPluginCaps {
+    std::shared_ptr<Plugin::PluginInfo> info;
+    std::vector<CompiledCapability> inCaps;
+};
+
+struct CompiledPluginSet {
+    uint32_t generation {0};
+    std::vector<CompiledPluginCaps> plugins {};
+};
+
+struct NegotiationCacheEntry {
+    Plugin::PluginType pluginType;
+    uint32_t generation;
+    CompiledCapability upStreamCaps;
+    AvailablePlugins plugins;
+};
+
+constexpr size_t NEGOTIATION_CACHE_SIZE = 16;
+
+OSAL::Mutex g_compiledCapsMutex {};
+std::map<Plugin::PluginType, std::shared_ptr<const CompiledPluginSet>> g_compiledPluginSets {};
+std::list<NegotiationCacheEntry> g_negotiationCache {}; // the most recently used first
+}
+
+/**
+ * The in caps of all plugins of one type, compiled once per set of registered plugins.
+ */
+static std::shared_ptr<const CompiledPluginSet> GetCompiledPlugins(Plugin::PluginType pluginType, uint32_t generation)
+{
+    {
+        OSAL::ScopedLock lock(g_compiledCapsMutex);
+        auto ite = g_compiledPluginSets.find(pluginType);
+        if (ite != g_compiledPluginSets.end() && ite->second->generation == generation) {
+            return ite->second;
+        }
+    }
+    auto compiled = std::make_shared<CompiledPluginSet>();
+    compiled->generation = generation;
+    auto& pluginManager = Plugin::PluginManager::Instance();
+    for (const auto& name : pluginManager.ListPlugins(pluginType)) {
+        auto info = pluginManager.GetPluginInfo(pluginType, name);
+        if (info == nullptr) {
+            continue;
+        }
+        CompiledPluginCaps plugin {info, {}};
+        plugin.inCaps.reserve(info->inCaps.size());
+        for (const auto& cap : info->inCaps) {
+            plugin.inCaps.emplace_back(CompileCapability(cap));
+        }
+        compiled->plugins.emplace_back(std::move(plugin));
+    }
+    OSAL::ScopedLock lock(g_compiledCapsMutex);
+    g_compiledPluginSets[pluginType] = compiled;
+    return compiled;
+}
+
+static bool FindInNegotiationCache(Plugin::PluginType pluginType, uint32_t generation,
+                                   const CompiledCapability& upStreamCaps, AvailablePlugins& plugins)
+{
+    OSAL::ScopedLock lock(g_compiledCapsMutex);
+    for (auto ite = g_negotiationCache.begin(); ite != g_negotiationCache.end(); ++ite) {
+        if (ite->pluginType == pluginType && ite->generation == generation &&
+            IsSameCapability(ite->upStreamCaps, upStreamCaps)) {
+            g_negotiationCache.splice(g_negotiationCache.begin(), g_negotiationCache, ite);
+            plugins = g_negotiationCache.front().plugins;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void AddToNegotiationCache(Plugin::PluginType pluginType, uint32_t generation,
+                                  CompiledCapability upStreamCaps, const AvailablePlugins& plugins)
+{
+    if (!upStreamCaps.complete) {
+        return; // equal compiled caps don't mean equal caps then
+    }
+    OSAL::ScopedLock lock(g_compiledCapsMutex);
+    g_negotiationCache.push_front({pluginType, generation, std::move(upStreamCaps), plugins});
+    if (g_negotiationCache.size() > NEGOTIATION_CACHE_SIZE) {
+        g_negotiationCache.pop_back();
+    }
+}
+
 std::vector<std::pair<std::shared_ptr<Plugin::PluginInfo>, Plugin::Capability>>
     FindAvailablePlugins(const Plugin::Capability& upStreamCaps, Plugin::PluginType pluginType)
 {
-    auto pluginNames = Plugin::PluginManager::Instance().ListPlugins(pluginType);
-    std::vector<std::pair<std::shared_ptr<Plugin::PluginInfo>, Plugin::Capability>> infos;
-    for (const auto& name : pluginNames) {
-        auto tmpInfo = Plugin::PluginManager::Instance().GetPluginInfo(pluginType, name);
-        Capability cap;
-        if (ApplyCapabilitySet(upStreamCaps, tmpInfo->inCaps, cap)) {
-            infos.emplace_back(tmpInfo, cap);
+    auto generation = Plugin::PluginManager::Instance().GetGeneration();
+    auto compiledUpStreamCaps = CompileCapability(upStreamCaps);
+    AvailablePlugins infos;
+    if (FindInNegotiationCache(pluginType, generation, compiledUpStreamCaps, infos)) {
+        return infos;
+    }
+    auto compiledPlugins = GetCompiledPlugins(pluginType, generation);
+    for (const auto& plugin : compiledPlugins->plugins) {
+        // the same as ApplyCapabilitySet, the compiled caps skip the ones that can't match
+        for (size_t i = 0; i < plugin.inCaps.size(); ++i) {
+            Capability cap;
+            if (MayMergeCapability(compiledUpStreamCaps, plugin.inCaps[i]) &&
+                MergeCapability(upStreamCaps, plugin.info->inCaps[i], cap)) {
+                infos.emplace_back(plugin.info, std::move(cap));
+                break;
+            }
         }
     }
+    AddToNegotiationCache(pluginType, generation, std::move(compiledUpStreamCaps), infos);
     return infos;
 }
 std::vector<std::shared_ptr<Plugin::PluginInfo>> FindAvailablePluginsByOutputMime(const std::string& outputMime,
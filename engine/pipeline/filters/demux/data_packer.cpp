@@ -140,11 +140,14 @@ bool DataPacker::PeekRange(uint64_t offset, uint32_t size, AVBufferPtr& bufferPt
 // Should call IsDataAvailable() before to make sure there is enough buffer to copy.
 // offset : the offset (of the media file) to peek ( 要peek的数据起始位置 在media file文件 中的 offset )
 // size : the size of data to peek
-// bufferPtr : out buffer
+// bufferPtr : out buffer, if it has no memory, the data is not copied but shared, see PeekRangeView()
 // isGet : is it called from GetRange.
 bool DataPacker::PeekRangeInternal(uint64_t offset, uint32_t size, AVBufferPtr &bufferPtr, bool isGet)
 {
     MEDIA_LOG_D("PeekRangeInternal (offset, size) = (" PUBLIC_LOG_U64 ", " PUBLIC_LOG_U32 ")...", offset, size);
+    if (bufferPtr->IsEmpty()) {
+        return PeekRangeView(offset, size, bufferPtr, isGet);
+    }
     int32_t startIndex = 0; // The index of buffer that we first use
     size_t copySize = 0;
     uint32_t needCopySize = size, firstBufferOffset = 0;
@@ -188,14 +191,36 @@ bool DataPacker::PeekRangeInternal(uint64_t offset, uint32_t size, AVBufferPtr &
     return true;
 }
 
+// Zero copy peek, bufferPtr has no memory.
+// The range is appended to bufferPtr as read-only views of the cached buffers: one memory if the range lies in one
+// cached buffer, otherwise one memory for each cached buffer it spans.
+bool DataPacker::PeekRangeView(uint64_t offset, uint32_t size, AVBufferPtr &bufferPtr, bool isGet)
+{
+    int32_t startIndex = 0;
+    uint64_t prevOffset = 0;
+    FALSE_RETURN_V(FindFirstBufferToCopy(offset, startIndex, prevOffset), false);
+    auto bufferOffset = static_cast<int32_t>(offset - prevOffset);
+    size_t needViewSize = size;
+    for (auto index = startIndex; static_cast<size_t>(index) < que_.size() && needViewSize > 0; ++index) {
+        auto viewSize = ViewFirstBuffer(needViewSize, index, bufferPtr, (index == startIndex) ? bufferOffset : 0);
+        FALSE_RETURN_V(viewSize > 0, false);
+        needViewSize -= viewSize;
+    }
+    bufferPtr->pts = que_[startIndex]->pts;
+    bufferPtr->dts = que_[startIndex]->dts;
+    EXEC_WHEN_GET(isGet, currentGet_ = Position(startIndex, bufferOffset, offset));
+    return true;
+}
+
 // Call IsDataAvailable() first before call GetRange
+// If bufferPtr has no memory, the range is shared with the cached data instead of copied, see PeekRangeView()
 bool DataPacker::GetRange(uint64_t offset, uint32_t size, AVBufferPtr& bufferPtr)
 {
     MEDIA_LOG_D("DataPacker GetRange(offset, size) = (" PUBLIC_LOG_U64 ", "
                 PUBLIC_LOG_U32 ")...", offset, size);
     DUMP_BUFFER2LOG("GetRange Input", bufferPtr, 0);
-    FALSE_RETURN_V_MSG_E(bufferPtr && (!bufferPtr->IsEmpty()) && bufferPtr->GetMemory()->GetCapacity() >= size, false,
-        "GetRange input bufferPtr empty or capacity not enough.");
+    FALSE_RETURN_V_MSG_E(bufferPtr && (bufferPtr->IsEmpty() || bufferPtr->GetMemory()->GetCapacity() >= size), false,
+        "GetRange input bufferPtr capacity not enough.");
 
     OSAL::ScopedLock lock(mutex_);
     if (que_.empty()) {
@@ -227,8 +252,8 @@ bool DataPacker::GetRange(uint64_t offset, uint32_t size, AVBufferPtr& bufferPtr
 bool DataPacker::GetRange(uint32_t size, AVBufferPtr& bufferPtr)
 {
     MEDIA_LOG_D("DataPacker live play GetRange(size) = (" PUBLIC_LOG_U32 ")...", size);
-    FALSE_RETURN_V_MSG_E(bufferPtr && (!bufferPtr->IsEmpty()) && bufferPtr->GetMemory()->GetCapacity() >= size, false,
-        "Live play GetRange input bufferPtr empty or capacity not enough.");
+    FALSE_RETURN_V_MSG_E(bufferPtr && (bufferPtr->IsEmpty() || bufferPtr->GetMemory()->GetCapacity() >= size), false,
+        "Live play GetRange input bufferPtr capacity not enough.");
 
     OSAL::ScopedLock lock(mutex_);
     if (que_.empty()) {
@@ -248,16 +273,25 @@ bool DataPacker::GetRange(uint32_t size, AVBufferPtr& bufferPtr)
     int32_t index = 0;
     uint32_t lastBufferOffsetEnd = 0;
 
-    uint8_t* dstPtr = AudioBufferWritableData(bufferPtr, size);
-    FALSE_RETURN_V(dstPtr != nullptr, false);
+    bool zeroCopy = bufferPtr->IsEmpty();
+    uint8_t* dstPtr = nullptr;
+    if (!zeroCopy) {
+        dstPtr = AudioBufferWritableData(bufferPtr, size);
+        FALSE_RETURN_V(dstPtr != nullptr, false);
+    }
 
     while (index < que_.size()) {
         AVBufferPtr& buffer = que_[index];
         size_t bufferSize = AudioBufferSize(buffer);
         currCopySize = std::min(static_cast<int32_t>(bufferSize), needCopySize);
-        currCopySize = CopyFirstBuffer(currCopySize, index, dstPtr, bufferPtr, 0);
+        if (zeroCopy) {
+            currCopySize = ViewFirstBuffer(currCopySize, index, bufferPtr, 0);
+            FALSE_RETURN_V(currCopySize > 0, false);
+        } else {
+            currCopySize = CopyFirstBuffer(currCopySize, index, dstPtr, bufferPtr, 0);
+            dstPtr += currCopySize;
+        }
         lastBufferOffsetEnd = currCopySize;
-        dstPtr += currCopySize;
         needCopySize -= currCopySize;
         if (needCopySize <= 0) { // it is enough
             break;
@@ -269,7 +303,9 @@ bool DataPacker::GetRange(uint32_t size, AVBufferPtr& bufferPtr)
     if (needCopySize < 0) {
         needCopySize = 0;
     }
-    bufferPtr->GetMemory()->UpdateDataSize(size - needCopySize);
+    if (!zeroCopy) {
+        bufferPtr->GetMemory()->UpdateDataSize(size - needCopySize);
+    }
 
     auto endPosition = Position(index, lastBufferOffsetEnd, mediaOffset_ + size - needCopySize);
     RemoveOldData(endPosition); // Live play, remove the got data
@@ -314,6 +350,7 @@ void DataPacker::FlushInternal()
 }
 
 // Remove first removeSize data in the buffer
+// The remaining data is not moved, views returned by PeekRange/GetRange may still refer to it.
 void DataPacker::RemoveBufferContent(std::shared_ptr<AVBuffer> &buffer, size_t removeSize)
 {
     if (removeSize == 0) {
@@ -322,8 +359,16 @@ void DataPacker::RemoveBufferContent(std::shared_ptr<AVBuffer> &buffer, size_t r
     auto memory = buffer->GetMemory();
     FALSE_RETURN(removeSize < memory->GetSize());
     auto copySize = memory->GetSize() - removeSize;
-    FALSE_LOG_MSG(memmove_s(memory->GetWritableAddr(copySize), memory->GetCapacity(),
-        memory->GetReadOnlyData(removeSize), copySize) == EOK, "memmove failed.");
+    auto remain = std::make_shared<AVBuffer>();
+    if (remain->WrapMemorySlice(memory, removeSize, copySize) != nullptr) {
+        remain->pts = buffer->pts;
+        remain->dts = buffer->dts;
+        remain->flag = buffer->flag;
+        buffer = remain;
+    } else {
+        FALSE_LOG_MSG(memmove_s(memory->GetWritableAddr(copySize), memory->GetCapacity(),
+            memory->GetReadOnlyData(removeSize), copySize) == EOK, "memmove failed.");
+    }
     FALSE_RETURN(UpdateWhenFrontDataRemoved(removeSize));
 }
 
@@ -417,6 +462,23 @@ size_t DataPacker::CopyFirstBuffer(size_t size, int32_t index, uint8_t *dstPtr,
     return copySize;
 }
 
+// size : the wanted size
+// dstBufferPtr : the AVBuffer to append the read-only view of que_[index] to, pts / dts are updated too.
+// bufferOffset : the buffer offset that the view starts
+size_t DataPacker::ViewFirstBuffer(size_t size, int32_t index, AVBufferPtr &dstBufferPtr, int32_t bufferOffset)
+{
+    auto remainSize = static_cast<int32_t>(AudioBufferSize(que_[index]) - bufferOffset);
+    FALSE_RETURN_V_MSG_E(remainSize > 0, 0, "View size can not be negative.");
+    size_t viewSize = std::min(static_cast<size_t>(remainSize), size);
+    // the view shares the cached data, writing through it would corrupt the cache
+    FALSE_RETURN_V_MSG_E(dstBufferPtr->WrapMemorySlice(que_[index]->GetMemory(), bufferOffset, viewSize, true) !=
+        nullptr, 0, "Can not share memory of the cached buffer.");
+
+    dstBufferPtr->pts = que_[index]->pts;
+    dstBufferPtr->dts = que_[index]->dts;
+    return viewSize;
+}
+
 // prevOffset : the media offset of the first byte in the startIndex + 1 buffer
 // offsetEnd : calculate from GetRange(offset, size), offsetEnd = offset + size.
 // startIndex : the index start copy data for this GetRange. CopyFromSuccessiveBuffer process from startIndex + 1.
@@ -88,6 +88,8 @@ private:
 
     bool PeekRangeInternal(uint64_t offset, uint32_t size, AVBufferPtr &bufferPtr, bool isGet);
 
+    bool PeekRangeView(uint64_t offset, uint32_t size, AVBufferPtr &bufferPtr, bool isGet);
+
     void FlushInternal();
 
     bool FindFirstBufferToCopy(uint64_t offset, int32_t &startIndex, uint64_t &prevOffset);
@@ -95,6 +97,8 @@ private:
     size_t CopyFirstBuffer(size_t size, int32_t index, uint8_t *dstPtr, AVBufferPtr &dstBufferPtr,
                            int32_t bufferOffset);
 
+    size_t ViewFirstBuffer(size_t size, int32_t index, AVBufferPtr &dstBufferPtr, int32_t bufferOffset);
+
     int32_t CopyFromSuccessiveBuffer(uint64_t prevOffset, uint64_t offsetEnd, int32_t startIndex, uint8_t *dstPtr,
                                      uint32_t &needCopySize);
 
@@ -18,8 +18,10 @@
 #include "demuxer_filter.h"
 #include <algorithm>
 #include "compatible_check.h"
+#include "parallel_runner.h"
 #include "factory/filter_factory.h"
 #include "foundation/log.h"
+#include "osal/thread/scoped_lock.h"
 #include "pipeline/filters/common/plugin_utils.h"
 #include "plugin/common/plugin_time.h"
 #include "utils/constants.h"
@@ -36,6 +38,8 @@ public:
     explicit DataSourceImpl(const DemuxerFilter& filter);
     ~DataSourceImpl() override = default;
     Plugin::Status ReadAt(int64_t offset, std::shared_ptr<Plugin::Buffer>& buffer, size_t expectedLen) override;
+    Plugin::Status ReadAtDirect(int64_t offset, std::shared_ptr<Plugin::Buffer>& buffer, size_t expectedLen) override;
+    bool IsSeekCheap() override;
     Plugin::Status GetSize(size_t& size) override;
 
 private:
@@ -49,14 +53,14 @@ DemuxerFilter::DataSourceImpl::DataSourceImpl(const DemuxerFilter& filter) : fil
 /**
  * ReadAt Plugin::DataSource::ReadAt implementation.
  * @param offset offset in media stream.
- * @param buffer caller allocate real buffer.
+ * @param buffer caller allocate real buffer, or a buffer without memory to share the cached data without copy.
  * @param expectedLen buffer size wanted to read.
  * @return read result.
  */
 Plugin::Status DemuxerFilter::DataSourceImpl::ReadAt(int64_t offset, std::shared_ptr<Plugin::Buffer>& buffer,
                                                      size_t expectedLen)
 {
-    if (!buffer || buffer->IsEmpty() || expectedLen == 0 || !filter.IsOffsetValid(offset)) {
+    if (!buffer || expectedLen == 0 || !filter.IsOffsetValid(offset)) {
         MEDIA_LOG_E("ReadAt failed, buffer empty: " PUBLIC_LOG_D32 ", expectedLen: " PUBLIC_LOG_D32
                     ", offset: " PUBLIC_LOG_D64, !buffer, static_cast<int>(expectedLen), offset);
         return Plugin::Status::ERROR_UNKNOWN;
@@ -90,6 +94,36 @@ Plugin::Status DemuxerFilter::DataSourceImpl::ReadAt(int64_t offset, std::shared
     return rtv;
 }
 
+/**
+ * ReadAtDirect Plugin::DataSource::ReadAtDirect implementation, pulls from the source without the data packer.
+ * @param offset offset in media stream.
+ * @param buffer caller allocate real buffer.
+ * @param expectedLen buffer size wanted to read.
+ * @return read result, ERROR_UNIMPLEMENTED in push mode.
+ */
+Plugin::Status DemuxerFilter::DataSourceImpl::ReadAtDirect(int64_t offset, std::shared_ptr<Plugin::Buffer>& buffer,
+                                                           size_t expectedLen)
+{
+    if (!filter.readDirect_) {
+        return Plugin::Status::ERROR_UNIMPLEMENTED;
+    }
+    if (!buffer || buffer->GetMemory() == nullptr || expectedLen == 0 || !filter.IsOffsetValid(offset)) {
+        MEDIA_LOG_E("ReadAtDirect failed, expectedLen: " PUBLIC_LOG_ZU ", offset: " PUBLIC_LOG_D64,
+                    expectedLen, offset);
+        return Plugin::Status::ERROR_UNKNOWN;
+    }
+    return filter.readDirect_(static_cast<uint64_t>(offset), expectedLen, buffer);
+}
+
+/**
+ * IsSeekCheap Plugin::DataSource::IsSeekCheap implementation.
+ * @return true in pull mode from a source which told so, each pull at another offset seeks the source.
+ */
+bool DemuxerFilter::DataSourceImpl::IsSeekCheap()
+{
+    return filter.readDirect_ && filter.cheapSeek_;
+}
+
 Plugin::Status DemuxerFilter::DataSourceImpl::GetSize(size_t& size)
 {
     size = filter.mediaDataSize_;
@@ -192,6 +226,7 @@ ErrorCode DemuxerFilter::Prepare()
 
     pluginState_ = DemuxerState::DEMUXER_STATE_NULL;
     task_->RegisterHandler([this] { DemuxerLoop(); });
+    ApplyTaskSchedule(*task_);
     Pipeline::WorkMode mode;
     GetInPort(PORT_NAME_DEFAULT)->Activate({Pipeline::WorkMode::PULL, Pipeline::WorkMode::PUSH}, mode);
     if (mode == Pipeline::WorkMode::PULL) {
@@ -231,6 +266,8 @@ bool DemuxerFilter::Negotiate(const std::string& inPort,
 bool DemuxerFilter::Configure(const std::string& inPort, const std::shared_ptr<const Plugin::Meta>& upstreamMeta)
 {
     (void)upstreamMeta->GetUint64(Plugin::MetaID::MEDIA_FILE_SIZE, mediaDataSize_);
+    uint32_t cheapSeek = 0;
+    cheapSeek_ = upstreamMeta->GetUint32(Plugin::MetaID::MEDIA_CHEAP_SEEK, cheapSeek) && cheapSeek != 0;
     return upstreamMeta->GetString(Plugin::MetaID::MEDIA_FILE_EXTENSION, uriSuffix_);
 }
 
@@ -325,8 +362,15 @@ void DemuxerFilter::ActivatePullMode()
         MEDIA_LOG_D("IsDataAvailable false, require offset " PUBLIC_LOG_D64 ", DataPacker data offset end - curOffset "
                     PUBLIC_LOG_D64, offset, curOffset);
         AVBufferPtr bufferPtr = std::make_shared<AVBuffer>();
-        bufferPtr->AllocMemory(pluginAllocator_, size);
-        auto ret = inPorts_.front()->PullData(curOffset, size, bufferPtr);
+        // without an allocator of the plugin the source provides the memory, e.g. the pages of a mapped file
+        if (pluginAllocator_ != nullptr) {
+            bufferPtr->AllocMemory(pluginAllocator_, size);
+        }
+        ErrorCode ret;
+        {
+            OSAL::ScopedLock lock(pullMutex_);
+            ret = inPorts_.front()->PullData(curOffset, size, bufferPtr);
+        }
         if (ret == ErrorCode::SUCCESS) {
             dataPacker_->PushData(std::move(bufferPtr), curOffset);
             return true;
@@ -357,6 +401,17 @@ void DemuxerFilter::ActivatePullMode()
         }
         return false;
     };
+    readDirect_ = [this](uint64_t offset, size_t size, AVBufferPtr& bufferPtr) -> Plugin::Status {
+        OSAL::ScopedLock lock(pullMutex_);
+        switch (inPorts_.front()->PullData(offset, size, bufferPtr)) {
+            case ErrorCode::SUCCESS:
+                return Plugin::Status::OK;
+            case ErrorCode::END_OF_STREAM:
+                return Plugin::Status::END_OF_STREAM;
+            default:
+                return Plugin::Status::ERROR_UNKNOWN;
+        }
+    };
     typeFinder_->Init(uriSuffix_, mediaDataSize_, checkRange_, peekRange_);
     MediaTypeFound(typeFinder_->FindMediaType());
 }
@@ -375,6 +430,7 @@ void DemuxerFilter::ActivatePushMode()
         // In push mode, ignore offset, always get data from the start of the data packer.
         return dataPacker_->GetRange(size, bufferPtr);
     };
+    readDirect_ = nullptr; // the data is pushed, nothing can be read at an offset
     typeFinder_->Init(uriSuffix_, mediaDataSize_, checkRange_, peekRange_);
     typeFinder_->FindMediaTypeAsync([this](std::string pluginName) { MediaTypeFound(std::move(pluginName)); });
 }
@@ -497,21 +553,41 @@ void DemuxerFilter::HandleFrame(const AVBufferPtr& bufferPtr, uint32_t trackId)
 void DemuxerFilter::NegotiateDownstream()
 {
     PROFILE_BEGIN("NegotiateDownstream profile begins.");
+    // the branches of the tracks don't share filters, so decoder creation and sink device open of e.g. the audio and
+    // the video track overlap
+    ParallelRunner runner;
+    std::vector<std::pair<StreamTrackInfo*, bool>> results; // the track and whether it was configured
     for (auto& stream : mediaMetaData_.trackInfos) {
-        if (stream.needNegoCaps) {
+        if (!stream.needNegoCaps) {
+            continue;
+        }
+        auto index = results.size();
+        results.emplace_back(&stream, false);
+        runner.AddJob(name_ + "." + stream.port->GetName() + ".Negotiate", [this, &results, index] {
+            auto& result = results[index];
+            auto& stream = *result.first;
             Capability caps;
             MEDIA_LOG_I("demuxer negotiate with trackId: " PUBLIC_LOG_U32, stream.trackId);
             auto streamMeta = GetTrackMeta(stream.trackId);
             auto tmpCap = MetaToCapability(*streamMeta);
             Plugin::TagMap upstreamParams;
             Plugin::TagMap downstreamParams;
-            if (stream.port->Negotiate(tmpCap, caps, upstreamParams, downstreamParams) &&
-                stream.port->Configure(streamMeta)) {
-                stream.needNegoCaps = false;
-            } else {
-                task_->PauseAsync();
-                OnEvent({name_, EventType::EVENT_ERROR, ErrorCode::ERROR_UNSUPPORTED_FORMAT});
-            }
+            result.second = stream.port->Negotiate(tmpCap, caps, upstreamParams, downstreamParams) &&
+                stream.port->Configure(streamMeta);
+            return ErrorCode::SUCCESS; // one failed track doesn't stop the others
+        });
+    }
+    (void)runner.Run();
+    for (const auto& timing : runner.GetTimings()) {
+        MEDIA_LOG_I(PUBLIC_LOG_S " at " PUBLIC_LOG_D64 " us took " PUBLIC_LOG_D64 " us",
+                    timing.name.c_str(), timing.beginUs, timing.durationUs);
+    }
+    for (auto& result : results) {
+        if (result.second) {
+            result.first->needNegoCaps = false;
+        } else {
+            task_->PauseAsync();
+            OnEvent({name_, EventType::EVENT_ERROR, ErrorCode::ERROR_UNSUPPORTED_FORMAT});
         }
     }
     PROFILE_END("NegotiateDownstream end.");
@@ -130,6 +130,7 @@ private:
 
     std::string uriSuffix_;
     uint64_t mediaDataSize_;
+    bool cheapSeek_ {false}; // from the source, e.g. a local file
     std::shared_ptr<OSAL::Task> task_;
     std::shared_ptr<TypeFinder> typeFinder_;
     std::shared_ptr<DataPacker> dataPacker_;
@@ -144,6 +145,8 @@ private:
     std::function<bool(uint64_t, size_t)> checkRange_;
     std::function<bool(uint64_t, size_t, AVBufferPtr&)> peekRange_;
     std::function<bool(uint64_t, size_t, AVBufferPtr&)> getRange_;
+    std::function<Plugin::Status(uint64_t, size_t, AVBufferPtr&)> readDirect_; // nullptr in push mode
+    OSAL::Mutex pullMutex_; // one pull from the source at a time, for checkRange_ and readDirect_
 };
 } // namespace Pipeline
 } // namespace Media
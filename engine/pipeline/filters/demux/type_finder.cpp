@@ -17,8 +17,12 @@
 
 #include "type_finder.h"
 #include <algorithm>
+#include <cstring>
 #include "foundation/log.h"
+#include "osal/thread/mutex.h"
+#include "osal/thread/scoped_lock.h"
 #include "osal/utils/util.h"
+#include "pipeline/core/parallel_runner.h"
 #include "utils/steady_clock.h"
 
 namespace OHOS {
@@ -50,6 +54,103 @@ void ToLower(std::string& str)
 
 // lowercase suffix
 std::vector<std::string> g_findTypeNeededForSameSuffix = {"aac"};
+
+constexpr int PROBE_THRESHOLD = 50; // valid range [0, 100]
+constexpr size_t PROBE_WINDOW_SIZE = 16 * 1024; // the most any sniffer reads at once
+constexpr size_t TS_PACKET_SIZE = 188;
+
+/**
+ * Leading bytes of a container format and the file extensions of the demuxers that are likely to read it.
+ */
+struct MagicPrefix {
+    const char* name;
+    std::function<bool(const uint8_t*, size_t)> match;
+    std::vector<std::string> extensions;
+};
+
+const std::vector<MagicPrefix>& GetMagicPrefixes()
+{
+    static const std::vector<MagicPrefix> prefixes = {
+        {"ftyp", [](const uint8_t* data, size_t size) {
+            return size >= 8 && memcmp(data + 4, "ftyp", 4) == 0; // 8, 4: box size, then box type
+        }, {"mp4", "m4a", "mov", "3gp"}},
+        {"ID3", [](const uint8_t* data, size_t size) {
+            return size >= 3 && memcmp(data, "ID3", 3) == 0; // 3: tag length
+        }, {"mp3"}},
+        {"RIFF", [](const uint8_t* data, size_t size) {
+            return size >= 4 && (memcmp(data, "RIFF", 4) == 0 || memcmp(data, "RF64", 4) == 0); // 4: tag length
+        }, {"wav", "avi"}},
+        {"ADTS", [](const uint8_t* data, size_t size) {
+            return size >= 2 && data[0] == 0xFF && (data[1] & 0xF6) == 0xF0; // 2, 0xF6, 0xF0: sync word, layer 0
+        }, {"aac"}},
+        {"MPEG audio", [](const uint8_t* data, size_t size) {
+            return size >= 2 && data[0] == 0xFF && (data[1] & 0xE0) == 0xE0 && (data[1] & 0x06) != 0; // 2: sync, layer
+        }, {"mp3"}},
+        {"TS", [](const uint8_t* data, size_t size) {
+            return size >= 1 && data[0] == 0x47 && (size <= TS_PACKET_SIZE || data[TS_PACKET_SIZE] == 0x47);
+        }, {"ts", "m2ts", "mts"}},
+    };
+    return prefixes;
+}
+
+const MagicPrefix* FindMagicPrefix(const AVBufferPtr& window)
+{
+    auto memory = window->GetMemory();
+    if (memory == nullptr || memory->GetSize() == 0) {
+        return nullptr;
+    }
+    const auto& prefixes = GetMagicPrefixes();
+    auto it = std::find_if(prefixes.begin(), prefixes.end(), [&memory](const MagicPrefix& prefix) {
+        return prefix.match(memory->GetReadOnlyData(), memory->GetSize());
+    });
+    return it == prefixes.end() ? nullptr : &*it;
+}
+
+bool IsPluginLikely(const MagicPrefix* magic, const std::shared_ptr<Plugin::PluginInfo>& plugin)
+{
+    return magic != nullptr && std::any_of(magic->extensions.begin(), magic->extensions.end(),
+        [&plugin](const std::string& ext) { return IsPluginSupportedExtension(*plugin, ext); });
+}
+
+/**
+ * Serves the sniffers from the probe window that was read once for all of them. Reads beyond the window go to
+ * the type finder, one after the other since the sniffers run in parallel.
+ */
+class ProbeWindowSource : public Plugin::DataSourceHelper {
+public:
+    ProbeWindowSource(std::shared_ptr<TypeFinder> typeFinder, AVBufferPtr window)
+        : typeFinder_(std::move(typeFinder)), window_(std::move(window))
+    {
+    }
+
+    Plugin::Status ReadAt(int64_t offset, std::shared_ptr<Plugin::Buffer>& buffer, size_t expectedLen) override
+    {
+        auto windowMemory = window_->GetMemory();
+        auto windowSize = windowMemory ? windowMemory->GetSize() : 0;
+        if (buffer == nullptr || expectedLen == 0 || offset < 0 ||
+            static_cast<uint64_t>(offset) + expectedLen > windowSize) {
+            OSAL::ScopedLock lock(mutex_);
+            return typeFinder_->ReadAt(offset, buffer, expectedLen);
+        }
+        auto memory = buffer->GetMemory();
+        if (memory == nullptr) {
+            memory = buffer->AllocMemory(nullptr, expectedLen);
+        }
+        memory->Reset();
+        (void)memory->Write(windowMemory->GetReadOnlyData(offset), expectedLen, 0);
+        return Plugin::Status::OK;
+    }
+
+    Plugin::Status GetSize(size_t& size) override
+    {
+        return typeFinder_->GetSize(size);
+    }
+
+private:
+    std::shared_ptr<TypeFinder> typeFinder_;
+    AVBufferPtr window_;
+    OSAL::Mutex mutex_ {};
+};
 } // namespace
 
 TypeFinder::TypeFinder()
@@ -62,7 +163,13 @@ TypeFinder::TypeFinder()
       task_(nullptr),
       checkRange_(),
       peekRange_(),
-      typeFound_()
+      typeFound_(),
+      sniffer_([](const std::string& name, std::shared_ptr<Plugin::DataSourceHelper> source) {
+          return Plugin::PluginManager::Instance().Sniffer(name, std::move(source));
+      }),
+      isPluginLoaded_([](const std::string& name) {
+          return Plugin::PluginManager::Instance().IsPluginLoaded(Plugin::PluginType::DEMUXER, name);
+      })
 {
     MEDIA_LOG_D("TypeFinder ctor called...");
 }
@@ -174,27 +281,102 @@ void TypeFinder::DoTask()
 std::string TypeFinder::SniffMediaType()
 {
     PROFILE_BEGIN("SniffMediaType begin.");
-    constexpr int probThresh = 50; // valid range [0, 100]
+    auto window = ReadProbeWindow();
+    auto dataSource = std::make_shared<ProbeWindowSource>(shared_from_this(), window);
+    std::vector<std::shared_ptr<Plugin::PluginInfo>> candidates(plugins_);
+    auto magic = FindMagicPrefix(window);
+    auto likelyEnd = std::stable_partition(candidates.begin(), candidates.end(),
+        [magic](const std::shared_ptr<Plugin::PluginInfo>& plugin) { return IsPluginLikely(magic, plugin); });
+    auto likelyCnt = static_cast<size_t>(likelyEnd - candidates.begin());
+    if (magic != nullptr) {
+        MEDIA_LOG_D("probe window starts with " PUBLIC_LOG_S ", " PUBLIC_LOG_ZU " likely plugins", magic->name,
+                    likelyCnt);
+    }
+    // a library registered from the manifest is only loaded to sniff if its extensions hint at the media
+    auto hintedEnd = std::stable_partition(likelyEnd, candidates.end(),
+        [this](const std::shared_ptr<Plugin::PluginInfo>& plugin) {
+            return IsPluginSupportedExtension(*plugin, uriSuffix_) || isPluginLoaded_(plugin->name);
+        });
+    auto hintedCnt = static_cast<size_t>(hintedEnd - candidates.begin());
+
+    // the likely plugins one after the other, the first one that is sure wins
+    std::vector<int> probs(candidates.size(), 0);
+    size_t sniffedCnt = 0;
+    for (; sniffedCnt < likelyCnt; ++sniffedCnt) {
+        probs[sniffedCnt] = sniffer_(candidates[sniffedCnt]->name, dataSource);
+        if (probs[sniffedCnt] > PROBE_THRESHOLD) {
+            PROFILE_END("SniffMediaType end, found by magic prefix, sniffed plugin num = " PUBLIC_LOG_ZU,
+                        sniffedCnt + 1);
+            return candidates[sniffedCnt]->name;
+        }
+    }
+
+    // the other loaded or hinted ones in parallel, the libraries without any hint only if none of them is sure
+    SniffInParallel(candidates, likelyCnt, hintedCnt, dataSource, probs);
+    sniffedCnt = hintedCnt;
+    bool sure = false;
+    std::string pluginName = PickPlugin(candidates, probs, sure);
+    if (!sure && hintedCnt < candidates.size()) {
+        MEDIA_LOG_I("no hinted plugin is sure, sniff with the " PUBLIC_LOG_ZU " plugins of unloaded libraries",
+                    candidates.size() - hintedCnt);
+        SniffInParallel(candidates, hintedCnt, candidates.size(), dataSource, probs);
+        sniffedCnt = candidates.size();
+        pluginName = PickPlugin(candidates, probs, sure);
+    }
+    PROFILE_END("SniffMediaType end, sniffed plugin num = " PUBLIC_LOG_ZU, sniffedCnt);
+    return pluginName;
+}
+
+void TypeFinder::SniffInParallel(const std::vector<std::shared_ptr<Plugin::PluginInfo>>& candidates, size_t begin,
+                                 size_t end, const std::shared_ptr<Plugin::DataSourceHelper>& dataSource,
+                                 std::vector<int>& probs)
+{
+    // every one of them runs, so which plugin is picked never depends on which sniffer finished first
+    ParallelRunner runner;
+    for (size_t i = begin; i < end; ++i) {
+        (void)runner.AddJob(candidates[i]->name, [&, i] {
+            probs[i] = sniffer_(candidates[i]->name, dataSource);
+            return ErrorCode::SUCCESS;
+        });
+    }
+    (void)runner.Run();
+}
+
+std::string TypeFinder::PickPlugin(const std::vector<std::shared_ptr<Plugin::PluginInfo>>& candidates,
+                                   const std::vector<int>& probs, bool& sure)
+{
+    // in plugin order: the first one that is sure, the most probable one otherwise
     std::string pluginName;
     int maxProb = 0;
-    auto dataSource = shared_from_this();
-    int cnt = 0;
-    for (const auto& plugin : plugins_) {
-        auto prob = Plugin::PluginManager::Instance().Sniffer(plugin->name, dataSource);
-        ++cnt;
-        if (prob > probThresh) {
-            pluginName = plugin->name;
-            break;
+    sure = false;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (probs[i] > PROBE_THRESHOLD) {
+            sure = true;
+            return candidates[i]->name;
         }
-        if (prob > maxProb) {
-            maxProb = prob;
-            pluginName = plugin->name;
+        if (probs[i] > maxProb) {
+            maxProb = probs[i];
+            pluginName = candidates[i]->name;
         }
     }
-    PROFILE_END("SniffMediaType end, sniffed plugin num = " PUBLIC_LOG_D32, cnt);
     return pluginName;
 }
 
+AVBufferPtr TypeFinder::ReadProbeWindow()
+{
+    size_t windowSize = PROBE_WINDOW_SIZE;
+    if (mediaDataSize_ > 0) {
+        windowSize = std::min(windowSize, mediaDataSize_);
+    }
+    auto window = std::make_shared<AVBuffer>();
+    window->AllocMemory(nullptr, windowSize);
+    if (ReadAt(0, window, windowSize) != Plugin::Status::OK) {
+        MEDIA_LOG_W("probe window not available, every sniffer reads on its own");
+        window->GetMemory()->Reset();
+    }
+    return window;
+}
+
 std::string TypeFinder::GuessMediaType() const
 {
     std::string pluginName;
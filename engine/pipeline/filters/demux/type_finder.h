@@ -50,6 +50,21 @@ private:
 
     std::string SniffMediaType();
 
+    /**
+     * Sniffs with all the candidates in [begin, end) in parallel and stores their probabilities in probs.
+     */
+    void SniffInParallel(const std::vector<std::shared_ptr<Plugin::PluginInfo>>& candidates, size_t begin,
+                         size_t end, const std::shared_ptr<Plugin::DataSourceHelper>& dataSource,
+                         std::vector<int>& probs);
+
+    static std::string PickPlugin(const std::vector<std::shared_ptr<Plugin::PluginInfo>>& candidates,
+                                  const std::vector<int>& probs, bool& sure);
+
+    /**
+     * Reads the start of the media once for all sniffers, the window is empty if no data is available.
+     */
+    AVBufferPtr ReadProbeWindow();
+
     std::string GuessMediaType() const;
 
     bool IsOffsetValid(int64_t offset) const;
@@ -70,6 +85,9 @@ private:
     std::function<bool(uint64_t, size_t)> checkRange_;
     std::function<bool(uint64_t, size_t, AVBufferPtr&)> peekRange_;
     std::function<void(std::string)> typeFound_;
+    // by the plugin manager, unit tests replace them
+    std::function<int32_t(const std::string&, std::shared_ptr<Plugin::DataSourceHelper>)> sniffer_;
+    std::function<bool(const std::string&)> isPluginLoaded_;
 };
 } // namespace Pipeline
 } // namespace Media
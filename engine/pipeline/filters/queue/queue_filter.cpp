@@ -0,0 +1,429 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define HST_LOG_TAG "QueueFilter"
+
+#include "queue_filter.h"
+#include <algorithm>
+#include "factory/filter_factory.h"
+#include "foundation/log.h"
+
+namespace OHOS {
+namespace Media {
+namespace Pipeline {
+namespace {
+constexpr int POP_WAIT_TIMEOUT_MS = 100; // wake up now and then, the task is paused or stopped meanwhile
+constexpr uint32_t PERCENT_FULL = 100;
+constexpr uint32_t LEAVE_EMPTY_PERCENT = 25; // 25: report filling once a quarter of the queue is used
+constexpr uint32_t LEAVE_FULL_PERCENT = 75; // 75: report filling once a quarter of the queue is free again
+
+uint32_t GetPercent(uint64_t value, uint64_t limit)
+{
+    if (limit == 0) {
+        return 0;
+    }
+    return static_cast<uint32_t>(std::min<uint64_t>(value * PERCENT_FULL / limit, PERCENT_FULL));
+}
+} // namespace
+
+static AutoRegisterFilter<QueueFilter> g_registerFilterHelper("builtin.queue");
+
+void QueueGroup::Add(QueueFilter* queue)
+{
+    OSAL::ScopedLock lock(mutex_);
+    queues_.push_back(queue);
+}
+
+void QueueGroup::Remove(QueueFilter* queue)
+{
+    OSAL::ScopedLock lock(mutex_);
+    queues_.erase(std::remove(queues_.begin(), queues_.end(), queue), queues_.end());
+}
+
+void QueueGroup::SetStarving(bool starving)
+{
+    if (starving) {
+        starvingCnt_++;
+    } else {
+        starvingCnt_--;
+    }
+}
+
+void QueueGroup::WakeUpOthers(const QueueFilter* starvingQueue)
+{
+    OSAL::ScopedLock lock(mutex_);
+    for (auto queue : queues_) {
+        if (queue != starvingQueue) {
+            queue->WakeUp();
+        }
+    }
+}
+
+QueueFilter::QueueFilter(const std::string& name)
+    : FilterBase(name)
+{
+    MEDIA_LOG_D("queue filter ctor called");
+    task_ = std::make_shared<OSAL::Task>(name + "Push");
+    task_->RegisterHandler([this] { PushTask(); });
+}
+
+QueueFilter::~QueueFilter()
+{
+    MEDIA_LOG_D("queue filter dtor called");
+    {
+        OSAL::ScopedLock lock(mutex_);
+        active_ = false;
+        ClearLocked();
+        (void)UpdateStarvingLocked();
+        notEmpty_.NotifyAll();
+        notFull_.NotifyAll();
+    }
+    if (group_) {
+        group_->Remove(this);
+    }
+    if (task_) {
+        task_->Stop();
+    }
+}
+
+void QueueFilter::SetLimits(const QueueLimits& limits)
+{
+    OSAL::ScopedLock lock(mutex_);
+    limits_ = limits;
+    notFull_.NotifyAll();
+}
+
+void QueueFilter::SetLeakyMode(QueueLeakyMode mode)
+{
+    OSAL::ScopedLock lock(mutex_);
+    leakyMode_ = mode;
+    notFull_.NotifyAll();
+}
+
+void QueueFilter::SetGroup(const std::shared_ptr<QueueGroup>& group)
+{
+    std::shared_ptr<QueueGroup> oldGroup;
+    {
+        OSAL::ScopedLock lock(mutex_);
+        if (group_ == group) {
+            return;
+        }
+        if (starving_ && group_) {
+            group_->SetStarving(false);
+        }
+        if (starving_ && group) {
+            group->SetStarving(true);
+        }
+        oldGroup = std::move(group_);
+        group_ = group;
+    }
+    // outside the lock, the group locks its queues while it holds its own lock
+    if (oldGroup) {
+        oldGroup->Remove(this);
+    }
+    if (group) {
+        group->Add(this);
+    }
+}
+
+QueueFillLevel QueueFilter::GetFillLevel()
+{
+    OSAL::ScopedLock lock(mutex_);
+    return {fillState_, queue_.size(), bytes_, GetDurationLocked(), GetPercentLocked()};
+}
+
+uint64_t QueueFilter::GetDroppedCount()
+{
+    OSAL::ScopedLock lock(mutex_);
+    return droppedCnt_;
+}
+
+bool QueueFilter::Negotiate(const std::string& inPort,
+                            const std::shared_ptr<const Plugin::Capability>& upstreamCap,
+                            Plugin::Capability& negotiatedCap,
+                            const Plugin::TagMap& upstreamParams,
+                            Plugin::TagMap& downstreamParams)
+{
+    auto outPort = GetRouteOutPort(inPort);
+    FALSE_RETURN_V_MSG_E(outPort != nullptr, false, "no out port for " PUBLIC_LOG_S, inPort.c_str());
+    return outPort->Negotiate(upstreamCap, negotiatedCap, upstreamParams, downstreamParams);
+}
+
+bool QueueFilter::Configure(const std::string& inPort, const std::shared_ptr<const Plugin::Meta>& upstreamMeta)
+{
+    auto outPort = GetRouteOutPort(inPort);
+    FALSE_RETURN_V_MSG_E(outPort != nullptr, false, "no out port for " PUBLIC_LOG_S, inPort.c_str());
+    FALSE_RETURN_V_MSG_E(outPort->Configure(upstreamMeta), false, "fail to configure downstream");
+    ApplyTaskSchedule(*task_);
+    state_ = FilterState::READY;
+    OnEvent(Event{name_, EventType::EVENT_READY, {}});
+    return true;
+}
+
+ErrorCode QueueFilter::PushData(const std::string& inPort, const AVBufferPtr& buffer, int64_t offset)
+{
+    UNUSED_VARIABLE(inPort);
+    UNUSED_VARIABLE(offset);
+    FALSE_RETURN_V_MSG_E(buffer != nullptr, ErrorCode::ERROR_INVALID_PARAMETER_VALUE, "buffer is null");
+    QueueFillLevel level;
+    bool changed = false;
+    {
+        OSAL::ScopedLock lock(mutex_);
+        if (!active_) {
+            return ErrorCode::SUCCESS; // flushing or stopped
+        }
+        bool eos = (buffer->flag & BUFFER_FLAG_EOS) != 0;
+        if (IsBlockedLocked() && leakyMode_ == QueueLeakyMode::UPSTREAM && !eos) {
+            droppedCnt_++;
+            return ErrorCode::SUCCESS;
+        }
+        while (IsBlockedLocked() && leakyMode_ == QueueLeakyMode::DOWNSTREAM &&
+               (queue_.front()->flag & BUFFER_FLAG_EOS) == 0) {
+            PopFrontLocked();
+            droppedCnt_++;
+        }
+        if (IsBlockedLocked()) {
+            auto begin = PipelineTracer::NowNs();
+            notFull_.Wait(lock, [this] { return !active_ || !IsBlockedLocked(); });
+            traceCounters_->AddBlocked(PipelineTracer::NowNs() - begin);
+            if (!active_) {
+                return ErrorCode::SUCCESS;
+            }
+        }
+        queue_.push_back(buffer);
+        bytes_ += GetTraceBufferBytes(buffer);
+        traceCounters_->SetQueueDepth(queue_.size());
+        notEmpty_.NotifyOne();
+        (void)UpdateStarvingLocked();
+        changed = UpdateFillStateLocked(level);
+    }
+    if (changed) {
+        ReportFillLevel(level);
+    }
+    return ErrorCode::SUCCESS;
+}
+
+ErrorCode QueueFilter::Prepare()
+{
+    MEDIA_LOG_I("queue filter prepare called");
+    {
+        OSAL::ScopedLock lock(mutex_);
+        ClearLocked();
+        active_ = true;
+        droppedCnt_ = 0;
+        eosPassed_ = false;
+    }
+    return FilterBase::Prepare();
+}
+
+ErrorCode QueueFilter::Start()
+{
+    MEDIA_LOG_I("queue filter start called");
+    bool starving = false;
+    {
+        OSAL::ScopedLock lock(mutex_);
+        active_ = true;
+        starving = UpdateStarvingLocked();
+    }
+    if (starving && group_) {
+        group_->WakeUpOthers(this);
+    }
+    task_->Start();
+    return FilterBase::Start();
+}
+
+ErrorCode QueueFilter::Stop()
+{
+    MEDIA_LOG_I("queue filter stop called");
+    {
+        OSAL::ScopedLock lock(mutex_);
+        active_ = false;
+        ClearLocked();
+        (void)UpdateStarvingLocked();
+        notEmpty_.NotifyAll();
+        notFull_.NotifyAll();
+    }
+    task_->Stop();
+    return FilterBase::Stop();
+}
+
+void QueueFilter::FlushStart()
+{
+    MEDIA_LOG_I("queue filter flush start");
+    {
+        OSAL::ScopedLock lock(mutex_);
+        active_ = false;
+        eosPassed_ = false;
+        ClearLocked();
+        (void)UpdateStarvingLocked();
+        notEmpty_.NotifyAll();
+        notFull_.NotifyAll();
+    }
+    task_->Pause();
+}
+
+void QueueFilter::FlushEnd()
+{
+    MEDIA_LOG_I("queue filter flush end");
+    bool starving = false;
+    {
+        OSAL::ScopedLock lock(mutex_);
+        active_ = true;
+        starving = UpdateStarvingLocked();
+    }
+    if (starving && group_) {
+        group_->WakeUpOthers(this);
+    }
+    if (state_ == FilterState::RUNNING || state_ == FilterState::PAUSED) {
+        task_->Start();
+    }
+}
+
+void QueueFilter::PushTask()
+{
+    AVBufferPtr buffer;
+    QueueFillLevel level;
+    bool changed = false;
+    bool starving = false;
+    {
+        OSAL::ScopedLock lock(mutex_);
+        notEmpty_.WaitFor(lock, POP_WAIT_TIMEOUT_MS, [this] { return !active_ || !queue_.empty(); });
+        if (!active_ || queue_.empty()) {
+            return;
+        }
+        buffer = queue_.front();
+        PopFrontLocked();
+        if ((buffer->flag & BUFFER_FLAG_EOS) != 0) {
+            eosPassed_ = true;
+        }
+        notFull_.NotifyAll();
+        starving = UpdateStarvingLocked();
+        changed = UpdateFillStateLocked(level);
+    }
+    if (starving && group_) {
+        group_->WakeUpOthers(this);
+    }
+    if (changed) {
+        ReportFillLevel(level);
+    }
+    outPorts_[0]->PushData(buffer, -1);
+}
+
+bool QueueFilter::IsFullLocked(uint32_t factor) const
+{
+    if (queue_.empty()) {
+        return false; // a single buffer over all limits still has to pass
+    }
+    return (limits_.maxBuffers != 0 && queue_.size() >= limits_.maxBuffers * factor) ||
+           (limits_.maxBytes != 0 && bytes_ >= limits_.maxBytes) ||
+           (limits_.maxDuration != 0 && GetDurationLocked() >= limits_.maxDuration * factor);
+}
+
+bool QueueFilter::IsBlockedLocked() const
+{
+    if (!IsFullLocked()) {
+        return false;
+    }
+    if (group_ == nullptr || !group_->HasStarvingQueue()) {
+        return true;
+    }
+    return IsFullLocked(QueueGroup::OVERRUN_FACTOR);
+}
+
+bool QueueFilter::UpdateStarvingLocked()
+{
+    bool starving = active_ && queue_.empty() && !eosPassed_;
+    if (starving == starving_) {
+        return false;
+    }
+    starving_ = starving;
+    if (group_) {
+        group_->SetStarving(starving);
+    }
+    return starving;
+}
+
+void QueueFilter::WakeUp()
+{
+    OSAL::ScopedLock lock(mutex_);
+    notFull_.NotifyAll();
+}
+
+uint32_t QueueFilter::GetPercentLocked() const
+{
+    auto duration = static_cast<uint64_t>(std::max<int64_t>(limits_.maxDuration, 0));
+    return std::max({GetPercent(queue_.size(), limits_.maxBuffers), GetPercent(bytes_, limits_.maxBytes),
+                     GetPercent(static_cast<uint64_t>(GetDurationLocked()), duration)});
+}
+
+int64_t QueueFilter::GetDurationLocked() const
+{
+    if (queue_.size() < 2) { // 2: the duration is the distance of two buffers
+        return 0;
+    }
+    auto front = queue_.front()->pts;
+    auto back = queue_.back()->pts;
+    return back > front ? static_cast<int64_t>(back - front) : 0;
+}
+
+void QueueFilter::PopFrontLocked()
+{
+    auto size = GetTraceBufferBytes(queue_.front());
+    bytes_ = bytes_ > size ? bytes_ - size : 0;
+    queue_.pop_front();
+    traceCounters_->SetQueueDepth(queue_.size());
+}
+
+bool QueueFilter::UpdateFillStateLocked(QueueFillLevel& level)
+{
+    auto percent = GetPercentLocked();
+    auto state = fillState_;
+    if (queue_.empty()) {
+        state = QueueFillState::EMPTY;
+    } else if (IsFullLocked()) {
+        state = QueueFillState::FULL;
+    } else if (fillState_ == QueueFillState::EMPTY) {
+        bool noLimits = limits_.maxBuffers == 0 && limits_.maxBytes == 0 && limits_.maxDuration == 0;
+        if (percent >= LEAVE_EMPTY_PERCENT || noLimits) {
+            state = QueueFillState::FILLING;
+        }
+    } else if (fillState_ == QueueFillState::FULL && percent <= LEAVE_FULL_PERCENT) {
+        state = QueueFillState::FILLING;
+    }
+    if (state == fillState_) {
+        return false;
+    }
+    fillState_ = state;
+    level = {state, queue_.size(), bytes_, GetDurationLocked(), percent};
+    return true;
+}
+
+void QueueFilter::ClearLocked()
+{
+    queue_.clear();
+    bytes_ = 0;
+    fillState_ = QueueFillState::EMPTY;
+    traceCounters_->SetQueueDepth(0);
+}
+
+void QueueFilter::ReportFillLevel(const QueueFillLevel& level)
+{
+    MEDIA_LOG_D(PUBLIC_LOG_S " fill state " PUBLIC_LOG_U32 ", " PUBLIC_LOG_ZU " buffers, " PUBLIC_LOG_U32 "%%",
+                name_.c_str(), static_cast<uint32_t>(level.state), level.buffers, level.percent);
+    OnEvent(Event{name_, EventType::EVENT_QUEUE_FILL_LEVEL, level});
+}
+} // namespace Pipeline
+} // namespace Media
+} // namespace OHOS
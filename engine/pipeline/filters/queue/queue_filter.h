@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HISTREAMER_PIPELINE_FILTER_QUEUE_H
+#define HISTREAMER_PIPELINE_FILTER_QUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "osal/thread/condition_variable.h"
+#include "osal/thread/mutex.h"
+#include "osal/thread/task.h"
+#include "pipeline/core/error_code.h"
+#include "pipeline/core/filter_base.h"
+#include "plugin/common/plugin_time.h"
+#include "utils/pipeline_tracer.h"
+
+namespace OHOS {
+namespace Media {
+namespace Pipeline {
+/**
+ * What a queue filter does with a buffer pushed while it is full.
+ */
+enum struct QueueLeakyMode : uint8_t {
+    NONE,       // upstream waits until there is room
+    UPSTREAM,   // the pushed buffer is dropped
+    DOWNSTREAM, // the oldest queued buffers are dropped to make room
+};
+
+/**
+ * Limits of a queue filter, the queue is full as soon as one of them is reached. 0 means no limit.
+ */
+struct QueueLimits {
+    QueueLimits() = default;
+
+    QueueLimits(size_t buffers, size_t bytes, int64_t duration)
+        : maxBuffers(buffers), maxBytes(bytes), maxDuration(duration)
+    {
+    }
+
+    size_t maxBuffers {0};
+    size_t maxBytes {0};
+    int64_t maxDuration {0}; // pts distance of the oldest and the newest queued buffer, based on HST_TIME_BASE
+};
+
+enum struct QueueFillState : uint8_t {
+    EMPTY,
+    FILLING,
+    FULL,
+};
+
+/**
+ * Parameter of EVENT_QUEUE_FILL_LEVEL.
+ */
+struct QueueFillLevel {
+    QueueFillLevel() = default;
+
+    QueueFillLevel(QueueFillState fillState, size_t bufferCnt, size_t byteCnt, int64_t dur, uint32_t percentage)
+        : state(fillState), buffers(bufferCnt), bytes(byteCnt), duration(dur), percent(percentage)
+    {
+    }
+
+    QueueFillState state {QueueFillState::EMPTY};
+    size_t buffers {0};
+    size_t bytes {0};
+    int64_t duration {0};
+    uint32_t percent {0}; // of the limit that is closest to be reached
+};
+
+class QueueFilter;
+
+/**
+ * Queues fed by the same thread, e.g. one per track of a demuxer. While one of them runs empty, the others may
+ * take up to OVERRUN_FACTOR times their buffer and duration limits, so the shared thread keeps reading ahead
+ * instead of blocking on a full queue while the track of the empty one starves. The byte limit is never exceeded.
+ */
+class QueueGroup {
+public:
+    static constexpr uint32_t OVERRUN_FACTOR = 4;
+
+    bool HasStarvingQueue() const
+    {
+        return starvingCnt_.load() > 0;
+    }
+
+private:
+    friend class QueueFilter;
+
+    void Add(QueueFilter* queue);
+
+    void Remove(QueueFilter* queue);
+
+    void SetStarving(bool starving);
+
+    /// Wakes the queues that wait for room, they may overrun now.
+    void WakeUpOthers(const QueueFilter* starvingQueue);
+
+    OSAL::Mutex mutex_ {};
+    std::vector<QueueFilter*> queues_ {};
+    std::atomic<uint32_t> starvingCnt_ {0};
+};
+
+/**
+ * Decouples the filters before and after it: PushData() only queues the buffer, a task of its own pushes the queued
+ * buffers to the next filter. A slow downstream filter then no longer stalls the thread of the upstream one until
+ * the queue is full.
+ *
+ * Negotiation and configuration pass through unchanged. EVENT_QUEUE_FILL_LEVEL is reported when the queue runs
+ * empty, becomes full, and when it leaves one of these states again. Leaving them takes some hysteresis, so a queue
+ * kept at its limit by a blocked upstream doesn't report every buffer.
+ */
+class QueueFilter : public FilterBase {
+public:
+    static constexpr size_t DEFAULT_MAX_BUFFERS = 64;
+    static constexpr size_t DEFAULT_MAX_BYTES = 4 * 1024 * 1024; // 4 MiB
+    static constexpr int64_t DEFAULT_MAX_DURATION = 2 * HST_SECOND;
+
+    explicit QueueFilter(const std::string& name);
+    ~QueueFilter() override;
+
+    void SetLimits(const QueueLimits& limits);
+
+    void SetLeakyMode(QueueLeakyMode mode);
+
+    /**
+     * Joins a group of queues fed by the same thread, see QueueGroup. Must be set before the queue is prepared.
+     */
+    void SetGroup(const std::shared_ptr<QueueGroup>& group);
+
+    QueueFillLevel GetFillLevel();
+
+    /// Buffers dropped by the leaky mode since the queue was prepared.
+    uint64_t GetDroppedCount();
+
+    bool Negotiate(const std::string& inPort,
+                   const std::shared_ptr<const Plugin::Capability>& upstreamCap,
+                   Plugin::Capability& negotiatedCap,
+                   const Plugin::TagMap& upstreamParams,
+                   Plugin::TagMap& downstreamParams) override;
+
+    bool Configure(const std::string& inPort, const std::shared_ptr<const Plugin::Meta>& upstreamMeta) override;
+
+    ErrorCode PushData(const std::string& inPort, const AVBufferPtr& buffer, int64_t offset) override;
+
+    ErrorCode Prepare() override;
+    ErrorCode Start() override;
+    ErrorCode Stop() override;
+
+    void FlushStart() override;
+    void FlushEnd() override;
+
+private:
+    friend class QueueGroup;
+
+    void PushTask();
+
+    /**
+     * @param factor multiplies the buffer and the duration limit
+     */
+    bool IsFullLocked(uint32_t factor = 1) const;
+
+    /// Full unless a queue of the group starves and the overrun limits are not reached yet.
+    bool IsBlockedLocked() const;
+
+    /**
+     * Updates whether this queue starves, i.e. is active and empty before the end of stream.
+     *
+     * @return true if it started to starve
+     */
+    bool UpdateStarvingLocked();
+
+    void WakeUp();
+
+    uint32_t GetPercentLocked() const;
+
+    int64_t GetDurationLocked() const;
+
+    void PopFrontLocked();
+
+    /**
+     * @return true if the fill state changed, level is set then
+     */
+    bool UpdateFillStateLocked(QueueFillLevel& level);
+
+    void ClearLocked();
+
+    void ReportFillLevel(const QueueFillLevel& level);
+
+    OSAL::Mutex mutex_ {};
+    OSAL::ConditionVariable notEmpty_ {};
+    OSAL::ConditionVariable notFull_ {};
+    std::deque<AVBufferPtr> queue_ {};
+    size_t bytes_ {0};
+    bool active_ {false};
+    QueueLimits limits_ {DEFAULT_MAX_BUFFERS, DEFAULT_MAX_BYTES, DEFAULT_MAX_DURATION};
+    QueueLeakyMode leakyMode_ {QueueLeakyMode::NONE};
+    QueueFillState fillState_ {QueueFillState::EMPTY};
+    uint64_t droppedCnt_ {0};
+    bool eosPassed_ {false};
+    bool starving_ {false};
+    std::shared_ptr<QueueGroup> group_ {nullptr};
+
+    std::shared_ptr<OSAL::Task> task_ {nullptr};
+};
+} // namespace Pipeline
+} // namespace Media
+} // namespace OHOS
+#endif // HISTREAMER_PIPELINE_FILTER_QUEUE_H
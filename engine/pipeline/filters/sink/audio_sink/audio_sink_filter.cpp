@@ -33,7 +33,8 @@ namespace Media {
 namespace Pipeline {
 static AutoRegisterFilter<AudioSinkFilter> g_registerFilterHelper("builtin.player.audiosink");
 
-AudioSinkFilter::AudioSinkFilter(const std::string& name) : FilterBase(name)
+AudioSinkFilter::AudioSinkFilter(const std::string& name)
+    : FilterBase(name), traceWriteName_(PipelineTracer::Instance().Intern(name + ".write"))
 {
     filterType_ = FilterType::AUDIO_SINK;
     MEDIA_LOG_I("audio sink ctor called");
@@ -177,7 +178,13 @@ ErrorCode AudioSinkFilter::PushData(const std::string& inPort, const AVBufferPtr
         return ErrorCode::SUCCESS;
     }
     DUMP_BUFFER2LOG("AudioSink Write", buffer, offset);
-    auto err = TranslatePluginStatus(plugin_->Write(buffer));
+    ErrorCode err;
+    {
+        PIPELINE_TRACE_BUFFER(traceWriteName_, "sink", buffer, GetTraceBufferBytes(buffer));
+        auto begin = PipelineTracer::NowNs();
+        err = TranslatePluginStatus(plugin_->Write(buffer));
+        traceCounters_->AddBlocked(PipelineTracer::NowNs() - begin); // the audio server blocks while it is full
+    }
     FAIL_RETURN_MSG(err, "audio sink write failed");
     ReportCurrentPosition(static_cast<int64_t>(buffer->pts));
     if ((buffer->flag & BUFFER_FLAG_EOS) != 0) {
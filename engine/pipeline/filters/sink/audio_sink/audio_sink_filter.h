@@ -25,6 +25,7 @@
 #include "pipeline/core/filter_base.h"
 #include "plugin/core/audio_sink.h"
 #include "plugin/core/plugin_info.h"
+#include "utils/pipeline_tracer.h"
 
 namespace OHOS {
 namespace Media {
@@ -87,6 +88,7 @@ private:
     OSAL::Mutex mutex_ {};
 
     std::shared_ptr<Plugin::AudioSink> plugin_ {};
+    const char* traceWriteName_ {nullptr};
 };
 } // namespace Pipeline
 } // namespace Media
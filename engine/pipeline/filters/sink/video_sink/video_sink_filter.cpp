@@ -37,7 +37,8 @@ static AutoRegisterFilter<VideoSinkFilter> g_registerFilterHelper("builtin.playe
 
 const uint32_t VSINK_DEFAULT_BUFFER_NUM = 8;
 
-VideoSinkFilter::VideoSinkFilter(const std::string& name) : FilterBase(name)
+VideoSinkFilter::VideoSinkFilter(const std::string& name)
+    : FilterBase(name), traceRenderName_(PipelineTracer::Instance().Intern(name + ".render"))
 {
     curPts_ = 0;
     refreshTime_ = 0;
@@ -62,7 +63,7 @@ void VideoSinkFilter::Init(EventReceiver* receiver, FilterCallback* callback)
     FilterBase::Init(receiver, callback);
     outPorts_.clear();
     if (inBufQueue_ == nullptr) {
-        inBufQueue_ = std::make_shared<BlockingQueue<AVBufferPtr>>("VideoSinkInBufQue", VSINK_DEFAULT_BUFFER_NUM);
+        inBufQueue_ = std::make_shared<LockFreeQueue<AVBufferPtr>>("VideoSinkInBufQue", VSINK_DEFAULT_BUFFER_NUM);
     }
     if (renderTask_ == nullptr) {
         renderTask_ = std::make_shared<OHOS::Media::OSAL::Task>("VideoSinkRenderThread");
@@ -203,6 +204,7 @@ bool VideoSinkFilter::Configure(const std::string& inPort, const std::shared_ptr
         OnEvent(Event{name_, EventType::EVENT_ERROR, {err}});
         return false;
     }
+    ApplyTaskSchedule(*renderTask_);
     state_ = FilterState::READY;
     OnEvent(Event{name_, EventType::EVENT_READY, {}});
     MEDIA_LOG_I("video sink send EVENT_READY");
@@ -309,6 +311,8 @@ void VideoSinkFilter::RenderFrame()
         return;
     }
     curPts_ = frameBuffer->pts;
+    traceCounters_->SetQueueDepth(inBufQueue_->Size());
+    PIPELINE_TRACE_BUFFER(traceRenderName_, "sink", frameBuffer, GetTraceBufferBytes(frameBuffer));
     auto err = plugin_->Write(frameBuffer);
     if (err != Plugin::Status::OK) {
         MEDIA_LOG_E("write to plugin fail: " PUBLIC_LOG_U32, err);
@@ -349,7 +353,10 @@ ErrorCode VideoSinkFilter::PushData(const std::string& inPort, const AVBufferPtr
         MEDIA_LOG_D("video sink push data end");
         return ErrorCode::SUCCESS;
     }
+    auto begin = PipelineTracer::NowNs();
     inBufQueue_->Push(buffer);
+    traceCounters_->AddBlocked(PipelineTracer::NowNs() - begin);
+    traceCounters_->SetQueueDepth(inBufQueue_->Size());
     MEDIA_LOG_D("video sink push data end");
     return ErrorCode::SUCCESS;
 }
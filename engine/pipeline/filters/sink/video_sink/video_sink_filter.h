@@ -26,12 +26,13 @@
 #include "osal/thread/condition_variable.h"
 #include "osal/thread/mutex.h"
 #include "osal/thread/task.h"
-#include "utils/blocking_queue.h"
+#include "utils/lock_free_queue.h"
 #include "pipeline/core/clock_provider.h"
 #include "pipeline/core/error_code.h"
 #include "pipeline/core/filter_base.h"
 #include "plugin/core/plugin_info.h"
 #include "plugin/core/video_sink.h"
+#include "utils/pipeline_tracer.h"
 
 namespace OHOS {
 namespace Media {
@@ -86,7 +87,7 @@ private:
     void RenderFrame();
     void SyncVideoOnly(int64_t pts);
     bool DoSync(const AVBufferPtr& buffer);
-    std::shared_ptr<OHOS::Media::BlockingQueue<AVBufferPtr>> inBufQueue_ {nullptr};
+    std::shared_ptr<OHOS::Media::LockFreeQueue<AVBufferPtr>> inBufQueue_ {nullptr};
     std::shared_ptr<OHOS::Media::OSAL::Task> renderTask_ {nullptr};
     std::atomic<bool> pushThreadIsBlocking_ {false};
     bool isFlushing_ {false};
@@ -99,6 +100,7 @@ private:
     int64_t frameCnt_ {0};
     int64_t curPts_ {0};
     int64_t refreshTime_ {0};
+    const char* traceRenderName_ {nullptr};
 };
 } // namespace Pipeline
 } // namespace Media
@@ -206,6 +206,7 @@ ErrorCode AudioCaptureFilter::Prepare()
     if (!taskPtr_) {
         taskPtr_ = std::make_shared<OSAL::Task>("DataReader");
         taskPtr_->RegisterHandler([this] { ReadLoop(); });
+        ApplyTaskSchedule(*taskPtr_);
     }
     ErrorCode err = FindPlugin();
     if (err != ErrorCode::SUCCESS || !plugin_) {
@@ -233,6 +233,7 @@ void MediaSourceFilter::ActivateMode()
         if (taskPtr_ == nullptr) {
             taskPtr_ = std::make_shared<OSAL::Task>("DataReader");
             taskPtr_->RegisterHandler(std::bind(&MediaSourceFilter::ReadLoop, this));
+            ApplyTaskSchedule(*taskPtr_);
         }
         taskPtr_->Start();
     }
@@ -251,6 +252,9 @@ ErrorCode MediaSourceFilter::DoNegotiate(const std::shared_ptr<MediaSource>& sou
             if ((plugin_->GetSize(fileSize) == Status::OK) && (fileSize != 0)) {
                 suffixMeta->SetUint64(Media::Plugin::MetaID::MEDIA_FILE_SIZE, fileSize);
             }
+            if (protocol_ == "file" || protocol_ == "fd") {
+                suffixMeta->SetUint32(Media::Plugin::MetaID::MEDIA_CHEAP_SEEK, 1);
+            }
             Capability peerCap;
             auto tmpCap = MetaToCapability(*suffixMeta);
             Plugin::TagMap upstreamParams;
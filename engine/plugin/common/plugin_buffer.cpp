@@ -14,11 +14,91 @@
  */
 
 #include "plugin_buffer.h"
+#include <algorithm>
+#include <cstddef>
+#include <new>
 #include "surface_memory.h"
 
 namespace OHOS {
 namespace Media {
 namespace Plugin {
+namespace {
+/// Pointer without ownership and without control block, it is never deleted.
+template <typename T>
+std::shared_ptr<T> Unowned(T* ptr)
+{
+    return std::shared_ptr<T>(std::shared_ptr<T>(), ptr);
+}
+
+/// Allocator which adds tailSize bytes after the object, for the payload of the memory.
+template <typename T>
+struct TailAllocator {
+    using value_type = T;
+
+    TailAllocator(size_t tailSize, uint8_t** tail) : tailSize(tailSize), tail(tail)
+    {
+    }
+
+    template <typename U>
+    TailAllocator(const TailAllocator<U>& other) : tailSize(other.tailSize), tail(other.tail) // NOLINT: rebind
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        auto ptr = static_cast<uint8_t*>(::operator new(n * sizeof(T) + tailSize));
+        *tail = ptr + n * sizeof(T);
+        return reinterpret_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t)
+    {
+        ::operator delete(ptr);
+    }
+
+    template <typename U>
+    bool operator==(const TailAllocator<U>& other) const
+    {
+        return tail == other.tail;
+    }
+
+    template <typename U>
+    bool operator!=(const TailAllocator<U>& other) const
+    {
+        return tail != other.tail;
+    }
+
+    size_t tailSize;
+    uint8_t** tail;
+};
+
+/// Storage of the objects that CreateDefaultBuffer() places in one block, the payload follows it.
+struct BufferBlock {
+    ~BufferBlock()
+    {
+        if (buffer != nullptr) {
+            buffer->~Buffer();
+        }
+        if (meta != nullptr) {
+            meta->~BufferMeta();
+        }
+        if (memory != nullptr) {
+            memory->~Memory();
+        }
+    }
+
+    Buffer* buffer {nullptr};
+    BufferMeta* meta {nullptr};
+    Memory* memory {nullptr};
+    alignas(Buffer) uint8_t bufferStorage[sizeof(Buffer)];
+    // the larger of both metas, std::max is not constexpr before C++14
+    alignas(AudioBufferMeta) alignas(VideoBufferMeta) uint8_t metaStorage[sizeof(AudioBufferMeta) >
+        sizeof(VideoBufferMeta) ? sizeof(AudioBufferMeta) : sizeof(VideoBufferMeta)];
+    alignas(Memory) uint8_t memoryStorage[sizeof(Memory)];
+};
+static_assert(alignof(BufferBlock) <= alignof(std::max_align_t), "buffer block is over aligned");
+} // namespace
+
 Memory::Memory(size_t capacity, std::shared_ptr<uint8_t> bufData, size_t align, MemoryType type)
     : memoryType(type), capacity(capacity), alignment(align),
       offset(0), size(0), allocator(nullptr), addr(std::move(bufData))
@@ -34,8 +114,10 @@ Memory::Memory(size_t capacity, std::shared_ptr<Allocator> allocator, size_t ali
     }
     size_t allocSize = align ? (capacity + align - 1) : capacity;
     if (this->allocator) {
-        addr = std::shared_ptr<uint8_t>(static_cast<uint8_t*>(this->allocator->Alloc(allocSize)),
-                                        [this](uint8_t* ptr) { this->allocator->Free((void*)ptr); });
+        // capture the allocator rather than this, the data may outlive this memory through WrapMemorySlice()
+        auto alloc = this->allocator;
+        addr = std::shared_ptr<uint8_t>(static_cast<uint8_t*>(alloc->Alloc(allocSize)),
+                                        [alloc](uint8_t* ptr) { alloc->Free((void*)ptr); });
     } else {
         addr = std::shared_ptr<uint8_t>(new uint8_t[allocSize], std::default_delete<uint8_t[]>());
     }
@@ -54,6 +136,9 @@ void Memory::Reset()
 
 size_t Memory::Write(const uint8_t* in, size_t writeSize, size_t position)
 {
+    if (readOnly) {
+        return 0;
+    }
     size_t start = 0;
     if (position == INVALID_POSITION) {
         start = size;
@@ -91,7 +176,7 @@ const uint8_t* Memory::GetReadOnlyData(size_t position)
 
 uint8_t* Memory::GetWritableAddr(size_t estimatedWriteSize, size_t position)
 {
-    if (position + estimatedWriteSize > capacity) {
+    if (readOnly || position + estimatedWriteSize > capacity) {
         return nullptr;
     }
     uint8_t* ptr = GetRealAddr() + position;
@@ -107,6 +192,11 @@ void Memory::UpdateDataSize(size_t realWriteSize, size_t position)
     size = (realWriteSize + position);
 }
 
+bool Memory::IsReadOnly() const
+{
+    return readOnly;
+}
+
 size_t Memory::GetSize()
 {
     return size;
@@ -128,18 +218,16 @@ BufferMeta::BufferMeta(BufferMetaType type) : type(type)
 
 ValueType BufferMeta::GetMeta(Tag tag)
 {
-    if (tags) {
-        return (*tags.get())[tag];
+    auto ite = tags.find(tag);
+    if (ite != tags.end()) {
+        return ite->second;
     }
     return ValueType();
 }
 
 void BufferMeta::SetMeta(Tag tag, ValueType value)
 {
-    if (!tags) {
-        tags = std::make_shared<TagMap>();
-    }
-    (*tags.get())[tag] = value;
+    tags.insert_or_assign(tag, std::move(value));
 }
 
 BufferMetaType BufferMeta::GetType() const
@@ -156,20 +244,59 @@ Buffer::Buffer(BufferMetaType type) : trackID(0), pts(0), dts(0), duration(0), f
     }
 }
 
+Buffer::Buffer(BufferMeta* blockMeta)
+    : trackID(0), pts(0), dts(0), duration(0), flag (0), meta(Unowned(blockMeta))
+{
+}
+
 std::shared_ptr<Buffer> Buffer::CreateDefaultBuffer(BufferMetaType type, size_t capacity,
                                                     std::shared_ptr<Allocator> allocator, size_t align)
 {
-    auto buffer = std::make_shared<Buffer>(type);
-    std::shared_ptr<Memory> memory = std::shared_ptr<Memory>(new Memory(capacity, allocator, align));
-    buffer->data.push_back(memory);
+    if (allocator != nullptr) {
+        auto buffer = std::make_shared<Buffer>(type);
+        buffer->firstMemory = std::shared_ptr<Memory>(new Memory(capacity, allocator, align));
+        return buffer;
+    }
+    uint8_t* payload = nullptr;
+    size_t payloadSize = align ? (capacity + align - 1) : capacity;
+    auto block = std::allocate_shared<BufferBlock>(TailAllocator<BufferBlock>(payloadSize, &payload));
+    if (type == BufferMetaType::VIDEO) {
+        block->meta = new (block->metaStorage) VideoBufferMeta();
+    } else {
+        block->meta = new (block->metaStorage) AudioBufferMeta();
+    }
+    block->memory = new (block->memoryStorage) Memory(capacity, Unowned(payload), align);
+    block->memory->offset = static_cast<size_t>(AlignUp((uintptr_t)payload, (uintptr_t)align) - (uintptr_t)payload);
+    block->buffer = new (block->bufferStorage) Buffer(block->meta);
+    block->buffer->firstMemory = Unowned(block->memory);
+    std::shared_ptr<Buffer> buffer(block, block->buffer);
+    buffer->block = buffer;
     return buffer;
 }
 
+template <typename T>
+std::shared_ptr<T> Buffer::Share(const std::shared_ptr<T>& ptr) const
+{
+    if (ptr == nullptr || ptr.use_count() != 0) {
+        return ptr;
+    }
+    return std::shared_ptr<T>(block.lock(), ptr.get());
+}
+
+void Buffer::AddMemory(std::shared_ptr<Memory> memory)
+{
+    if (firstMemory == nullptr) {
+        firstMemory = std::move(memory);
+    } else {
+        data.push_back(std::move(memory));
+    }
+}
+
 std::shared_ptr<Memory> Buffer::WrapMemory(uint8_t* data, size_t capacity, size_t size)
 {
     auto memory = std::shared_ptr<Memory>(new Memory(capacity, std::shared_ptr<uint8_t>(data, [](void* ptr) {})));
     memory->size = size;
-    this->data.push_back(memory);
+    AddMemory(memory);
     return memory;
 }
 
@@ -177,10 +304,36 @@ std::shared_ptr<Memory> Buffer::WrapMemoryPtr(std::shared_ptr<uint8_t> data, siz
 {
     auto memory = std::shared_ptr<Memory>(new Memory(capacity, data));
     memory->size = size;
-    this->data.push_back(memory);
+    AddMemory(memory);
+    return memory;
+}
+
+std::shared_ptr<Memory> Buffer::WrapReadOnlyMemoryPtr(std::shared_ptr<uint8_t> data, size_t size)
+{
+    auto memory = std::shared_ptr<Memory>(new Memory(size, std::move(data)));
+    memory->size = size;
+    memory->readOnly = true;
+    AddMemory(memory);
     return memory;
 }
 
+std::shared_ptr<Memory> Buffer::WrapMemorySlice(const std::shared_ptr<Memory>& memory, size_t offset, size_t size,
+                                                bool readOnly)
+{
+    if (memory == nullptr || memory->addr == nullptr || memory->GetMemoryType() != MemoryType::VIRTUAL_ADDR ||
+        offset + size > memory->GetSize()) {
+        return nullptr;
+    }
+    // the payload of a memory placed in a buffer block is owned by the block, keep it through the memory
+    auto addr = memory->addr.use_count() != 0 ? memory->addr : std::shared_ptr<uint8_t>(memory, memory->addr.get());
+    auto slice = std::shared_ptr<Memory>(new Memory(size, std::move(addr), 1, MemoryType::VIRTUAL_ADDR));
+    slice->offset = memory->offset + offset;
+    slice->size = size;
+    slice->readOnly = readOnly || memory->readOnly;
+    AddMemory(slice);
+    return slice;
+}
+
 std::shared_ptr<Memory> Buffer::AllocMemory(std::shared_ptr<Allocator> allocator, size_t capacity, size_t align)
 {
     auto type = (allocator != nullptr) ? allocator->GetMemoryType() : MemoryType::VIRTUAL_ADDR;
@@ -204,48 +357,65 @@ std::shared_ptr<Memory> Buffer::AllocMemory(std::shared_ptr<Allocator> allocator
     if (memory == nullptr) {
         return nullptr;
     }
-    data.push_back(memory);
+    AddMemory(memory);
     return memory;
 }
 
 uint32_t Buffer::GetMemoryCount()
 {
-    return data.size();
+    return (firstMemory != nullptr ? 1 : 0) + data.size();
 }
 
 std::shared_ptr<Memory> Buffer::GetMemory(uint32_t index)
 {
-    if (data.size() <= index) {
+    if (index == 0) {
+        return Share(firstMemory);
+    }
+    if (data.size() < index) {
         return nullptr;
     }
-    return data[index];
+    return data[index - 1];
 }
 
 std::shared_ptr<BufferMeta> Buffer::GetBufferMeta()
 {
-    return meta;
+    return Share(meta);
 }
 
 bool Buffer::IsEmpty()
 {
-    return data.empty();
+    return firstMemory == nullptr;
 }
 
 void Buffer::Reset()
 {
-    data[0]->Reset();
+    firstMemory->Reset();
     trackID = 0;
     pts = 0;
     dts = 0;
     duration = 0;
     flag = 0;
     BufferMetaType type = meta->GetType();
-    meta.reset();
+    // a meta placed in the block is held without count, the pointers handed out for it count on the block
+    bool shared = meta.use_count() == 0 ? block.use_count() > 1 : meta.use_count() > 1;
+    if (shared) {
+        // still referenced from elsewhere, leave it to them
+        if (type == BufferMetaType::AUDIO) {
+            meta = std::shared_ptr<AudioBufferMeta>(new AudioBufferMeta());
+        } else if (type == BufferMetaType::VIDEO) {
+            meta = std::shared_ptr<VideoBufferMeta>(new VideoBufferMeta());
+        }
+        return;
+    }
+    // reset it in place, keeping the capacity of its tags
+    auto tags = std::move(meta->tags);
     if (type == BufferMetaType::AUDIO) {
-        meta = std::shared_ptr<AudioBufferMeta>(new AudioBufferMeta());
+        *static_cast<AudioBufferMeta*>(meta.get()) = AudioBufferMeta();
     } else if (type == BufferMetaType::VIDEO) {
-        meta = std::shared_ptr<VideoBufferMeta>(new VideoBufferMeta());
+        *static_cast<VideoBufferMeta*>(meta.get()) = VideoBufferMeta();
     }
+    tags.clear();
+    meta->tags = std::move(tags);
 }
 } // namespace Plugin
 } // namespace Media
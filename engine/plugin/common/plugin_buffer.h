@@ -145,6 +145,9 @@ public:
 
     size_t Write(const uint8_t* in, size_t writeSize, size_t position = INVALID_POSITION);
 
+    /// Read-only memories, e.g. of a file mapping, return no writable address and write nothing.
+    bool IsReadOnly() const;
+
     size_t Read(uint8_t* out, size_t readSize, size_t position = INVALID_POSITION);
 
     void Reset();
@@ -204,6 +207,8 @@ private:
     /// Allocated virtual memory address.
     std::shared_ptr<uint8_t> addr;
 
+    bool readOnly {false};
+
     friend class Buffer;
 };
 
@@ -233,7 +238,9 @@ private:
     BufferMetaType type;
 
     /// Buffer metadata information of the buffer, which is represented by the key-value pair of the tag.
-    std::shared_ptr<TagMap> tags {};
+    TagMap tags {};
+
+    friend class Buffer;
 };
 
 /**
@@ -333,6 +340,10 @@ public:
     /// Destructor
     ~Buffer() = default;
 
+    /**
+     * Create a buffer with one memory of the capacity. Without allocator the buffer, its meta, the memory and its
+     * payload are placed in one allocation.
+     */
     static std::shared_ptr<Buffer> CreateDefaultBuffer(BufferMetaType type, size_t capacity,
                                                        std::shared_ptr<Allocator> allocator = nullptr,
                                                        size_t align = 1);
@@ -341,6 +352,14 @@ public:
 
     std::shared_ptr<Memory> WrapMemoryPtr(std::shared_ptr<uint8_t> data, size_t capacity, size_t size);
 
+    /// Append a read-only memory of size bytes at data, see Memory::IsReadOnly().
+    std::shared_ptr<Memory> WrapReadOnlyMemoryPtr(std::shared_ptr<uint8_t> data, size_t size);
+
+    /// Append a view of [offset, offset + size) of another virtual address memory, sharing its data without copy.
+    /// The view is read-only if the memory is or if readOnly is set, e.g. for views of a cache.
+    std::shared_ptr<Memory> WrapMemorySlice(const std::shared_ptr<Memory>& memory, size_t offset, size_t size,
+                                            bool readOnly = false);
+
     std::shared_ptr<Memory> AllocMemory(std::shared_ptr<Allocator> allocator, size_t capacity, size_t align = 1);
 
     uint32_t GetMemoryCount();
@@ -371,11 +390,30 @@ public:
     uint64_t flag;
 
 private:
-    /// Data described by this buffer.
+    /// Construct a buffer placed in one block together with its meta, see CreateDefaultBuffer().
+    explicit Buffer(BufferMeta* blockMeta);
+
+    /// The shared pointer of memory or meta which may be placed in the block of this buffer.
+    template <typename T>
+    std::shared_ptr<T> Share(const std::shared_ptr<T>& ptr) const;
+
+    void AddMemory(std::shared_ptr<Memory> memory);
+
+    /// The first memory, most buffers have only this one and need no memory list.
+    std::shared_ptr<Memory> firstMemory {};
+
+    /// The other data described by this buffer.
     std::vector<std::shared_ptr<Memory>> data {};
 
     /// The buffer meta information.
     std::shared_ptr<BufferMeta> meta;
+
+    /**
+     * Set if this buffer was created by CreateDefaultBuffer(): the buffer, its meta, its memory and the payload of
+     * the memory are placed in one block with one reference count. The buffer holds the meta and the memory without
+     * reference, the pointers handed out share the count of the block.
+     */
+    std::weak_ptr<Buffer> block {};
 };
 } // namespace Plugin
 } // namespace Media
@@ -20,6 +20,7 @@
 #include <string>
 #include <vector> // NOLINT
 #include "any.h" // NOLINT
+#include "foundation/cpp_ext/flat_map.h"
 
 namespace OHOS {
 namespace Media {
@@ -110,6 +111,7 @@ enum struct Tag : uint32_t {
     MEDIA_FILE_EXTENSION,                  ///< std::string, file extension
     MEDIA_CODEC_CONFIG,                    ///< std::vector<uint8_t>, codec config. e.g. AudioSpecificConfig for mp4
     MEDIA_POSITION,                        ///< uint64_t : The byte position within media stream/file
+    MEDIA_CHEAP_SEEK,                      ///< uint32_t, 1 if seeking the source is cheap, e.g. on a local file
 
     /* -------------------- audio universal tag -------------------- */
     AUDIO_CHANNELS = SECTION_AUDIO_UNIVERSAL_START + 1, ///< uint32_t
@@ -136,6 +138,8 @@ enum struct Tag : uint32_t {
     VIDEO_SURFACE,                                   ///< @see class Surface
     VIDEO_MAX_SURFACE_NUM,                           ///< uint32_t, max video surface num
     VIDEO_CAPTURE_RATE,                              ///< double, video capture rate
+    VIDEO_DECODE_THREAD_COUNT,                       ///< uint32_t, decode thread count, 0 means one per core
+    VIDEO_DECODE_THREAD_TYPE,                        ///< @see VideoDecodeThreadType
 
     /* -------------------- video specific tag -------------------- */
     VIDEO_SPECIFIC_H264_START = MAKE_VIDEO_SPECIFIC_START(VideoFormat::H264),
@@ -167,9 +171,9 @@ enum struct ProtocolType : uint32_t {
 using ValueType = Any;
 
 /**
- * The tag content is stored in key-value format.
+ * The tag content is stored in key-value format, sorted by tag in one flat array.
  */
-using TagMap = std::map<Tag, ValueType>;
+using TagMap = CppExt::FlatMap<Tag, ValueType>;
 using CodecConfig = std::vector<uint8_t>;
 } // namespace Plugin
 } // namespace Media
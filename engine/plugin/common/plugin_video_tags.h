@@ -68,6 +68,18 @@ enum struct VideoH264Profile : uint32_t {
     HIGH422,   ///< High 4:2:2 profile
     HIGH444,   ///< High 4:4:4 profile
 };
+
+/**
+ * @enum Video decode threading type.
+ *
+ * @since 1.0
+ * @version 1.0
+ */
+enum struct VideoDecodeThreadType : uint32_t {
+    AUTO,  ///< Let the decoder use frame and/or slice threading
+    FRAME, ///< Decode several frames in parallel, output is delayed by one frame per extra thread
+    SLICE, ///< Decode the slices of one frame in parallel, no extra output delay
+};
 } // namespace Plugin
 } // namespace Media
 } // namespace OHOS
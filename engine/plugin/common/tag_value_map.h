@@ -16,6 +16,7 @@
 #ifndef HISTREAMER_PLUGIN_TAG_VALUE_MAP_H
 #define HISTREAMER_PLUGIN_TAG_VALUE_MAP_H
 
+#include "foundation/cpp_ext/flat_map.h"
 #include "plugin_tags.h"
 
 namespace OHOS {
@@ -58,7 +59,7 @@ public:
         tag == Tag::MEDIA_FILE_SIZE, int64_t);
 
 private:
-    std::map<Tag, Any> map;
+    CppExt::FlatMap<Tag, Any> map;
 };
 } // namespace Plugin
 } // namespace Media
@@ -35,6 +35,14 @@ struct MediaInfoHelper {
 struct DataSourceHelper {
     virtual ~DataSourceHelper() = default;
     virtual Status ReadAt(int64_t offset, std::shared_ptr<Buffer> &buffer, size_t expectedLen) = 0;
+    virtual Status ReadAtDirect(int64_t offset, std::shared_ptr<Buffer> &buffer, size_t expectedLen)
+    {
+        return Status::ERROR_UNIMPLEMENTED;
+    }
+    virtual bool IsSeekCheap()
+    {
+        return false;
+    }
     virtual Status GetSize(size_t &size) = 0;
 };
 
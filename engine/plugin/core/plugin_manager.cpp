@@ -52,7 +52,7 @@ int32_t PluginManager::Sniffer(const std::string& name, std::shared_ptr<DataSour
         return 0;
     }
     std::shared_ptr<PluginRegInfo> regInfo = pluginRegister_->GetPluginRegInfo(PluginType::DEMUXER, name);
-    if (!regInfo) {
+    if (!regInfo || !pluginRegister_->LoadPluginLibrary(regInfo)) {
         return 0;
     }
     if (regInfo->info->pluginType == PluginType::DEMUXER) {
@@ -61,6 +61,12 @@ int32_t PluginManager::Sniffer(const std::string& name, std::shared_ptr<DataSour
     return 0;
 }
 
+bool PluginManager::IsPluginLoaded(PluginType type, const std::string& name)
+{
+    std::shared_ptr<PluginRegInfo> regInfo = pluginRegister_->GetPluginRegInfo(type, name);
+    return regInfo != nullptr && pluginRegister_->IsPluginLibraryLoaded(regInfo);
+}
+
 void PluginManager::EnablePackage(PluginType type, const std::string& name)
 {
     return pluginRegister_->EnablePackage(type, name);
@@ -91,6 +97,11 @@ int PluginManager::GetRegisteredPluginCountByPackageName(std::string name)
     return pluginRegister_->GetRegisteredPluginCountByPackageName(name);
 }
 
+uint32_t PluginManager::GetGeneration()
+{
+    return pluginRegister_->GetGeneration();
+}
+
 void PluginManager::Init()
 {
     pluginRegister_ = std::make_shared<PluginRegister>();
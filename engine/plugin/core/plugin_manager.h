@@ -62,6 +62,11 @@ public:
 
     int32_t Sniffer(const std::string& name, std::shared_ptr<DataSourceHelper> source);
 
+    /**
+     * @return false if creating the plugin or sniffing with it loads its library first
+     */
+    bool IsPluginLoaded(PluginType type, const std::string& name);
+
     void EnablePackage(PluginType type, const std::string& name);
 
     void DisablePackage(PluginType type, const std::string& name);
@@ -74,6 +79,11 @@ public:
 
     int GetRegisteredPluginCountByPackageName(std::string name);
 
+    /**
+     * Changes whenever the set of registered plugins changes.
+     */
+    uint32_t GetGeneration();
+
 private:
     PluginManager();
 
@@ -83,7 +93,7 @@ private:
     std::shared_ptr<T> CreatePlugin(const std::string& name, PluginType pluginType)
     {
         std::shared_ptr<PluginRegInfo> regInfo = pluginRegister_->GetPluginRegInfo(pluginType, name);
-        if (!regInfo) {
+        if (!regInfo || !pluginRegister_->LoadPluginLibrary(regInfo)) {
             return {};
         }
         auto plugin = ReinterpretPointerCast<U>(regInfo->creator(name));
@@ -0,0 +1,464 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define HST_LOG_TAG "PluginManifest"
+
+#include "plugin_manifest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include "common/plugin_audio_tags.h"
+#include "common/plugin_source_tags.h"
+#include "common/plugin_video_tags.h"
+#include "foundation/log.h"
+#include "interface/codec_plugin.h"
+
+namespace OHOS {
+namespace Media {
+namespace Plugin {
+namespace {
+const char* const MANIFEST_MAGIC = "HiStreamerPluginManifest";
+constexpr int MANIFEST_VERSION = 1;
+constexpr uint64_t MAX_ITEMS = 4096; // 4096: far more entries, plugins, caps or values than any library has
+constexpr uint64_t MAX_STRING_SIZE = 65536; // 65536: far longer than any name or description
+
+// integers and enums, written as decimal number
+template <typename T>
+struct ScalarIo {
+    using Raw = typename std::conditional<std::is_enum<T>::value, std::underlying_type<T>,
+                                          std::common_type<T>>::type::type;
+    using Wide = typename std::conditional<std::is_signed<Raw>::value, int64_t, uint64_t>::type;
+
+    static void Write(std::ostream& os, const T& val)
+    {
+        os << ' ' << static_cast<Wide>(static_cast<Raw>(val));
+    }
+
+    static bool Read(std::istream& is, T& val)
+    {
+        Wide wide {};
+        is >> wide;
+        val = static_cast<T>(static_cast<Raw>(wide));
+        return !is.fail();
+    }
+};
+
+template <>
+struct ScalarIo<std::string> {
+    static void Write(std::ostream& os, const std::string& val)
+    {
+        os << ' ' << val.size() << ':' << val;
+    }
+
+    static bool Read(std::istream& is, std::string& val)
+    {
+        uint64_t size = 0;
+        char separator = 0;
+        is >> size >> separator;
+        if (is.fail() || separator != ':' || size > MAX_STRING_SIZE) {
+            return false;
+        }
+        val.resize(size);
+        return size == 0 || !is.read(&val[0], static_cast<std::streamsize>(size)).fail();
+    }
+};
+
+template <typename T>
+void Put(std::ostream& os, const T& val)
+{
+    ScalarIo<T>::Write(os, val);
+}
+
+template <typename T>
+bool Get(std::istream& is, T& val)
+{
+    return ScalarIo<T>::Read(is, val);
+}
+
+bool GetCount(std::istream& is, size_t& count)
+{
+    uint64_t val = 0;
+    if (!Get(is, val) || val > MAX_ITEMS) {
+        return false;
+    }
+    count = static_cast<size_t>(val);
+    return true;
+}
+
+template <typename T>
+struct FixedIo {
+    using Type = T;
+
+    static void Write(std::ostream& os, const Type& val)
+    {
+        Put(os, val);
+    }
+
+    static bool Read(std::istream& is, Type& val)
+    {
+        return Get(is, val);
+    }
+};
+
+template <typename T>
+struct IntervalIo {
+    using Type = std::pair<T, T>;
+
+    static void Write(std::ostream& os, const Type& val)
+    {
+        Put(os, val.first);
+        Put(os, val.second);
+    }
+
+    static bool Read(std::istream& is, Type& val)
+    {
+        return Get(is, val.first) && Get(is, val.second);
+    }
+};
+
+template <typename T>
+struct DiscreteIo {
+    using Type = std::vector<T>;
+
+    static void Write(std::ostream& os, const Type& val)
+    {
+        Put(os, static_cast<uint64_t>(val.size()));
+        for (const auto& item : val) {
+            Put(os, item);
+        }
+    }
+
+    static bool Read(std::istream& is, Type& val)
+    {
+        size_t count = 0;
+        if (!GetCount(is, count)) {
+            return false;
+        }
+        val.resize(count);
+        for (auto& item : val) {
+            T tmp {};
+            if (!Get(is, tmp)) {
+                return false;
+            }
+            item = std::move(tmp);
+        }
+        return true;
+    }
+};
+
+struct ValueCodec {
+    const std::type_info* type;
+    std::string name;
+    void (*write)(std::ostream& os, const ValueType& value);
+    bool (*read)(std::istream& is, ValueType& value);
+};
+
+template <typename Io>
+void WriteValue(std::ostream& os, const ValueType& value)
+{
+    Io::Write(os, *AnyCast<typename Io::Type>(&value));
+}
+
+template <typename Io>
+bool ReadValue(std::istream& is, ValueType& value)
+{
+    typename Io::Type val {};
+    if (!Io::Read(is, val)) {
+        return false;
+    }
+    value = std::move(val);
+    return true;
+}
+
+template <typename T>
+void AddValueCodecs(std::vector<ValueCodec>& codecs, const std::string& name)
+{
+    codecs.push_back({&typeid(T), name, WriteValue<FixedIo<T>>, ReadValue<FixedIo<T>>});
+    codecs.push_back({&typeid(std::pair<T, T>), name + "_i", WriteValue<IntervalIo<T>>, ReadValue<IntervalIo<T>>});
+    codecs.push_back({&typeid(std::vector<T>), name + "_d", WriteValue<DiscreteIo<T>>, ReadValue<DiscreteIo<T>>});
+}
+
+// the value types used by the capability keys and the extra infos of the plugin definitions
+const std::vector<ValueCodec>& GetValueCodecs()
+{
+    static const std::vector<ValueCodec> codecs = [] {
+        std::vector<ValueCodec> res;
+        AddValueCodecs<uint32_t>(res, "u32");
+        AddValueCodecs<int64_t>(res, "i64");
+        AddValueCodecs<AudioChannelLayout>(res, "channel_layout");
+        AddValueCodecs<AudioSampleFormat>(res, "sample_format");
+        AddValueCodecs<AudioAacProfile>(res, "aac_profile");
+        AddValueCodecs<AudioAacStreamFormat>(res, "aac_stream_format");
+        AddValueCodecs<VideoPixelFormat>(res, "pixel_format");
+        AddValueCodecs<ProtocolType>(res, "protocol");
+        AddValueCodecs<SrcInputType>(res, "src_input_type");
+        AddValueCodecs<CodecType>(res, "codec_type");
+        AddValueCodecs<std::string>(res, "string");
+        return res;
+    }();
+    return codecs;
+}
+
+bool WriteAny(std::ostream& os, const ValueType& value)
+{
+    for (const auto& codec : GetValueCodecs()) {
+        if (value.SameTypeWith(*codec.type)) {
+            os << ' ' << codec.name;
+            codec.write(os, value);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ReadAny(std::istream& is, ValueType& value)
+{
+    std::string name;
+    is >> name;
+    for (const auto& codec : GetValueCodecs()) {
+        if (codec.name == name) {
+            return codec.read(is, value);
+        }
+    }
+    return false;
+}
+
+bool WriteCaps(std::ostream& os, const CapabilitySet& caps)
+{
+    Put(os, static_cast<uint64_t>(caps.size()));
+    for (const auto& cap : caps) {
+        Put(os, cap.mime);
+        Put(os, static_cast<uint64_t>(cap.keys.size()));
+        for (const auto& pairKey : cap.keys) {
+            Put(os, pairKey.first);
+            if (!WriteAny(os, pairKey.second)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool ReadCaps(std::istream& is, CapabilitySet& caps)
+{
+    size_t capCnt = 0;
+    if (!GetCount(is, capCnt)) {
+        return false;
+    }
+    caps.resize(capCnt);
+    for (auto& cap : caps) {
+        size_t keyCnt = 0;
+        if (!Get(is, cap.mime) || !GetCount(is, keyCnt)) {
+            return false;
+        }
+        for (size_t i = 0; i < keyCnt; ++i) {
+            Capability::Key key {};
+            if (!Get(is, key) || !ReadAny(is, cap.keys[key])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool WritePluginItem(std::ostream& os, const PluginManifestEntry::PluginItem& item)
+{
+    if (item.packageDef == nullptr || item.info == nullptr) {
+        return false;
+    }
+    const auto& info = *item.info;
+    os << "\nplugin";
+    Put(os, item.packageDef->pkgVersion);
+    Put(os, item.packageDef->name);
+    Put(os, item.packageDef->licenseType);
+    Put(os, info.apiVersion);
+    Put(os, info.pluginType);
+    Put(os, info.name);
+    Put(os, info.description);
+    Put(os, info.rank);
+    Put(os, static_cast<uint64_t>(info.extra.size()));
+    for (const auto& pairExtra : info.extra) {
+        Put(os, pairExtra.first);
+        if (!WriteAny(os, pairExtra.second)) {
+            return false;
+        }
+    }
+    return WriteCaps(os, info.inCaps) && WriteCaps(os, info.outCaps);
+}
+
+bool ReadPluginItem(std::istream& is, PluginManifestEntry::PluginItem& item)
+{
+    std::string tag;
+    is >> tag;
+    if (tag != "plugin") {
+        return false;
+    }
+    item.packageDef = std::make_shared<PackageDef>();
+    item.info = std::make_shared<PluginInfo>();
+    auto& info = *item.info;
+    size_t extraCnt = 0;
+    if (!Get(is, item.packageDef->pkgVersion) || !Get(is, item.packageDef->name) ||
+        !Get(is, item.packageDef->licenseType) || !Get(is, info.apiVersion) || !Get(is, info.pluginType) ||
+        !Get(is, info.name) || !Get(is, info.description) || !Get(is, info.rank) || !GetCount(is, extraCnt)) {
+        return false;
+    }
+    for (size_t i = 0; i < extraCnt; ++i) {
+        std::string key;
+        if (!Get(is, key) || !ReadAny(is, info.extra[key])) {
+            return false;
+        }
+    }
+    return ReadCaps(is, info.inCaps) && ReadCaps(is, info.outCaps);
+}
+
+bool WriteEntry(std::ostream& os, const PluginManifestEntry& entry)
+{
+    os << "\nlibrary";
+    Put(os, entry.libName);
+    Put(os, entry.registerName);
+    Put(os, entry.fileSize);
+    Put(os, entry.modifyTime);
+    Put(os, static_cast<uint64_t>(entry.plugins.size()));
+    for (const auto& item : entry.plugins) {
+        if (!WritePluginItem(os, item)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReadEntry(std::istream& is, PluginManifestEntry& entry)
+{
+    std::string tag;
+    is >> tag;
+    size_t pluginCnt = 0;
+    if (tag != "library" || !Get(is, entry.libName) || !Get(is, entry.registerName) || !Get(is, entry.fileSize) ||
+        !Get(is, entry.modifyTime) || !GetCount(is, pluginCnt)) {
+        return false;
+    }
+    entry.plugins.resize(pluginCnt);
+    for (auto& item : entry.plugins) {
+        if (!ReadPluginItem(is, item)) {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+bool PluginManifest::Load(const std::string& path)
+{
+    entries_.clear();
+    changed_ = false;
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        MEDIA_LOG_I("no plugin manifest at " PUBLIC_LOG_S, path.c_str());
+        return false;
+    }
+    std::string magic;
+    int version = 0;
+    size_t entryCnt = 0;
+    file >> magic >> version;
+    bool ok = !file.fail() && magic == MANIFEST_MAGIC && version == MANIFEST_VERSION && GetCount(file, entryCnt);
+    for (size_t i = 0; ok && i < entryCnt; ++i) {
+        PluginManifestEntry entry;
+        ok = ReadEntry(file, entry);
+        if (ok) {
+            auto libName = entry.libName;
+            entries_[libName] = std::move(entry);
+        }
+    }
+    if (!ok) {
+        MEDIA_LOG_W("plugin manifest " PUBLIC_LOG_S " is outdated or broken, ignore it", path.c_str());
+        entries_.clear();
+        changed_ = true;
+    }
+    return ok;
+}
+
+bool PluginManifest::Save(const std::string& path) const
+{
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!file.is_open()) {
+            MEDIA_LOG_W("can't write plugin manifest " PUBLIC_LOG_S, tmpPath.c_str());
+            return false;
+        }
+        file << MANIFEST_MAGIC << ' ' << MANIFEST_VERSION;
+        Put(file, static_cast<uint64_t>(entries_.size()));
+        for (const auto& pairEntry : entries_) {
+            (void)WriteEntry(file, pairEntry.second); // checked by Update()
+        }
+        file << '\n';
+        if (file.flush().fail()) {
+            MEDIA_LOG_W("write plugin manifest " PUBLIC_LOG_S " failed", tmpPath.c_str());
+            file.close();
+            (void)std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    // rename doesn't replace an existing file on every platform
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0 &&
+        (std::remove(path.c_str()) != 0 || std::rename(tmpPath.c_str(), path.c_str()) != 0)) {
+        MEDIA_LOG_W("replace plugin manifest " PUBLIC_LOG_S " failed", path.c_str());
+        (void)std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+const PluginManifestEntry* PluginManifest::Find(const std::string& libName, int64_t fileSize,
+                                                int64_t modifyTime) const
+{
+    auto ite = entries_.find(libName);
+    if (ite == entries_.end() || ite->second.fileSize != fileSize || ite->second.modifyTime != modifyTime) {
+        return nullptr;
+    }
+    return &ite->second;
+}
+
+bool PluginManifest::Update(PluginManifestEntry entry)
+{
+    std::ostringstream os;
+    if (!WriteEntry(os, entry)) {
+        MEDIA_LOG_I("plugins of " PUBLIC_LOG_S " can't be written to the manifest", entry.libName.c_str());
+        changed_ = entries_.erase(entry.libName) > 0 || changed_;
+        return false;
+    }
+    auto libName = entry.libName;
+    entries_[libName] = std::move(entry);
+    changed_ = true;
+    return true;
+}
+
+void PluginManifest::Retain(const std::set<std::string>& libNames)
+{
+    for (auto ite = entries_.begin(); ite != entries_.end();) {
+        if (libNames.count(ite->first) == 0) {
+            ite = entries_.erase(ite);
+            changed_ = true;
+        } else {
+            ++ite;
+        }
+    }
+}
+} // namespace Plugin
+} // namespace Media
+} // namespace OHOS
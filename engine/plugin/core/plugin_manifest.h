@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HISTREAMER_PLUGIN_MANIFEST_H
+#define HISTREAMER_PLUGIN_MANIFEST_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "interface/plugin_definition.h"
+#include "plugin_info.h"
+
+namespace OHOS {
+namespace Media {
+namespace Plugin {
+/**
+ * The plugins one dynamic library registered, together with what identifies the version of the library file.
+ */
+struct PluginManifestEntry {
+    struct PluginItem {
+        std::shared_ptr<PackageDef> packageDef;
+        std::shared_ptr<PluginInfo> info;
+    };
+
+    PluginManifestEntry() = default;
+
+    PluginManifestEntry(std::string lib, std::string reg, int64_t size, int64_t mtime)
+        : libName(std::move(lib)), registerName(std::move(reg)), fileSize(size), modifyTime(mtime)
+    {
+    }
+
+    std::string libName;
+    std::string registerName; // the library exports register_<registerName> and unregister_<registerName>
+    int64_t fileSize {0};
+    int64_t modifyTime {0};
+    std::vector<PluginItem> plugins {};
+};
+
+/**
+ * Plugin infos of the dynamic plugin libraries, persisted between startups so that the plugins of a library can be
+ * registered without loading it. An entry is only used while size and modify time of its library stay the same.
+ * The file extensions in the extra infos of the demuxers are their sniff hints: the type finder only loads the
+ * library of a demuxer to sniff if they match the uri or the magic prefix of the media, or if nothing else does.
+ *
+ * The file is text, one token after the other, strings are written as "<length>:<bytes>". Only the value types the
+ * plugin definitions use in capabilities and extra infos can be written, a library using others has no entry.
+ */
+class PluginManifest {
+public:
+    /**
+     * @return false if the file is missing or can't be parsed, the manifest is empty then
+     */
+    bool Load(const std::string& path);
+
+    /**
+     * Writes a temporary file next to path and renames it, so a crash never leaves a partial manifest behind.
+     */
+    bool Save(const std::string& path) const;
+
+    /**
+     * @return the entry of the library if it was saved for the same file, nullptr otherwise
+     */
+    const PluginManifestEntry* Find(const std::string& libName, int64_t fileSize, int64_t modifyTime) const;
+
+    /**
+     * Adds or replaces the entry of a library.
+     *
+     * @return false if some value of the plugin infos can't be written, the manifest has no entry for it then
+     */
+    bool Update(PluginManifestEntry entry);
+
+    /**
+     * Removes the entries of the libraries that are not in libNames any more.
+     */
+    void Retain(const std::set<std::string>& libNames);
+
+    /// Whether the manifest differs from the file it was loaded from.
+    bool IsChanged() const
+    {
+        return changed_;
+    }
+
+private:
+    std::map<std::string, PluginManifestEntry> entries_ {};
+    bool changed_ {false};
+};
+} // namespace Plugin
+} // namespace Media
+} // namespace OHOS
+#endif // HISTREAMER_PLUGIN_MANIFEST_H
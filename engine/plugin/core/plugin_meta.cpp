@@ -25,7 +25,6 @@
 namespace OHOS {
 namespace Media {
 namespace Plugin {
-using PointerPair = std::pair<std::shared_ptr<uint8_t>, size_t>;
 Meta::~Meta()
 {
     Clear();
@@ -33,7 +32,7 @@ Meta::~Meta()
 
 bool Meta::Empty() const
 {
-    return items_.empty();
+    return items_ == nullptr || items_->empty();
 }
 
 bool Meta::SetString(Plugin::MetaID id, const std::string& value)
@@ -68,16 +67,16 @@ bool Meta::SetFloat(Plugin::MetaID id, float value)
 
 bool Meta::GetString(Plugin::MetaID id, std::string& value) const
 {
-    auto ite = items_.find(id);
-    if (ite == items_.end()) {
+    auto item = GetData(id);
+    if (item == nullptr) {
         return false;
     }
-    if (ite->second.SameTypeWith(typeid(const char*))) {
-        value = Plugin::AnyCast<const char*>(ite->second);
-    } else if (ite->second.SameTypeWith(typeid(std::string))) {
-        value = Plugin::AnyCast<std::string>(ite->second);
-    } else if (ite->second.SameTypeWith(typeid(char*))) {
-        value = Plugin::AnyCast<char*>(ite->second);
+    if (item->SameTypeWith(typeid(const char*))) {
+        value = Plugin::AnyCast<const char*>(*item);
+    } else if (item->SameTypeWith(typeid(std::string))) {
+        value = Plugin::AnyCast<std::string>(*item);
+    } else if (item->SameTypeWith(typeid(char*))) {
+        value = Plugin::AnyCast<char*>(*item);
     } else {
         return false;
     }
@@ -111,30 +110,43 @@ bool Meta::GetFloat(Plugin::MetaID id, float& value) const
 
 void Meta::Clear()
 {
-    items_.clear();
+    // other metas may still share the items
+    items_.reset();
 }
 
 bool Meta::Remove(Plugin::MetaID id)
 {
-    auto ite = items_.find(id);
-    if (ite == items_.end()) {
+    if (GetData(id) == nullptr) {
         return false;
     }
-    items_.erase(ite);
+    MutableItems().erase(id);
     return true;
 }
 
 void Meta::Update(const Meta& meta)
 {
-    for (auto& ptr : meta.items_) {
-        // we need to copy memory for pointers
-        if (ptr.second.SameTypeWith(typeid(PointerPair))) {
-            auto pointerPair = Plugin::AnyCast<PointerPair>(ptr.second);
-            SetPointer(ptr.first, pointerPair.first.get(), pointerPair.second);
-        } else {
-            items_[ptr.first] = ptr.second;
-        }
+    if (meta.Empty() || meta.items_ == items_) {
+        return;
+    }
+    // the memory of pointers is never written after SetPointer, so it is shared just like the items
+    if (Empty()) {
+        items_ = meta.items_;
+        return;
+    }
+    auto& items = MutableItems();
+    for (const auto& item : *meta.items_) {
+        items.insert_or_assign(item.first, item.second);
+    }
+}
+
+Meta::Items& Meta::MutableItems()
+{
+    if (items_ == nullptr) {
+        items_ = std::make_shared<Items>();
+    } else if (items_.use_count() > 1) {
+        items_ = std::make_shared<Items>(*items_);
     }
+    return *items_;
 }
 
 bool Meta::SetPointer(Plugin::MetaID id, const void* ptr, size_t size) // NOLINT:void*
@@ -179,10 +191,13 @@ bool Meta::GetPointer(Plugin::MetaID id, void** ptr, size_t& size) const // NOLI
 
 std::vector<MetaID> Meta::GetMetaIDs() const
 {
-    std::vector<MetaID> ret (items_.size());
-    int cnt = 0;
-    for (const auto& tmp : items_) {
-        ret[cnt++] = tmp.first;
+    std::vector<MetaID> ret;
+    if (items_ == nullptr) {
+        return ret;
+    }
+    ret.reserve(items_->size());
+    for (const auto& tmp : *items_) {
+        ret.push_back(tmp.first);
     }
     return ret;
 }
@@ -16,10 +16,12 @@
 #ifndef HISTREAMER_PLUGIN_META_H
 #define HISTREAMER_PLUGIN_META_H
 
+#include <memory>
 #include <vector>
 
 #include "common/plugin_tags.h"
 #include "common/plugin_types.h"
+#include "foundation/cpp_ext/flat_map.h"
 #include "foundation/cpp_ext/type_traits_ext.h"
 
 namespace OHOS {
@@ -58,6 +60,7 @@ enum struct MetaID : uint32_t {
     MEDIA_BITRATE = CppExt::to_underlying(Tag::MEDIA_BITRATE),
     MEDIA_FILE_EXTENSION = CppExt::to_underlying(Tag::MEDIA_FILE_EXTENSION),
     MEDIA_FILE_SIZE = CppExt::to_underlying(Tag::MEDIA_FILE_SIZE),
+    MEDIA_CHEAP_SEEK = CppExt::to_underlying(Tag::MEDIA_CHEAP_SEEK),
 
     AUDIO_MPEG_VERSION = CppExt::to_underlying(Tag::AUDIO_MPEG_VERSION),
     AUDIO_MPEG_LAYER = CppExt::to_underlying(Tag::AUDIO_MPEG_LAYER),
@@ -75,6 +78,12 @@ enum struct MetaID : uint32_t {
     BITS_PER_CODED_SAMPLE = CppExt::to_underlying(Tag::BITS_PER_CODED_SAMPLE),
 };
 
+/**
+ * Metadata of a media file or one of its tracks.
+ *
+ * The items are kept sorted in one flat array, which copies of a Meta share until one of them is modified, so
+ * handing the track metas from filter to filter does not copy them.
+ */
 class Meta {
 public:
     explicit Meta() = default;
@@ -114,28 +123,34 @@ public:
     template <typename T>
     bool GetData(Plugin::MetaID id, T& value) const
     {
-        auto ite = items_.find(id);
-        if (ite == items_.end() || !ite->second.SameTypeWith(typeid(T))) {
+        auto item = GetData(id);
+        if (item == nullptr || !item->SameTypeWith(typeid(T))) {
             return false;
         }
-        value = Plugin::AnyCast<T>(ite->second);
+        value = Plugin::AnyCast<T>(*item);
         return true;
     }
 
     bool GetData(Plugin::MetaID id, Plugin::ValueType& value) const
     {
-        auto ite = items_.find(id);
-        if (ite == items_.end()) {
+        auto item = GetData(id);
+        if (item == nullptr) {
             return false;
         }
-        value = ite->second;
+        value = *item;
         return true;
     }
 
+    /**
+     * The returned pointer is valid until this meta is modified.
+     */
     const Plugin::ValueType* GetData(MetaID id) const
     {
-        auto ite = items_.find(id);
-        if (ite == items_.end()) {
+        if (items_ == nullptr) {
+            return nullptr;
+        }
+        auto ite = items_->find(id);
+        if (ite == items_->end()) {
             return nullptr;
         }
         return &(ite->second);
@@ -165,20 +180,24 @@ public:
     template <typename T>
     bool SetData(Plugin::MetaID id, const T& value)
     {
-        items_[id] = value;
+        MutableItems().insert_or_assign(id, value);
         return true;
     }
 
     bool SetData(Plugin::MetaID id, const Plugin::ValueType& value)
     {
-        items_[id] = value;
+        MutableItems().insert_or_assign(id, value);
         return true;
     }
 
     std::vector<MetaID> GetMetaIDs() const;
 
 private:
-    std::map<MetaID, Plugin::ValueType> items_ {};
+    using Items = CppExt::FlatMap<MetaID, Plugin::ValueType>;
+
+    Items& MutableItems();
+
+    std::shared_ptr<Items> items_ {};
 };
 } // namespace Plugin
 } // namespace Media
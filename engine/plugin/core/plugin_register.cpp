@@ -16,9 +16,11 @@
 #include "plugin_register.h"
 
 #include <dirent.h>
+#include <sys/stat.h>
 
 #include "all_plugin_static.h"
 #include "foundation/log.h"
+#include "foundation/osal/thread/scoped_lock.h"
 #include "interface/audio_sink_plugin.h"
 #include "interface/codec_plugin.h"
 #include "interface/demuxer_plugin.h"
@@ -48,6 +50,11 @@ static std::string g_fileSeparator = "/";
 #endif
 static std::string g_libFileTail = HST_PLUGIN_FILE_TAIL;
 
+#ifndef HST_PLUGIN_MANIFEST_PATH
+#define HST_PLUGIN_MANIFEST_PATH HST_PLUGIN_PATH
+#endif
+static std::string g_manifestFileName = "histreamer_plugins.manifest";
+
 PluginRegister::~PluginRegister()
 {
     UnregisterAllPlugins();
@@ -70,10 +77,12 @@ Status PluginRegister::RegisterImpl::AddPlugin(const PluginDefBase& def)
 {
     if (!Verification(def)) {
         // 插件定义参数校验不合法
+        anyRejected = true;
         return Status::ERROR_INVALID_DATA;
     }
     if (!VersionMatched(def)) {
         // 版本不匹配，不给注册
+        anyRejected = true;
         return Status::ERROR_UNKNOWN;
     }
     if (registerData->IsPluginExist(def.pluginType, def.name)) {
@@ -81,11 +90,14 @@ Status PluginRegister::RegisterImpl::AddPlugin(const PluginDefBase& def)
             registerData->registerTable[def.pluginType].erase(def.name);
         } else {
             // 重复注册，且有更合适的版本存在
+            anyRejected = true;
             return Status::ERROR_PLUGIN_ALREADY_EXISTS;
         }
     }
+    auto regInfo = BuildRegInfo(def);
     registerData->registerNames[def.pluginType].insert(def.name);
-    registerData->registerTable[def.pluginType][def.name] = BuildRegInfo(def);
+    registerData->registerTable[def.pluginType][def.name] = regInfo;
+    addedPlugins.push_back(regInfo);
     return Status::OK;
 }
 
@@ -280,7 +292,12 @@ Status PluginRegister::RegisterImpl::VideoSinkCapabilityConvert(std::shared_ptr<
 
 std::set<std::string> PluginRegister::ListPlugins(PluginType type)
 {
-    return registerData->registerNames[type];
+    // no operator[], it would insert into the map while the branches of a pipeline negotiate concurrently
+    auto ite = registerData->registerNames.find(type);
+    if (ite == registerData->registerNames.end()) {
+        return {};
+    }
+    return ite->second;
 }
 
 int PluginRegister::GetAllRegisteredPluginCount()
@@ -304,6 +321,12 @@ void PluginRegister::RegisterPlugins()
 {
     RegisterStaticPlugins();
     RegisterDynamicPlugins();
+    generation++;
+}
+
+uint32_t PluginRegister::GetGeneration() const
+{
+    return generation.load();
 }
 
 void PluginRegister::RegisterStaticPlugins()
@@ -321,6 +344,10 @@ void PluginRegister::RegisterPluginsFromPath(const char* libDirPath)
 #ifdef DYNAMIC_PLUGINS
     DIR* libDir = opendir(libDirPath);
     if (libDir) {
+        std::string manifestPath = std::string(HST_PLUGIN_MANIFEST_PATH) + g_fileSeparator + g_manifestFileName;
+        PluginManifest manifest;
+        (void)manifest.Load(manifestPath);
+        std::set<std::string> libNames;
         struct dirent* lib = nullptr;
         std::shared_ptr<PluginLoader> loader = nullptr;
         while ((lib = readdir(libDir))) {
@@ -335,15 +362,112 @@ void PluginRegister::RegisterPluginsFromPath(const char* libDirPath)
             std::string pluginName =
                 libName.substr(g_libFileHead.size(), libName.size() - g_libFileHead.size() - g_libFileTail.size());
             std::string libPath = libDirPath + g_fileSeparator + lib->d_name;
+            struct stat libStat {};
+            if (stat(libPath.c_str(), &libStat) != 0) {
+                continue;
+            }
+            libNames.insert(libName);
+            auto entry = manifest.Find(libName, libStat.st_size, libStat.st_mtime);
+            if (entry != nullptr) {
+                RegisterPluginsFromManifest(*entry, libPath);
+                continue;
+            }
             loader = PluginLoader::Create(pluginName, libPath);
             if (loader) {
-                loader->FetchRegisterFunction()(std::make_shared<RegisterImpl>(registerData, loader));
+                auto impl = std::make_shared<RegisterImpl>(registerData, loader);
+                loader->FetchRegisterFunction()(impl);
                 registeredLoaders.push_back(loader);
+                if (impl->anyRejected) {
+                    continue; // which of its plugins register depends on the other libraries, load it every time
+                }
+                PluginManifestEntry newEntry(libName, pluginName, libStat.st_size, libStat.st_mtime);
+                for (const auto& regInfo : impl->addedPlugins) {
+                    newEntry.plugins.push_back({regInfo->packageDef, regInfo->info});
+                }
+                (void)manifest.Update(std::move(newEntry));
             }
         }
         closedir(libDir);
+        manifest.Retain(libNames);
+        if (manifest.IsChanged()) {
+            (void)manifest.Save(manifestPath);
+        }
+    }
+#endif
+}
+
+void PluginRegister::RegisterPluginsFromManifest(const PluginManifestEntry& entry, const std::string& libPath)
+{
+    auto library = std::make_shared<PluginLibrary>();
+    library->registerName = entry.registerName;
+    library->path = libPath;
+    RegisterImpl checker(registerData);
+    for (const auto& item : entry.plugins) {
+        PluginDefBase def;
+        def.apiVersion = item.info->apiVersion;
+        def.pluginType = item.info->pluginType;
+        def.rank = item.info->rank;
+        if (!checker.Verification(def) || !checker.VersionMatched(def) ||
+            registerData->IsPluginExist(def.pluginType, item.info->name)) {
+            continue;
+        }
+        auto regInfo = std::make_shared<PluginRegInfo>();
+        regInfo->packageDef = item.packageDef;
+        regInfo->info = item.info;
+        regInfo->library = library;
+        registerData->registerNames[def.pluginType].insert(item.info->name);
+        registerData->registerTable[def.pluginType][item.info->name] = regInfo;
+        library->plugins.push_back(regInfo);
+    }
+    MEDIA_LOG_D("register " PUBLIC_LOG_ZU " plugins of " PUBLIC_LOG_S " from the manifest", library->plugins.size(),
+                entry.libName.c_str());
+}
+
+bool PluginRegister::LoadPluginLibrary(const std::shared_ptr<PluginRegInfo>& regInfo)
+{
+    if (regInfo->library == nullptr) {
+        return true;
+    }
+    OSAL::ScopedLock lock(libraryMutex);
+#ifdef DYNAMIC_PLUGINS
+    auto& library = *regInfo->library;
+    if (!library.loadTried) {
+        library.loadTried = true;
+        MEDIA_LOG_I("load plugin library " PUBLIC_LOG_S, library.path.c_str());
+        auto loader = PluginLoader::Create(library.registerName, library.path);
+        if (loader) {
+            // register into a table of its own, the plugins are in the register table already
+            auto impl = std::make_shared<RegisterImpl>(std::make_shared<RegisterData>(), loader);
+            loader->FetchRegisterFunction()(impl);
+            for (const auto& weakPlugin : library.plugins) {
+                auto plugin = weakPlugin.lock();
+                if (plugin == nullptr || !impl->registerData->IsPluginExist(plugin->info->pluginType,
+                                                                             plugin->info->name)) {
+                    continue;
+                }
+                auto& loaded = impl->registerData->registerTable[plugin->info->pluginType][plugin->info->name];
+                plugin->creator = loaded->creator;
+                plugin->sniffer = loaded->sniffer;
+                plugin->loader = loader;
+            }
+            registeredLoaders.push_back(loader);
+        }
     }
 #endif
+    if (regInfo->creator == nullptr) {
+        MEDIA_LOG_E("plugin " PUBLIC_LOG_S " is not in its library", regInfo->info->name.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool PluginRegister::IsPluginLibraryLoaded(const std::shared_ptr<PluginRegInfo>& regInfo)
+{
+    if (regInfo->library == nullptr) {
+        return true;
+    }
+    OSAL::ScopedLock lock(libraryMutex);
+    return regInfo->library->loadTried;
 }
 
 void PluginRegister::UnregisterAllPlugins()
@@ -458,6 +582,7 @@ void PluginRegister::EnablePackage(PluginType type, const std::string& name)
 {
     if (!IsPackageExist(type, name)) {
         RecoverDisabledPackage(type, name);
+        generation++;
     }
 }
 
@@ -465,6 +590,7 @@ void PluginRegister::DisablePackage(PluginType type, const std::string& name)
 {
     if (IsPackageExist(type, name)) {
         EraseRegisteredPluginsByPackageName(name);
+        generation++;
     }
 }
 
@@ -16,29 +16,46 @@
 #ifndef HISTREAMER_PLUGIN_REGISTER_H
 #define HISTREAMER_PLUGIN_REGISTER_H
 
+#include <atomic>
 #include <functional>
 #include <map>
 #include <set>
 #include <utility>
 #include "common/any.h"
+#include "foundation/osal/thread/mutex.h"
 #include "interface/audio_sink_plugin.h"
 #include "interface/codec_plugin.h"
 #include "interface/demuxer_plugin.h"
 #include "interface/plugin_base.h"
 #include "interface/source_plugin.h"
 #include "plugin_loader.h"
+#include "plugin_manifest.h"
 
 #include "plugin_info.h"
 
 namespace OHOS {
 namespace Media {
 namespace Plugin {
+struct PluginRegInfo;
+
+/**
+ * Dynamic library whose plugins were registered from the manifest. It is loaded the first time one of its plugins is
+ * created or sniffs, which fills in creator, sniffer and loader of the plugins.
+ */
+struct PluginLibrary {
+    std::string registerName;
+    std::string path;
+    bool loadTried {false};
+    std::vector<std::weak_ptr<PluginRegInfo>> plugins {};
+};
+
 struct PluginRegInfo {
     std::shared_ptr<PackageDef> packageDef;
     std::shared_ptr<PluginInfo> info;
     PluginCreatorFunc<PluginBase> creator;
     DemuxerPluginSnifferFunc sniffer;
     std::shared_ptr<PluginLoader> loader;
+    std::shared_ptr<PluginLibrary> library {nullptr}; // not null if registered from the manifest
 };
 
 class PluginRegister {
@@ -67,10 +84,29 @@ public:
 
     void RegisterPlugins();
 
+    /**
+     * Changes whenever plugins are registered, enabled or disabled, so data derived from the registered plugins can
+     * tell that it is outdated.
+     */
+    uint32_t GetGeneration() const;
+
+    /**
+     * Loads the library of a plugin that was registered from the manifest, if not done yet.
+     *
+     * @return false if the plugin can't be created, e.g. the library doesn't load or has no such plugin any more
+     */
+    bool LoadPluginLibrary(const std::shared_ptr<PluginRegInfo>& regInfo);
+
+    /**
+     * @return false if the plugin was registered from the manifest and its library is not loaded yet
+     */
+    bool IsPluginLibraryLoaded(const std::shared_ptr<PluginRegInfo>& regInfo);
+
 private:
     void RegisterStaticPlugins();
     void RegisterDynamicPlugins();
     void RegisterPluginsFromPath(const char* libDirPath);
+    void RegisterPluginsFromManifest(const PluginManifestEntry& entry, const std::string& libPath);
     void UnregisterAllPlugins();
     void EraseRegisteredPluginsByPackageName(std::string name);
     void EraseRegisteredPluginsByLoader(const std::shared_ptr<PluginLoader>& loader);
@@ -136,10 +172,14 @@ private:
         std::shared_ptr<PluginLoader> pluginLoader;
         std::shared_ptr<RegisterData> registerData;
         std::shared_ptr<PackageDef> packageDef {nullptr};
+        std::vector<std::shared_ptr<PluginRegInfo>> addedPlugins {};
+        bool anyRejected {false};
     };
 
     std::shared_ptr<RegisterData> registerData = std::make_shared<RegisterData>();
     std::vector<std::shared_ptr<PluginLoader>> registeredLoaders;
+    std::atomic<uint32_t> generation {0};
+    OSAL::Mutex libraryMutex {};
 };
 } // namespace Plugin
 } // namespace Media
@@ -39,6 +39,16 @@ struct DataSourceWrapper : DataSource {
         return helper->ReadAt(offset, buffer, expectedLen);
     }
 
+    Status ReadAtDirect(int64_t offset, std::shared_ptr<Buffer>& buffer, size_t expectedLen) override
+    {
+        return helper->ReadAtDirect(offset, buffer, expectedLen);
+    }
+
+    bool IsSeekCheap() override
+    {
+        return helper->IsSeekCheap();
+    }
+
     Status GetSize(size_t& size) override
     {
         return helper->GetSize(size);
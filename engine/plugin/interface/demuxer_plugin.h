@@ -56,7 +56,9 @@ struct DataSource {
      * @brief Read data from data source.
      *
      * @param offset    Offset of read position
-     * @param buffer    Storage of the read data
+     * @param buffer    Storage of the read data. If the buffer has no memory, the data source may append
+     *                  read-only memories which share the cached data instead of copying it, the data can
+     *                  then be split into several memories, see Buffer::GetMemoryCount().
      * @param expectedLen   Expected data size to be read
      * @return  Execution status return
      *  @retval OK: Plugin reset succeeded.
@@ -65,6 +67,37 @@ struct DataSource {
      */
     virtual Status ReadAt(int64_t offset, std::shared_ptr<Buffer>& buffer, size_t expectedLen) = 0;
 
+    /**
+     * @brief Read data from data source around the data cached for ReadAt, which it neither uses nor disturbs.
+     *
+     * For reads beside the playback, e.g. scanning the file for a seek index in the background.
+     *
+     * @param offset    Offset of read position
+     * @param buffer    Storage of the read data, with memory of at least expectedLen bytes
+     * @param expectedLen   Expected data size to be read
+     * @return  Execution status return
+     *  @retval OK: Plugin reset succeeded.
+     *  @retval END_OF_STREAM: End of stream
+     *  @retval ERROR_UNIMPLEMENTED: The data source cannot read at random, e.g. for a live stream
+     */
+    virtual Status ReadAtDirect(int64_t offset, std::shared_ptr<Buffer>& buffer, size_t expectedLen)
+    {
+        return Status::ERROR_UNIMPLEMENTED;
+    }
+
+    /**
+     * @brief Whether ReadAtDirect is cheap at any offset, e.g. on a local file.
+     *
+     * Over a network each direct read beside the playback is a request of its own, reading the whole stream that
+     * way downloads it a second time.
+     *
+     * @return  true if ReadAtDirect is implemented and seeking the source costs no more than reading it
+     */
+    virtual bool IsSeekCheap()
+    {
+        return false;
+    }
+
     /**
      * @brief Get data source size.
      *
@@ -21,9 +21,11 @@
 #include <cstring>
 #include <new>
 #include <securec.h>
+#include "foundation/cpp_ext/memory_ext.h"
 #include "foundation/log.h"
 #include "osal/thread/scoped_lock.h"
 #include "plugin/common/plugin_buffer.h"
+#include "plugin/common/plugin_time.h"
 #include "constants.h"
 #include "osal/utils/util.h"
 
@@ -77,6 +79,7 @@ Status AACDemuxerPlugin::DoReadFromSource(uint32_t readSize)
     if (readSize == 0) {
         return Status::OK;
     }
+    OSAL::ScopedLock lock(readMutex_);
     auto buffer  = std::make_shared<Buffer>();
     auto bufData = buffer->AllocMemory(nullptr, readSize);
     int retryTimes = 0;
@@ -126,6 +129,34 @@ Status AACDemuxerPlugin::DoReadFromSource(uint32_t readSize)
     return Status::OK;
 }
 
+size_t AACDemuxerPlugin::ReadForFrameIndex(uint64_t offset, uint8_t* data, size_t size, bool direct)
+{
+    auto buffer = std::make_shared<Buffer>();
+    auto bufData = buffer->AllocMemory(nullptr, size);
+    FALSE_RETURN_V(ioContext_.dataSource != nullptr, 0);
+    Status ret;
+    if (direct) {
+        // around the data cached for the playback, so it neither waits for nor disturbs the reads of the frames
+        ret = ioContext_.dataSource->ReadAtDirect(offset, buffer, size);
+    } else {
+        OSAL::ScopedLock lock(readMutex_);
+        ret = ioContext_.dataSource->ReadAt(offset, buffer, size);
+    }
+    if (ret != Status::OK) {
+        return 0;
+    }
+    size_t readSize = std::min(size, bufData->GetSize());
+    (void)memcpy_s(data, size, bufData->GetReadOnlyData(), readSize);
+    return readSize;
+}
+
+AudioFrameIndex::ReadFunc AACDemuxerPlugin::GetFrameIndexReader(bool direct)
+{
+    return [this, direct](uint64_t offset, uint8_t* data, size_t size) {
+        return ReadForFrameIndex(offset, data, size, direct);
+    };
+}
+
 Status AACDemuxerPlugin::GetDataFromSource()
 {
     uint32_t ioNeedReadSize = inIoBufferSize_ - ioDataRemainSize_;
@@ -170,6 +201,19 @@ Status AACDemuxerPlugin::GetMediaInfo(MediaInfo& mediaInfo)
     int ret = AudioDemuxerAACPrepare(inIoBuffer_, ioDataRemainSize_, &aacDemuxerRst_);
     if (ret == 0) {
         mediaInfo.tracks.resize(1);
+        if (isSeekable_) {
+            frameIndex_ = CppExt::make_unique<AudioFrameIndex>(AudioFrameFormat::ADTS, GetFrameIndexReader(false));
+            if (frameIndex_->Init(0, fileSize_)) {
+                auto& firstFrame = frameIndex_->GetFirstFrame();
+                mediaInfo.tracks[0].insert({Tag::MEDIA_DURATION, static_cast<uint64_t>(
+                    frameIndex_->GetDurationSamples() * HST_SECOND / firstFrame.sampleRate)});
+                if (ioContext_.dataSource->IsSeekCheap()) { // else seeks are estimated, see AudioFrameIndex
+                    frameIndex_->StartScan(GetFrameIndexReader(true));
+                }
+            } else {
+                frameIndex_.reset();
+            }
+        }
         if (aacDemuxerRst_.frameChannels == 1) {
             mediaInfo.tracks[0].insert({Tag::AUDIO_CHANNEL_LAYOUT, AudioChannelLayout::MONO});
         } else {
@@ -209,6 +253,14 @@ Status AACDemuxerPlugin::ReadFrame(Buffer& outBuffer, int32_t timeOutMs)
     switch (status) {
         case 0:
             aacFrameData->Write(aacDemuxerRst_.frameBuffer, aacDemuxerRst_.frameLength);
+            if (frameIndex_ != nullptr && aacDemuxerRst_.frameLength > 0) {
+                AudioFrameInfo info;
+                outBuffer.pts = currentSample_ * HST_SECOND / frameIndex_->GetFirstFrame().sampleRate;
+                if (ParseAudioFrameHeader(AudioFrameFormat::ADTS, aacDemuxerRst_.frameBuffer,
+                                          aacDemuxerRst_.frameLength, info)) {
+                    currentSample_ += info.samples;
+                }
+            }
             if (aacDemuxerRst_.frameBuffer) {
                 free(aacDemuxerRst_.frameBuffer);
                 aacDemuxerRst_.frameBuffer = nullptr;
@@ -230,6 +282,19 @@ Status AACDemuxerPlugin::ReadFrame(Buffer& outBuffer, int32_t timeOutMs)
 
 Status AACDemuxerPlugin::SeekTo(int32_t trackId, int64_t hstTime, SeekMode mode)
 {
+    FALSE_RETURN_V_MSG_W(frameIndex_ != nullptr, Status::ERROR_INVALID_OPERATION, "not seekable");
+    uint64_t targetSample = static_cast<uint64_t>(std::max<int64_t>(hstTime, 0)) *
+        frameIndex_->GetFirstFrame().sampleRate / HST_SECOND;
+    uint64_t offset = 0;
+    if (!frameIndex_->FindSeekPosition(targetSample, offset, currentSample_)) {
+        MEDIA_LOG_I("sample " PUBLIC_LOG_U64 " not indexed yet, seek to the estimate " PUBLIC_LOG_U64,
+                    targetSample, offset);
+    }
+    ioContext_.offset = static_cast<int64_t>(offset);
+    ioContext_.eos = false;
+    ioDataRemainSize_ = 0;
+    usedDataSize_ = 0;
+    (void)memset_s(inIoBuffer_, inIoBufferSize_, 0x00, inIoBufferSize_);
     return Status::OK;
 }
 
@@ -259,6 +324,8 @@ Status AACDemuxerPlugin::Prepare()
 
 Status AACDemuxerPlugin::Reset()
 {
+    frameIndex_.reset();
+    currentSample_ = 0;
     ioContext_.eos = false;
     ioContext_.dataSource.reset();
     ioContext_.offset = 0;
@@ -20,7 +20,9 @@
 #include <string>
 #include <vector>
 
+#include "foundation/osal/thread/mutex.h"
 #include "interface/demuxer_plugin.h"
+#include "plugin/plugins/demuxer/common/audio_frame_index.h"
 
 namespace OHOS {
 namespace Media {
@@ -76,6 +78,8 @@ private:
         bool eos {false};
     };
     Status DoReadFromSource(uint32_t readSize);
+    size_t ReadForFrameIndex(uint64_t offset, uint8_t* data, size_t size, bool direct);
+    AudioFrameIndex::ReadFunc GetFrameIndexReader(bool direct);
     Status GetDataFromSource();
     int GetFrameLength(const uint8_t *data);
     int AudioDemuxerAACOpen(AudioDemuxerUserArg *userArg);
@@ -91,6 +95,9 @@ private:
     unsigned char *inIoBuffer_;
     unsigned int ioDataRemainSize_;
     int inIoBufferSize_;
+    uint64_t currentSample_ {0}; // of the next frame
+    OSAL::Mutex readMutex_ {};   // the data source is shared with the seeks of the frame index
+    std::unique_ptr<AudioFrameIndex> frameIndex_ {nullptr}; // last, its scan stops before the rest is destroyed
 };
 } // namespace AacDemuxer
 } // namespace Plugin
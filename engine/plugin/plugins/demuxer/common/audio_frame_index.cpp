@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define HST_LOG_TAG "AudioFrameIndex"
+
+#include "audio_frame_index.h"
+#include <algorithm>
+#include <cstring>
+#include "foundation/cpp_ext/memory_ext.h"
+#include "foundation/log.h"
+#include "foundation/osal/thread/scoped_lock.h"
+
+namespace OHOS {
+namespace Media {
+namespace Plugin {
+namespace {
+constexpr size_t MPEG_HEADER_SIZE = 4;
+constexpr size_t ADTS_HEADER_SIZE = 7;
+constexpr size_t MAX_FRAME_SIZE = 8191; // 13 bits of the adts frame length, mpeg audio frames are smaller
+constexpr size_t SCAN_CHUNK_SIZE = 64 * 1024;
+constexpr size_t SYNC_WINDOW_SIZE = 16 * 1024;
+constexpr uint32_t XING_TOC_SIZE = 100;
+constexpr uint32_t XING_FLAG_FRAMES = 0x1;
+constexpr uint32_t XING_FLAG_BYTES = 0x2;
+constexpr uint32_t XING_FLAG_TOC = 0x4;
+constexpr size_t VBRI_POS = 36; // 36: header and 32 bytes of side info
+constexpr size_t VBRI_TOC_POS = 26;
+
+constexpr uint32_t MPEG_SAMPLE_RATES[] = {44100, 48000, 32000};
+constexpr uint32_t ADTS_SAMPLE_RATES[] = {
+    96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050, 16000, 12000, 11025, 8000, 7350
+};
+// kbps of the bitrate indexes 0 to 14, of mpeg 1 layer I, II and III, then of mpeg 2/2.5 layer I and layer II/III
+constexpr uint16_t MPEG_BITRATES[5][15] = { // 5: tables, 15: bitrate indexes
+    {0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448},
+    {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384},
+    {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320},
+    {0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256},
+    {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},
+};
+
+uint32_t GetU16(const uint8_t* data)
+{
+    return (static_cast<uint32_t>(data[0]) << 8) | data[1]; // 8: big endian
+}
+
+uint32_t GetU32(const uint8_t* data)
+{
+    return (GetU16(data) << 16) | GetU16(data + 2); // 16, 2: big endian
+}
+
+bool ParseMpegAudioHeader(const uint8_t* data, size_t size, AudioFrameInfo& info)
+{
+    if (size < MPEG_HEADER_SIZE || data[0] != 0xFF || (data[1] & 0xE0) != 0xE0) { // 0xE0: rest of the sync word
+        return false;
+    }
+    uint32_t version = (data[1] >> 3) & 0x3; // 3: version bits, 0: 2.5, 1: reserved, 2: mpeg 2, 3: mpeg 1
+    uint32_t layer = 4 - ((data[1] >> 1) & 0x3); // 4: layer bits are 3 for layer I down to 1 for layer III
+    uint32_t bitrateIndex = data[2] >> 4; // 4: bitrate index bits
+    uint32_t sampleRateIndex = (data[2] >> 2) & 0x3; // 2: sample rate index bits
+    uint32_t padding = (data[2] >> 1) & 0x1;
+    if (version == 1 || layer > 3 || bitrateIndex == 0 || bitrateIndex == 15 || sampleRateIndex == 3) { // 3, 15
+        return false;
+    }
+    bool isMpeg1 = version == 3; // 3: mpeg 1
+    uint32_t table = isMpeg1 ? layer - 1 : (layer == 1 ? 3 : 4); // 3, 4: tables of mpeg 2/2.5
+    info.bitrate = MPEG_BITRATES[table][bitrateIndex] * 1000; // 1000: kbps
+    // mpeg 2 halves the mpeg 1 sample rates, mpeg 2.5 quarters them
+    info.sampleRate = MPEG_SAMPLE_RATES[sampleRateIndex] >> (isMpeg1 ? 0 : (version == 2 ? 1 : 2)); // 2: mpeg 2
+    if (layer == 1) {
+        info.samples = 384; // 384: samples of layer I
+        info.size = (12 * info.bitrate / info.sampleRate + padding) * 4; // 12, 4: slots of 4 bytes
+    } else {
+        info.samples = (layer == 3 && !isMpeg1) ? 576 : 1152; // 3, 576, 1152: samples of layer II and III
+        info.size = info.samples / 8 * info.bitrate / info.sampleRate + padding; // 8: bits per byte
+    }
+    return true;
+}
+
+bool ParseAdtsHeader(const uint8_t* data, size_t size, AudioFrameInfo& info)
+{
+    if (size < ADTS_HEADER_SIZE || data[0] != 0xFF || (data[1] & 0xF6) != 0xF0) { // 0xF6: sync word and layer
+        return false;
+    }
+    uint32_t sampleRateIndex = (data[2] >> 2) & 0xF; // 2: sample rate index bits
+    info.size = ((data[3] & 0x3) << 11) | (data[4] << 3) | (data[5] >> 5); // 3, 11, 4, 5: 13 bits of frame length
+    if (sampleRateIndex >= sizeof(ADTS_SAMPLE_RATES) / sizeof(ADTS_SAMPLE_RATES[0]) || info.size < ADTS_HEADER_SIZE) {
+        return false;
+    }
+    info.sampleRate = ADTS_SAMPLE_RATES[sampleRateIndex];
+    info.samples = 1024 * ((data[6] & 0x3) + 1); // 1024: samples per raw data block, 6: number of blocks - 1
+    info.bitrate = static_cast<uint32_t>(static_cast<uint64_t>(info.size) * 8 * info.sampleRate / info.samples); // 8
+    return true;
+}
+
+size_t GetHeaderSize(AudioFrameFormat format)
+{
+    return format == AudioFrameFormat::ADTS ? ADTS_HEADER_SIZE : MPEG_HEADER_SIZE;
+}
+} // namespace
+
+bool ParseAudioFrameHeader(AudioFrameFormat format, const uint8_t* data, size_t size, AudioFrameInfo& info)
+{
+    return format == AudioFrameFormat::ADTS ? ParseAdtsHeader(data, size, info) :
+                                              ParseMpegAudioHeader(data, size, info);
+}
+
+AudioFrameIndex::AudioFrameIndex(AudioFrameFormat format, ReadFunc read) : format_(format), read_(std::move(read))
+{
+}
+
+AudioFrameIndex::~AudioFrameIndex()
+{
+    StopScan();
+}
+
+bool AudioFrameIndex::Init(uint64_t dataStart, uint64_t dataEnd)
+{
+    std::vector<uint8_t> frame(MAX_FRAME_SIZE);
+    frame.resize(read_(dataStart, frame.data(), std::min<uint64_t>(frame.size(), dataEnd - dataStart)));
+    AudioFrameInfo info;
+    if (dataStart >= dataEnd || !ParseAudioFrameHeader(format_, frame.data(), frame.size(), info)) {
+        MEDIA_LOG_W("no frame at " PUBLIC_LOG_U64, dataStart);
+        return false;
+    }
+    dataStart_ = dataStart;
+    dataEnd_ = dataEnd;
+    firstFrame_ = info;
+    tocFrames_ = 0;
+    tocOffsets_.clear();
+    tocStepSamples_ = 0;
+    frame.resize(std::min<size_t>(frame.size(), info.size));
+    if (format_ == AudioFrameFormat::MPEG_AUDIO && ParseVbrHeader(frame)) {
+        uint8_t header[MPEG_HEADER_SIZE];
+        dataStart_ += info.size;
+        if (read_(dataStart_, header, sizeof(header)) == sizeof(header) &&
+            ParseAudioFrameHeader(format_, header, sizeof(header), info)) {
+            firstFrame_ = info;
+        }
+    }
+    OSAL::ScopedLock lock(mutex_);
+    entries_.clear();
+    scannedOffset_ = dataStart_;
+    scannedSamples_ = 0;
+    scannedFrames_ = 0;
+    scanResyncing_ = false;
+    scanDone_ = false;
+    return true;
+}
+
+bool AudioFrameIndex::ParseVbrHeader(const std::vector<uint8_t>& frame)
+{
+    bool isMpeg1 = ((frame[1] >> 3) & 0x3) == 3; // 3: version bits, 3: mpeg 1
+    bool isMono = (frame[3] >> 6) == 3; // 6: channel mode bits, 3: mono
+    size_t pos = MPEG_HEADER_SIZE + (isMpeg1 ? (isMono ? 17 : 32) : (isMono ? 9 : 17)); // side info sizes
+    uint64_t frameStart = dataStart_;
+    if (pos + 8 <= frame.size() && // 8: tag and flags
+        (memcmp(frame.data() + pos, "Xing", 4) == 0 || memcmp(frame.data() + pos, "Info", 4) == 0)) { // 4: tag size
+        uint32_t flags = GetU32(frame.data() + pos + 4); // 4: after the tag
+        pos += 8; // 8: tag and flags
+        uint64_t bytes = dataEnd_ - frameStart;
+        if ((flags & XING_FLAG_FRAMES) && pos + 4 <= frame.size()) { // 4: u32 frame count
+            tocFrames_ = GetU32(frame.data() + pos);
+            pos += 4; // 4: u32 frame count
+        }
+        if ((flags & XING_FLAG_BYTES) && pos + 4 <= frame.size()) { // 4: u32 byte count
+            bytes = std::min<uint64_t>(GetU32(frame.data() + pos), bytes);
+            pos += 4; // 4: u32 byte count
+        }
+        if ((flags & XING_FLAG_TOC) && tocFrames_ > 0 && pos + XING_TOC_SIZE <= frame.size()) {
+            // each entry is the position of 1 percent of the duration, in 1/256 of the bytes
+            for (uint32_t i = 0; i < XING_TOC_SIZE; ++i) {
+                tocOffsets_.push_back(frameStart + frame[pos + i] * bytes / 256); // 256: scale of the entries
+            }
+            tocOffsets_.push_back(frameStart + bytes);
+            tocStepSamples_ = tocFrames_ * firstFrame_.samples / XING_TOC_SIZE;
+        }
+        MEDIA_LOG_I("xing header, " PUBLIC_LOG_U64 " frames", tocFrames_);
+        return true;
+    }
+    if (VBRI_POS + VBRI_TOC_POS <= frame.size() && memcmp(frame.data() + VBRI_POS, "VBRI", 4) == 0) { // 4: tag
+        const uint8_t* vbri = frame.data() + VBRI_POS;
+        tocFrames_ = GetU32(vbri + 14); // 14: after tag, version, delay, quality and bytes
+        uint32_t entries = GetU16(vbri + 18); // 18: toc entry count
+        uint32_t scale = GetU16(vbri + 20); // 20: toc scale
+        uint32_t entrySize = GetU16(vbri + 22); // 22: bytes per toc entry
+        uint32_t framesPerEntry = GetU16(vbri + 24); // 24: frames per toc entry
+        if (entrySize == 0 || entrySize > 4 || VBRI_POS + VBRI_TOC_POS + entries * entrySize > frame.size()) { // 4
+            return true;
+        }
+        uint64_t offset = frameStart;
+        tocOffsets_.push_back(offset);
+        for (uint32_t i = 0; i < entries; ++i) {
+            uint32_t value = 0;
+            for (uint32_t byte = 0; byte < entrySize; ++byte) {
+                value = (value << 8) | vbri[VBRI_TOC_POS + i * entrySize + byte]; // 8: big endian
+            }
+            offset += static_cast<uint64_t>(value) * scale;
+            tocOffsets_.push_back(std::min(offset, dataEnd_));
+        }
+        tocStepSamples_ = static_cast<uint64_t>(framesPerEntry) * firstFrame_.samples;
+        MEDIA_LOG_I("vbri header, " PUBLIC_LOG_U64 " frames", tocFrames_);
+        return true;
+    }
+    return false;
+}
+
+void AudioFrameIndex::StartScan(ReadFunc scanRead)
+{
+    if (scanDone_.load() || scanRead == nullptr) {
+        return;
+    }
+    if (HasToc()) {
+        MEDIA_LOG_I("seeks are estimated from the table of contents, no scan");
+        return;
+    }
+    if (scanTask_ == nullptr) {
+        scanRead_ = std::move(scanRead);
+        // pooled: each iteration scans one chunk and returns
+        scanTask_ = CppExt::make_unique<OSAL::Task>("AudioFrameIndexScan", [this] { ScanOnce(); },
+                                                    OSAL::ThreadPriority::LOW, true);
+    }
+    scanTask_->Start();
+}
+
+void AudioFrameIndex::StopScan()
+{
+    if (scanTask_ != nullptr) {
+        scanTask_->Stop();
+    }
+}
+
+void AudioFrameIndex::ScanOnce()
+{
+    uint64_t offset = scannedOffset_; // only changed by this task
+    size_t headerSize = GetHeaderSize(format_);
+    uint64_t available = dataEnd_ - std::min(offset, dataEnd_);
+    size_t expected = static_cast<size_t>(std::min<uint64_t>(SCAN_CHUNK_SIZE, available));
+    scanBuffer_.resize(SCAN_CHUNK_SIZE);
+    size_t size = expected > 0 ? scanRead_(offset, scanBuffer_.data(), expected) : 0;
+    if (size == 0 && expected > 0 && offset == dataStart_) {
+        MEDIA_LOG_W("scan cannot read the stream, seeks are estimated");
+        scanTask_->StopAsync();
+        return;
+    }
+    const uint8_t* data = scanBuffer_.data();
+    std::vector<IndexEntry> entries;
+    uint64_t samples = scannedSamples_;
+    uint64_t frames = scannedFrames_;
+    size_t pos = 0;
+    bool resyncing = scanResyncing_; // a frame after junk deferred to this chunk is still to be checked and indexed
+    while (pos + headerSize <= size) {
+        AudioFrameInfo info;
+        if (!ParseAudioFrameHeader(format_, data + pos, size - pos, info)) {
+            resyncing = true;
+            ++pos;
+            continue;
+        }
+        size_t nextPos = pos + info.size;
+        if (nextPos > size) {
+            break;
+        }
+        if (resyncing) {
+            // junk between the frames, a frame found after it only counts if the next one follows
+            AudioFrameInfo next;
+            if (nextPos + headerSize > size && offset + nextPos < dataEnd_) {
+                break; // checked in the next chunk
+            }
+            if (nextPos + headerSize <= size && !ParseAudioFrameHeader(format_, data + nextPos, size - nextPos, next)) {
+                ++pos;
+                continue;
+            }
+        }
+        if (frames % INDEX_INTERVAL == 0 || resyncing) { // seeks walk the headers from an entry, never across junk
+            entries.push_back({offset + pos, samples});
+        }
+        resyncing = false;
+        samples += info.samples;
+        ++frames;
+        pos += info.size;
+    }
+    {
+        OSAL::ScopedLock lock(mutex_);
+        entries_.insert(entries_.end(), entries.begin(), entries.end());
+        scannedOffset_ = offset + pos;
+        scannedSamples_ = samples;
+        scannedFrames_ = frames;
+    }
+    scanResyncing_ = resyncing;
+    if (size < expected || size == 0 || pos == 0) {
+        MEDIA_LOG_I("scanned " PUBLIC_LOG_U64 " frames up to " PUBLIC_LOG_U64, frames, offset + pos);
+        scanDone_ = true;
+        scanTask_->StopAsync();
+    }
+}
+
+uint64_t AudioFrameIndex::GetDurationSamples()
+{
+    OSAL::ScopedLock lock(mutex_);
+    if (scanDone_.load()) {
+        return scannedSamples_;
+    }
+    if (tocFrames_ > 0) {
+        return tocFrames_ * firstFrame_.samples;
+    }
+    uint64_t bytes = dataEnd_ - dataStart_;
+    if (scannedSamples_ > 0) {
+        return bytes * scannedSamples_ / (scannedOffset_ - dataStart_);
+    }
+    return bytes * firstFrame_.samples / firstFrame_.size;
+}
+
+bool AudioFrameIndex::FindSeekPosition(uint64_t targetSample, uint64_t& offset, uint64_t& sample)
+{
+    IndexEntry entry {dataStart_, 0};
+    bool indexed = targetSample == 0;
+    {
+        OSAL::ScopedLock lock(mutex_);
+        if (!entries_.empty() && targetSample < scannedSamples_) {
+            auto it = std::upper_bound(entries_.begin(), entries_.end(), targetSample,
+                                       [](uint64_t target, const IndexEntry& e) { return target < e.sample; });
+            entry = *(--it); // the first entry is at sample 0
+            indexed = true;
+        }
+    }
+    if (!indexed) {
+        offset = SyncToFrame(EstimateOffset(targetSample));
+        sample = targetSample;
+        return false;
+    }
+    offset = entry.offset;
+    sample = entry.sample;
+    size_t headerSize = GetHeaderSize(format_);
+    uint8_t header[ADTS_HEADER_SIZE];
+    AudioFrameInfo info;
+    // at most INDEX_INTERVAL frames from the entry to the one containing the target
+    while (read_(offset, header, headerSize) == headerSize &&
+           ParseAudioFrameHeader(format_, header, headerSize, info) && targetSample >= sample + info.samples) {
+        offset += info.size;
+        sample += info.samples;
+    }
+    return true;
+}
+
+uint64_t AudioFrameIndex::EstimateOffset(uint64_t targetSample)
+{
+    uint64_t offset = 0;
+    if (tocOffsets_.size() > 1 && tocStepSamples_ > 0) {
+        uint64_t step = targetSample / tocStepSamples_;
+        if (step + 1 >= tocOffsets_.size()) {
+            return tocOffsets_.back();
+        }
+        uint64_t rest = targetSample % tocStepSamples_;
+        return tocOffsets_[step] + (tocOffsets_[step + 1] - tocOffsets_[step]) * rest / tocStepSamples_;
+    }
+    {
+        OSAL::ScopedLock lock(mutex_);
+        if (scannedSamples_ > 0) {
+            offset = dataStart_ + targetSample * (scannedOffset_ - dataStart_) / scannedSamples_;
+        } else {
+            offset = dataStart_ + targetSample * firstFrame_.size / firstFrame_.samples;
+        }
+    }
+    return std::min(offset, dataEnd_);
+}
+
+uint64_t AudioFrameIndex::SyncToFrame(uint64_t offset)
+{
+    std::vector<uint8_t> window(SYNC_WINDOW_SIZE);
+    uint64_t available = dataEnd_ - std::min(offset, dataEnd_);
+    size_t size = read_(offset, window.data(), std::min<uint64_t>(window.size(), available));
+    AudioFrameInfo info;
+    AudioFrameInfo next;
+    for (size_t pos = 0; pos + GetHeaderSize(format_) <= size; ++pos) {
+        if (ParseAudioFrameHeader(format_, window.data() + pos, size - pos, info) && pos + info.size < size &&
+            ParseAudioFrameHeader(format_, window.data() + pos + info.size, size - pos - info.size, next) &&
+            next.sampleRate == info.sampleRate) {
+            return offset + pos;
+        }
+    }
+    return offset;
+}
+} // namespace Plugin
+} // namespace Media
+} // namespace OHOS
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HISTREAMER_PLUGIN_DEMUXER_AUDIO_FRAME_INDEX_H
+#define HISTREAMER_PLUGIN_DEMUXER_AUDIO_FRAME_INDEX_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "foundation/osal/thread/mutex.h"
+#include "foundation/osal/thread/task.h"
+
+namespace OHOS {
+namespace Media {
+namespace Plugin {
+enum struct AudioFrameFormat : uint8_t {
+    MPEG_AUDIO, // mpeg 1, 2 and 2.5 audio layer I, II and III
+    ADTS,
+};
+
+struct AudioFrameInfo {
+    uint32_t size {0};       // of the whole frame, header included
+    uint32_t samples {0};    // per channel
+    uint32_t sampleRate {0};
+    uint32_t bitrate {0};    // bits per second
+};
+
+/**
+ * Parses the frame header at data, free format mpeg audio frames are not supported.
+ */
+bool ParseAudioFrameHeader(AudioFrameFormat format, const uint8_t* data, size_t size, AudioFrameInfo& info);
+
+/**
+ * Seek index of an elementary mpeg audio or adts stream.
+ *
+ * If the first frame carries a Xing or VBRI table of contents, seeks are estimated from it and moved to the next
+ * frame boundary, nothing is scanned. Otherwise a pooled task scans the frame headers from the start of the stream in
+ * chunks, through a reader of its own which does not disturb the reads of the playback, and keeps the offset and the
+ * first sample of every INDEX_INTERVAL-th frame, and of every frame after junk. Seeks into the scanned part find the
+ * frame containing the target in O(log n) plus at most INDEX_INTERVAL header reads, seeks beyond it are estimated
+ * from the bytes per sample of the scanned part.
+ */
+class AudioFrameIndex {
+public:
+    static constexpr uint32_t INDEX_INTERVAL = 16;
+
+    /// Reads up to size bytes at offset, returns the number of bytes read, 0 at the end of the stream or on errors.
+    using ReadFunc = std::function<size_t(uint64_t offset, uint8_t* data, size_t size)>;
+
+    AudioFrameIndex(AudioFrameFormat format, ReadFunc read);
+    ~AudioFrameIndex();
+
+    /**
+     * Reads the first frame, and its Xing or VBRI table of contents if it has one.
+     *
+     * @param dataStart offset of the first frame, i.e. after an ID3v2 tag
+     * @param dataEnd end of the stream
+     */
+    bool Init(uint64_t dataStart, uint64_t dataEnd);
+
+    /**
+     * Starts scanning the frame headers in the background, unless the first frame has a table of contents.
+     * The scan reads the whole stream, only start it if the source seeks cheaply, without it seeks are estimated.
+     *
+     * @param scanRead reads for the scan, must not go through the cache of the reader given to the constructor, the
+     * scan gives up if it cannot read the first frame
+     */
+    void StartScan(ReadFunc scanRead);
+
+    void StopScan();
+
+    bool IsScanDone() const
+    {
+        return scanDone_.load();
+    }
+
+    /// Whether the first frame has a Xing or VBRI table of contents.
+    bool HasToc() const
+    {
+        return tocOffsets_.size() > 1 && tocStepSamples_ > 0;
+    }
+
+    /// The first audio frame, i.e. not the one carrying the Xing or VBRI header.
+    const AudioFrameInfo& GetFirstFrame() const
+    {
+        return firstFrame_;
+    }
+
+    /**
+     * @return duration in samples, exact once scanned or if the first frame tells the frame count
+     */
+    uint64_t GetDurationSamples();
+
+    /**
+     * @param targetSample sample to seek to, at the sample rate of the first frame
+     * @param offset frame containing targetSample, or the frame boundary closest to the estimate
+     * @param sample first sample of the frame at offset, estimated as well if offset is
+     * @return true if offset and sample are exact
+     */
+    bool FindSeekPosition(uint64_t targetSample, uint64_t& offset, uint64_t& sample);
+
+private:
+    struct IndexEntry {
+        uint64_t offset;
+        uint64_t sample;
+    };
+
+    /// @return true if the frame carries a Xing, Info or VBRI header instead of audio
+    bool ParseVbrHeader(const std::vector<uint8_t>& frame);
+
+    void ScanOnce();
+
+    uint64_t EstimateOffset(uint64_t targetSample);
+
+    uint64_t SyncToFrame(uint64_t offset);
+
+    const AudioFrameFormat format_;
+    ReadFunc read_;
+    ReadFunc scanRead_ {nullptr};
+    uint64_t dataStart_ {0}; // of the first audio frame
+    uint64_t dataEnd_ {0};
+    AudioFrameInfo firstFrame_ {};
+    uint64_t tocFrames_ {0};              // from the Xing or VBRI header, 0 if unknown
+    std::vector<uint64_t> tocOffsets_ {}; // offsets of equal time steps from the start to the end of the stream
+    uint64_t tocStepSamples_ {0};
+
+    OSAL::Mutex mutex_ {};
+    std::vector<IndexEntry> entries_ {};
+    uint64_t scannedOffset_ {0};  // of the next frame to scan
+    uint64_t scannedSamples_ {0}; // before scannedOffset_
+    uint64_t scannedFrames_ {0};
+    bool scanResyncing_ {false}; // junk right before scannedOffset_, only used by the scan task
+    std::atomic<bool> scanDone_ {false};
+    std::vector<uint8_t> scanBuffer_ {};
+    std::unique_ptr<OSAL::Task> scanTask_ {nullptr};
+};
+} // namespace Plugin
+} // namespace Media
+} // namespace OHOS
+#endif // HISTREAMER_PLUGIN_DEMUXER_AUDIO_FRAME_INDEX_H
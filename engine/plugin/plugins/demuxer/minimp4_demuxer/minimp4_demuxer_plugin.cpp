@@ -22,6 +22,7 @@
 #include <new>
 
 #include <securec.h>
+#include "foundation/cpp_ext/memory_ext.h"
 #include "foundation/log.h"
 #include "plugin/common/plugin_buffer.h"
 #include "plugin/common/plugin_time.h"
@@ -44,6 +45,7 @@ constexpr int8_t MP4_HEADER_OFFSET = 4;
 constexpr int8_t RANK_MAX = 100;
 constexpr unsigned int DEFAULT_AUDIO_SAMPLE_PER_FRAME = 1024;
 constexpr unsigned int MEDIA_IO_SIZE = 16 * 1024;
+constexpr uint64_t LAZY_SAMPLE_TABLE_MOOV_SIZE = 512 * 1024; // about half an hour of aac
 int Sniff(const std::string &name, std::shared_ptr<DataSource> dataSource);
 Status RegisterPlugins(const std::shared_ptr<Register> &reg);
 }
@@ -111,6 +113,9 @@ Status MiniMP4DemuxerPlugin::Reset()
     ioContext_.dataSource.reset();
     ioDataRemainSize_ = 0;
     (void)memset_s(inIoBuffer_, inIoBufferSize_, 0x00, inIoBufferSize_);
+    sampleTable_.reset();
+    track_ = Mp4AudioTrack {};
+    sampleIndex_ = 0;
     return Status::OK;
 }
 
@@ -248,19 +253,17 @@ Status MiniMP4DemuxerPlugin::GetMediaInfo(MediaInfo &mediaInfo)
         return Status::ERROR_UNKNOWN;
     }
 
-    if (MP4D_open(&miniMP4_, ReadCallback, reinterpret_cast<void *>(this), fileSize_) == 0) {
-        MEDIA_LOG_E("MP4D_open IS ERROR");
-        return Status::ERROR_MISMATCHED_TYPE;
+    auto ret = OpenTrack();
+    if (ret != Status::OK) {
+        return ret;
     }
     if (AudioAdapterForDecoder() != Status::OK) {
         return Status::ERROR_UNKNOWN;
     }
     mediaInfo.tracks.resize(1);
-    mediaInfo.tracks[0].insert({Tag::AUDIO_SAMPLE_RATE,
-        static_cast<uint32_t>(miniMP4_.track->SampleDescription.audio.samplerate_hz) });
-    mediaInfo.tracks[0].insert({Tag::MEDIA_BITRATE, static_cast<int64_t>(miniMP4_.track->avg_bitrate_bps) });
-    mediaInfo.tracks[0].insert({Tag::AUDIO_CHANNELS,
-        static_cast<uint32_t>(miniMP4_.track->SampleDescription.audio.channelcount) });
+    mediaInfo.tracks[0].insert({Tag::AUDIO_SAMPLE_RATE, track_.sampleRate });
+    mediaInfo.tracks[0].insert({Tag::MEDIA_BITRATE, static_cast<int64_t>(track_.avgBitrate) });
+    mediaInfo.tracks[0].insert({Tag::AUDIO_CHANNELS, track_.channelCount });
     mediaInfo.tracks[0].insert({Tag::TRACK_ID, static_cast<uint32_t>(0) });
     mediaInfo.tracks[0].insert({Tag::MIME, std::string(MEDIA_MIME_AUDIO_AAC) });
     mediaInfo.tracks[0].insert({Tag::AUDIO_MPEG_VERSION, static_cast<uint32_t>(4) }); // 4
@@ -268,36 +271,95 @@ Status MiniMP4DemuxerPlugin::GetMediaInfo(MediaInfo &mediaInfo)
     mediaInfo.tracks[0].insert({Tag::AUDIO_AAC_STREAM_FORMAT, AudioAacStreamFormat::MP4ADTS });
     mediaInfo.tracks[0].insert({Tag::AUDIO_SAMPLE_FORMAT, AudioSampleFormat::S16 });
     mediaInfo.tracks[0].insert({Tag::AUDIO_SAMPLE_PER_FRAME, DEFAULT_AUDIO_SAMPLE_PER_FRAME });
-    if (miniMP4_.track->SampleDescription.audio.channelcount == 1) {
+    if (track_.channelCount == 1) {
         mediaInfo.tracks[0].insert({Tag::AUDIO_CHANNEL_LAYOUT, AudioChannelLayout::MONO });
     } else {
         mediaInfo.tracks[0].insert({Tag::AUDIO_CHANNEL_LAYOUT, AudioChannelLayout::STEREO });
     }
 
-    unsigned int frameSize = 0;
-    unsigned int timeStamp = 0;
-    unsigned int duration = 0;
-    int64_t offset = MP4D_frame_offset(&miniMP4_, 0, 0, &frameSize, &timeStamp, &duration);
+    uint64_t offset = 0;
+    uint32_t frameSize = 0;
+    if (!GetSampleInfo(0, offset, frameSize)) {
+        return Status::ERROR_UNKNOWN;
+    }
     ioDataRemainSize_ = 0;
     ioContext_.offset = offset;
-    MEDIA_LOG_D("samplerate_hz " PUBLIC_LOG_D32,
-        static_cast<uint32_t>(miniMP4_.track->SampleDescription.audio.samplerate_hz));
-    MEDIA_LOG_D("avg_bitrate_bps " PUBLIC_LOG_D32, static_cast<uint32_t>(miniMP4_.track->avg_bitrate_bps));
-    MEDIA_LOG_D("channel num " PUBLIC_LOG_D32,
-        static_cast<uint32_t>(miniMP4_.track->SampleDescription.audio.channelcount));
+    MEDIA_LOG_D("samplerate_hz " PUBLIC_LOG_D32, track_.sampleRate);
+    MEDIA_LOG_D("avg_bitrate_bps " PUBLIC_LOG_D32, track_.avgBitrate);
+    MEDIA_LOG_D("channel num " PUBLIC_LOG_D32, track_.channelCount);
     return Status::OK;
 }
 
+Status MiniMP4DemuxerPlugin::OpenTrack()
+{
+    // minimp4 reads the whole moov and keeps every sample table in memory, which takes long for a long recording
+    auto sampleTable = CppExt::make_unique<Mp4SampleTable>([this](uint64_t offset, uint8_t* data, size_t size) {
+        return ReadFromSource(offset, data, size);
+    });
+    if (sampleTable->FindMoov(fileSize_) && sampleTable->GetMoovSize() > LAZY_SAMPLE_TABLE_MOOV_SIZE) {
+        if (!sampleTable->Open()) {
+            MEDIA_LOG_E("no aac track in moov");
+            return Status::ERROR_MISMATCHED_TYPE;
+        }
+        track_ = sampleTable->GetTrack();
+        sampleTable_ = std::move(sampleTable);
+        return Status::OK;
+    }
+    if (MP4D_open(&miniMP4_, ReadCallback, reinterpret_cast<void *>(this), fileSize_) == 0 ||
+        miniMP4_.track == nullptr) {
+        MEDIA_LOG_E("MP4D_open IS ERROR");
+        return Status::ERROR_MISMATCHED_TYPE;
+    }
+    track_.sampleCount = miniMP4_.track->sample_count;
+    track_.channelCount = miniMP4_.track->SampleDescription.audio.channelcount;
+    track_.sampleRate = miniMP4_.track->SampleDescription.audio.samplerate_hz;
+    track_.objectTypeIndication = miniMP4_.track->object_type_indication;
+    track_.avgBitrate = miniMP4_.track->avg_bitrate_bps;
+    track_.dsi.assign(miniMP4_.track->dsi, miniMP4_.track->dsi + miniMP4_.track->dsi_bytes);
+    return Status::OK;
+}
+
+bool MiniMP4DemuxerPlugin::ReadFromSource(uint64_t offset, uint8_t* data, size_t size)
+{
+    auto buffer = std::make_shared<Buffer>();
+    auto bufData = buffer->AllocMemory(nullptr, size);
+    if (ioContext_.dataSource->ReadAt(static_cast<int64_t>(offset), buffer, size) != Status::OK ||
+        bufData->GetSize() != size) {
+        MEDIA_LOG_W("read " PUBLIC_LOG_ZU " bytes at " PUBLIC_LOG_U64 " failed", size, offset);
+        return false;
+    }
+    return memcpy_s(data, size, bufData->GetReadOnlyData(), size) == EOK;
+}
+
+bool MiniMP4DemuxerPlugin::GetSampleInfo(uint32_t index, uint64_t& offset, uint32_t& size)
+{
+    if (sampleTable_ != nullptr) {
+        Mp4Sample sample;
+        if (!sampleTable_->GetSample(index, sample)) {
+            return false;
+        }
+        offset = sample.offset;
+        size = sample.size;
+        return true;
+    }
+    unsigned int frameSize = 0;
+    unsigned int timeStamp = 0;
+    unsigned int duration = 0;
+    offset = MP4D_frame_offset(&miniMP4_, 0, index, &frameSize, &timeStamp, &duration);
+    size = frameSize;
+    return true;
+}
+
 
 void MiniMP4DemuxerPlugin::FillADTSHead(std::shared_ptr<Memory> &data, unsigned int frameSize)
 {
     uint8_t adtsHeader[ADTS_HEADER_SIZE] = {0};
-    unsigned int channelConfig = miniMP4_.track->SampleDescription.audio.channelcount;
+    unsigned int channelConfig = track_.channelCount;
     unsigned int packetLen = frameSize + 7;
     unsigned int samplerateIndex = 0;
     /* 按格式读取信息帧 */
-    uint8_t objectTypeIndication = miniMP4_.track->object_type_indication;
-    samplerateIndex = ((miniMP4_.track->dsi[0] & 0x7) << 1) + (miniMP4_.track->dsi[1] >> 7); // 1,7 按协议取信息帧
+    uint8_t objectTypeIndication = track_.objectTypeIndication;
+    samplerateIndex = ((track_.dsi[0] & 0x7) << 1) + (track_.dsi[1] >> 7); // 1,7 按协议取信息帧
     adtsHeader[0] = static_cast<uint8_t>(0xFF);
     adtsHeader[1] = static_cast<uint8_t>(0xF1);
     adtsHeader[2] = static_cast<uint8_t>(objectTypeIndication) + (samplerateIndex << 2) + (channelConfig >> 2); // 2
@@ -346,18 +408,16 @@ Status MiniMP4DemuxerPlugin::ReadFrame(Buffer &outBuffer, int32_t timeOutMs)
 {
     Status retResult = Status::OK;
     std::shared_ptr<Memory> mp4FrameData;
-    if (sampleIndex_ >= miniMP4_.track->sample_count) {
+    if (sampleIndex_ >= track_.sampleCount) {
         (void)memset_s(inIoBuffer_, MEDIA_IO_SIZE, 0, MEDIA_IO_SIZE);
         ioDataRemainSize_ = 0;
         MEDIA_LOG_D("sampleIndex_ " PUBLIC_LOG_D32, sampleIndex_);
-        MEDIA_LOG_D("miniMP4_.track->sample_count " PUBLIC_LOG_D32, miniMP4_.track->sample_count);
+        MEDIA_LOG_D("sample count " PUBLIC_LOG_D32, track_.sampleCount);
         return Status::END_OF_STREAM;
     }
-    unsigned int frameSize = 0;
-    unsigned int timeStamp = 0;
-    unsigned int duration = 0;
-    uint64_t offset = MP4D_frame_offset(&miniMP4_, 0, sampleIndex_, &frameSize, &timeStamp, &duration);
-    if (offset > fileSize_) {
+    uint64_t offset = 0;
+    uint32_t frameSize = 0;
+    if (!GetSampleInfo(sampleIndex_, offset, frameSize) || offset > fileSize_) {
         return Status::ERROR_UNKNOWN;
     }
     MEDIA_LOG_D("frameSize " PUBLIC_LOG_D32 " offset " PUBLIC_LOG_D32 " sampleIndex_ " PUBLIC_LOG_D32,
@@ -389,21 +449,35 @@ Status MiniMP4DemuxerPlugin::ReadFrame(Buffer &outBuffer, int32_t timeOutMs)
 
 Status MiniMP4DemuxerPlugin::SeekTo(int32_t trackId, int64_t hstTime, SeekMode mode)
 {
+    if (sampleTable_ != nullptr) {
+        // seeks by time to the sync sample before, instead of estimating the position from the bitrate
+        uint64_t dts = static_cast<uint64_t>(std::max<int64_t>(Plugin::HstTime2Ms(hstTime), 0)) *
+            track_.timeScale / 1000; // 1000: ms per second
+        sampleIndex_ = sampleTable_->FindSeekSample(dts);
+        uint64_t offset = 0;
+        uint32_t frameSize = 0;
+        if (!GetSampleInfo(sampleIndex_, offset, frameSize)) {
+            return Status::ERROR_UNKNOWN;
+        }
+        ioContext_.offset = offset;
+        ioDataRemainSize_ = 0;
+        (void)memset_s(inIoBuffer_, inIoBufferSize_, 0x00, inIoBufferSize_);
+        return Status::OK;
+    }
     unsigned int frameSize = 0;
     unsigned int timeStamp = 0;
     unsigned int duration = 0;
     uint64_t offsetStart = MP4D_frame_offset(&miniMP4_, 0, 0, &frameSize, &timeStamp, &duration);
     uint64_t offsetEnd =
-        MP4D_frame_offset(&miniMP4_, 0, miniMP4_.track->sample_count - 1, &frameSize, &timeStamp, &duration);
-    uint64_t targetPos = (Plugin::HstTime2Ms(hstTime) * static_cast<int64_t>(miniMP4_.track->avg_bitrate_bps)) / 8 +
-        offsetStart;
+        MP4D_frame_offset(&miniMP4_, 0, track_.sampleCount - 1, &frameSize, &timeStamp, &duration);
+    uint64_t targetPos = (Plugin::HstTime2Ms(hstTime) * static_cast<int64_t>(track_.avgBitrate)) / 8 + offsetStart;
     if (targetPos >= offsetEnd) {
-        sampleIndex_ = miniMP4_.track->sample_count;
+        sampleIndex_ = track_.sampleCount;
         return Status::OK;
     }
     sampleIndex_ = 0;
     uint64_t tempPos = 0;
-    while (sampleIndex_ < miniMP4_.track->sample_count) {
+    while (sampleIndex_ < track_.sampleCount) {
         tempPos = MP4D_frame_offset(&miniMP4_, 0, sampleIndex_, &frameSize, &timeStamp, &duration);
         if (tempPos < targetPos) {
             sampleIndex_++;
@@ -425,18 +499,18 @@ size_t MiniMP4DemuxerPlugin::GetFileSize()
 
 Status MiniMP4DemuxerPlugin::AudioAdapterForDecoder()
 {
-    if (miniMP4_.track == nullptr) {
+    if (track_.dsi.size() < 2) { // 2: sample rate index and channel config
         return Status::ERROR_UNKNOWN;
     }
     /* 适配解码协议 */
-    size_t sampleRateIndex = (static_cast<unsigned int>(miniMP4_.track->dsi[0] & 0x7) << 1) +
-        (static_cast<unsigned int>(miniMP4_.track->dsi[1]) >> 7);
+    size_t sampleRateIndex = (static_cast<unsigned int>(track_.dsi[0] & 0x7) << 1) +
+        (static_cast<unsigned int>(track_.dsi[1]) >> 7);
 
-    if ((sampleRateVec.size() <= sampleRateIndex) || (miniMP4_.track->dsi_bytes >= 20)) { // 20 按协议适配解码器
+    if ((sampleRateVec.size() <= sampleRateIndex) || (track_.dsi.size() >= 20)) { // 20 按协议适配解码器
         return Status::ERROR_MISMATCHED_TYPE;
     }
-    miniMP4_.track->SampleDescription.audio.samplerate_hz = sampleRateVec[sampleRateIndex];
-    miniMP4_.track->SampleDescription.audio.channelcount = (miniMP4_.track->dsi[1] & 0x7F) >> 3; // 3 按协议适配解码器
+    track_.sampleRate = sampleRateVec[sampleRateIndex];
+    track_.channelCount = (track_.dsi[1] & 0x7F) >> 3; // 3 按协议适配解码器
     return Status::OK;
 }
 
@@ -23,6 +23,7 @@
 
 #include "interface/demuxer_plugin.h"
 #include "minimp4.h"
+#include "mp4_sample_table.h"
 
 namespace OHOS {
 namespace Media {
@@ -57,6 +58,9 @@ public:
 private:
     void FillADTSHead(std::shared_ptr<Memory> &data, unsigned int frameSize);
     static int ReadCallback(int64_t offset, void *buffer, size_t size, void *token);
+    bool ReadFromSource(uint64_t offset, uint8_t* data, size_t size);
+    Status OpenTrack();
+    bool GetSampleInfo(uint32_t index, uint64_t& offset, uint32_t& size);
     struct IOContext {
         std::shared_ptr<DataSource> dataSource {nullptr};
         int64_t offset {0};
@@ -65,6 +69,8 @@ private:
     IOContext ioContext_;
     std::shared_ptr<Callback> callback_ {nullptr};
     MP4D_demux_t miniMP4_;
+    std::unique_ptr<Mp4SampleTable> sampleTable_ {nullptr}; // set instead of miniMP4_ for a big moov
+    Mp4AudioTrack track_ {};
     size_t fileSize_;
     unsigned int sampleIndex_;
     std::unique_ptr<MediaInfo> mediaInfo_;
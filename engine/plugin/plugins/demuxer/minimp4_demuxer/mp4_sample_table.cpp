@@ -0,0 +1,548 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define HST_LOG_TAG "Mp4SampleTable"
+
+#include "mp4_sample_table.h"
+#include <algorithm>
+#include "foundation/log.h"
+
+namespace OHOS {
+namespace Media {
+namespace Plugin {
+namespace Minimp4 {
+namespace {
+constexpr uint32_t BOX_HEADER_SIZE = 8;
+constexpr uint32_t LARGE_BOX_HEADER_SIZE = 16;
+constexpr uint32_t ENTRIES_PER_READ = 1024; // 4 to 12 KiB per table read
+constexpr uint32_t STTS_INDEX_STEP = 64;
+constexpr uint32_t MAX_SAMPLE_ENTRY_SIZE = 4096;
+constexpr uint32_t AUDIO_SAMPLE_ENTRY_SIZE = 36; // box header, reserved, data reference index and audio fields
+constexpr uint32_t AUDIO_CHANNEL_COUNT_POS = 24;
+constexpr uint32_t AUDIO_SAMPLE_RATE_POS = 32;
+constexpr uint8_t ES_DESCRIPTOR_TAG = 0x03;
+constexpr uint8_t DECODER_CONFIG_DESCRIPTOR_TAG = 0x04;
+constexpr uint8_t DECODER_SPECIFIC_INFO_TAG = 0x05;
+constexpr uint32_t DECODER_CONFIG_SIZE = 13; // object type, stream type, buffer size, max and avg bitrate
+
+constexpr uint32_t FourCc(const char (&type)[5]) // 5: four characters and the terminating zero
+{
+    return (static_cast<uint32_t>(static_cast<uint8_t>(type[0])) << 24) | // 24: first byte
+           (static_cast<uint32_t>(static_cast<uint8_t>(type[1])) << 16) | // 16: second byte
+           (static_cast<uint32_t>(static_cast<uint8_t>(type[2])) << 8) |  // 2, 8: third byte
+           static_cast<uint32_t>(static_cast<uint8_t>(type[3]));          // 3: fourth byte
+}
+
+uint16_t GetU16(const uint8_t* data)
+{
+    return static_cast<uint16_t>((data[0] << 8) | data[1]); // 8: big endian
+}
+
+uint32_t GetU32(const uint8_t* data)
+{
+    return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) | // 24, 16: big endian
+           (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]);           // 2, 8, 3: big endian
+}
+
+uint64_t GetU64(const uint8_t* data)
+{
+    return (static_cast<uint64_t>(GetU32(data)) << 32) | GetU32(data + 4); // 32, 4: high word first
+}
+
+/**
+ * Reads the tag and the length of an MPEG-4 descriptor, the length takes 1 to 4 bytes of 7 bits.
+ */
+bool ReadDescriptorHeader(const std::vector<uint8_t>& data, size_t& pos, uint8_t& tag, size_t& length)
+{
+    if (pos >= data.size()) {
+        return false;
+    }
+    tag = data[pos++];
+    length = 0;
+    for (int i = 0; i < 4; ++i) { // 4: bytes of the length at most
+        if (pos >= data.size()) {
+            return false;
+        }
+        uint8_t byte = data[pos++];
+        length = (length << 7) | (byte & 0x7F); // 7, 0x7F: bits of each length byte
+        if ((byte & 0x80) == 0) {
+            return pos + length <= data.size();
+        }
+    }
+    return false;
+}
+} // namespace
+
+Mp4SampleTable::Mp4SampleTable(ReadFunc read) : read_(std::move(read))
+{
+}
+
+bool Mp4SampleTable::FindMoov(uint64_t fileSize)
+{
+    return FindBox(0, fileSize, FourCc("moov"), moovOffset_, moovSize_);
+}
+
+bool Mp4SampleTable::FindBox(uint64_t start, uint64_t end, uint32_t type, uint64_t& payload, uint64_t& payloadSize)
+{
+    uint64_t offset = start;
+    uint8_t header[LARGE_BOX_HEADER_SIZE];
+    while (offset + BOX_HEADER_SIZE <= end) {
+        if (!read_(offset, header, BOX_HEADER_SIZE)) {
+            return false;
+        }
+        uint64_t size = GetU32(header);
+        uint32_t headerSize = BOX_HEADER_SIZE;
+        if (size == 1) { // 1: the size follows the type
+            if (offset + LARGE_BOX_HEADER_SIZE > end ||
+                !read_(offset + BOX_HEADER_SIZE, header + BOX_HEADER_SIZE, BOX_HEADER_SIZE)) {
+                return false;
+            }
+            size = GetU64(header + BOX_HEADER_SIZE);
+            headerSize = LARGE_BOX_HEADER_SIZE;
+        } else if (size == 0) { // 0: the box extends to the end
+            size = end - offset;
+        }
+        if (size < headerSize || size > end - offset) {
+            MEDIA_LOG_W("broken box at " PUBLIC_LOG_U64, offset);
+            return false;
+        }
+        if (GetU32(header + 4) == type) { // 4: the type follows the size
+            payload = offset + headerSize;
+            payloadSize = size - headerSize;
+            return true;
+        }
+        offset += size; // a moov after the mdat is found without reading the mdat
+    }
+    return false;
+}
+
+bool Mp4SampleTable::Open()
+{
+    uint64_t moovEnd = moovOffset_ + moovSize_;
+    uint64_t trak = 0;
+    uint64_t trakSize = 0;
+    for (uint64_t start = moovOffset_; FindBox(start, moovEnd, FourCc("trak"), trak, trakSize);
+         start = trak + trakSize) {
+        if (ParseTrak(trak, trakSize)) {
+            MEDIA_LOG_I("audio track with " PUBLIC_LOG_U32 " samples, sample tables stay in the file",
+                        track_.sampleCount);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Mp4SampleTable::ParseTrak(uint64_t trak, uint64_t trakSize)
+{
+    uint64_t mdia = 0;
+    uint64_t mdiaSize = 0;
+    uint64_t box = 0;
+    uint64_t boxSize = 0;
+    uint8_t data[32]; // 32: the largest fields read below, those of a version 1 mdhd
+    if (!FindBox(trak, trak + trakSize, FourCc("mdia"), mdia, mdiaSize) ||
+        !FindBox(mdia, mdia + mdiaSize, FourCc("hdlr"), box, boxSize) || boxSize < 12 || // 12: up to handler type
+        !read_(box, data, 12) || GetU32(data + 8) != FourCc("soun")) { // 12, 8: version, flags, pre defined, type
+        return false;
+    }
+    if (!FindBox(mdia, mdia + mdiaSize, FourCc("mdhd"), box, boxSize) || boxSize < 20 || // 20: version 0 fields
+        !read_(box, data, std::min<uint64_t>(boxSize, sizeof(data)))) {
+        return false;
+    }
+    if (data[0] == 1) { // 1: version with 64 bit times
+        if (boxSize < sizeof(data)) {
+            return false;
+        }
+        track_.timeScale = GetU32(data + 20); // 20: after version, flags, creation and modification time
+        track_.duration = GetU64(data + 24);  // 24: after the time scale
+    } else {
+        track_.timeScale = GetU32(data + 12); // 12: after version, flags, creation and modification time
+        track_.duration = GetU32(data + 16);  // 16: after the time scale
+    }
+    uint64_t minf = 0;
+    uint64_t minfSize = 0;
+    uint64_t stbl = 0;
+    uint64_t stblSize = 0;
+    if (track_.timeScale == 0 || !FindBox(mdia, mdia + mdiaSize, FourCc("minf"), minf, minfSize) ||
+        !FindBox(minf, minf + minfSize, FourCc("stbl"), stbl, stblSize) ||
+        !FindBox(stbl, stbl + stblSize, FourCc("stsd"), box, boxSize) || !ParseStsd(box, boxSize)) {
+        return false;
+    }
+    // stsz: version, flags, sample size and sample count; the entries only if the samples differ in size
+    if (!InitTable(stsz_, stbl, stblSize, FourCc("stsz"), 4, 12) || // 4: u32 entries, 12: header size
+        !read_(stsz_.dataOffset - 8, data, 4)) { // 8: sample size, then sample count, 4: sample size
+        return false;
+    }
+    constSampleSize_ = GetU32(data);
+    track_.sampleCount = stsz_.entryCount;
+    bool hasChunkOffsets = InitTable(stco_, stbl, stblSize, FourCc("stco"), 4) || // 4: u32 offsets
+                           InitTable(stco_, stbl, stblSize, FourCc("co64"), 8);   // 8: u64 offsets
+    if (!hasChunkOffsets || !InitTable(stts_, stbl, stblSize, FourCc("stts"), 8) || // 8: count and delta
+        !InitTable(stsc_, stbl, stblSize, FourCc("stsc"), 12) || stsc_.entryCount == 0) { // 12: three u32
+        return false;
+    }
+    if (!InitTable(stss_, stbl, stblSize, FourCc("stss"), 4)) { // 4: u32 sample numbers
+        stss_ = Table {}; // every sample is a sync sample
+    }
+    cursor_ = Cursor {};
+    sttsIndex_.clear();
+    return track_.sampleCount > 0;
+}
+
+bool Mp4SampleTable::ParseStsd(uint64_t stsd, uint64_t stsdSize)
+{
+    // version, flags and entry count, then the first sample entry, which has to be mp4a
+    constexpr uint32_t stsdHeaderSize = 8;
+    uint8_t header[BOX_HEADER_SIZE];
+    if (stsdSize < stsdHeaderSize + AUDIO_SAMPLE_ENTRY_SIZE || !read_(stsd + stsdHeaderSize, header, BOX_HEADER_SIZE)) {
+        return false;
+    }
+    uint32_t entrySize = GetU32(header);
+    if (GetU32(header + 4) != FourCc("mp4a") || entrySize < AUDIO_SAMPLE_ENTRY_SIZE || // 4: type
+        entrySize > MAX_SAMPLE_ENTRY_SIZE || entrySize > stsdSize - stsdHeaderSize) {
+        return false;
+    }
+    std::vector<uint8_t> entry(entrySize);
+    if (!read_(stsd + stsdHeaderSize, entry.data(), entrySize)) {
+        return false;
+    }
+    track_.channelCount = GetU16(entry.data() + AUDIO_CHANNEL_COUNT_POS);
+    track_.sampleRate = GetU32(entry.data() + AUDIO_SAMPLE_RATE_POS) >> 16; // 16: 16.16 fixed point
+    for (size_t pos = AUDIO_SAMPLE_ENTRY_SIZE; pos + BOX_HEADER_SIZE <= entrySize;) {
+        uint32_t size = GetU32(entry.data() + pos);
+        if (size < BOX_HEADER_SIZE || size > entrySize - pos) {
+            break;
+        }
+        if (GetU32(entry.data() + pos + 4) == FourCc("esds")) { // 4: type
+            return ParseEsds(std::vector<uint8_t>(entry.begin() + pos + BOX_HEADER_SIZE, entry.begin() + pos + size));
+        }
+        pos += size;
+    }
+    return false;
+}
+
+bool Mp4SampleTable::ParseEsds(const std::vector<uint8_t>& esds)
+{
+    size_t pos = 4; // 4: version and flags
+    uint8_t tag = 0;
+    size_t length = 0;
+    if (!ReadDescriptorHeader(esds, pos, tag, length) || tag != ES_DESCRIPTOR_TAG || length < 3) { // 3: id, flags
+        return false;
+    }
+    uint8_t flags = esds[pos + 2]; // 2: after the es id
+    pos += 3; // 3: es id and flags
+    if (flags & 0x80) { // 0x80: stream dependence, the id of the stream follows
+        pos += 2; // 2: depends on es id
+    }
+    if ((flags & 0x40) && pos < esds.size()) { // 0x40: url, its length and the url follow
+        pos += 1 + esds[pos];
+    }
+    if (flags & 0x20) { // 0x20: ocr stream, its id follows
+        pos += 2; // 2: ocr es id
+    }
+    if (!ReadDescriptorHeader(esds, pos, tag, length) || tag != DECODER_CONFIG_DESCRIPTOR_TAG ||
+        length < DECODER_CONFIG_SIZE) {
+        return false;
+    }
+    track_.objectTypeIndication = esds[pos];
+    track_.avgBitrate = GetU32(esds.data() + pos + 9); // 9: object type, stream type, buffer size, max bitrate
+    pos += DECODER_CONFIG_SIZE;
+    if (!ReadDescriptorHeader(esds, pos, tag, length) || tag != DECODER_SPECIFIC_INFO_TAG) {
+        return false;
+    }
+    track_.dsi.assign(esds.begin() + pos, esds.begin() + pos + length);
+    return true;
+}
+
+bool Mp4SampleTable::InitTable(Table& table, uint64_t stbl, uint64_t stblSize, uint32_t type, uint32_t entrySize,
+                               uint32_t headerSize)
+{
+    uint64_t box = 0;
+    uint64_t boxSize = 0;
+    uint8_t count[4]; // 4: u32 entry count, the last field of the header
+    if (!FindBox(stbl, stbl + stblSize, type, box, boxSize) || boxSize < headerSize ||
+        !read_(box + headerSize - 4, count, 4)) { // 4: u32 entry count
+        return false;
+    }
+    table = Table {};
+    table.dataOffset = box + headerSize;
+    table.entryCount = GetU32(count);
+    table.entrySize = entrySize;
+    bool hasEntries = type != FourCc("stsz") || boxSize > headerSize; // stsz of same sized samples has none
+    if (hasEntries && static_cast<uint64_t>(table.entryCount) * entrySize > boxSize - headerSize) {
+        MEDIA_LOG_E("table of " PUBLIC_LOG_U32 " entries doesn't fit into its box", table.entryCount);
+        return false;
+    }
+    return true;
+}
+
+const uint8_t* Mp4SampleTable::GetEntry(Table& table, uint32_t index)
+{
+    if (index >= table.entryCount) {
+        return nullptr;
+    }
+    if (index < table.cacheFirst || index >= table.cacheFirst + table.cacheCount) {
+        uint32_t first = index - index % ENTRIES_PER_READ;
+        uint32_t count = std::min(ENTRIES_PER_READ, table.entryCount - first);
+        table.cache.resize(static_cast<size_t>(count) * table.entrySize);
+        if (!read_(table.dataOffset + static_cast<uint64_t>(first) * table.entrySize, table.cache.data(),
+                   table.cache.size())) {
+            table.cacheCount = 0;
+            return nullptr;
+        }
+        table.cacheFirst = first;
+        table.cacheCount = count;
+    }
+    return table.cache.data() + static_cast<size_t>(index - table.cacheFirst) * table.entrySize;
+}
+
+bool Mp4SampleTable::GetStscEntry(uint32_t index, uint32_t& firstChunk, uint32_t& samplesPerChunk)
+{
+    auto entry = GetEntry(stsc_, index);
+    if (entry == nullptr) {
+        return false;
+    }
+    firstChunk = GetU32(entry) - 1; // stsc counts chunks from 1
+    samplesPerChunk = GetU32(entry + 4); // 4: after the first chunk
+    return samplesPerChunk > 0;
+}
+
+bool Mp4SampleTable::GetSttsEntry(uint32_t index, uint32_t& count, uint32_t& delta)
+{
+    auto entry = GetEntry(stts_, index);
+    if (entry == nullptr) {
+        return false;
+    }
+    count = GetU32(entry);
+    delta = GetU32(entry + 4); // 4: after the sample count
+    return true;
+}
+
+bool Mp4SampleTable::GetChunkOffset(uint32_t chunk, uint64_t& offset)
+{
+    auto entry = GetEntry(stco_, chunk);
+    if (entry == nullptr) {
+        return false;
+    }
+    offset = stco_.entrySize == 8 ? GetU64(entry) : GetU32(entry); // 8: co64
+    return true;
+}
+
+uint32_t Mp4SampleTable::GetSampleSize(uint32_t index)
+{
+    if (constSampleSize_ != 0) {
+        return constSampleSize_;
+    }
+    auto entry = GetEntry(stsz_, index);
+    return entry == nullptr ? 0 : GetU32(entry);
+}
+
+bool Mp4SampleTable::GetSample(uint32_t index, Mp4Sample& sample)
+{
+    if (index >= track_.sampleCount || !MoveCursorTo(index)) {
+        return false;
+    }
+    sample.offset = cursor_.offset;
+    sample.size = GetSampleSize(index);
+    sample.dts = cursor_.dts;
+    return true;
+}
+
+bool Mp4SampleTable::MoveCursorTo(uint32_t index)
+{
+    if (cursor_.valid && index == cursor_.sample) {
+        return true;
+    }
+    if (cursor_.valid && index == cursor_.sample + 1) {
+        return Advance();
+    }
+    cursor_.valid = false;
+    // the chunk of the sample, each stsc entry is a run of chunks with the same number of samples
+    uint32_t runFirstSample = 0;
+    for (uint32_t entry = 0;; ++entry) {
+        uint32_t firstChunk = 0;
+        uint32_t samplesPerChunk = 0;
+        if (!GetStscEntry(entry, firstChunk, samplesPerChunk)) {
+            return false;
+        }
+        uint32_t nextFirstChunk = stco_.entryCount;
+        uint32_t nextSamplesPerChunk = 0;
+        if (entry + 1 < stsc_.entryCount && !GetStscEntry(entry + 1, nextFirstChunk, nextSamplesPerChunk)) {
+            return false;
+        }
+        if (nextFirstChunk < firstChunk) {
+            return false;
+        }
+        uint64_t runSamples = static_cast<uint64_t>(nextFirstChunk - firstChunk) * samplesPerChunk;
+        if (index < runFirstSample + runSamples || entry + 1 >= stsc_.entryCount) {
+            uint32_t chunkInRun = (index - runFirstSample) / samplesPerChunk;
+            cursor_.stscEntry = entry;
+            cursor_.chunk = firstChunk + chunkInRun;
+            cursor_.chunkFirstSample = runFirstSample + chunkInRun * samplesPerChunk;
+            cursor_.samplesPerChunk = samplesPerChunk;
+            break;
+        }
+        runFirstSample += static_cast<uint32_t>(runSamples);
+    }
+    if (!GetChunkOffset(cursor_.chunk, cursor_.offset)) {
+        return false;
+    }
+    for (uint32_t sample = cursor_.chunkFirstSample; sample < index; ++sample) {
+        cursor_.offset += GetSampleSize(sample);
+    }
+    // the dts of the sample, starting at the closest index point of the stts
+    if (!BuildSttsIndex()) {
+        return false;
+    }
+    auto point = std::upper_bound(sttsIndex_.begin(), sttsIndex_.end(), index,
+                                  [](uint32_t sample, const SttsIndexPoint& p) { return sample < p.sample; });
+    --point; // the first point is at sample 0
+    cursor_.sttsEntry = point->entry;
+    cursor_.sttsFirstSample = point->sample;
+    cursor_.sttsFirstDts = point->dts;
+    for (;;) {
+        uint32_t count = 0;
+        uint32_t delta = 0;
+        if (!GetSttsEntry(cursor_.sttsEntry, count, delta)) {
+            return false;
+        }
+        if (index < cursor_.sttsFirstSample + count || cursor_.sttsEntry + 1 >= stts_.entryCount) {
+            cursor_.dts = cursor_.sttsFirstDts + static_cast<uint64_t>(index - cursor_.sttsFirstSample) * delta;
+            break;
+        }
+        cursor_.sttsFirstSample += count;
+        cursor_.sttsFirstDts += static_cast<uint64_t>(count) * delta;
+        cursor_.sttsEntry++;
+    }
+    cursor_.sample = index;
+    cursor_.valid = true;
+    return true;
+}
+
+bool Mp4SampleTable::Advance()
+{
+    uint32_t next = cursor_.sample + 1;
+    if (next - cursor_.chunkFirstSample < cursor_.samplesPerChunk) {
+        cursor_.offset += GetSampleSize(cursor_.sample);
+    } else {
+        cursor_.chunk++;
+        cursor_.chunkFirstSample = next;
+        uint32_t nextFirstChunk = 0;
+        uint32_t samplesPerChunk = 0;
+        if (cursor_.stscEntry + 1 < stsc_.entryCount &&
+            GetStscEntry(cursor_.stscEntry + 1, nextFirstChunk, samplesPerChunk) && cursor_.chunk >= nextFirstChunk) {
+            cursor_.stscEntry++;
+            cursor_.samplesPerChunk = samplesPerChunk;
+        }
+        if (!GetChunkOffset(cursor_.chunk, cursor_.offset)) {
+            cursor_.valid = false;
+            return false;
+        }
+    }
+    uint32_t count = 0;
+    uint32_t delta = 0;
+    if (!GetSttsEntry(cursor_.sttsEntry, count, delta)) {
+        cursor_.valid = false;
+        return false;
+    }
+    cursor_.dts += delta;
+    if (next - cursor_.sttsFirstSample >= count && cursor_.sttsEntry + 1 < stts_.entryCount) {
+        cursor_.sttsEntry++;
+        cursor_.sttsFirstSample = next;
+        cursor_.sttsFirstDts = cursor_.dts;
+    }
+    cursor_.sample = next;
+    return true;
+}
+
+bool Mp4SampleTable::BuildSttsIndex()
+{
+    if (!sttsIndex_.empty()) {
+        return true;
+    }
+    if (stts_.entryCount == 0) {
+        return false;
+    }
+    uint32_t sample = 0;
+    uint64_t dts = 0;
+    for (uint32_t entry = 0; entry < stts_.entryCount; ++entry) {
+        uint32_t count = 0;
+        uint32_t delta = 0;
+        if (!GetSttsEntry(entry, count, delta)) {
+            sttsIndex_.clear();
+            return false;
+        }
+        if (entry % STTS_INDEX_STEP == 0) {
+            sttsIndex_.push_back({entry, sample, dts});
+        }
+        sample += count;
+        dts += static_cast<uint64_t>(count) * delta;
+    }
+    return true;
+}
+
+uint32_t Mp4SampleTable::FindSeekSample(uint64_t dts)
+{
+    if (!BuildSttsIndex()) {
+        return 0;
+    }
+    auto point = std::upper_bound(sttsIndex_.begin(), sttsIndex_.end(), dts,
+                                  [](uint64_t time, const SttsIndexPoint& p) { return time < p.dts; });
+    --point; // the first point is at dts 0
+    uint64_t target = track_.sampleCount - 1;
+    uint32_t sample = point->sample;
+    uint64_t entryDts = point->dts;
+    for (uint32_t entry = point->entry; entry < stts_.entryCount; ++entry) {
+        uint32_t count = 0;
+        uint32_t delta = 0;
+        if (!GetSttsEntry(entry, count, delta)) {
+            break;
+        }
+        uint64_t entryDuration = static_cast<uint64_t>(count) * delta;
+        if (dts < entryDts + entryDuration) {
+            target = sample + (delta == 0 ? 0 : (dts - entryDts) / delta);
+            break;
+        }
+        sample += count;
+        entryDts += entryDuration;
+    }
+    target = std::min<uint64_t>(target, track_.sampleCount - 1);
+    if (stss_.entryCount == 0) {
+        return static_cast<uint32_t>(target);
+    }
+    // the last sync sample not after the target, stss holds ascending sample numbers counted from 1
+    uint32_t low = 0;
+    uint32_t high = stss_.entryCount;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2; // 2: halves
+        auto entry = GetEntry(stss_, mid);
+        if (entry == nullptr) {
+            return 0;
+        }
+        if (GetU32(entry) - 1 <= target) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == 0) {
+        return 0;
+    }
+    auto entry = GetEntry(stss_, low - 1);
+    return entry == nullptr ? 0 : GetU32(entry) - 1;
+}
+} // namespace Minimp4
+} // namespace Plugin
+} // namespace Media
+} // namespace OHOS
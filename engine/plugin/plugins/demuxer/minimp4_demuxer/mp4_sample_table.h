@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MP4_SAMPLE_TABLE_H
+#define MP4_SAMPLE_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace OHOS {
+namespace Media {
+namespace Plugin {
+namespace Minimp4 {
+/**
+ * What the demuxer needs to know about the audio track, taken from mdhd and the mp4a sample entry.
+ */
+struct Mp4AudioTrack {
+    uint32_t timeScale {0};
+    uint64_t duration {0}; // in timeScale units
+    uint32_t sampleCount {0};
+    uint32_t channelCount {0};
+    uint32_t sampleRate {0};
+    uint32_t objectTypeIndication {0};
+    uint32_t avgBitrate {0};
+    std::vector<uint8_t> dsi {}; // decoder specific info, the AudioSpecificConfig for aac
+};
+
+struct Mp4Sample {
+    uint64_t offset {0};
+    uint32_t size {0};
+    uint64_t dts {0}; // in timeScale units
+};
+
+/**
+ * Sample tables of the first audio track of an mp4 file that stay in the file. Only box headers and the small
+ * boxes are read when the file is opened; stts, stsc, stsz, stco/co64 and stss are read in chunks of entries when
+ * a sample needs them, so a long recording neither takes long to open nor keeps megabytes of tables in memory.
+ *
+ * The moov box is found by walking the top level box headers, a moov after the mdat costs one more read, no matter
+ * how big the mdat is. Reading the samples one after the other costs O(1) per sample, FindSeekSample() uses a
+ * compact index of the stts and binary searches stss.
+ */
+class Mp4SampleTable {
+public:
+    /// Reads size bytes at offset of the file, returns false if they can't be read completely.
+    using ReadFunc = std::function<bool(uint64_t offset, uint8_t* data, size_t size)>;
+
+    explicit Mp4SampleTable(ReadFunc read);
+
+    /**
+     * Finds the moov box. Also fine for files that don't need lazy tables, it tells the moov size.
+     */
+    bool FindMoov(uint64_t fileSize);
+
+    uint64_t GetMoovSize() const
+    {
+        return moovSize_;
+    }
+
+    /**
+     * Parses the moov found by FindMoov() up to the sample tables of the first audio track.
+     */
+    bool Open();
+
+    const Mp4AudioTrack& GetTrack() const
+    {
+        return track_;
+    }
+
+    /**
+     * @param index 0 based sample index, must be less than the sample count
+     */
+    bool GetSample(uint32_t index, Mp4Sample& sample);
+
+    /**
+     * @return the sync sample at or before the sample playing at dts, 0 if there is none
+     */
+    uint32_t FindSeekSample(uint64_t dts);
+
+private:
+    struct Table {
+        uint64_t dataOffset {0}; // of the first entry
+        uint32_t entryCount {0};
+        uint32_t entrySize {0};
+        std::vector<uint8_t> cache {};
+        uint32_t cacheFirst {0};
+        uint32_t cacheCount {0};
+    };
+
+    /// Position of one sample in the stsc and in the stts, so that the next one is found without any search.
+    struct Cursor {
+        bool valid {false};
+        uint32_t sample {0};
+        uint32_t stscEntry {0};
+        uint32_t chunk {0};            // 0 based
+        uint32_t chunkFirstSample {0};
+        uint32_t samplesPerChunk {0};
+        uint64_t offset {0};
+        uint32_t sttsEntry {0};
+        uint32_t sttsFirstSample {0};  // of the stts entry
+        uint64_t sttsFirstDts {0};
+        uint64_t dts {0};
+    };
+
+    /// Every STTS_INDEX_STEP-th stts entry with its first sample and dts.
+    struct SttsIndexPoint {
+        uint32_t entry;
+        uint32_t sample;
+        uint64_t dts;
+    };
+
+    bool FindBox(uint64_t start, uint64_t end, uint32_t type, uint64_t& payload, uint64_t& payloadSize);
+
+    bool ParseTrak(uint64_t trak, uint64_t trakSize);
+
+    bool ParseStsd(uint64_t stsd, uint64_t stsdSize);
+
+    bool ParseEsds(const std::vector<uint8_t>& esds);
+
+    bool InitTable(Table& table, uint64_t stbl, uint64_t stblSize, uint32_t type, uint32_t entrySize,
+                   uint32_t headerSize = 8); // 8: version, flags and entry count
+
+    const uint8_t* GetEntry(Table& table, uint32_t index);
+
+    bool GetStscEntry(uint32_t index, uint32_t& firstChunk, uint32_t& samplesPerChunk);
+
+    bool GetSttsEntry(uint32_t index, uint32_t& count, uint32_t& delta);
+
+    bool GetChunkOffset(uint32_t chunk, uint64_t& offset);
+
+    uint32_t GetSampleSize(uint32_t index);
+
+    bool MoveCursorTo(uint32_t index);
+
+    bool Advance();
+
+    bool BuildSttsIndex();
+
+    ReadFunc read_;
+    uint64_t moovOffset_ {0};
+    uint64_t moovSize_ {0};
+    Mp4AudioTrack track_ {};
+    uint32_t constSampleSize_ {0};
+    Table stts_ {};
+    Table stsc_ {};
+    Table stsz_ {};
+    Table stco_ {};
+    Table stss_ {};
+    Cursor cursor_ {};
+    std::vector<SttsIndexPoint> sttsIndex_ {};
+};
+} // namespace Minimp4
+} // namespace Plugin
+} // namespace Media
+} // namespace OHOS
+#endif // MP4_SAMPLE_TABLE_H
@@ -35,12 +35,22 @@ namespace WavPlugin {
 namespace {
 constexpr uint8_t  MAX_RANK = 100;
 constexpr uint8_t  PROBE_READ_LENGTH  = 4;
-constexpr uint32_t WAV_PER_FRAME_SIZE = 8192;
-constexpr uint32_t WAV_HEAD_INFO_LEN = sizeof(WavHeadAttr);
+constexpr uint32_t RIFF_HEADER_SIZE = 12;   // "RIFF" or "RF64", size and "WAVE"
+constexpr uint32_t CHUNK_HEADER_SIZE = 8;   // id and size
+constexpr uint32_t CHUNK_ID_SIZE = 4;
+constexpr uint32_t DS64_MIN_SIZE = 24;      // riff size, data size and sample count, 64 bits each
+constexpr uint32_t FMT_MIN_SIZE = 16;
+constexpr uint32_t FMT_EXTENSIBLE_SIZE = 40;
+constexpr uint32_t FMT_SUB_FORMAT_POS = 24; // the sub format guid of WAVE_FORMAT_EXTENSIBLE starts with the format
+constexpr uint32_t RF64_SIZE_IN_DS64 = 0xFFFFFFFF;
+constexpr uint32_t MAX_HEADER_CHUNKS = 64;
+constexpr uint32_t PCM_BLOCK_DURATION_MS = 100;
+constexpr size_t   MAX_PCM_BLOCK_SIZE = 1024 * 1024;
 bool WavSniff(const uint8_t *inputBuf);
 std::map<uint32_t, AudioSampleFormat> g_WavAudioSampleFormatPacked = {
     {8, AudioSampleFormat::U8},
     {16, AudioSampleFormat::S16},
+    {24, AudioSampleFormat::S24},
     {32, AudioSampleFormat::S32},
 };
 
@@ -53,6 +63,32 @@ enum class WavAudioFormat {
 };
 int Sniff(const std::string& pluginName, std::shared_ptr<DataSource> dataSource);
 Status RegisterPlugin(const std::shared_ptr<Register>& reg);
+
+uint16_t GetLe16(const uint8_t* data)
+{
+    return static_cast<uint16_t>(data[0] | (data[1] << 8)); // 8: little endian
+}
+
+uint32_t GetLe32(const uint8_t* data)
+{
+    return GetLe16(data) | (static_cast<uint32_t>(GetLe16(data + 2)) << 16); // 2, 16: little endian
+}
+
+uint64_t GetLe64(const uint8_t* data)
+{
+    return GetLe32(data) | (static_cast<uint64_t>(GetLe32(data + 4)) << 32); // 4, 32: little endian
+}
+
+// split in seconds and the rest so that neither overflows, whatever the size of the file
+uint64_t BytesToHstTime(uint64_t bytes, uint32_t byteRate)
+{
+    return bytes / byteRate * HST_SECOND + bytes % byteRate * HST_SECOND / byteRate;
+}
+
+uint64_t HstTimeToBytes(uint64_t hstTime, uint32_t byteRate)
+{
+    return hstTime / HST_SECOND * byteRate + hstTime % HST_SECOND * byteRate / HST_SECOND;
+}
 }
 
 WavDemuxerPlugin::WavDemuxerPlugin(std::string name)
@@ -61,8 +97,9 @@ WavDemuxerPlugin::WavDemuxerPlugin(std::string name)
       ioContext_(),
       dataOffset_(0),
       isSeekable_(true),
-      wavHeadLength_(0),
-      wavHeader_(nullptr)
+      dataStart_(0),
+      dataEnd_(0),
+      blockSize_(0)
 {
     MEDIA_LOG_I("WavDemuxerPlugin, plugin name: " PUBLIC_LOG_S, pluginName_.c_str());
 }
@@ -85,99 +122,206 @@ Status WavDemuxerPlugin::SetDataSource(const std::shared_ptr<DataSource>& source
     return Status::OK;
 }
 
-Status WavDemuxerPlugin::GetMediaInfo(MediaInfo& mediaInfo)
+Status WavDemuxerPlugin::ReadHeaderData(uint64_t offset, uint8_t* data, size_t size)
 {
     auto buffer = std::make_shared<Buffer>();
-    auto bufData = buffer->AllocMemory(nullptr, WAV_HEAD_INFO_LEN);
-    Status status = ioContext_.dataSource->ReadAt(0, buffer, WAV_HEAD_INFO_LEN);
-    if (status != Status::OK) {
-        return status;
+    auto bufData = buffer->AllocMemory(nullptr, size);
+    Status status = ioContext_.dataSource->ReadAt(static_cast<int64_t>(offset), buffer, size);
+    FALSE_RETURN_V_MSG_W(status == Status::OK, status, "read header at " PUBLIC_LOG_U64 " failed", offset);
+    FALSE_RETURN_V_MSG_W(bufData->GetSize() >= size, Status::ERROR_UNSUPPORTED_FORMAT,
+                         "header truncated at " PUBLIC_LOG_U64, offset);
+    return memcpy_s(data, size, bufData->GetReadOnlyData(), size) == EOK ? Status::OK : Status::ERROR_UNKNOWN;
+}
+
+Status WavDemuxerPlugin::ParseFormatChunk(uint64_t offset, uint64_t chunkSize)
+{
+    FALSE_RETURN_V_MSG_W(chunkSize >= FMT_MIN_SIZE, Status::ERROR_UNSUPPORTED_FORMAT, "fmt chunk too small");
+    uint8_t fmt[FMT_EXTENSIBLE_SIZE] = {0};
+    size_t size = static_cast<size_t>(std::min<uint64_t>(chunkSize, sizeof(fmt)));
+    Status status = ReadHeaderData(offset, fmt, size);
+    FALSE_RETURN_V(status == Status::OK, status);
+    wavHeader_.subChunk1Size = static_cast<uint32_t>(chunkSize);
+    wavHeader_.audioFormat = GetLe16(fmt);
+    wavHeader_.numChannels = GetLe16(fmt + 2);   // 2: after the format
+    wavHeader_.sampleRate = GetLe32(fmt + 4);    // 4: after the channels
+    wavHeader_.byteRate = GetLe32(fmt + 8);      // 8: after the sample rate
+    wavHeader_.blockAlign = GetLe16(fmt + 12);   // 12: after the byte rate
+    wavHeader_.bitsPerSample = GetLe16(fmt + 14); // 14: after the block align
+    if (wavHeader_.audioFormat == static_cast<uint16_t>(WavAudioFormat::WAVE_FORMAT_EXTENSIBLE) &&
+        size >= FMT_EXTENSIBLE_SIZE) {
+        wavHeader_.audioFormat = GetLe16(fmt + FMT_SUB_FORMAT_POS);
     }
-    uint8_t *dataPtr = const_cast<uint8_t *>(bufData->GetReadOnlyData());
-    wavHeader_ = reinterpret_cast<WavHeadAttr *>(dataPtr);
-    if (wavHeader_ == nullptr) {
-        return Status::ERROR_UNKNOWN;
+    FALSE_RETURN_V_MSG_W(wavHeader_.blockAlign > 0 && wavHeader_.byteRate > 0 && wavHeader_.sampleRate > 0,
+                         Status::ERROR_UNSUPPORTED_FORMAT, "invalid fmt chunk");
+    return Status::OK;
+}
+
+/**
+ * Walks the chunks up to the data chunk, skipping the ones of no interest such as bext, LIST or fact. The sizes of
+ * RF64 files over 4 GiB are in the ds64 chunk, the 32 bit sizes of the riff and data chunks are then 0xFFFFFFFF.
+ */
+Status WavDemuxerPlugin::ParseHeader()
+{
+    uint8_t riff[RIFF_HEADER_SIZE];
+    Status status = ReadHeaderData(0, riff, sizeof(riff));
+    FALSE_RETURN_V(status == Status::OK, status);
+    bool isRf64 = memcmp(riff, "RF64", CHUNK_ID_SIZE) == 0 || memcmp(riff, "BW64", CHUNK_ID_SIZE) == 0;
+    FALSE_RETURN_V_MSG_W((isRf64 || memcmp(riff, "RIFF", CHUNK_ID_SIZE) == 0) &&
+                         memcmp(riff + 8, "WAVE", CHUNK_ID_SIZE) == 0, // 8: after the id and the size
+                         Status::ERROR_UNSUPPORTED_FORMAT, "not a wave file");
+    uint64_t ds64DataSize = 0;
+    bool hasFormat = false;
+    uint64_t offset = RIFF_HEADER_SIZE;
+    for (uint32_t i = 0; i < MAX_HEADER_CHUNKS; ++i) {
+        uint8_t chunk[CHUNK_HEADER_SIZE];
+        status = ReadHeaderData(offset, chunk, sizeof(chunk));
+        FALSE_RETURN_V(status == Status::OK, status);
+        uint64_t chunkSize = GetLe32(chunk + CHUNK_ID_SIZE);
+        offset += CHUNK_HEADER_SIZE;
+        if (memcmp(chunk, "ds64", CHUNK_ID_SIZE) == 0 && chunkSize >= DS64_MIN_SIZE) {
+            uint8_t ds64[DS64_MIN_SIZE];
+            status = ReadHeaderData(offset, ds64, sizeof(ds64));
+            FALSE_RETURN_V(status == Status::OK, status);
+            ds64DataSize = GetLe64(ds64 + 8); // 8: after the riff size
+        } else if (memcmp(chunk, "fmt ", CHUNK_ID_SIZE) == 0) {
+            status = ParseFormatChunk(offset, chunkSize);
+            FALSE_RETURN_V(status == Status::OK, status);
+            hasFormat = true;
+        } else if (memcmp(chunk, "data", CHUNK_ID_SIZE) == 0) {
+            FALSE_RETURN_V_MSG_W(hasFormat, Status::ERROR_UNSUPPORTED_FORMAT, "no fmt chunk before the data");
+            uint64_t dataSize = (isRf64 && chunkSize == RF64_SIZE_IN_DS64) ? ds64DataSize : chunkSize;
+            // recorders that stopped early or stream leave the size at 0 or 0xFFFFFFFF
+            bool sizeUnknown = dataSize == 0 || dataSize == RF64_SIZE_IN_DS64;
+            dataStart_ = offset;
+            if (fileSize_ > 0) {
+                dataEnd_ = sizeUnknown ? fileSize_ : std::min<uint64_t>(dataStart_ + dataSize, fileSize_);
+            } else {
+                dataEnd_ = sizeUnknown ? UINT64_MAX : dataStart_ + dataSize;
+            }
+            // blocks of PCM_BLOCK_DURATION_MS, whole sample frames
+            blockSize_ = std::min<size_t>(static_cast<uint64_t>(wavHeader_.byteRate) * PCM_BLOCK_DURATION_MS / 1000,
+                                          MAX_PCM_BLOCK_SIZE); // 1000: ms
+            blockSize_ = std::max<size_t>(blockSize_ - blockSize_ % wavHeader_.blockAlign, wavHeader_.blockAlign);
+            return Status::OK;
+        }
+        offset += chunkSize + (chunkSize & 1); // 1: chunks are padded to an even size
     }
-    wavHeadLength_  = WAV_HEAD_INFO_LEN;
-    if (wavHeader_->audioFormat == static_cast<uint16_t>(WavAudioFormat::WAVE_FORMAT_PCM)) {
-        wavHeadLength_ -= 12; // 12 = subChunk2ID(optional)+subChunk2Size(optional)+dataFactSize(optional)
+    MEDIA_LOG_W("no data chunk found");
+    return Status::ERROR_UNSUPPORTED_FORMAT;
+}
+
+Status WavDemuxerPlugin::GetMediaInfo(MediaInfo& mediaInfo)
+{
+    Status status = ParseHeader();
+    if (status != Status::OK) {
+        return status;
     }
-    MEDIA_LOG_D("wavHeadLength_ " PUBLIC_LOG_U32, wavHeadLength_);
-    dataOffset_ = wavHeadLength_;
+    dataOffset_ = dataStart_;
+    MEDIA_LOG_I("data " PUBLIC_LOG_U64 " to " PUBLIC_LOG_U64 ", block size " PUBLIC_LOG_ZU,
+                dataStart_, dataEnd_, blockSize_);
     mediaInfo.tracks.resize(1);
-    if (wavHeader_->numChannels == 1) {
+    if (wavHeader_.numChannels == 1) {
         mediaInfo.tracks[0].insert({Tag::AUDIO_CHANNEL_LAYOUT, AudioChannelLayout::MONO});
     } else {
         mediaInfo.tracks[0].insert({Tag::AUDIO_CHANNEL_LAYOUT, AudioChannelLayout::STEREO});
     }
-    mediaInfo.tracks[0].insert({Tag::AUDIO_SAMPLE_RATE, static_cast<uint32_t>(wavHeader_->sampleRate)});
-    mediaInfo.tracks[0].insert({Tag::MEDIA_BITRATE, static_cast<int64_t>(wavHeader_->byteRate) * 8}); // 8  byte to bit
-    mediaInfo.tracks[0].insert({Tag::AUDIO_CHANNELS, static_cast<uint32_t>(wavHeader_->numChannels)});
+    mediaInfo.tracks[0].insert({Tag::AUDIO_SAMPLE_RATE, static_cast<uint32_t>(wavHeader_.sampleRate)});
+    mediaInfo.tracks[0].insert({Tag::MEDIA_BITRATE, static_cast<int64_t>(wavHeader_.byteRate) * 8}); // 8  byte to bit
+    mediaInfo.tracks[0].insert({Tag::AUDIO_CHANNELS, static_cast<uint32_t>(wavHeader_.numChannels)});
     mediaInfo.tracks[0].insert({Tag::TRACK_ID, static_cast<uint32_t>(0)});
     mediaInfo.tracks[0].insert({Tag::MIME, std::string(MEDIA_MIME_AUDIO_RAW)});
     mediaInfo.tracks[0].insert({Tag::AUDIO_MPEG_VERSION, static_cast<uint32_t>(1)});
-    mediaInfo.tracks[0].insert({Tag::AUDIO_SAMPLE_PER_FRAME, WAV_PER_FRAME_SIZE});
-    if (wavHeader_->audioFormat == static_cast<uint16_t>(WavAudioFormat::WAVE_FORMAT_PCM)
-        || wavHeader_->audioFormat == static_cast<uint16_t>(WavAudioFormat::WAVE_FORMAT_EXTENSIBLE)) {
+    mediaInfo.tracks[0].insert({Tag::AUDIO_SAMPLE_PER_FRAME,
+                                static_cast<uint32_t>(blockSize_ / wavHeader_.blockAlign)});
+    if (dataEnd_ != UINT64_MAX) {
+        mediaInfo.tracks[0].insert({Tag::MEDIA_DURATION, BytesToHstTime(dataEnd_ - dataStart_, wavHeader_.byteRate)});
+    }
+    if (wavHeader_.audioFormat == static_cast<uint16_t>(WavAudioFormat::WAVE_FORMAT_PCM)
+        || wavHeader_.audioFormat == static_cast<uint16_t>(WavAudioFormat::WAVE_FORMAT_EXTENSIBLE)) {
         mediaInfo.tracks[0].insert({Tag::AUDIO_SAMPLE_FORMAT,
-                                    g_WavAudioSampleFormatPacked[static_cast<uint32_t>(wavHeader_->bitsPerSample)]});
-    } else if (wavHeader_->audioFormat == static_cast<uint16_t>(WavAudioFormat::WAVE_FORMAT_IEEE_FLOAT)) {
+                                    g_WavAudioSampleFormatPacked[static_cast<uint32_t>(wavHeader_.bitsPerSample)]});
+    } else if (wavHeader_.audioFormat == static_cast<uint16_t>(WavAudioFormat::WAVE_FORMAT_IEEE_FLOAT)) {
         mediaInfo.tracks[0].insert({Tag::AUDIO_SAMPLE_FORMAT, AudioSampleFormat::F32});
     } else {
         mediaInfo.tracks[0].insert({Tag::AUDIO_SAMPLE_FORMAT, AudioSampleFormat::NONE});
     }
-    mediaInfo.tracks[0].insert({Tag::BITS_PER_CODED_SAMPLE, static_cast<uint32_t>(wavHeader_->bitsPerSample)});
+    mediaInfo.tracks[0].insert({Tag::BITS_PER_CODED_SAMPLE, static_cast<uint32_t>(wavHeader_.bitsPerSample)});
 
     return Status::OK;
 }
 
+/**
+ * Without memory in the buffer the data source shares its cached data, a block lying in one cached buffer is handed
+ * out as a view of it. A block spanning several, e.g. after a seek, is gathered into one memory for the consumers.
+ */
+Status WavDemuxerPlugin::ReadPcmBlock(Buffer& outBuffer, size_t blockSize, size_t& readSize)
+{
+    bool hasMemory = !outBuffer.IsEmpty();
+    std::shared_ptr<Buffer> block = hasMemory ? std::shared_ptr<Buffer>(&outBuffer, [](Buffer *) {}) :
+                                                std::make_shared<Buffer>();
+    Status retResult = ioContext_.dataSource->ReadAt(static_cast<int64_t>(dataOffset_), block, blockSize);
+    FALSE_RETURN_V_MSG_E(retResult == Status::OK, retResult, "Read Data Error");
+    readSize = 0;
+    for (uint32_t i = 0; i < block->GetMemoryCount(); ++i) {
+        readSize += block->GetMemory(i)->GetSize();
+    }
+    readSize -= readSize % wavHeader_.blockAlign; // a partial sample frame at the end of a truncated file is dropped
+    if (hasMemory) {
+        outBuffer.GetMemory()->UpdateDataSize(readSize);
+    } else if (readSize > 0 && block->GetMemoryCount() == 1) {
+        FALSE_RETURN_V(outBuffer.WrapMemorySlice(block->GetMemory(), 0, readSize) != nullptr, Status::ERROR_UNKNOWN);
+    } else if (readSize > 0) {
+        auto memory = outBuffer.AllocMemory(nullptr, readSize);
+        for (uint32_t i = 0; i < block->GetMemoryCount() && memory->GetSize() < readSize; ++i) {
+            auto view = block->GetMemory(i);
+            memory->Write(view->GetReadOnlyData(), std::min(view->GetSize(), readSize - memory->GetSize()));
+        }
+    }
+    return Status::OK;
+}
+
 Status WavDemuxerPlugin::ReadFrame(Buffer& outBuffer, int32_t timeOutMs)
 {
-    std::shared_ptr<Buffer> outBufferPtr(&outBuffer, [](Buffer *) {});
-    if (outBuffer.IsEmpty()) {
-        outBuffer.AllocMemory(nullptr, WAV_PER_FRAME_SIZE);
+    if (dataOffset_ >= dataEnd_) {
+        return Status::END_OF_STREAM;
     }
-    Status retResult = ioContext_.dataSource->ReadAt(dataOffset_, outBufferPtr, WAV_PER_FRAME_SIZE);
-    dataOffset_ +=  outBuffer.GetMemory()->GetSize();
+    size_t blockSize = static_cast<size_t>(std::min<uint64_t>(blockSize_, dataEnd_ - dataOffset_));
+    if (!outBuffer.IsEmpty()) {
+        size_t capacity = outBuffer.GetMemory()->GetCapacity();
+        blockSize = std::min(blockSize, capacity - capacity % wavHeader_.blockAlign);
+    }
+    size_t readSize = 0;
+    Status retResult = ReadPcmBlock(outBuffer, blockSize, readSize);
     if (retResult != Status::OK) {
-        MEDIA_LOG_E("Read Data Error");
+        return retResult;
+    }
+    if (readSize == 0) {
+        return Status::END_OF_STREAM;
     }
-    return retResult;
+    outBuffer.pts = BytesToHstTime(dataOffset_ - dataStart_, wavHeader_.byteRate);
+    dataOffset_ += readSize;
+    return Status::OK;
 }
 
 Status WavDemuxerPlugin::SeekTo(int32_t trackId, int64_t hstTime, SeekMode mode)
 {
-    if (fileSize_ <= 0 || !isSeekable_) {
+    if (fileSize_ <= 0 || !isSeekable_ || wavHeader_.byteRate == 0) {
         return Status::ERROR_INVALID_OPERATION;
     }
-
-    // time(sec) * byte per second= current time byte number
-    auto position = hstTime * wavHeader_->sampleRate * wavHeader_->numChannels * wavHeader_->byteRate;
-
-    // current time byte number / sample rate * numChannels
-    // To round and position to the starting point of a complete sample.
-    position = position / (wavHeader_->sampleRate * wavHeader_->numChannels) *
-            (wavHeader_->sampleRate * wavHeader_->numChannels);
-    if (position) { // no loop play seek
-        if (mode == SeekMode::SEEK_NEXT_SYNC) {
-            dataOffset_ = dataOffset_ + position;
-        } else if (mode == SeekMode::SEEK_PREVIOUS_SYNC) {
-            dataOffset_ = dataOffset_ - position;
-        }
-    } else {
-        dataOffset_ = position; // loop play seek
-    }
-    if (!dataOffset_) {
-        dataOffset_ = wavHeadLength_;
-    } else if (dataOffset_ >= fileSize_) {
-        dataOffset_ = fileSize_;
-    }
+    // every sample frame is a sync point, the mode makes no difference
+    uint64_t position = HstTimeToBytes(static_cast<uint64_t>(std::max<int64_t>(hstTime, 0)), wavHeader_.byteRate);
+    position -= position % wavHeader_.blockAlign;
+    dataOffset_ = std::min(dataStart_ + position, dataEnd_);
+    MEDIA_LOG_D("seek to " PUBLIC_LOG_D64 ", offset " PUBLIC_LOG_U64, hstTime, dataOffset_);
     return Status::OK;
 }
 
 Status WavDemuxerPlugin::Reset()
 {
     dataOffset_ = 0;
+    dataStart_ = 0;
+    dataEnd_ = 0;
+    blockSize_ = 0;
     fileSize_ = 0;
     isSeekable_ = true;
     return Status::OK;
@@ -223,8 +367,9 @@ Status WavDemuxerPlugin::GetSelectedTracks(std::vector<int32_t>& trackIds)
 namespace {
 bool WavSniff(const uint8_t *inputBuf)
 {
-    // 解析数据起始位置的值，判断是否为wav格式文件
-    return ((inputBuf[0] != 'R') || (inputBuf[1] != 'I') || (inputBuf[2] != 'F') || (inputBuf[3] != 'F')); // 0 1 2 3
+    // 解析数据起始位置的值，判断是否为wav格式文件, files over 4 GiB start with RF64 or BW64
+    return memcmp(inputBuf, "RIFF", CHUNK_ID_SIZE) != 0 && memcmp(inputBuf, "RF64", CHUNK_ID_SIZE) != 0 &&
+           memcmp(inputBuf, "BW64", CHUNK_ID_SIZE) != 0;
 }
 int Sniff(const std::string& name, std::shared_ptr<DataSource> dataSource)
 {
@@ -76,12 +76,19 @@ private:
         int64_t offset {0};
         bool eos {false};
     };
+    Status ReadHeaderData(uint64_t offset, uint8_t* data, size_t size);
+    Status ParseFormatChunk(uint64_t offset, uint64_t chunkSize);
+    Status ParseHeader();
+    Status ReadPcmBlock(Buffer& outBuffer, size_t blockSize, size_t& readSize);
+
     size_t              fileSize_;
     IOContext           ioContext_;
-    uint32_t            dataOffset_;
+    uint64_t            dataOffset_;    // of the next sample frame to read
     bool                isSeekable_;
-    uint32_t            wavHeadLength_;
-    WavHeadAttr*        wavHeader_;
+    uint64_t            dataStart_;     // of the data chunk payload
+    uint64_t            dataEnd_;
+    size_t              blockSize_;     // bytes per ReadFrame, whole sample frames
+    WavHeadAttr         wavHeader_ {};  // fmt chunk fields, the chunk sizes are in dataStart_ and dataEnd_
 };
 } // namespace WavPlugin
 } // namespace Plugin
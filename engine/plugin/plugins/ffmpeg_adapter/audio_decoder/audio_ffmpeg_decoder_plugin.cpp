@@ -24,6 +24,7 @@
 #include "plugin/common/plugin_caps_builder.h"
 #include "plugin/interface/codec_plugin.h"
 #include "plugins/ffmpeg_adapter/utils/ffmpeg_utils.h"
+#include "utils/audio_format.h"
 #include "utils/constants.h"
 
 namespace {
@@ -499,7 +500,18 @@ Status AudioFfmpegDecoderPlugin::ReceiveFrameSucc(const std::shared_ptr<Buffer>&
         MEDIA_LOG_W("output buffer size is not enough");
         return Status::ERROR_NO_MEMORY;
     }
-    if (av_sample_fmt_is_planar(avCodecContext_->sample_fmt)) {
+    auto format = ConvFf2PSampleFmt(sampleFormat);
+    if (av_sample_fmt_is_planar(sampleFormat) &&
+        IsAudioConvertSupported(format, format, static_cast<uint32_t>(channels))) {
+        // gather all planes in one pass instead of one Memory::Write per channel
+        size_t planarSize = outputSize / channels;
+        uint8_t* planes[MAX_AUDIO_CONVERT_CHANNELS];
+        uint8_t* out = ioInfoMem->GetWritableAddr(outputSize);
+        for (int32_t idx = 0; idx < channels; idx++) {
+            planes[idx] = out + idx * planarSize;
+        }
+        ConvertAudioSamples(cachedFrame_->extended_data, format, planes, format, channels, samples);
+    } else if (av_sample_fmt_is_planar(sampleFormat)) {
         size_t planarSize = outputSize / channels;
         for (int32_t idx = 0; idx < channels; idx++) {
             ioInfoMem->Write(cachedFrame_->extended_data[idx], planarSize);
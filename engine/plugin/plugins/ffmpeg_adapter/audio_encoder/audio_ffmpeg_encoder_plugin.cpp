@@ -16,12 +16,14 @@
 #define HST_LOG_TAG "Ffmpeg_Au_Encoder"
 
 #include "audio_ffmpeg_encoder_plugin.h"
+#include <algorithm>
 #include <cstring>
 #include <map>
 #include <set>
 #include "ffmpeg_au_enc_config.h"
 #include "plugin/common/plugin_caps_builder.h"
 #include "plugins/ffmpeg_adapter/utils/ffmpeg_utils.h"
+#include "utils/audio_format.h"
 
 namespace {
 // register plugins
@@ -255,6 +257,15 @@ Status AudioFfmpegEncoderPlugin::Start()
             srcFmt_ = avCodecContext_->sample_fmt;
             // always use the first fmt
             avCodecContext_->sample_fmt = avCodec_->sample_fmts[0];
+            reSrcFmt_ = ConvFf2PSampleFmt(srcFmt_);
+            reDestFmt_ = ConvFf2PSampleFmt(avCodecContext_->sample_fmt);
+        }
+        if (needReformat_ &&
+            IsAudioConvertSupported(reSrcFmt_, reDestFmt_, static_cast<uint32_t>(avCodecContext_->channels))) {
+            // the rate does not change, FillInFrameCache converts the samples itself instead of going through swr
+            MEDIA_LOG_I("reformat audio with " PUBLIC_LOG_S " kernels", GetAudioConvertIsa());
+            swrCtx_.reset();
+        } else if (needReformat_) {
             SwrContext* swrContext = swr_alloc();
             FALSE_RETURN_V_MSG_E(swrContext != nullptr, Status::ERROR_NO_MEMORY, "cannot allocate swr context");
             swrContext = swr_alloc_set_opts(swrContext, avCodecContext_->channel_layout, avCodecContext_->sample_fmt,
@@ -358,6 +369,27 @@ Status AudioFfmpegEncoderPlugin::SendOutputBuffer()
     return status;
 }
 
+int32_t AudioFfmpegEncoderPlugin::ConvertInputSamples(const std::shared_ptr<Memory>& mem,
+                                                      const std::vector<const uint8_t*>& input)
+{
+    auto channels = static_cast<uint32_t>(avCodecContext_->channels);
+    auto samples = std::min(static_cast<uint32_t>(mem->GetSize() / srcBytesPerSample_),
+                            static_cast<uint32_t>(avCodecContext_->frame_size));
+    size_t planeSize = samples * GetAudioConvertSampleBytes(reDestFmt_);
+    if (resampleCache_.size() < planeSize * channels) {
+        resampleCache_.resize(planeSize * channels);
+    }
+    // the planes follow each other without padding, which is how the frame is set up afterwards
+    std::vector<uint8_t*> output(av_sample_fmt_is_planar(avCodecContext_->sample_fmt) ? channels : 1);
+    for (size_t i = 0; i < output.size(); ++i) {
+        output[i] = resampleCache_.data() + i * planeSize;
+    }
+    if (!ConvertAudioSamples(input.data(), reSrcFmt_, output.data(), reDestFmt_, channels, samples)) {
+        return -1;
+    }
+    return static_cast<int32_t>(samples);
+}
+
 void AudioFfmpegEncoderPlugin::FillInFrameCache(const std::shared_ptr<Memory>& mem)
 {
     uint8_t* sampleData = nullptr;
@@ -371,8 +403,13 @@ void AudioFfmpegEncoderPlugin::FillInFrameCache(const std::shared_ptr<Memory>& m
                 input[i] = input[i-1] + lineSize;
             }
         }
-        auto res = swr_convert(swrCtx_.get(), resampleChannelAddr_.data(), avCodecContext_->frame_size,
-                               input.data(), avCodecContext_->frame_size);
+        int32_t res = -1;
+        if (swrCtx_ == nullptr) {
+            res = ConvertInputSamples(mem, input);
+        } else {
+            res = swr_convert(swrCtx_.get(), resampleChannelAddr_.data(), avCodecContext_->frame_size,
+                              input.data(), avCodecContext_->frame_size);
+        }
         if (res < 0) {
             MEDIA_LOG_E("resample input failed");
             nbSamples = 0;
@@ -89,6 +89,8 @@ private:
 
     bool CheckReformat();
 
+    int32_t ConvertInputSamples(const std::shared_ptr<Memory>& mem, const std::vector<const uint8_t*>& input);
+
     void FillInFrameCache(const std::shared_ptr<Memory>& mem);
 
     Status SendOutputBuffer();
@@ -105,6 +107,8 @@ private:
     uint64_t prev_pts_;
     bool needReformat_ {false};
     AVSampleFormat srcFmt_ {AVSampleFormat::AV_SAMPLE_FMT_NONE};
+    AudioSampleFormat reSrcFmt_ {AudioSampleFormat::NONE};
+    AudioSampleFormat reDestFmt_ {AudioSampleFormat::NONE};
     uint32_t srcBytesPerSample_ {0};
     std::shared_ptr<SwrContext> swrCtx_ {nullptr};
     std::vector<uint8_t> resampleCache_ {};
@@ -526,7 +526,9 @@ int Sniff(const std::string& pluginName, std::shared_ptr<DataSource> dataSource)
         MEDIA_LOG_E("Sniff failed due to empty plugin name or dataSource invalid.");
         return 0;
     }
-    auto plugin = g_pluginInputFormat[pluginName];
+    // sniffers run in parallel, so only look the plugin up
+    auto iter = g_pluginInputFormat.find(pluginName);
+    auto plugin = iter != g_pluginInputFormat.end() ? iter->second : nullptr;
     if (!plugin || !plugin->read_probe) {
         MEDIA_LOG_D("Sniff failed due to invalid plugin for " PUBLIC_LOG_S ".", pluginName.c_str());
         return 0;
@@ -18,6 +18,8 @@
 #define HST_LOG_TAG "FfmpegVideoDecoderPlugin"
 
 #include "video_ffmpeg_decoder_plugin.h"
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
 #include <map>
 #include <set>
@@ -35,6 +37,10 @@ std::map<std::string, std::shared_ptr<const AVCodec>> codecMap;
 
 constexpr size_t BUFFER_QUEUE_SIZE = 8;
 constexpr int32_t STRIDE_ALIGN = 16;
+constexpr uint32_t MAX_DECODE_THREAD_COUNT = 16;
+constexpr int32_t WAIT_DECODE_TIMEOUT_MS = 100;
+constexpr size_t RESERVED_OUT_BUFFER_CNT = 2;
+constexpr int32_t DECODER_OVER_READ_ROWS = 2;
 
 std::set<AVCodecID> supportedCodec = {AV_CODEC_ID_H264};
 
@@ -128,10 +134,6 @@ namespace Plugin {
 VideoFfmpegDecoderPlugin::VideoFfmpegDecoderPlugin(std::string name)
     : CodecPlugin(std::move(name)), outBufferQ_("vdecPluginQueue", BUFFER_QUEUE_SIZE)
 {
-    for (int32_t i = 0; i < AV_NUM_DATA_POINTERS; i++) {
-        scaleData_[i] = nullptr;
-        scaleLineSize_[i] = 0;
-    }
 }
 
 Status VideoFfmpegDecoderPlugin::Init()
@@ -171,6 +173,15 @@ Status VideoFfmpegDecoderPlugin::Deinit()
 Status VideoFfmpegDecoderPlugin::SetParameter(Tag tag, const ValueType& value)
 {
     OSAL::ScopedLock l(avMutex_);
+    if (tag == Tag::VIDEO_DECODE_THREAD_COUNT || tag == Tag::VIDEO_DECODE_THREAD_TYPE) {
+        FALSE_RETURN_V_MSG_E(state_ != State::RUNNING, Status::ERROR_WRONG_STATE,
+                             "decode threads can only be set before Start");
+        FALSE_RETURN_V_MSG_E(value.SameTypeWith(tag == Tag::VIDEO_DECODE_THREAD_COUNT ? typeid(uint32_t) :
+                             typeid(VideoDecodeThreadType)), Status::ERROR_INVALID_PARAMETER,
+                             "parameter " PUBLIC_LOG_D32 " type mismatch", static_cast<int32_t>(tag));
+        videoDecParams_[tag] = value;
+        return Status::OK;
+    }
     videoDecParams_.insert(std::make_pair(tag, value));
     return Status::OK;
 }
@@ -233,6 +244,44 @@ void VideoFfmpegDecoderPlugin::InitCodecContext()
     avCodecContext_->coded_height = 0;
     avCodecContext_->workaround_bugs |= FF_BUG_AUTODETECT;
     avCodecContext_->err_recognition = 1;
+    if ((avCodec_->capabilities & AV_CODEC_CAP_DR1) != 0) {
+        // decode straight into the output buffers, see GetBufferCallback
+        avCodecContext_->opaque = this;
+        avCodecContext_->get_buffer2 = GetBufferCallback;
+#if FF_API_THREAD_SAFE_CALLBACKS
+        avCodecContext_->thread_safe_callbacks = 1;
+#endif
+    }
+    InitCodecThreads();
+}
+
+void VideoFfmpegDecoderPlugin::InitCodecThreads()
+{
+    uint32_t threadCount = 0;
+    auto iter = videoDecParams_.find(Tag::VIDEO_DECODE_THREAD_COUNT);
+    if (iter != videoDecParams_.end()) {
+        threadCount = Plugin::AnyCast<uint32_t>(iter->second);
+    }
+    VideoDecodeThreadType threadType = VideoDecodeThreadType::AUTO;
+    iter = videoDecParams_.find(Tag::VIDEO_DECODE_THREAD_TYPE);
+    if (iter != videoDecParams_.end()) {
+        threadType = Plugin::AnyCast<VideoDecodeThreadType>(iter->second);
+    }
+    // 0 lets ffmpeg start one thread per core
+    avCodecContext_->thread_count = static_cast<int>(std::min(threadCount, MAX_DECODE_THREAD_COUNT));
+    switch (threadType) {
+        case VideoDecodeThreadType::FRAME:
+            avCodecContext_->thread_type = FF_THREAD_FRAME;
+            break;
+        case VideoDecodeThreadType::SLICE:
+            avCodecContext_->thread_type = FF_THREAD_SLICE;
+            break;
+        default:
+            avCodecContext_->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+            break;
+    }
+    MEDIA_LOG_D("decode thread count: " PUBLIC_LOG_U32 ", thread type: " PUBLIC_LOG_U32,
+                threadCount, static_cast<uint32_t>(threadType));
 }
 
 void VideoFfmpegDecoderPlugin::DeinitCodecContext()
@@ -289,6 +338,8 @@ Status VideoFfmpegDecoderPlugin::OpenCodecContext()
         DeinitCodecContext();
         return Status::ERROR_UNKNOWN;
     }
+    MEDIA_LOG_I("decode with " PUBLIC_LOG_D32 " threads, active thread type: " PUBLIC_LOG_D32,
+                avCodecContext_->thread_count, avCodecContext_->active_thread_type);
     MEDIA_LOG_I("OpenCodecContext success");
     return Status::OK;
 }
@@ -335,13 +386,7 @@ Status VideoFfmpegDecoderPlugin::ResetLocked()
     videoDecParams_.clear();
     avCodecContext_.reset();
     outBufferQ_.Clear();
-    if (scaleData_[0] != nullptr) {
-        // av_free(scaleData_[0]); // Maybe free wrong address.
-        for (int32_t i = 0; i < AV_NUM_DATA_POINTERS; i++) {
-            scaleData_[i] = nullptr;
-            scaleLineSize_[i] = 0;
-        }
-    }
+    swsCtx_.reset();
 #ifdef DUMP_RAW_DATA
     if (dumpFd_) {
         std::fclose(dumpFd_);
@@ -390,6 +435,7 @@ Status VideoFfmpegDecoderPlugin::Stop()
         }
 #endif
         state_ = State::INITIALIZED;
+        decodeCond_.NotifyAll();
     }
     outBufferQ_.SetActive(false);
     decodeTask_->Stop();
@@ -407,9 +453,13 @@ Status VideoFfmpegDecoderPlugin::QueueOutputBuffer(const std::shared_ptr<Buffer>
 Status VideoFfmpegDecoderPlugin::Flush()
 {
     OSAL::ScopedLock l(avMutex_);
-    if (avCodecContext_ != nullptr) {
-        // flush avcodec buffers
+    if (avCodecContext_ != nullptr && state_ == State::RUNNING) {
+        // drop the packets and the frames held back by frame threading, they belong to the old position
+        avcodec_flush_buffers(avCodecContext_.get());
     }
+    inputSent_ = true;
+    frameTaken_ = true;
+    decodeCond_.NotifyAll();
     return Status::OK;
 }
 
@@ -423,6 +473,14 @@ Status VideoFfmpegDecoderPlugin::QueueInputBuffer(const std::shared_ptr<Buffer>&
     {
         OSAL::ScopedLock l(avMutex_);
         ret = SendBufferLocked(inputBuffer);
+        if (ret == Status::ERROR_AGAIN) {
+            // the decoder holds a frame nobody has taken yet, give the decode task a chance to take it
+            frameTaken_ = false;
+            decodeCond_.WaitFor(l, WAIT_DECODE_TIMEOUT_MS, [this] {
+                return frameTaken_ || state_ != State::RUNNING;
+            });
+            ret = SendBufferLocked(inputBuffer);
+        }
     }
     NotifyInputBufferDone(inputBuffer);
     MEDIA_LOG_D("QueueInputBuffer ret: " PUBLIC_LOG_U32, ret);
@@ -468,47 +526,29 @@ Status VideoFfmpegDecoderPlugin::SendBufferLocked(const std::shared_ptr<Buffer>&
         packetPtr = &packet;
     }
     auto ret = avcodec_send_packet(avCodecContext_.get(), packetPtr);
+    if (ret == AVERROR(EAGAIN)) {
+        MEDIA_LOG_D("decoder is full, receive frame first");
+        return Status::ERROR_AGAIN;
+    }
     if (ret < 0) {
         MEDIA_LOG_D("send buffer error " PUBLIC_LOG_S, AVStrError(ret).c_str());
         return Status::ERROR_NO_MEMORY;
     }
+    inputSent_ = true;
+    decodeCond_.NotifyAll();
     return Status::OK;
 }
 
 #ifdef DUMP_RAW_DATA
-void VideoFfmpegDecoderPlugin::DumpVideoRawOutData()
+void VideoFfmpegDecoderPlugin::DumpVideoRawOutData(const std::shared_ptr<Buffer>& frameBuffer)
 {
     if (dumpFd_ == nullptr) {
         return;
     }
-    if (pixelFormat_ == VideoPixelFormat::YUV420P) {
-        if (scaleData_[0] != nullptr && scaleLineSize_[0] != 0) {
-            std::fwrite(reinterpret_cast<const char*>(scaleData_[0]),
-                        scaleLineSize_[0] * height_, 1, dumpFd_);
-        }
-        if (scaleData_[1] != nullptr && scaleLineSize_[1] != 0) {
-            std::fwrite(reinterpret_cast<const char*>(scaleData_[1]),
-                        scaleLineSize_[1] * height_ / 2, 1, dumpFd_); // 2
-        }
-        if (scaleData_[2] != nullptr && scaleLineSize_[2] != 0) { // 2
-            std::fwrite(reinterpret_cast<const char*>(scaleData_[2]),
-                        scaleLineSize_[2] * height_ / 2, 1, dumpFd_); // 2
-        }
-    } else if (pixelFormat_ == VideoPixelFormat::NV21 || pixelFormat_ == VideoPixelFormat::NV12) {
-        if (scaleData_[0] != nullptr && scaleLineSize_[0] != 0) {
-            std::fwrite(reinterpret_cast<const char*>(scaleData_[0]),
-                        scaleLineSize_[0] * height_, 1, dumpFd_);
-        }
-        if (scaleData_[1] != nullptr && scaleLineSize_[1] != 0) {
-            std::fwrite(reinterpret_cast<const char*>(scaleData_[1]),
-                        scaleLineSize_[1] * height_ / 2, 1, dumpFd_); // 2
-        }
-    } else if (pixelFormat_ == VideoPixelFormat::RGBA || pixelFormat_ == VideoPixelFormat::ARGB ||
-               pixelFormat_ == VideoPixelFormat::ABGR || pixelFormat_ == VideoPixelFormat::BGRA) {
-        if (scaleData_[0] != nullptr && scaleLineSize_[0] != 0) {
-            std::fwrite(reinterpret_cast<const char*>(scaleData_[0]),
-                        scaleLineSize_[0] * height_, 1, dumpFd_);
-        }
+    auto frameBufferMem = frameBuffer->GetMemory();
+    if (frameBufferMem->GetSize() > 0) {
+        std::fwrite(reinterpret_cast<const char*>(frameBufferMem->GetReadOnlyData()),
+                    frameBufferMem->GetSize(), 1, dumpFd_);
     }
 }
 #endif
@@ -529,215 +569,254 @@ Status VideoFfmpegDecoderPlugin::CreateSwsContext()
         }
     });
     FALSE_RETURN_V_MSG_E(swsCtx_ != nullptr, Status::ERROR_NO_MEMORY, "create swsCtx fail");
-    if (scaleData_[0] == nullptr) {
-        auto ret = av_image_alloc(scaleData_, scaleLineSize_, width_, height_,
-                                  ConvertPixelFormatToFFmpeg(pixelFormat_), STRIDE_ALIGN);
-        FALSE_RETURN_V_MSG_E(ret >= 0, Status::ERROR_UNKNOWN, "av_image_fill_linesizes fail: " PUBLIC_LOG_D32, ret);
-        MEDIA_LOG_E("pixelFormat_: " PUBLIC_LOG_U32 ", pix_fmt: " PUBLIC_LOG_D32,
-                    pixelFormat_, ConvertPixelFormatToFFmpeg(pixelFormat_));
-        for (int32_t i = 0; i < AV_NUM_DATA_POINTERS; i++) {
-            MEDIA_LOG_D("scaleData[" PUBLIC_LOG_D32 "]: " PUBLIC_LOG_P ", scaleLineSize[" PUBLIC_LOG_D32 "]: "
-                        PUBLIC_LOG_D32, i, scaleData_[i], i, scaleLineSize_[i]);
-            if (scaleData_[i] && !scaleLineSize_[i]) {
-                MEDIA_LOG_E("scaleFrame is broken, i: " PUBLIC_LOG_D32, i);
-                return Status::ERROR_UNKNOWN;
-            }
-        }
-    }
     MEDIA_LOG_D("CreateSwsContext success");
     return Status::OK;
 }
 
-Status VideoFfmpegDecoderPlugin::ScaleVideoFrame()
+int32_t VideoFfmpegDecoderPlugin::GetPlaneRows(const std::shared_ptr<Memory>& memory) const
 {
-    if (ConvertPixelFormatFromFFmpeg(static_cast<AVPixelFormat>(cachedFrame_->format)) == pixelFormat_ &&
-        static_cast<uint32_t>(cachedFrame_->width) == width_ &&
-        static_cast<uint32_t>(cachedFrame_->height) == height_) {
-        for (int32_t i = 0; cachedFrame_->linesize[i] > 0; i++) {
-            scaleData_[i] = cachedFrame_->data[i];
-            scaleLineSize_[i] = cachedFrame_->linesize[i];
-        }
-        return Status::OK;
+#ifndef OHOS_LITE
+    if (memory->GetMemoryType() == Plugin::MemoryType::SURFACE_BUFFER) {
+        // the surface layout puts each plane right behind the visible rows of the previous one
+        return static_cast<int32_t>(height_);
     }
-    auto ret = CreateSwsContext();
-    FALSE_RETURN_V_MSG_E(ret == Status::OK, ret, "CreateSwsContext fail: " PUBLIC_LOG_D32, ret);
-    int32_t res = sws_scale(swsCtx_.get(), cachedFrame_->data, cachedFrame_->linesize, 0, cachedFrame_->height,
-                            scaleData_, scaleLineSize_);
-    FALSE_RETURN_V_MSG_E(res >= 0, Status::ERROR_UNKNOWN, "sws_scale fail: " PUBLIC_LOG_D32, ret);
-    MEDIA_LOG_D("ScaleVideoFrame success");
-    return Status::OK;
+#endif
+    // plain memory is laid out on the aligned height, which is what the sinks and the encoder read it with
+    return static_cast<int32_t>(AlignUp(height_, STRIDE_ALIGN));
 }
 
-#ifndef OHOS_LITE
-Status VideoFfmpegDecoderPlugin::WriteYuvDataStride(const std::shared_ptr<Buffer>& frameBuffer, int32_t stride)
+Status VideoFfmpegDecoderPlugin::GetDstPlanes(const std::shared_ptr<Buffer>& frameBuffer,
+                                              uint8_t* dstData[MAX_PLANES], int32_t dstLineSize[MAX_PLANES])
 {
+    auto dstFormat = ConvertPixelFormatToFFmpeg(pixelFormat_);
+    auto ret = av_image_fill_linesizes(dstLineSize, dstFormat, static_cast<int32_t>(AlignUp(width_, STRIDE_ALIGN)));
+    FALSE_RETURN_V_MSG_E(ret >= 0 && dstLineSize[0] > 0, Status::ERROR_UNSUPPORTED_FORMAT,
+                         "av_image_fill_linesizes fail: " PUBLIC_LOG_D32, ret);
     auto frameBufferMem = frameBuffer->GetMemory();
-    size_t srcPos = 0;
-    size_t dstPos = 0;
-    if (pixelFormat_ == VideoPixelFormat::YUV420P) {
-        auto writeSize = scaleLineSize_[0];
-        for (uint32_t colNum = 0; colNum < height_; colNum++) {
-            frameBufferMem->Write(scaleData_[0] + srcPos, writeSize, dstPos);
-            dstPos += stride;
-        }
-        srcPos = 0;
-        writeSize = scaleLineSize_[1];
-        for (uint32_t colNum = 0; colNum < height_; colNum++) {
-            frameBufferMem->Write(scaleData_[1] + srcPos, writeSize, dstPos);
-            dstPos += stride;
-        }
-        srcPos = 0;
-        writeSize = scaleLineSize_[2]; // 2
-        for (uint32_t colNum = 0; colNum < height_; colNum++) {
-            frameBufferMem->Write(scaleData_[2] + srcPos, writeSize, dstPos); // 2
-            dstPos += stride;
-        }
-    } else if ((pixelFormat_ == VideoPixelFormat::NV12) || (pixelFormat_ == VideoPixelFormat::NV21)) {
-        auto writeSize = scaleLineSize_[0];
-        for (uint32_t colNum = 0; colNum < height_; colNum++) {
-            frameBufferMem->Write(scaleData_[0] + srcPos, writeSize, dstPos);
-            dstPos += stride;
-        }
-        srcPos = 0;
-        writeSize = scaleLineSize_[1];
-        for (uint32_t colNum = 0; colNum < height_; colNum++) {
-            frameBufferMem->Write(scaleData_[1] + srcPos, writeSize, dstPos);
-            dstPos += stride;
+#ifndef OHOS_LITE
+    if (frameBufferMem->GetMemoryType() == Plugin::MemoryType::SURFACE_BUFFER) {
+        std::shared_ptr<Plugin::SurfaceMemory> surfaceMemory =
+                Plugin::ReinterpretPointerCast<Plugin::SurfaceMemory>(frameBufferMem);
+        // the surface decides the stride of the first plane, the other planes keep their ratio to it
+        auto stride = static_cast<int64_t>(surfaceMemory->GetSurfaceBufferStride());
+        auto firstLineSize = static_cast<int64_t>(dstLineSize[0]);
+        for (int32_t i = 0; i < MAX_PLANES; ++i) {
+            dstLineSize[i] = static_cast<int32_t>(dstLineSize[i] * stride / firstLineSize);
         }
-    } else {
-        return Status::ERROR_UNSUPPORTED_FORMAT;
     }
-    MEDIA_LOG_D("WriteYuvDataStride success");
+#endif
+    uint8_t* base = frameBufferMem->GetWritableAddr(0);
+    FALSE_RETURN_V_MSG_E(base != nullptr, Status::ERROR_NO_MEMORY, "output buffer has no memory");
+    auto frameSize = av_image_fill_pointers(dstData, dstFormat, GetPlaneRows(frameBufferMem), base, dstLineSize);
+    FALSE_RETURN_V_MSG_E(frameSize > 0, Status::ERROR_UNSUPPORTED_FORMAT,
+                         "av_image_fill_pointers fail: " PUBLIC_LOG_D32, frameSize);
+    FALSE_RETURN_V_MSG_E(frameBufferMem->GetCapacity() >= static_cast<size_t>(frameSize), Status::ERROR_NO_MEMORY,
+                         "output buffer size is not enough: real[" PUBLIC_LOG "zu], need[" PUBLIC_LOG "d]",
+                         frameBufferMem->GetCapacity(), frameSize);
+    frameBufferMem->UpdateDataSize(static_cast<size_t>(frameSize));
     return Status::OK;
 }
 
-Status VideoFfmpegDecoderPlugin::WriteRgbDataStride(const std::shared_ptr<Buffer>& frameBuffer, int32_t stride)
+int VideoFfmpegDecoderPlugin::GetBufferCallback(AVCodecContext* context, AVFrame* frame, int flags)
 {
-    auto frameBufferMem = frameBuffer->GetMemory();
-    if (pixelFormat_ == VideoPixelFormat::RGBA || pixelFormat_ == VideoPixelFormat::ARGB ||
-        pixelFormat_ == VideoPixelFormat::ABGR || pixelFormat_ == VideoPixelFormat::BGRA) {
-        size_t srcPos = 0;
-        size_t dstPos = 0;
-        auto writeSize = scaleLineSize_[0];
-        for (uint32_t colNum = 0; colNum < height_; colNum++) {
-            frameBufferMem->Write(scaleData_[0] + srcPos, writeSize, dstPos);
-            dstPos += stride;
-        }
-    } else {
-        return Status::ERROR_UNSUPPORTED_FORMAT;
+    auto plugin = static_cast<VideoFfmpegDecoderPlugin*>(context->opaque);
+    if (plugin != nullptr && plugin->GetDirectBuffer(context, frame) == 0) {
+        return 0;
     }
-    MEDIA_LOG_D("WriteRgbDataStride success");
-    return Status::OK;
+    // no output buffer to spare or its layout does not suit the decoder, the frame will be copied when received
+    return avcodec_default_get_buffer2(context, frame, flags);
 }
-#endif
 
-Status VideoFfmpegDecoderPlugin::WriteYuvData(const std::shared_ptr<Buffer>& frameBuffer)
+void VideoFfmpegDecoderPlugin::ReleaseDirectBufferCallback(void* opaque, uint8_t* data)
 {
-    auto frameBufferMem = frameBuffer->GetMemory();
-#ifndef OHOS_LITE
-    if (frameBufferMem->GetMemoryType() == Plugin::MemoryType::SURFACE_BUFFER) {
-        std::shared_ptr<Plugin::SurfaceMemory> surfaceMemory =
-                Plugin::ReinterpretPointerCast<Plugin::SurfaceMemory>(frameBufferMem);
-        auto stride = surfaceMemory->GetSurfaceBufferStride();
-        if (stride % width_) {
-            return WriteYuvDataStride(frameBuffer, stride);
-        }
+    static_cast<VideoFfmpegDecoderPlugin*>(opaque)->ReleaseDirectBuffer(data);
+}
+
+int VideoFfmpegDecoderPlugin::GetDirectBuffer(AVCodecContext* context, AVFrame* frame)
+{
+    if (context->codec_type != AVMEDIA_TYPE_VIDEO || frame->format != ConvertPixelFormatToFFmpeg(pixelFormat_) ||
+        static_cast<uint32_t>(context->width) != width_ || static_cast<uint32_t>(context->height) != height_) {
+        return -1;
     }
-#endif
-    size_t ySize = static_cast<size_t>(scaleLineSize_[0] * height_);
-    // AV_PIX_FMT_YUV420P: scaleLineSize_[0] = scaleLineSize_[1] * 2 = scaleLineSize_[2] * 2
-    // AV_PIX_FMT_NV12: scaleLineSize_[0] = scaleLineSize_[1]
-    size_t uvSize = static_cast<size_t>(scaleLineSize_[1] * height_ / 2); // 2
-    size_t frameSize = 0;
-    if (pixelFormat_ == VideoPixelFormat::YUV420P) {
-        frameSize = ySize + (uvSize * 2); // 2
-    } else if (pixelFormat_ == VideoPixelFormat::NV21 || pixelFormat_ == VideoPixelFormat::NV12) {
-        frameSize = ySize + uvSize;
-    }
-    FALSE_RETURN_V_MSG_E(frameBufferMem->GetCapacity() >= frameSize, Status::ERROR_NO_MEMORY,
-                         "output buffer size is not enough: real[" PUBLIC_LOG "zu], need[" PUBLIC_LOG "zu]",
-                         frameBufferMem->GetCapacity(), frameSize);
-    if (pixelFormat_ == VideoPixelFormat::YUV420P) {
-        frameBufferMem->Write(scaleData_[0], ySize);
-        frameBufferMem->Write(scaleData_[1], uvSize);
-        frameBufferMem->Write(scaleData_[2], uvSize); // 2
-    } else if ((pixelFormat_ == VideoPixelFormat::NV12) || (pixelFormat_ == VideoPixelFormat::NV21)) {
-        frameBufferMem->Write(scaleData_[0], ySize);
-        frameBufferMem->Write(scaleData_[1], uvSize);
-    } else {
-        return Status::ERROR_UNSUPPORTED_FORMAT;
+    // reference frames may pin the buffers for long, leave some to the copy path so that decoding never stalls
+    if (outBufferQ_.Size() <= RESERVED_OUT_BUFFER_CNT) {
+        return -1;
+    }
+    auto frameBuffer = outBufferQ_.Pop(0);
+    if (frameBuffer == nullptr) {
+        return -1;
+    }
+    uint8_t* data[MAX_PLANES] = {nullptr};
+    int32_t lineSize[MAX_PLANES] = {0};
+    if (GetDirectPlanes(context, frame, frameBuffer, data, lineSize) != Status::OK) {
+        outBufferQ_.Push(frameBuffer);
+        return -1;
+    }
+    auto memory = frameBuffer->GetMemory();
+    {
+        OSAL::ScopedLock l(directMutex_);
+        directBuffers_[data[0]] = {frameBuffer, false};
+    }
+    // the buffer goes back to the pool once both ffmpeg and the pipeline have dropped it
+    frame->buf[0] = av_buffer_create(data[0], static_cast<int32_t>(memory->GetCapacity()),
+                                     ReleaseDirectBufferCallback, this, 0);
+    if (frame->buf[0] == nullptr) {
+        ReleaseDirectBuffer(data[0]);
+        outBufferQ_.Push(frameBuffer);
+        return -1;
+    }
+    for (int32_t i = 0; i < MAX_PLANES; ++i) {
+        frame->data[i] = data[i];
+        frame->linesize[i] = lineSize[i];
     }
-    MEDIA_LOG_D("WriteYuvData success");
+    frame->extended_data = frame->data;
+    return 0;
+}
+
+Status VideoFfmpegDecoderPlugin::GetDirectPlanes(AVCodecContext* context, const AVFrame* frame,
+                                                 const std::shared_ptr<Buffer>& frameBuffer,
+                                                 uint8_t* data[MAX_PLANES], int32_t lineSize[MAX_PLANES])
+{
+    auto bufferMeta = frameBuffer->GetBufferMeta();
+    FALSE_RETURN_V(!frameBuffer->IsEmpty() && bufferMeta != nullptr && bufferMeta->GetType() == BufferMetaType::VIDEO,
+                   Status::ERROR_INVALID_PARAMETER);
+    // same layout as the copy path, so that consumers cannot tell the two apart
+    auto ret = GetDstPlanes(frameBuffer, data, lineSize);
+    FALSE_RETURN_V(ret == Status::OK, ret);
+    int32_t codedWidth = frame->width;
+    int32_t codedHeight = frame->height;
+    int32_t lineAlign[AV_NUM_DATA_POINTERS] = {0};
+    avcodec_align_dimensions2(context, &codedWidth, &codedHeight, lineAlign);
+    int32_t minLineSize[MAX_PLANES] = {0};
+    FALSE_RETURN_V(av_image_fill_linesizes(minLineSize, static_cast<AVPixelFormat>(frame->format), codedWidth) >= 0,
+                   Status::ERROR_UNSUPPORTED_FORMAT);
+    for (int32_t i = 0; i < MAX_PLANES && data[i] != nullptr; ++i) {
+        int32_t align = std::max(lineAlign[i], 1);
+        FALSE_RETURN_V(lineSize[i] >= minLineSize[i] && lineSize[i] % align == 0 &&
+                       reinterpret_cast<uintptr_t>(data[i]) % static_cast<uintptr_t>(align) == 0,
+                       Status::ERROR_INVALID_PARAMETER);
+    }
+    // the decoder writes whole macroblock rows and its motion compensation reads a few rows past them: the
+    // planes must hold the coded height, and the last plane needs some room behind it
+    auto memory = frameBuffer->GetMemory();
+    FALSE_RETURN_V(codedHeight <= GetPlaneRows(memory) + DECODER_OVER_READ_ROWS, Status::ERROR_INVALID_PARAMETER);
+    auto tailSize = static_cast<size_t>(lineSize[0]) * DECODER_OVER_READ_ROWS + AV_INPUT_BUFFER_PADDING_SIZE;
+    FALSE_RETURN_V(memory->GetCapacity() >= memory->GetSize() + tailSize, Status::ERROR_NO_MEMORY);
     return Status::OK;
 }
 
-Status VideoFfmpegDecoderPlugin::WriteRgbData(const std::shared_ptr<Buffer>& frameBuffer)
+void VideoFfmpegDecoderPlugin::ReleaseDirectBuffer(uint8_t* data)
 {
-    auto frameBufferMem = frameBuffer->GetMemory();
-#ifndef OHOS_LITE
-    if (frameBufferMem->GetMemoryType() == Plugin::MemoryType::SURFACE_BUFFER) {
-        std::shared_ptr<Plugin::SurfaceMemory> surfaceMemory =
-                Plugin::ReinterpretPointerCast<Plugin::SurfaceMemory>(frameBufferMem);
-        auto stride = surfaceMemory->GetSurfaceBufferStride();
-        if (stride % width_) {
-            return WriteRgbDataStride(frameBuffer, stride);
+    std::shared_ptr<Buffer> frameBuffer;
+    {
+        OSAL::ScopedLock l(directMutex_);
+        auto iter = directBuffers_.find(data);
+        if (iter == directBuffers_.end()) {
+            return;
         }
+        frameBuffer = std::move(iter->second.buffer);
+        directBuffers_.erase(iter);
     }
-#endif
-    size_t frameSize = static_cast<size_t>(scaleLineSize_[0] * height_);
-    FALSE_RETURN_V_MSG_E(frameBufferMem->GetCapacity() >= frameSize, Status::ERROR_NO_MEMORY,
-                         "output buffer size is not enough: real[" PUBLIC_LOG "zu], need[" PUBLIC_LOG "zu]",
-                         frameBufferMem->GetCapacity(), frameSize);
-    if (pixelFormat_ == VideoPixelFormat::RGBA || pixelFormat_ == VideoPixelFormat::ARGB ||
-        pixelFormat_ == VideoPixelFormat::ABGR || pixelFormat_ == VideoPixelFormat::BGRA) {
-        frameBufferMem->Write(scaleData_[0], frameSize);
-    } else {
-        return Status::ERROR_UNSUPPORTED_FORMAT;
+    // dropped outside the lock, this may hand the buffer back to the pool
+    frameBuffer.reset();
+}
+
+std::shared_ptr<Buffer> VideoFfmpegDecoderPlugin::TakeDirectBuffer()
+{
+    // cropping moves the plane pointers away from the buffer start, such frames are copied
+    if (cachedFrame_->buf[0] == nullptr || cachedFrame_->data[0] != cachedFrame_->buf[0]->data ||
+        cachedFrame_->format != ConvertPixelFormatToFFmpeg(pixelFormat_) ||
+        static_cast<uint32_t>(cachedFrame_->width) != width_ ||
+        static_cast<uint32_t>(cachedFrame_->height) != height_) {
+        return nullptr;
+    }
+    OSAL::ScopedLock l(directMutex_);
+    auto iter = directBuffers_.find(cachedFrame_->data[0]);
+    // a picture the decoder outputs twice is copied the second time, the first one may still be rendering
+    if (iter == directBuffers_.end() || iter->second.output) {
+        return nullptr;
     }
-    MEDIA_LOG_D("WriteRgbData success");
+    iter->second.output = true;
+    return iter->second.buffer;
+}
+
+Status VideoFfmpegDecoderPlugin::ScaleVideoFrame(uint8_t* dstData[MAX_PLANES], int32_t dstLineSize[MAX_PLANES])
+{
+    if (ConvertPixelFormatFromFFmpeg(static_cast<AVPixelFormat>(cachedFrame_->format)) == pixelFormat_ &&
+        static_cast<uint32_t>(cachedFrame_->width) == width_ &&
+        static_cast<uint32_t>(cachedFrame_->height) == height_) {
+        // same layout, only the strides may differ: copy each plane once straight into the output buffer
+        av_image_copy(dstData, dstLineSize, const_cast<const uint8_t**>(cachedFrame_->data), cachedFrame_->linesize,
+                      static_cast<AVPixelFormat>(cachedFrame_->format), cachedFrame_->width, cachedFrame_->height);
+        return Status::OK;
+    }
+    auto ret = CreateSwsContext();
+    FALSE_RETURN_V_MSG_E(ret == Status::OK, ret, "CreateSwsContext fail: " PUBLIC_LOG_D32, ret);
+    int32_t res = sws_scale(swsCtx_.get(), cachedFrame_->data, cachedFrame_->linesize, 0, cachedFrame_->height,
+                            dstData, dstLineSize);
+    FALSE_RETURN_V_MSG_E(res >= 0, Status::ERROR_UNKNOWN, "sws_scale fail: " PUBLIC_LOG_D32, res);
+    MEDIA_LOG_D("ScaleVideoFrame success");
     return Status::OK;
 }
 
-Status VideoFfmpegDecoderPlugin::FillFrameBuffer(const std::shared_ptr<Buffer>& frameBuffer)
+void VideoFfmpegDecoderPlugin::FillBufferMeta(const std::shared_ptr<Buffer>& frameBuffer,
+                                              const int32_t lineSize[MAX_PLANES])
 {
-    MEDIA_LOG_D("receive one frame: " PUBLIC_LOG_D32 ", picture type: " PUBLIC_LOG_D32 ", pixel format: "
-                PUBLIC_LOG_D32 ", packet size: " PUBLIC_LOG_D32, cachedFrame_->key_frame,
-                static_cast<int32_t>(cachedFrame_->pict_type), cachedFrame_->format, cachedFrame_->pkt_size);
-    FALSE_RETURN_V_MSG_E((cachedFrame_->flags & AV_FRAME_FLAG_CORRUPT) == 0, Status::ERROR_INVALID_DATA,
-                         "decoded frame is corrupt");
-    auto ret = ScaleVideoFrame();
-    FALSE_RETURN_V_MSG_E(ret == Status::OK, ret, "ScaleVideoFrame fail: " PUBLIC_LOG_D32, ret);
     auto bufferMeta = frameBuffer->GetBufferMeta();
     if (bufferMeta != nullptr && bufferMeta->GetType() == BufferMetaType::VIDEO) {
         std::shared_ptr<VideoBufferMeta> videoMeta = ReinterpretPointerCast<VideoBufferMeta>(bufferMeta);
         videoMeta->videoPixelFormat = pixelFormat_;
         videoMeta->height = height_;
         videoMeta->width = width_;
-        for (int i = 0; scaleLineSize_[i] > 0; ++i) {
-            videoMeta->stride.emplace_back(scaleLineSize_[i]);
+        videoMeta->stride.clear();
+        for (int i = 0; i < MAX_PLANES && lineSize[i] > 0; ++i) {
+            videoMeta->stride.emplace_back(lineSize[i]);
         }
         videoMeta->planes = videoMeta->stride.size();
     }
+}
+
+Status VideoFfmpegDecoderPlugin::FillFrameBuffer(const std::shared_ptr<Buffer>& frameBuffer)
+{
+    MEDIA_LOG_D("receive one frame: " PUBLIC_LOG_D32 ", picture type: " PUBLIC_LOG_D32 ", pixel format: "
+                PUBLIC_LOG_D32 ", packet size: " PUBLIC_LOG_D32, cachedFrame_->key_frame,
+                static_cast<int32_t>(cachedFrame_->pict_type), cachedFrame_->format, cachedFrame_->pkt_size);
+    FALSE_RETURN_V_MSG_E((cachedFrame_->flags & AV_FRAME_FLAG_CORRUPT) == 0, Status::ERROR_INVALID_DATA,
+                         "decoded frame is corrupt");
+    auto newFormat = ConvertPixelFormatToFFmpeg(pixelFormat_);
+    FALSE_RETURN_V_MSG_E(IsYuvFormat(newFormat) || IsRgbFormat(newFormat), Status::ERROR_UNSUPPORTED_FORMAT,
+                         "Unsupported pixel format: " PUBLIC_LOG_U32, pixelFormat_);
+    uint8_t* dstData[MAX_PLANES] = {nullptr};
+    int32_t dstLineSize[MAX_PLANES] = {0};
+    auto ret = GetDstPlanes(frameBuffer, dstData, dstLineSize);
+    FALSE_RETURN_V_MSG_E(ret == Status::OK, ret, "GetDstPlanes fail: " PUBLIC_LOG_D32, ret);
+    ret = ScaleVideoFrame(dstData, dstLineSize);
+    FALSE_RETURN_V_MSG_E(ret == Status::OK, ret, "ScaleVideoFrame fail: " PUBLIC_LOG_D32, ret);
+    FillBufferMeta(frameBuffer, dstLineSize);
 #ifdef DUMP_RAW_DATA
-    DumpVideoRawOutData();
+    DumpVideoRawOutData(frameBuffer);
 #endif
-    auto newFormat = ConvertPixelFormatToFFmpeg(pixelFormat_);
-    if (IsYuvFormat(newFormat)) {
-        FALSE_RETURN_V_MSG_E(WriteYuvData(frameBuffer) == Status::OK, Status::ERROR_UNSUPPORTED_FORMAT,
-                             "Unsupported pixel format: " PUBLIC_LOG_U32, pixelFormat_);
-    } else if (IsRgbFormat(newFormat)) {
-        FALSE_RETURN_V_MSG_E(WriteRgbData(frameBuffer) == Status::OK, Status::ERROR_UNSUPPORTED_FORMAT,
-                             "Unsupported pixel format: " PUBLIC_LOG_U32, pixelFormat_);
-    } else {
-        MEDIA_LOG_E("Unsupported pixel format: " PUBLIC_LOG_U32, pixelFormat_);
-        return Status::ERROR_UNSUPPORTED_FORMAT;
-    }
     frameBuffer->pts = static_cast<uint64_t>(cachedFrame_->pts);
     MEDIA_LOG_D("FillFrameBuffer success");
     return Status::OK;
 }
 
-Status VideoFfmpegDecoderPlugin::ReceiveBufferLocked(const std::shared_ptr<Buffer>& frameBuffer)
+Status VideoFfmpegDecoderPlugin::FillDirectFrameBuffer(const std::shared_ptr<Buffer>& frameBuffer)
+{
+    MEDIA_LOG_D("receive one frame decoded in place: " PUBLIC_LOG_D32 ", picture type: " PUBLIC_LOG_D32,
+                cachedFrame_->key_frame, static_cast<int32_t>(cachedFrame_->pict_type));
+    FALSE_RETURN_V_MSG_E((cachedFrame_->flags & AV_FRAME_FLAG_CORRUPT) == 0, Status::ERROR_INVALID_DATA,
+                         "decoded frame is corrupt");
+    // planes and data size were set up in GetBufferCallback, only the meta is left
+    FillBufferMeta(frameBuffer, cachedFrame_->linesize);
+#ifdef DUMP_RAW_DATA
+    DumpVideoRawOutData(frameBuffer);
+#endif
+    frameBuffer->pts = static_cast<uint64_t>(cachedFrame_->pts);
+    return Status::OK;
+}
+
+Status VideoFfmpegDecoderPlugin::ReceiveBufferLocked(std::shared_ptr<Buffer>& frameBuffer)
 {
     if (state_ != State::RUNNING) {
         MEDIA_LOG_W("ReceiveBufferLocked in wrong state: " PUBLIC_LOG_D32, state_);
@@ -746,8 +825,19 @@ Status VideoFfmpegDecoderPlugin::ReceiveBufferLocked(const std::shared_ptr<Buffe
     Status status;
     auto ret = avcodec_receive_frame(avCodecContext_.get(), cachedFrame_.get());
     if (ret >= 0) {
-        status = FillFrameBuffer(frameBuffer);
+        frameTaken_ = true;
+        decodeCond_.NotifyAll();
+        auto directBuffer = TakeDirectBuffer();
+        if (directBuffer != nullptr) {
+            frameBuffer = directBuffer;
+            status = FillDirectFrameBuffer(frameBuffer);
+        } else {
+            status = FillFrameBuffer(frameBuffer);
+        }
+    } else if (ret == AVERROR(EAGAIN)) {
+        status = Status::ERROR_AGAIN;
     } else if (ret == AVERROR_EOF) {
+        // all the frames delayed by frame threading have been drained
         MEDIA_LOG_I("eos received");
         frameBuffer->GetMemory()->Reset();
         frameBuffer->flag |= BUFFER_FLAG_EOS;
@@ -775,13 +865,26 @@ void VideoFfmpegDecoderPlugin::ReceiveFrameBuffer()
         return;
     }
     Status status;
+    auto outBuffer = frameBuffer;
     {
         OSAL::ScopedLock l(avMutex_);
-        status = ReceiveBufferLocked(frameBuffer);
+        status = ReceiveBufferLocked(outBuffer);
+        if (status == Status::ERROR_AGAIN) {
+            // frame threading holds output back until enough packets are queued, wait for the next one
+            // instead of spinning on the codec lock
+            inputSent_ = false;
+            decodeCond_.WaitFor(l, WAIT_DECODE_TIMEOUT_MS, [this] {
+                return inputSent_ || state_ != State::RUNNING;
+            });
+        }
+    }
+    if (outBuffer != frameBuffer) {
+        // the frame was decoded in place, the buffer fetched for copying is not needed
+        outBufferQ_.Push(frameBuffer);
     }
     if (status == Status::OK || status == Status::END_OF_STREAM) {
-        NotifyOutputBufferDone(frameBuffer);
-    } else {
+        NotifyOutputBufferDone(outBuffer);
+    } else if (outBuffer == frameBuffer) {
         outBufferQ_.Push(frameBuffer);
     }
 }
@@ -21,7 +21,7 @@
 #include <functional>
 #include <map>
 #include "osal/thread/task.h"
-#include "utils/blocking_queue.h"
+#include "utils/lock_free_queue.h"
 #include "plugin/interface/codec_plugin.h"
 
 #ifdef __cplusplus
@@ -76,10 +76,14 @@ public:
     }
 
 private:
+    static constexpr int32_t MAX_PLANES = 4; // av_image_* and sws_scale work on up to 4 planes
+
     Status CreateCodecContext();
 
     void InitCodecContext();
 
+    void InitCodecThreads();
+
     void DeinitCodecContext();
 
     void SetCodecExtraData();
@@ -97,27 +101,39 @@ private:
 
     Status CreateSwsContext();
 
-    Status ScaleVideoFrame();
+    int32_t GetPlaneRows(const std::shared_ptr<Memory>& memory) const;
 
-    Status WriteYuvData(const std::shared_ptr<Buffer>& frameBuffer);
+    Status GetDstPlanes(const std::shared_ptr<Buffer>& frameBuffer, uint8_t* dstData[MAX_PLANES],
+                        int32_t dstLineSize[MAX_PLANES]);
 
-    Status WriteRgbData(const std::shared_ptr<Buffer>& frameBuffer);
+    static int GetBufferCallback(AVCodecContext* context, AVFrame* frame, int flags);
 
-#ifndef OHOS_LITE
-    Status WriteYuvDataStride(const std::shared_ptr<Buffer>& frameBuffer, int32_t stride);
+    static void ReleaseDirectBufferCallback(void* opaque, uint8_t* data);
 
-    Status WriteRgbDataStride(const std::shared_ptr<Buffer>& frameBuffer, int32_t stride);
-#endif
+    int GetDirectBuffer(AVCodecContext* context, AVFrame* frame);
+
+    Status GetDirectPlanes(AVCodecContext* context, const AVFrame* frame, const std::shared_ptr<Buffer>& frameBuffer,
+                           uint8_t* data[MAX_PLANES], int32_t lineSize[MAX_PLANES]);
+
+    void ReleaseDirectBuffer(uint8_t* data);
+
+    std::shared_ptr<Buffer> TakeDirectBuffer();
+
+    Status ScaleVideoFrame(uint8_t* dstData[MAX_PLANES], int32_t dstLineSize[MAX_PLANES]);
+
+    void FillBufferMeta(const std::shared_ptr<Buffer>& frameBuffer, const int32_t lineSize[MAX_PLANES]);
 
     Status FillFrameBuffer(const std::shared_ptr<Buffer>& frameBuffer);
 
-    Status ReceiveBufferLocked(const std::shared_ptr<Buffer>& frameBuffer);
+    Status FillDirectFrameBuffer(const std::shared_ptr<Buffer>& frameBuffer);
+
+    Status ReceiveBufferLocked(std::shared_ptr<Buffer>& frameBuffer);
 
     void ReceiveFrameBuffer();
 
 #ifdef DUMP_RAW_DATA
     std::FILE* dumpFd_;
-    void DumpVideoRawOutData();
+    void DumpVideoRawOutData(const std::shared_ptr<Buffer>& frameBuffer);
 #endif
 
     void NotifyInputBufferDone(const std::shared_ptr<Buffer>& input);
@@ -129,9 +145,17 @@ private:
     std::map<Tag, ValueType> videoDecParams_ {};
     std::vector<uint8_t> paddedBuffer_;
     size_t paddedBufferSize_ {0};
+
+    // pipeline buffers lent to the decoder by GetBufferCallback, keyed by the address of their first plane.
+    // An entry lives until ffmpeg drops its last reference to the frame, reference frames included.
+    struct DirectBuffer {
+        std::shared_ptr<Buffer> buffer;
+        bool output {false};
+    };
+    OSAL::Mutex directMutex_ {};
+    std::map<const uint8_t*, DirectBuffer> directBuffers_ {};
+
     std::shared_ptr<AVFrame> cachedFrame_ {nullptr};
-    uint8_t* scaleData_[AV_NUM_DATA_POINTERS];
-    int32_t scaleLineSize_[AV_NUM_DATA_POINTERS];
     DataCallback* dataCb_ {};
 
     uint32_t width_;
@@ -139,9 +163,12 @@ private:
     VideoPixelFormat pixelFormat_;
 
     mutable OSAL::Mutex avMutex_ {};
+    OSAL::ConditionVariable decodeCond_ {};
+    bool inputSent_ {false};
+    bool frameTaken_ {false};
     State state_ {State::CREATED};
     std::shared_ptr<AVCodecContext> avCodecContext_ {};
-    OHOS::Media::BlockingQueue<std::shared_ptr<Buffer>> outBufferQ_;
+    OHOS::Media::LockFreeQueue<std::shared_ptr<Buffer>> outBufferQ_;
     std::shared_ptr<OHOS::Media::OSAL::Task> decodeTask_;
 };
 }
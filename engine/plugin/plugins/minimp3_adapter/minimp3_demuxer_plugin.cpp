@@ -20,6 +20,7 @@
 #include <cstdio>
 #include <cstring>
 #include <new>
+#include "foundation/cpp_ext/memory_ext.h"
 #include "foundation/log.h"
 #include "osal/thread/scoped_lock.h"
 #include "plugin/common/plugin_buffer.h"
@@ -97,6 +98,7 @@ Status Minimp3DemuxerPlugin::SetDataSource(const std::shared_ptr<DataSource>& so
 
 Status Minimp3DemuxerPlugin::DoReadFromSource(uint32_t readSize)
 {
+    OSAL::ScopedLock lock(readMutex_);
     auto buffer = std::make_shared<Buffer>();
     auto bufData = buffer->AllocMemory(nullptr, readSize);
     int retryTimes = 0;
@@ -133,6 +135,34 @@ Status Minimp3DemuxerPlugin::DoReadFromSource(uint32_t readSize)
     return Status::OK;
 }
 
+size_t Minimp3DemuxerPlugin::ReadForFrameIndex(uint64_t offset, uint8_t* data, size_t size, bool direct)
+{
+    auto buffer = std::make_shared<Buffer>();
+    auto bufData = buffer->AllocMemory(nullptr, size);
+    FALSE_RETURN_V(ioContext_.dataSource != nullptr, 0);
+    Status ret;
+    if (direct) {
+        // around the data cached for the playback, so it neither waits for nor disturbs the reads of the frames
+        ret = ioContext_.dataSource->ReadAtDirect(offset, buffer, size);
+    } else {
+        OSAL::ScopedLock lock(readMutex_);
+        ret = ioContext_.dataSource->ReadAt(offset, buffer, size);
+    }
+    if (ret != Status::OK) {
+        return 0;
+    }
+    size_t readSize = std::min(size, bufData->GetSize());
+    (void)memcpy_s(data, size, bufData->GetReadOnlyData(), readSize);
+    return readSize;
+}
+
+AudioFrameIndex::ReadFunc Minimp3DemuxerPlugin::GetFrameIndexReader(bool direct)
+{
+    return [this, direct](uint64_t offset, uint8_t* data, size_t size) {
+        return ReadForFrameIndex(offset, data, size, direct);
+    };
+}
+
 Status Minimp3DemuxerPlugin::GetDataFromSource()
 {
     uint32_t ioNeedReadSize = inIoBufferSize_ - ioDataRemainSize_;
@@ -167,7 +197,12 @@ void Minimp3DemuxerPlugin::FillInMediaInfo(MediaInfo& mediaInfo) const
         mediaInfo.tracks[0].insert({Tag::AUDIO_CHANNEL_LAYOUT, AudioChannelLayout::STEREO});
     }
     int64_t durationHst;
-    Ms2HstTime(durationMs, durationHst);
+    if (frameIndex_ != nullptr) {
+        durationHst = static_cast<int64_t>(frameIndex_->GetDurationSamples() * HST_SECOND /
+                                           frameIndex_->GetFirstFrame().sampleRate);
+    } else {
+        Ms2HstTime(durationMs, durationHst);
+    }
     mediaInfo.tracks[0].insert({Tag::AUDIO_SAMPLE_RATE, static_cast<uint32_t>(mp3DemuxerRst_.frameSampleRate)});
     mediaInfo.tracks[0].insert({Tag::MEDIA_BITRATE, static_cast<int64_t>(mp3DemuxerRst_.frameBitrateKbps)});
     mediaInfo.tracks[0].insert({Tag::AUDIO_CHANNELS, static_cast<uint32_t>(mp3DemuxerRst_.frameChannels)});
@@ -201,6 +236,7 @@ Status Minimp3DemuxerPlugin::GetMediaInfo(MediaInfo& mediaInfo)
                 MEDIA_LOG_D("GetMediaInfo: OK usedInputLength " PUBLIC_LOG_U64, mp3DemuxerRst_.usedInputLength);
                 ioDataRemainSize_ -= mp3DemuxerRst_.usedInputLength;
                 currentDemuxerPos_ += mp3DemuxerRst_.usedInputLength;
+                CreateFrameIndex();
                 FillInMediaInfo(mediaInfo);
                 processLoop = 0;
                 break;
@@ -220,8 +256,28 @@ Status Minimp3DemuxerPlugin::GetMediaInfo(MediaInfo& mediaInfo)
     return Status::OK;
 }
 
+void Minimp3DemuxerPlugin::CreateFrameIndex()
+{
+    frameIndex_.reset();
+    currentSample_ = 0;
+    if (fileSize_ == 0) {
+        return;
+    }
+    frameIndex_ = CppExt::make_unique<AudioFrameIndex>(AudioFrameFormat::MPEG_AUDIO, GetFrameIndexReader(false));
+    if (!frameIndex_->Init(mp3DemuxerAttr_.id3v2Size, fileSize_)) {
+        frameIndex_.reset();
+        return;
+    }
+    if (ioContext_.dataSource->IsSeekCheap()) { // else seeks are estimated, see AudioFrameIndex
+        frameIndex_->StartScan(GetFrameIndexReader(true));
+    }
+}
+
 uint64_t Minimp3DemuxerPlugin::GetCurrentPositionTimeS(void)
 {
+    if (frameIndex_ != nullptr) {
+        return currentSample_ * HST_SECOND / frameIndex_->GetFirstFrame().sampleRate;
+    }
     uint64_t currentTime = (static_cast<uint64_t>(currentDemuxerPos_ - mp3DemuxerAttr_.id3v2Size) * 8 * HST_MSECOND) /
         mp3DemuxerAttr_.bitRate;
     return currentTime;
@@ -265,6 +321,9 @@ Status Minimp3DemuxerPlugin::ReadFrame(Buffer& outBuffer, int32_t timeOutMs)
                 currentDemuxerPos_ += mp3DemuxerRst_.usedInputLength;
             }
             outBuffer.pts = GetCurrentPositionTimeS();
+            if (mp3DemuxerRst_.frameLength && frameIndex_ != nullptr) {
+                currentSample_ += frameIndex_->GetFirstFrame().samples;
+            }
             MEDIA_LOG_D("ReadFrame: mp3DemuxerRst_.frameLength " PUBLIC_LOG_U32 ", pts " PUBLIC_LOG_U64,
                         mp3DemuxerRst_.frameLength, outBuffer.pts);
             if (mp3DemuxerRst_.frameBuffer) {
@@ -294,8 +353,18 @@ Status Minimp3DemuxerPlugin::ReadFrame(Buffer& outBuffer, int32_t timeOutMs)
 Status Minimp3DemuxerPlugin::SeekTo(int32_t trackId, int64_t hstTime, SeekMode mode)
 {
     uint64_t pos = 0;
+    if (frameIndex_ != nullptr) {
+        uint64_t targetSample = static_cast<uint64_t>(std::max<int64_t>(hstTime, 0)) *
+            frameIndex_->GetFirstFrame().sampleRate / HST_SECOND;
+        if (!frameIndex_->FindSeekPosition(targetSample, pos, currentSample_)) {
+            MEDIA_LOG_I("sample " PUBLIC_LOG_U64 " not indexed yet, seek to the estimate " PUBLIC_LOG_U64,
+                        targetSample, pos);
+        }
+        mp3DemuxerAttr_.mp3SeekFlag = 1;
+        ioContext_.eos = false;
+    }
     uint32_t targetTimeMs = static_cast<uint32_t>(HstTime2Ms(hstTime));
-    if (AudioDemuxerMp3GetSeekPosition(targetTimeMs, &pos) == 0) {
+    if (frameIndex_ != nullptr || AudioDemuxerMp3GetSeekPosition(targetTimeMs, &pos) == 0) {
         ioContext_.offset = pos;
         ioDataRemainSize_ = 0;
         currentDemuxerPos_ = pos;
@@ -337,6 +406,8 @@ Status Minimp3DemuxerPlugin::Prepare()
 
 Status Minimp3DemuxerPlugin::Reset()
 {
+    frameIndex_.reset();
+    currentSample_ = 0;
     ioContext_.eos = false;
     ioContext_.dataSource.reset();
     ioContext_.offset = 0;
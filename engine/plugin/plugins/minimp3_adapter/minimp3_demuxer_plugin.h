@@ -23,6 +23,7 @@
 #include "core/plugin_register.h"
 #include "minimp3_wrapper.h"
 #include "plugin/interface/demuxer_plugin.h"
+#include "plugin/plugins/demuxer/common/audio_frame_index.h"
 #include "foundation/osal/thread/mutex.h"
 
 using Mp3DemuxerHandle     = Minimp3WrapperMp3dec;
@@ -131,8 +132,11 @@ private:
     int AudioDemuxerMp3GetSeekPosition(uint32_t targetTimeMs, uint64_t *pos);
 
     Status DoReadFromSource(uint32_t readSize);
+    size_t ReadForFrameIndex(uint64_t offset, uint8_t* data, size_t size, bool direct);
+    AudioFrameIndex::ReadFunc GetFrameIndexReader(bool direct);
 
     void FillInMediaInfo(MediaInfo& mediaInfo) const;
+    void CreateFrameIndex();
 
     int                 inIoBufferSize_;
     size_t              fileSize_;
@@ -144,6 +148,9 @@ private:
     AudioDemuxerRst     mp3DemuxerRst_ {};
     Minimp3DemuxerOp    minimp3DemuxerImpl_ {};
     AudioDemuxerMp3Attr mp3DemuxerAttr_ {};
+    uint64_t            currentSample_ {0}; // of the next frame
+    OSAL::Mutex         readMutex_ {};      // the data source is shared with the seeks of the frame index
+    std::unique_ptr<AudioFrameIndex> frameIndex_ {nullptr}; // last, its scan stops before the rest is destroyed
 };
 } // namespace Minimp3
 } // namespace Plugin
@@ -23,6 +23,7 @@
 #include "foundation/osal/thread/scoped_lock.h"
 #include "foundation/osal/utils/util.h"
 #include "plugin/common/plugin_time.h"
+#include "utils/audio_format.h"
 #include "utils/constants.h"
 
 namespace {
@@ -270,7 +271,11 @@ Status AudioServerSinkPlugin::Prepare()
             return Status::ERROR_UNKNOWN;
         }
     }
-    if (needReformat_) {
+    if (needReformat_ && IsAudioConvertSupported(reSrcFmt_, reDestFmt_, channels_)) {
+        // the rate does not change, Write converts the samples itself instead of going through swr
+        MEDIA_LOG_I("reformat audio with " PUBLIC_LOG_S " kernels", GetAudioConvertIsa());
+        swrCtx_.reset();
+    } else if (needReformat_) {
         auto resampleSize = av_samples_get_buffer_size(nullptr, channels_, samplesPerFrame_, reFfDestFmt_, 0);
         resampleCache_ .reserve(resampleSize);
         resampleChannelAddr_.reserve(channels_);
@@ -309,6 +314,7 @@ Status AudioServerSinkPlugin::Reset()
     ResetAudioRendererParams(rendererParams_);
     fmtSupported_ = false;
     reSrcFfFmt_ = AV_SAMPLE_FMT_NONE;
+    reSrcFmt_ = AudioSampleFormat::NONE;
     channels_ = 0;
     bitRate_ = 0;
     sampleRate_ = 0;
@@ -454,6 +460,7 @@ bool AudioServerSinkPlugin::AssignSampleFmtIfSupported(Plugin::AudioSampleFormat
         } else {
             fmtSupported_ = true;
             needReformat_ = true;
+            reSrcFmt_ = sampleFormat;
             reSrcFfFmt_ = std::get<2>(*item);
             rendererParams_.sampleFormat = reStdDestFmt_;
         }
@@ -610,7 +617,19 @@ Status AudioServerSinkPlugin::Write(const std::shared_ptr<Buffer>& input)
             }
         }
         auto samples = lineSize / av_get_bytes_per_sample(reSrcFfFmt_);
-        auto res = swr_convert(swrCtx_.get(), resampleChannelAddr_.data(), samples, tmpInput.data(), samples);
+        int32_t res = -1;
+        if (swrCtx_ == nullptr) {
+            auto destSize = samples * channels_ * GetAudioConvertSampleBytes(reDestFmt_);
+            if (resampleCache_.size() < destSize) {
+                resampleCache_.resize(destSize);
+            }
+            uint8_t* dest[] = {resampleCache_.data()};
+            if (ConvertAudioSamples(tmpInput.data(), reSrcFmt_, dest, reDestFmt_, channels_, samples)) {
+                res = static_cast<int32_t>(samples);
+            }
+        } else {
+            res = swr_convert(swrCtx_.get(), resampleChannelAddr_.data(), samples, tmpInput.data(), samples);
+        }
         if (res < 0) {
             MEDIA_LOG_E("resample input failed");
             length = 0;
@@ -127,6 +127,8 @@ private:
 
     bool fmtSupported_ {false};
     AVSampleFormat reSrcFfFmt_ {AV_SAMPLE_FMT_NONE};
+    AudioSampleFormat reSrcFmt_ {AudioSampleFormat::NONE};
+    const AudioSampleFormat reDestFmt_ {AudioSampleFormat::S16};
     const AudioStandard::AudioSampleFormat reStdDestFmt_ {AudioStandard::AudioSampleFormat::SAMPLE_S16LE};
     const AVSampleFormat reFfDestFmt_ {AV_SAMPLE_FMT_S16};
     Plugin::AudioChannelLayout channelLayout_ {};
@@ -24,6 +24,7 @@
 #include "plugin/common/plugin_audio_tags.h"
 #include "plugin/common/plugin_buffer.h"
 #include "plugins/ffmpeg_adapter/utils/ffmpeg_utils.h"
+#include "utils/audio_format.h"
 #include "utils/constants.h"
 
 namespace {
@@ -152,7 +153,11 @@ Status SdlAudioSinkPlugin::Prepare()
         return Status::ERROR_UNKNOWN;
     }
 
-    if (needResample_) {
+    if (needResample_ && IsAudioConvertSupported(audioFormat_, reDestFmt_, channels_)) {
+        // the rate does not change, Write converts the samples itself instead of going through swr
+        MEDIA_LOG_I("reformat audio with " PUBLIC_LOG_S " kernels", GetAudioConvertIsa());
+        swrCtx_.reset();
+    } else if (needResample_) {
         auto destFrameSize = av_samples_get_buffer_size(nullptr, channels_, samplesPerFrame_, reFfDestFmt_, 0);
         resampleCache_.reserve(destFrameSize);
         resampleChannelAddr_.reserve(channels_);
@@ -355,7 +360,32 @@ Status SdlAudioSinkPlugin::Write(const std::shared_ptr<Buffer>& inputInfo)
             }
         }
         auto samples = lineSize / av_get_bytes_per_sample(reSrcFfFmt_);
-        auto res = swr_convert(swrCtx_.get(), resampleChannelAddr_.data(), samples, tmpInput.data(), samples);
+        int32_t res = -1;
+        if (swrCtx_ == nullptr) {
+            auto destSize = samples * channels_ * GetAudioConvertSampleBytes(reDestFmt_);
+            // convert straight into the ring buffer, unless it is inactive; then the copy below is dropped like
+            // any other write to an inactive ring buffer
+            uint8_t* dest[] = {destSize <= rb->GetCapacity() ? rb->ReserveWrite(destSize) : nullptr};
+            if (dest[0] != nullptr) {
+                if (!ConvertAudioSamples(tmpInput.data(), audioFormat_, dest, reDestFmt_, channels_, samples)) {
+                    MEDIA_LOG_E("resample input failed");
+                    rb->CancelWrite();
+                    return Status::ERROR_UNKNOWN;
+                }
+                rb->CommitWrite(destSize);
+                MEDIA_LOG_D("SdlSink Write end");
+                return Status::OK;
+            }
+            if (resampleCache_.size() < destSize) {
+                resampleCache_.resize(destSize);
+            }
+            dest[0] = resampleCache_.data();
+            if (ConvertAudioSamples(tmpInput.data(), audioFormat_, dest, reDestFmt_, channels_, samples)) {
+                res = static_cast<int32_t>(samples);
+            }
+        } else {
+            res = swr_convert(swrCtx_.get(), resampleChannelAddr_.data(), samples, tmpInput.data(), samples);
+        }
         if (res < 0) {
             MEDIA_LOG_E("resample input failed");
             length = 0;
@@ -381,16 +411,28 @@ void SdlAudioSinkPlugin::AudioCallback(void* userdata, uint8_t* stream, int len)
 {
     UNUSED_VARIABLE(userdata);
     MEDIA_LOG_D("sdl audio callback begin");
-    if (mixCache_.capacity() < len) {
-        mixCache_.reserve(len);
+    size_t realLen = 0;
+    auto wanted = static_cast<size_t>(len);
+    while (realLen < wanted) {
+        // mix straight from the ring buffer, the span is split only if the ring is not mirrored
+        size_t size = wanted - realLen;
+        auto span = rb->PeekRead(size);
+        if (span == nullptr) {
+            break;
+        }
+        if (realLen == 0) {
+            SDL_memset(stream, 0, len);
+        }
+        SDL_MixAudio(stream + realLen, span, static_cast<uint32_t>(size), volume_);
+        if (!rb->ConsumeRead(size)) {
+            break;
+        }
+        realLen += size;
     }
-    auto realLen = rb->ReadBuffer(mixCache_.data(), len);
     if (realLen == 0) {
         MEDIA_LOG_D("sdl audio callback end with 0");
         return;
     }
-    SDL_memset(stream, 0, len);
-    SDL_MixAudio(stream, mixCache_.data(), realLen, volume_);
     SDL_PauseAudio(0);
     MEDIA_LOG_D("sdl audio callback end with " PUBLIC_LOG_ZU, realLen);
 }
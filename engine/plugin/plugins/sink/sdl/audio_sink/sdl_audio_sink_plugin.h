@@ -95,7 +95,6 @@ private:
     bool needResample_ {false};
     std::vector<uint8_t> resampleCache_ {};
     std::vector<uint8_t*> resampleChannelAddr_ {};
-    std::vector<uint8_t> mixCache_ {};
     std::unique_ptr<RingBuffer> rb {};
     size_t srcFrameSize_ {};
     SDL_AudioSpec wantedSpec_ {};
@@ -107,6 +106,7 @@ private:
     std::shared_ptr<SwrContext> swrCtx_ {nullptr};
     int volume_;
     const AVSampleFormat reFfDestFmt_ {AV_SAMPLE_FMT_S16};
+    const AudioSampleFormat reDestFmt_ {AudioSampleFormat::S16};
     AVSampleFormat reSrcFfFmt_ {AV_SAMPLE_FMT_NONE};
 };
 } // namespace Sdl
@@ -16,25 +16,65 @@
 #define HST_LOG_TAG "FileSourcePlugin"
 
 #include "file_source_plugin.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/types.h>
+#if !defined(WIN32) && !defined(__LITEOS_M__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define FILE_SOURCE_MMAP_SUPPORT
+#elif !defined(WIN32)
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
 #include "foundation/log.h"
+#include "foundation/osal/filesystem/file_system.h"
 
 namespace OHOS {
 namespace Media {
 namespace Plugin {
 namespace FileSource {
 namespace {
-size_t GetFileSize(const std::string& fileName)
+constexpr uint64_t READ_AHEAD_SIZE = 1024 * 1024; // 1M: madvise(WILLNEED) window ahead of the read cursor
+
+size_t GetFileSize(int32_t fd)
 {
     size_t fileSize = 0;
-    if (!fileName.empty()) {
-        struct stat fileStatus {};
-        if (stat(fileName.c_str(), &fileStatus) == 0) {
-            fileSize = static_cast<size_t>(fileStatus.st_size);
-        }
+    struct stat fileStatus {};
+    if (fstat(fd, &fileStatus) == 0) {
+        fileSize = static_cast<size_t>(fileStatus.st_size);
     }
     return fileSize;
 }
+
+int64_t ReadFileAt(int32_t fd, uint8_t* data, size_t len, uint64_t offset)
+{
+#ifdef WIN32
+    if (lseek(fd, static_cast<long>(offset), SEEK_SET) == -1) {
+        return -1;
+    }
+#endif
+    size_t total = 0;
+    while (total < len) {
+#ifdef WIN32
+        auto ret = read(fd, data + total, static_cast<unsigned int>(len - total));
+#else
+        auto ret = pread(fd, data + total, len - total, static_cast<off_t>(offset + total));
+#endif
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return total > 0 ? static_cast<int64_t>(total) : ret;
+        }
+        total += static_cast<size_t>(ret);
+    }
+    return static_cast<int64_t>(total);
+}
 }
 std::shared_ptr<SourcePlugin> FileSourcePluginCreator(const std::string& name)
 {
@@ -70,7 +110,7 @@ void FileSourceAllocator::Free(void* ptr) // NOLINT: void*
 }
 
 FileSourcePlugin::FileSourcePlugin(std::string name)
-    : SourcePlugin(std::move(name)), fp_(nullptr), fileSize_(0), isSeekable_(true), position_(0)
+    : SourcePlugin(std::move(name)), fd_(-1), fileSize_(0), isSeekable_(true), position_(0)
 {
     MEDIA_LOG_D("IN");
 }
@@ -78,10 +118,7 @@ FileSourcePlugin::FileSourcePlugin(std::string name)
 FileSourcePlugin::~FileSourcePlugin()
 {
     MEDIA_LOG_D("IN");
-    if (fp_) {
-        std::fclose(fp_);
-        fp_ = nullptr;
-    }
+    CloseFile();
 }
 
 Status FileSourcePlugin::Init()
@@ -148,38 +185,56 @@ Status FileSourcePlugin::SetSource(std::shared_ptr<MediaSource> source)
 
 Status FileSourcePlugin::Read(std::shared_ptr<Buffer>& buffer, size_t expectedLen)
 {
-    if (std::feof(fp_)) {
-        MEDIA_LOG_W("It is the end of file!");
-        return Status::END_OF_STREAM;
-    }
     if (buffer == nullptr) {
         buffer = std::make_shared<Buffer>();
     }
-
-    std::shared_ptr<Memory> bufData;
-
-    // There is no buffer, so alloc it
-    if (buffer->IsEmpty()) {
-        bufData = buffer->AllocMemory(GetAllocator(), expectedLen);
-    } else {
-        bufData = buffer->GetMemory();
+    if (fd_ == -1) {
+        MEDIA_LOG_E("Need call SetSource() to open file first");
+        return Status::ERROR_WRONG_STATE;
+    }
+    CheckMappedSize();
+    if (position_ >= fileSize_) {
+        MEDIA_LOG_W("It is the end of file!");
+        return Status::END_OF_STREAM;
     }
     expectedLen = std::min(static_cast<size_t>(fileSize_ - position_), expectedLen);
-    expectedLen = std::min(bufData->GetCapacity(), expectedLen);
-
     MEDIA_LOG_D("buffer position " PUBLIC_LOG_U64 ", expectedLen " PUBLIC_LOG_ZU, position_, expectedLen);
-    auto size = std::fread(bufData->GetWritableAddr(expectedLen), sizeof(char), expectedLen, fp_);
-    bufData->UpdateDataSize(size);
-    position_ += bufData->GetSize();
+    if (mappedData_ != nullptr) {
+        AdviseReadAhead(expectedLen);
+        if (buffer->IsEmpty()) {
+            // Hand out the mapped pages directly, the memory keeps the mapping alive until it is released.
+            std::shared_ptr<uint8_t> data(mappedData_, mappedData_.get() + position_);
+            buffer->WrapReadOnlyMemoryPtr(data, expectedLen);
+        } else {
+            buffer->GetMemory()->Write(mappedData_.get() + position_, expectedLen, 0);
+        }
+    } else {
+        std::shared_ptr<Memory> bufData;
+        // There is no buffer, so alloc it
+        if (buffer->IsEmpty()) {
+            bufData = buffer->AllocMemory(GetAllocator(), expectedLen);
+        } else {
+            bufData = buffer->GetMemory();
+        }
+        expectedLen = std::min(bufData->GetCapacity(), expectedLen);
+        auto size = ReadFileAt(fd_, bufData->GetWritableAddr(expectedLen), expectedLen, position_);
+        if (size < 0) {
+            bufData->UpdateDataSize(0);
+            MEDIA_LOG_E("Read " PUBLIC_LOG_S " failed: " PUBLIC_LOG_S, fileName_.c_str(), strerror(errno));
+            return Status::ERROR_UNKNOWN;
+        }
+        bufData->UpdateDataSize(static_cast<size_t>(size));
+    }
+    position_ += buffer->GetMemory()->GetSize();
     MEDIA_LOG_D("position_: " PUBLIC_LOG_U64 ", readSize: " PUBLIC_LOG_ZU,
-                position_, bufData->GetSize());
+                position_, buffer->GetMemory()->GetSize());
     return Status::OK;
 }
 
 Status FileSourcePlugin::GetSize(size_t& size)
 {
     MEDIA_LOG_D("IN");
-    if (!fp_) {
+    if (fd_ == -1) {
         MEDIA_LOG_E("Need call SetSource() to open file first");
         return Status::ERROR_WRONG_STATE;
     }
@@ -196,19 +251,13 @@ bool FileSourcePlugin::IsSeekable()
 
 Status FileSourcePlugin::SeekTo(uint64_t offset)
 {
-    if (!fp_ || (offset > fileSize_) || (position_ == offset)) {
+    if ((fd_ == -1) || (offset > fileSize_) || (position_ == offset)) {
         MEDIA_LOG_E("Invalid operation");
         return Status::ERROR_WRONG_STATE;
     }
-    std::clearerr(fp_);
-    if (std::fseek(fp_, static_cast<long int>(offset), SEEK_SET) != 0) {
-        std::clearerr(fp_);
-        (void)std::fseek(fp_, static_cast<long int>(position_), SEEK_SET);
-        MEDIA_LOG_E("Seek to " PUBLIC_LOG_U64, offset);
-        return Status::ERROR_UNKNOWN;
-    }
     position_ = offset;
-    if (std::feof(fp_)) {
+    adviseEnd_ = 0; // restart the read ahead window from the new position
+    if (position_ == fileSize_) {
         MEDIA_LOG_I("It is the end of file!");
     }
     MEDIA_LOG_D("seek to position_: " PUBLIC_LOG_U64 " success", position_);
@@ -279,23 +328,92 @@ Status FileSourcePlugin::OpenFile()
         return ret;
     }
     CloseFile();
-    fp_ = std::fopen(fileName_.c_str(), "rb");
-    if (fp_ == nullptr) {
-        MEDIA_LOG_E("Fail to load file from " PUBLIC_LOG_S, fileName_.c_str());
+#ifdef WIN32
+    fd_ = open(fileName_.c_str(), O_RDONLY | O_BINARY);
+#else
+    fd_ = open(fileName_.c_str(), O_RDONLY);
+#endif
+    if (fd_ == -1) {
+        MEDIA_LOG_E("Fail to load file from " PUBLIC_LOG_S ": " PUBLIC_LOG_S, fileName_.c_str(), strerror(errno));
         return Status::ERROR_UNKNOWN;
     }
-    fileSize_ = GetFileSize(fileName_);
-    MEDIA_LOG_D("fileName_: " PUBLIC_LOG_S ", fileSize_: " PUBLIC_LOG_ZU, fileName_.c_str(), fileSize_);
+    fileSize_ = GetFileSize(fd_);
+    position_ = 0;
+    adviseEnd_ = 0;
+    MapFile();
+    MEDIA_LOG_D("fileName_: " PUBLIC_LOG_S ", fileSize_: " PUBLIC_LOG_ZU ", mapped: " PUBLIC_LOG_D32,
+                fileName_.c_str(), fileSize_, mappedData_ != nullptr);
     return Status::OK;
 }
 
 void FileSourcePlugin::CloseFile()
 {
-    if (fp_) {
+    // buffers handed out from the mapping still hold a reference, the pages are unmapped with the last of them
+    mappedData_.reset();
+    if (fd_ != -1) {
         MEDIA_LOG_I("close file");
-        std::fclose(fp_);
-        fp_ = nullptr;
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+void FileSourcePlugin::MapFile()
+{
+#ifdef FILE_SOURCE_MMAP_SUPPORT
+    if (fileSize_ == 0 || !OSAL::FileSystem::IsRegularFile(fd_)) {
+        return;
+    }
+    void* addr = mmap(nullptr, fileSize_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (addr == MAP_FAILED) {
+        MEDIA_LOG_W("mmap " PUBLIC_LOG_S " failed: " PUBLIC_LOG_S ", read it with pread",
+                    fileName_.c_str(), strerror(errno));
+        return;
+    }
+    (void)madvise(addr, fileSize_, MADV_SEQUENTIAL);
+    size_t mapSize = fileSize_;
+    mappedData_ = std::shared_ptr<uint8_t>(static_cast<uint8_t*>(addr), [mapSize](uint8_t* ptr) {
+        (void)munmap(ptr, mapSize);
+    });
+#endif
+}
+
+// Touching mapped pages past the end of a truncated file raises SIGBUS. A file whose size changed since it was
+// mapped, e.g. one still being written, is read with pread from then on.
+void FileSourcePlugin::CheckMappedSize()
+{
+#ifdef FILE_SOURCE_MMAP_SUPPORT
+    if (mappedData_ == nullptr) {
+        return;
+    }
+    size_t fileSize = GetFileSize(fd_);
+    if (fileSize == fileSize_) {
+        return;
+    }
+    MEDIA_LOG_W("size of " PUBLIC_LOG_S " changed from " PUBLIC_LOG_ZU " to " PUBLIC_LOG_ZU ", read it with pread",
+                fileName_.c_str(), fileSize_, fileSize);
+    mappedData_.reset();
+    fileSize_ = fileSize;
+#endif
+}
+
+void FileSourcePlugin::AdviseReadAhead(size_t readLen)
+{
+#ifdef FILE_SOURCE_MMAP_SUPPORT
+    uint64_t readEnd = position_ + readLen;
+    if (readEnd + READ_AHEAD_SIZE / 2 <= adviseEnd_) { // 2: keep at least half a window in flight
+        return;
+    }
+    static const auto pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t start = std::max(adviseEnd_, position_);
+    start -= start % pageSize;
+    uint64_t end = std::min(static_cast<uint64_t>(fileSize_), readEnd + READ_AHEAD_SIZE);
+    if (end > start) {
+        (void)madvise(mappedData_.get() + start, end - start, MADV_WILLNEED);
     }
+    adviseEnd_ = end;
+#else
+    (void)readLen;
+#endif
 }
 } // namespace FileSource
 } // namespace Plugin
@@ -16,7 +16,7 @@
 #ifndef MEDIA_PIPELINE_FILE_SOURCE_PLUGIN_H
 #define MEDIA_PIPELINE_FILE_SOURCE_PLUGIN_H
 
-#include <cstdio>
+#include <memory>
 #include "plugin/common/plugin_types.h"
 #include "plugin/interface/source_plugin.h"
 
@@ -54,16 +54,21 @@ public:
 
 private:
     std::string fileName_ {};
-    std::FILE* fp_;
+    int32_t fd_;
     size_t fileSize_;
     bool isSeekable_;
     uint64_t position_;
+    std::shared_ptr<uint8_t> mappedData_ {nullptr}; // whole file mapping, null if the file cannot be mapped
+    uint64_t adviseEnd_ {0};
     std::shared_ptr<FileSourceAllocator> mAllocator_ {nullptr};
 
     Status ParseFileName(const std::string& uri);
     Status CheckFileStat();
     Status OpenFile();
     void CloseFile();
+    void MapFile();
+    void CheckMappedSize();
+    void AdviseReadAhead(size_t readLen);
 };
 } // namespace FileSource
 } // namespace Plugin
@@ -25,6 +25,8 @@
 
 namespace {
 const float MAX_MEDIA_VOLUME = 100.0f;
+// demux-ahead per track, bounded by duration rather than by count, the bytes only guard against huge frames
+const OHOS::Media::Pipeline::QueueLimits DEMUX_QUEUE_LIMITS {0, 16 * 1024 * 1024, HST_SECOND};
 }
 
 namespace OHOS {
@@ -148,6 +150,17 @@ PFilter HiPlayerImpl::CreateAudioDecoder(const std::string& desc)
     return audioDecoderMap_[desc];
 }
 
+PFilter HiPlayerImpl::CreateQueue(const std::string& desc)
+{
+    if (!queueFilterMap_[desc]) {
+        queueFilterMap_[desc] = FilterFactory::Instance().CreateFilterWithType<QueueFilter>(
+            "builtin.queue", "queue-" + desc);
+        queueFilterMap_[desc]->SetLimits(DEMUX_QUEUE_LIMITS);
+        queueFilterMap_[desc]->SetGroup(demuxQueueGroup_);
+    }
+    return queueFilterMap_[desc];
+}
+
 int32_t HiPlayerImpl::Play()
 {
     PROFILE_BEGIN();
@@ -341,6 +354,11 @@ void HiPlayerImpl::OnEvent(const Event& event)
             }
             break;
         }
+        case EventType::EVENT_QUEUE_FILL_LEVEL: {
+            auto level = Plugin::AnyCast<Pipeline::QueueFillLevel>(event.param);
+            MEDIA_LOG_D(PUBLIC_LOG_S " fill level " PUBLIC_LOG_U32 "%%", event.srcFilter.c_str(), level.percent);
+            break;
+        }
         default:
             MEDIA_LOG_E("Unknown event(" PUBLIC_LOG_U32 ")", event.type);
     }
@@ -635,18 +653,22 @@ ErrorCode HiPlayerImpl::NewAudioPortFound(Filter* filter, const Plugin::Any& par
                 continue;
             }
             MEDIA_LOG_I("port name " PUBLIC_LOG_S, portDesc.name.c_str());
-            auto fromPort = filter->GetOutPort(portDesc.name);
+            // the queue lets the demuxer read ahead while the decoder or the sink is busy
+            auto queue = CreateQueue(portDesc.name);
+            pipeline_->AddFilters({queue.get()});
+            FAIL_LOG(pipeline_->LinkPorts(filter->GetOutPort(portDesc.name), queue->GetInPort(PORT_NAME_DEFAULT)));
+            auto fromPort = queue->GetOutPort(PORT_NAME_DEFAULT);
             if (portDesc.isPcm) {
                 pipeline_->AddFilters({audioSink_.get()});
                 FAIL_LOG(pipeline_->LinkPorts(fromPort, audioSink_->GetInPort(PORT_NAME_DEFAULT)));
-                ActiveFilters({audioSink_.get()});
+                ActiveFilters({queue.get(), audioSink_.get()});
             } else {
                 auto newAudioDecoder = CreateAudioDecoder(portDesc.name);
                 pipeline_->AddFilters({newAudioDecoder.get(), audioSink_.get()});
                 FAIL_LOG(pipeline_->LinkPorts(fromPort, newAudioDecoder->GetInPort(PORT_NAME_DEFAULT)));
                 FAIL_LOG(pipeline_->LinkPorts(newAudioDecoder->GetOutPort(PORT_NAME_DEFAULT),
                                               audioSink_->GetInPort(PORT_NAME_DEFAULT)));
-                ActiveFilters({newAudioDecoder.get(), audioSink_.get()});
+                ActiveFilters({queue.get(), newAudioDecoder.get(), audioSink_.get()});
             }
             mediaStats_.Append(MediaType::AUDIO);
             rtv = ErrorCode::SUCCESS;
@@ -672,9 +694,12 @@ ErrorCode HiPlayerImpl::NewVideoPortFound(Filter* filter, const Plugin::Any& par
             MEDIA_LOG_I("port name " PUBLIC_LOG_S, portDesc.name.c_str());
             videoDecoder = FilterFactory::Instance().CreateFilterWithType<VideoDecoderFilter>(
                 "builtin.player.videodecoder", "videodecoder-" + portDesc.name);
-            if (pipeline_->AddFilters({videoDecoder.get()}) == ErrorCode::SUCCESS) {
-                // link demuxer and video decoder
-                auto fromPort = filter->GetOutPort(portDesc.name);
+            auto queue = CreateQueue(portDesc.name);
+            if (pipeline_->AddFilters({queue.get(), videoDecoder.get()}) == ErrorCode::SUCCESS) {
+                // link demuxer, queue and video decoder
+                FAIL_LOG(pipeline_->LinkPorts(filter->GetOutPort(portDesc.name), queue->GetInPort(PORT_NAME_DEFAULT)));
+                newFilters.emplace_back(queue.get());
+                auto fromPort = queue->GetOutPort(PORT_NAME_DEFAULT);
                 auto toPort = videoDecoder->GetInPort(PORT_NAME_DEFAULT);
                 FAIL_LOG(pipeline_->LinkPorts(fromPort, toPort)); // link ports
                 newFilters.emplace_back(videoDecoder.get());
@@ -34,6 +34,7 @@
 #include "pipeline/core/pipeline.h"
 #include "pipeline/core/pipeline_core.h"
 #include "pipeline/filters/codec/audio_decoder/audio_decoder_filter.h"
+#include "pipeline/filters/queue/queue_filter.h"
 #include "pipeline/filters/sink/audio_sink/audio_sink_filter.h"
 #include "play_executor.h"
 #include "scene/lite/hiplayer.h"
@@ -177,6 +178,7 @@ private:
     ErrorCode StopAsync();
 
     Pipeline::PFilter CreateAudioDecoder(const std::string& desc);
+    Pipeline::PFilter CreateQueue(const std::string& desc);
 
     ErrorCode NewAudioPortFound(Pipeline::Filter* filter, const Plugin::Any& parameter);
 #ifdef VIDEO_SUPPORT
@@ -207,6 +209,9 @@ private:
 #endif
 
     std::unordered_map<std::string, std::shared_ptr<Pipeline::AudioDecoderFilter>> audioDecoderMap_;
+    std::unordered_map<std::string, std::shared_ptr<Pipeline::QueueFilter>> queueFilterMap_;
+    // the queues after the demuxer share its thread
+    std::shared_ptr<Pipeline::QueueGroup> demuxQueueGroup_ {std::make_shared<Pipeline::QueueGroup>()};
 
     std::weak_ptr<Plugin::Meta> sourceMeta_;
     std::vector<std::weak_ptr<Plugin::Meta>> streamMeta_;
@@ -24,11 +24,16 @@
 #include "plugin/common/media_source.h"
 #include "plugin/common/plugin_time.h"
 #include "plugin/core/plugin_meta.h"
+#include "utils/pipeline_tracer.h"
 #include "utils/steady_clock.h"
 #include "media_errors.h"
 
 namespace {
 const float MAX_MEDIA_VOLUME = 1.0f; // standard interface volume is between 0 to 1.
+// demux-ahead per track, bounded by duration rather than by count, the bytes only guard against huge frames
+const OHOS::Media::Pipeline::QueueLimits DEMUX_QUEUE_LIMITS {0, 16 * 1024 * 1024, HST_SECOND};
+// written on stop while pipeline tracing is enabled, see HstEngineFactory::CreatePlayerEngine
+const char* const PIPELINE_TRACE_PATH = "/data/local/tmp/histreamer_pipeline_trace.json";
 }
 
 namespace OHOS {
@@ -309,6 +314,11 @@ void HiPlayerImpl::OnEvent(const Event& event)
             }
             break;
         }
+        case EventType::EVENT_QUEUE_FILL_LEVEL: {
+            auto level = Plugin::AnyCast<Pipeline::QueueFillLevel>(event.param);
+            MEDIA_LOG_D(PUBLIC_LOG_S " fill level " PUBLIC_LOG_U32 "%%", event.srcFilter.c_str(), level.percent);
+            break;
+        }
         default:
             MEDIA_LOG_E("Unknown event(" PUBLIC_LOG_U32 ")", event.type);
     }
@@ -360,6 +370,7 @@ ErrorCode HiPlayerImpl::DoResume()
 ErrorCode HiPlayerImpl::DoStop()
 {
     mediaStats_.Reset();
+    ReportTrace();
     auto ret = pipeline_->Stop();
     if (ret == ErrorCode::SUCCESS) {
         pipelineStates_ = PlayerStates::PLAYER_STOPPED;
@@ -463,6 +474,33 @@ PFilter HiPlayerImpl::CreateAudioDecoder(const std::string& desc)
     return audioDecoderMap_[desc];
 }
 
+PFilter HiPlayerImpl::CreateQueue(const std::string& desc)
+{
+    if (!queueFilterMap_[desc]) {
+        queueFilterMap_[desc] = FilterFactory::Instance().CreateFilterWithType<QueueFilter>(
+            "builtin.queue", "queue-" + desc);
+        queueFilterMap_[desc]->SetLimits(DEMUX_QUEUE_LIMITS);
+        queueFilterMap_[desc]->SetGroup(demuxQueueGroup_);
+    }
+    return queueFilterMap_[desc];
+}
+
+void HiPlayerImpl::ReportTrace()
+{
+    auto& tracer = PipelineTracer::Instance();
+    if (!tracer.IsEnabled()) {
+        return;
+    }
+    for (const auto& stat : tracer.GetCounterStats(pipeline_->GetTraceScope())) {
+        MEDIA_LOG_I(PUBLIC_LOG_S "/" PUBLIC_LOG_S ": " PUBLIC_LOG_U64 " buffers, " PUBLIC_LOG_U64 " bytes, blocked "
+                    PUBLIC_LOG_D64 " ms, queue depth " PUBLIC_LOG_U32, stat.scope.c_str(), stat.name.c_str(),
+                    stat.buffers, stat.bytes, stat.blockedMs, stat.queueDepth);
+    }
+    if (tracer.ExportChromeTrace(PIPELINE_TRACE_PATH)) {
+        MEDIA_LOG_I("pipeline trace written to " PUBLIC_LOG_S, PIPELINE_TRACE_PATH);
+    }
+}
+
 int32_t HiPlayerImpl::SetLooping(bool loop)
 {
     MEDIA_LOG_D("SetLooping entered.");
@@ -596,18 +634,22 @@ ErrorCode HiPlayerImpl::NewAudioPortFound(Filter* filter, const Plugin::Any& par
                 continue;
             }
             MEDIA_LOG_I("port name " PUBLIC_LOG_S, portDesc.name.c_str());
-            auto fromPort = filter->GetOutPort(portDesc.name);
+            // the queue lets the demuxer read ahead while the decoder or the sink is busy
+            auto queue = CreateQueue(portDesc.name);
+            pipeline_->AddFilters({queue.get()});
+            FAIL_LOG(pipeline_->LinkPorts(filter->GetOutPort(portDesc.name), queue->GetInPort(PORT_NAME_DEFAULT)));
+            auto fromPort = queue->GetOutPort(PORT_NAME_DEFAULT);
             if (portDesc.isPcm) {
                 pipeline_->AddFilters({audioSink_.get()});
                 FAIL_LOG(pipeline_->LinkPorts(fromPort, audioSink_->GetInPort(PORT_NAME_DEFAULT)));
-                ActiveFilters({audioSink_.get()});
+                ActiveFilters({queue.get(), audioSink_.get()});
             } else {
                 auto newAudioDecoder = CreateAudioDecoder(portDesc.name);
                 pipeline_->AddFilters({newAudioDecoder.get(), audioSink_.get()});
                 FAIL_LOG(pipeline_->LinkPorts(fromPort, newAudioDecoder->GetInPort(PORT_NAME_DEFAULT)));
                 FAIL_LOG(pipeline_->LinkPorts(newAudioDecoder->GetOutPort(PORT_NAME_DEFAULT),
                                               audioSink_->GetInPort(PORT_NAME_DEFAULT)));
-                ActiveFilters({newAudioDecoder.get(), audioSink_.get()});
+                ActiveFilters({queue.get(), newAudioDecoder.get(), audioSink_.get()});
             }
             mediaStats_.Append(MediaStatStub::MediaType::AUDIO);
             rtv = ErrorCode::SUCCESS;
@@ -633,9 +675,12 @@ ErrorCode HiPlayerImpl::NewVideoPortFound(Filter* filter, const Plugin::Any& par
             MEDIA_LOG_I("port name " PUBLIC_LOG_S, portDesc.name.c_str());
             videoDecoder_ = FilterFactory::Instance().CreateFilterWithType<VideoDecoderFilter>(
                 "builtin.player.videodecoder", "videodecoder-" + portDesc.name);
-            if (pipeline_->AddFilters({videoDecoder_.get()}) == ErrorCode::SUCCESS) {
-                // link demuxer and video decoder
-                auto fromPort = filter->GetOutPort(portDesc.name);
+            auto queue = CreateQueue(portDesc.name);
+            if (pipeline_->AddFilters({queue.get(), videoDecoder_.get()}) == ErrorCode::SUCCESS) {
+                // link demuxer, queue and video decoder
+                FAIL_LOG(pipeline_->LinkPorts(filter->GetOutPort(portDesc.name), queue->GetInPort(PORT_NAME_DEFAULT)));
+                newFilters.emplace_back(queue.get());
+                auto fromPort = queue->GetOutPort(PORT_NAME_DEFAULT);
                 auto toPort = videoDecoder_->GetInPort(PORT_NAME_DEFAULT);
                 FAIL_LOG(pipeline_->LinkPorts(fromPort, toPort));  // link ports
                 newFilters.emplace_back(videoDecoder_.get());
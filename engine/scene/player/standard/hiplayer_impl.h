@@ -34,6 +34,7 @@
 #include "pipeline/filters/codec/video_decoder/video_decoder_filter.h"
 #include "pipeline/filters/sink/video_sink/video_sink_filter.h"
 #endif
+#include "pipeline/filters/queue/queue_filter.h"
 #include "pipeline/filters/sink/audio_sink/audio_sink_filter.h"
 #include "scene/common/media_stat_stub.h"
 #include "play_executor.h"
@@ -100,12 +101,14 @@ private:
     ErrorCode StopAsync();
     ErrorCode SetVolume(float volume);
     Pipeline::PFilter CreateAudioDecoder(const std::string& desc);
+    Pipeline::PFilter CreateQueue(const std::string& desc);
     ErrorCode NewAudioPortFound(Pipeline::Filter* filter, const Plugin::Any& parameter);
 #ifdef VIDEO_SUPPORT
     ErrorCode NewVideoPortFound(Pipeline::Filter* filter, const Plugin::Any& parameter);
 #endif
     ErrorCode RemoveFilterChains(Pipeline::Filter* filter, const Plugin::Any& parameter);
     void ActiveFilters(const std::vector<Pipeline::Filter*>& filters);
+    void ReportTrace();
 
     OSAL::Mutex stateMutex_ {};
     OSAL::ConditionVariable cond_ {};
@@ -132,6 +135,9 @@ private:
     std::shared_ptr<Pipeline::VideoSinkFilter> videoSink_;
 #endif
     std::unordered_map<std::string, std::shared_ptr<Pipeline::AudioDecoderFilter>> audioDecoderMap_;
+    std::unordered_map<std::string, std::shared_ptr<Pipeline::QueueFilter>> queueFilterMap_;
+    // the queues after the demuxer share its thread
+    std::shared_ptr<Pipeline::QueueGroup> demuxQueueGroup_ {std::make_shared<Pipeline::QueueGroup>()};
 };
 }  // namespace Media
 }  // namespace OHOS
@@ -21,6 +21,7 @@
 #include "parameter.h"
 #include "scene/player/standard/hiplayer_impl.h"
 #include "scene/recorder/standard/hirecorder_impl.h"
+#include "utils/pipeline_tracer.h"
 
 namespace OHOS {
 namespace Media {
@@ -42,6 +43,9 @@ int32_t HstEngineFactory::Score(Scene scene, const std::string& uri)
 std::unique_ptr<IPlayerEngine> HstEngineFactory::CreatePlayerEngine()
 {
     MEDIA_LOG_I("CreatePlayerEngine enter.");
+    char trace[10] = {0}; // 10 for system parameter usage
+    auto res = GetParameter("debug.media_service.histreamer.trace", "0", trace, sizeof(trace));
+    PipelineTracer::Instance().SetEnabled(res == 1 && trace[0] == '1');
     auto player = std::unique_ptr<HiPlayerImpl>(new (std::nothrow) HiPlayerImpl());
     if (player && player->Init() == ErrorCode::SUCCESS) {
         return player;
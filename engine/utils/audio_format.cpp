@@ -0,0 +1,770 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "audio_format.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "securec.h"
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define AUDIO_FORMAT_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define AUDIO_FORMAT_AVX2
+#include <immintrin.h>
+#endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define AUDIO_FORMAT_NEON
+#include <arm_neon.h>
+#endif
+
+namespace OHOS {
+namespace Media {
+namespace {
+using Plugin::AudioSampleFormat;
+
+enum struct SampleType : uint8_t {
+    S16,
+    S32,
+    F32,
+};
+
+struct FormatInfo {
+    SampleType type;
+    bool planar;
+    uint32_t bytes;
+};
+
+constexpr size_t SCRATCH_SIZE = 4096; // bytes per scratch area, keep the stack usage of the callers low
+constexpr float S16_SCALE = 32768.0f;
+constexpr float S32_SCALE = 2147483648.0f;
+constexpr float S16_MAX = 32767.0f;
+constexpr float S32_MAX = 2147483520.0f; // largest float below 2^31
+constexpr int32_t S16_SHIFT = 16;
+
+bool GetFormatInfo(AudioSampleFormat format, FormatInfo& info)
+{
+    switch (format) {
+        case AudioSampleFormat::S16:
+        case AudioSampleFormat::S16P:
+            info = {SampleType::S16, format == AudioSampleFormat::S16P, sizeof(int16_t)};
+            return true;
+        case AudioSampleFormat::S32:
+        case AudioSampleFormat::S32P:
+            info = {SampleType::S32, format == AudioSampleFormat::S32P, sizeof(int32_t)};
+            return true;
+        case AudioSampleFormat::F32:
+        case AudioSampleFormat::F32P:
+            info = {SampleType::F32, format == AudioSampleFormat::F32P, sizeof(float)};
+            return true;
+        default:
+            return false;
+    }
+}
+
+// compare in this order, so that NaN ends up at the lower bound just like the sse min/max do
+inline float Clamp(float value, float low, float high)
+{
+    value = value > low ? value : low;
+    return value < high ? value : high;
+}
+
+struct AudioKernels {
+    const char* isa;
+    void (*interleave16x2)(const int16_t* left, const int16_t* right, int16_t* dst, size_t n);
+    void (*interleave32x2)(const int32_t* left, const int32_t* right, int32_t* dst, size_t n);
+    void (*deinterleave16x2)(const int16_t* src, int16_t* left, int16_t* right, size_t n);
+    void (*deinterleave32x2)(const int32_t* src, int32_t* left, int32_t* right, size_t n);
+    void (*s16ToF32)(const int16_t* src, float* dst, size_t n);
+    void (*f32ToS16)(const float* src, int16_t* dst, size_t n);
+    void (*s32ToF32)(const int32_t* src, float* dst, size_t n);
+    void (*f32ToS32)(const float* src, int32_t* dst, size_t n);
+    void (*s16ToS32)(const int16_t* src, int32_t* dst, size_t n);
+    void (*s32ToS16)(const int32_t* src, int16_t* dst, size_t n);
+};
+
+// scalar kernels, also used for the tails of the simd ones
+template <typename T>
+void Interleave2C(const T* left, const T* right, T* dst, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        dst[2 * i] = left[i];      // 2: stereo
+        dst[2 * i + 1] = right[i]; // 2: stereo
+    }
+}
+
+template <typename T>
+void Deinterleave2C(const T* src, T* left, T* right, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        left[i] = src[2 * i];      // 2: stereo
+        right[i] = src[2 * i + 1]; // 2: stereo
+    }
+}
+
+void S16ToF32C(const int16_t* src, float* dst, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<float>(src[i]) * (1.0f / S16_SCALE);
+    }
+}
+
+void F32ToS16C(const float* src, int16_t* dst, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<int16_t>(std::lrint(Clamp(src[i] * S16_SCALE, -S16_SCALE, S16_MAX)));
+    }
+}
+
+void S32ToF32C(const int32_t* src, float* dst, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<float>(src[i]) * (1.0f / S32_SCALE);
+    }
+}
+
+void F32ToS32C(const float* src, int32_t* dst, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<int32_t>(std::lrint(Clamp(src[i] * S32_SCALE, -S32_SCALE, S32_MAX)));
+    }
+}
+
+void S16ToS32C(const int16_t* src, int32_t* dst, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<int32_t>(static_cast<uint32_t>(static_cast<int32_t>(src[i])) << S16_SHIFT);
+    }
+}
+
+void S32ToS16C(const int32_t* src, int16_t* dst, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<int16_t>(src[i] >> S16_SHIFT);
+    }
+}
+
+#ifdef AUDIO_FORMAT_SSE2
+void Interleave16x2Sse2(const int16_t* left, const int16_t* right, int16_t* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + i));
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), _mm_unpacklo_epi16(l, r));     // 2: stereo
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i + 8), _mm_unpackhi_epi16(l, r)); // 2: stereo, 8
+    }
+    Interleave2C(left + i, right + i, dst + 2 * i, n - i); // 2: stereo
+}
+
+void Interleave32x2Sse2(const int32_t* left, const int32_t* right, int32_t* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) { // 4 samples per register
+        __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + i));
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), _mm_unpacklo_epi32(l, r));     // 2: stereo
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i + 4), _mm_unpackhi_epi32(l, r)); // 2: stereo, 4
+    }
+    Interleave2C(left + i, right + i, dst + 2 * i, n - i); // 2: stereo
+}
+
+void Deinterleave16x2Sse2(const int16_t* src, int16_t* left, int16_t* right, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));     // 2: stereo
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i + 8)); // 2: stereo, 8
+        // sign extend each half of the 32 bit frames, the saturating pack is then exact
+        __m128i l = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, S16_SHIFT), S16_SHIFT),
+                                    _mm_srai_epi32(_mm_slli_epi32(b, S16_SHIFT), S16_SHIFT));
+        __m128i r = _mm_packs_epi32(_mm_srai_epi32(a, S16_SHIFT), _mm_srai_epi32(b, S16_SHIFT));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(left + i), l);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(right + i), r);
+    }
+    Deinterleave2C(src + 2 * i, left + i, right + i, n - i); // 2: stereo
+}
+
+void Deinterleave32x2Sse2(const int32_t* src, int32_t* left, int32_t* right, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) { // 4 samples per register
+        __m128 a = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i)));     // 2: stereo
+        __m128 b = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i + 4))); // 2, 4
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(left + i),
+                         _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))));  // 2, 0: even lanes
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(right + i),
+                         _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)))); // 3, 1: odd lanes
+    }
+    Deinterleave2C(src + 2 * i, left + i, right + i, n - i); // 2: stereo
+}
+
+void S16ToF32Sse2(const int16_t* src, float* dst, size_t n)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / S16_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), S16_SHIFT);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), S16_SHIFT);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale)); // 4: second half
+    }
+    S16ToF32C(src + i, dst + i, n - i);
+}
+
+void F32ToS16Sse2(const float* src, int16_t* dst, size_t n)
+{
+    const __m128 scale = _mm_set1_ps(S16_SCALE);
+    const __m128 low = _mm_set1_ps(-S16_SCALE);
+    const __m128 high = _mm_set1_ps(S16_MAX);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), low), high);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale), low), high); // 4
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+    F32ToS16C(src + i, dst + i, n - i);
+}
+
+void S32ToF32Sse2(const int32_t* src, float* dst, size_t n)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / S32_SCALE);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) { // 4 samples per register
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(x), scale));
+    }
+    S32ToF32C(src + i, dst + i, n - i);
+}
+
+void F32ToS32Sse2(const float* src, int32_t* dst, size_t n)
+{
+    const __m128 scale = _mm_set1_ps(S32_SCALE);
+    const __m128 low = _mm_set1_ps(-S32_SCALE);
+    const __m128 high = _mm_set1_ps(S32_MAX);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) { // 4 samples per register
+        __m128 x = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), low), high);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_cvtps_epi32(x));
+    }
+    F32ToS32C(src + i, dst + i, n - i);
+}
+
+void S16ToS32Sse2(const int16_t* src, int32_t* dst, size_t n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // the sample lands in the upper half of each 32 bit lane
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(zero, x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(zero, x)); // 4: second half
+    }
+    S16ToS32C(src + i, dst + i, n - i);
+}
+
+void S32ToS16Sse2(const int32_t* src, int16_t* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        __m128i a = _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), S16_SHIFT);
+        __m128i b = _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4)), S16_SHIFT); // 4
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(a, b));
+    }
+    S32ToS16C(src + i, dst + i, n - i);
+}
+#endif // AUDIO_FORMAT_SSE2
+
+#ifdef AUDIO_FORMAT_AVX2
+#define AUDIO_FORMAT_TARGET_AVX2 __attribute__((target("avx2")))
+constexpr int PERMUTE_LANES = 0xD8; // 0, 2, 1, 3: undo the per 128 bit lane packing
+constexpr int LOW_LANES = 0x20;
+constexpr int HIGH_LANES = 0x31;
+
+AUDIO_FORMAT_TARGET_AVX2 void Interleave16x2Avx2(const int16_t* left, const int16_t* right, int16_t* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) { // 16 samples per register
+        __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + i));
+        __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + i));
+        __m256i lo = _mm256_unpacklo_epi16(l, r);
+        __m256i hi = _mm256_unpackhi_epi16(l, r);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i), _mm256_permute2x128_si256(lo, hi, LOW_LANES));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i + 16), // 2: stereo, 16
+                            _mm256_permute2x128_si256(lo, hi, HIGH_LANES));
+    }
+    Interleave16x2Sse2(left + i, right + i, dst + 2 * i, n - i); // 2: stereo
+}
+
+AUDIO_FORMAT_TARGET_AVX2 void Interleave32x2Avx2(const int32_t* left, const int32_t* right, int32_t* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + i));
+        __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + i));
+        __m256i lo = _mm256_unpacklo_epi32(l, r);
+        __m256i hi = _mm256_unpackhi_epi32(l, r);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i), _mm256_permute2x128_si256(lo, hi, LOW_LANES));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i + 8), // 2: stereo, 8
+                            _mm256_permute2x128_si256(lo, hi, HIGH_LANES));
+    }
+    Interleave32x2Sse2(left + i, right + i, dst + 2 * i, n - i); // 2: stereo
+}
+
+AUDIO_FORMAT_TARGET_AVX2 void S16ToF32Avx2(const int16_t* src, float* dst, size_t n)
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / S16_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        __m256i x = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+    }
+    S16ToF32Sse2(src + i, dst + i, n - i);
+}
+
+AUDIO_FORMAT_TARGET_AVX2 void F32ToS16Avx2(const float* src, int16_t* dst, size_t n)
+{
+    const __m256 scale = _mm256_set1_ps(S16_SCALE);
+    const __m256 low = _mm256_set1_ps(-S16_SCALE);
+    const __m256 high = _mm256_set1_ps(S16_MAX);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) { // 16 samples per register
+        __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i), scale), low), high);
+        __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale), low), high); // 8
+        __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute4x64_epi64(packed, PERMUTE_LANES));
+    }
+    F32ToS16Sse2(src + i, dst + i, n - i);
+}
+
+AUDIO_FORMAT_TARGET_AVX2 void S32ToF32Avx2(const int32_t* src, float* dst, size_t n)
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / S32_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+    }
+    S32ToF32Sse2(src + i, dst + i, n - i);
+}
+
+AUDIO_FORMAT_TARGET_AVX2 void F32ToS32Avx2(const float* src, int32_t* dst, size_t n)
+{
+    const __m256 scale = _mm256_set1_ps(S32_SCALE);
+    const __m256 low = _mm256_set1_ps(-S32_SCALE);
+    const __m256 high = _mm256_set1_ps(S32_MAX);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        __m256 x = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i), scale), low), high);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_cvtps_epi32(x));
+    }
+    F32ToS32Sse2(src + i, dst + i, n - i);
+}
+
+AUDIO_FORMAT_TARGET_AVX2 void S16ToS32Avx2(const int16_t* src, int32_t* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        __m256i x = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_slli_epi32(x, S16_SHIFT));
+    }
+    S16ToS32Sse2(src + i, dst + i, n - i);
+}
+
+AUDIO_FORMAT_TARGET_AVX2 void S32ToS16Avx2(const int32_t* src, int16_t* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) { // 16 samples per register
+        __m256i a = _mm256_srai_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), S16_SHIFT);
+        __m256i b = _mm256_srai_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 8)), // 8
+                                      S16_SHIFT);
+        __m256i packed = _mm256_packs_epi32(a, b);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute4x64_epi64(packed, PERMUTE_LANES));
+    }
+    S32ToS16Sse2(src + i, dst + i, n - i);
+}
+#endif // AUDIO_FORMAT_AVX2
+
+#ifdef AUDIO_FORMAT_NEON
+void Interleave16x2Neon(const int16_t* left, const int16_t* right, int16_t* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        int16x8x2_t v = {{vld1q_s16(left + i), vld1q_s16(right + i)}};
+        vst2q_s16(dst + 2 * i, v); // 2: stereo
+    }
+    Interleave2C(left + i, right + i, dst + 2 * i, n - i); // 2: stereo
+}
+
+void Interleave32x2Neon(const int32_t* left, const int32_t* right, int32_t* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) { // 4 samples per register
+        int32x4x2_t v = {{vld1q_s32(left + i), vld1q_s32(right + i)}};
+        vst2q_s32(dst + 2 * i, v); // 2: stereo
+    }
+    Interleave2C(left + i, right + i, dst + 2 * i, n - i); // 2: stereo
+}
+
+void Deinterleave16x2Neon(const int16_t* src, int16_t* left, int16_t* right, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        int16x8x2_t v = vld2q_s16(src + 2 * i); // 2: stereo
+        vst1q_s16(left + i, v.val[0]);
+        vst1q_s16(right + i, v.val[1]);
+    }
+    Deinterleave2C(src + 2 * i, left + i, right + i, n - i); // 2: stereo
+}
+
+void Deinterleave32x2Neon(const int32_t* src, int32_t* left, int32_t* right, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) { // 4 samples per register
+        int32x4x2_t v = vld2q_s32(src + 2 * i); // 2: stereo
+        vst1q_s32(left + i, v.val[0]);
+        vst1q_s32(right + i, v.val[1]);
+    }
+    Deinterleave2C(src + 2 * i, left + i, right + i, n - i); // 2: stereo
+}
+
+void S16ToF32Neon(const int16_t* src, float* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        int16x8_t x = vld1q_s16(src + i);
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), 1.0f / S16_SCALE));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), 1.0f / S16_SCALE)); // 4
+    }
+    S16ToF32C(src + i, dst + i, n - i);
+}
+
+void F32ToS16Neon(const float* src, int16_t* dst, size_t n)
+{
+    const float32x4_t low = vdupq_n_f32(-S16_SCALE);
+    const float32x4_t high = vdupq_n_f32(S16_MAX);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        float32x4_t a = vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(src + i), S16_SCALE), low), high);
+        float32x4_t b = vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(src + i + 4), S16_SCALE), low), high); // 4
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b))));
+    }
+    F32ToS16C(src + i, dst + i, n - i);
+}
+
+void S32ToF32Neon(const int32_t* src, float* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) { // 4 samples per register
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(src + i)), 1.0f / S32_SCALE));
+    }
+    S32ToF32C(src + i, dst + i, n - i);
+}
+
+void F32ToS32Neon(const float* src, int32_t* dst, size_t n)
+{
+    const float32x4_t low = vdupq_n_f32(-S32_SCALE);
+    const float32x4_t high = vdupq_n_f32(S32_MAX);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) { // 4 samples per register
+        float32x4_t x = vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(src + i), S32_SCALE), low), high);
+        vst1q_s32(dst + i, vcvtnq_s32_f32(x));
+    }
+    F32ToS32C(src + i, dst + i, n - i);
+}
+
+void S16ToS32Neon(const int16_t* src, int32_t* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        int16x8_t x = vld1q_s16(src + i);
+        vst1q_s32(dst + i, vshll_n_s16(vget_low_s16(x), S16_SHIFT));
+        vst1q_s32(dst + i + 4, vshll_n_s16(vget_high_s16(x), S16_SHIFT)); // 4: second half
+    }
+    S16ToS32C(src + i, dst + i, n - i);
+}
+
+void S32ToS16Neon(const int32_t* src, int16_t* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 samples per register
+        int16x4_t a = vshrn_n_s32(vld1q_s32(src + i), S16_SHIFT);
+        int16x4_t b = vshrn_n_s32(vld1q_s32(src + i + 4), S16_SHIFT); // 4: second half
+        vst1q_s16(dst + i, vcombine_s16(a, b));
+    }
+    S32ToS16C(src + i, dst + i, n - i);
+}
+#endif // AUDIO_FORMAT_NEON
+
+AudioKernels SelectKernels()
+{
+    AudioKernels kernels {"c", Interleave2C<int16_t>, Interleave2C<int32_t>, Deinterleave2C<int16_t>,
+                          Deinterleave2C<int32_t>, S16ToF32C, F32ToS16C, S32ToF32C, F32ToS32C, S16ToS32C, S32ToS16C};
+#ifdef AUDIO_FORMAT_SSE2
+    kernels = {"sse2", Interleave16x2Sse2, Interleave32x2Sse2, Deinterleave16x2Sse2, Deinterleave32x2Sse2,
+               S16ToF32Sse2, F32ToS16Sse2, S32ToF32Sse2, F32ToS32Sse2, S16ToS32Sse2, S32ToS16Sse2};
+#endif
+#ifdef AUDIO_FORMAT_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        // the deinterleave kernels are load bound, sse2 is as fast there
+        kernels.isa = "avx2";
+        kernels.interleave16x2 = Interleave16x2Avx2;
+        kernels.interleave32x2 = Interleave32x2Avx2;
+        kernels.s16ToF32 = S16ToF32Avx2;
+        kernels.f32ToS16 = F32ToS16Avx2;
+        kernels.s32ToF32 = S32ToF32Avx2;
+        kernels.f32ToS32 = F32ToS32Avx2;
+        kernels.s16ToS32 = S16ToS32Avx2;
+        kernels.s32ToS16 = S32ToS16Avx2;
+    }
+#endif
+#ifdef AUDIO_FORMAT_NEON
+    kernels = {"neon", Interleave16x2Neon, Interleave32x2Neon, Deinterleave16x2Neon, Deinterleave32x2Neon,
+               S16ToF32Neon, F32ToS16Neon, S32ToF32Neon, F32ToS32Neon, S16ToS32Neon, S32ToS16Neon};
+#endif
+    return kernels;
+}
+
+const AudioKernels& GetKernels()
+{
+    static const AudioKernels kernels = SelectKernels();
+    return kernels;
+}
+
+void ConvertType(const AudioKernels& kernels, SampleType srcType, const uint8_t* src, SampleType dstType,
+                 uint8_t* dst, size_t n)
+{
+    auto s16 = [](const uint8_t* ptr) { return reinterpret_cast<const int16_t*>(ptr); };
+    auto s32 = [](const uint8_t* ptr) { return reinterpret_cast<const int32_t*>(ptr); };
+    auto f32 = [](const uint8_t* ptr) { return reinterpret_cast<const float*>(ptr); };
+    switch ((static_cast<uint32_t>(srcType) << 4) | static_cast<uint32_t>(dstType)) { // 4: bits of the dst type
+        case (static_cast<uint32_t>(SampleType::S16) << 4) | static_cast<uint32_t>(SampleType::S32): // 4
+            kernels.s16ToS32(s16(src), reinterpret_cast<int32_t*>(dst), n);
+            break;
+        case (static_cast<uint32_t>(SampleType::S16) << 4) | static_cast<uint32_t>(SampleType::F32): // 4
+            kernels.s16ToF32(s16(src), reinterpret_cast<float*>(dst), n);
+            break;
+        case (static_cast<uint32_t>(SampleType::S32) << 4) | static_cast<uint32_t>(SampleType::S16): // 4
+            kernels.s32ToS16(s32(src), reinterpret_cast<int16_t*>(dst), n);
+            break;
+        case (static_cast<uint32_t>(SampleType::S32) << 4) | static_cast<uint32_t>(SampleType::F32): // 4
+            kernels.s32ToF32(s32(src), reinterpret_cast<float*>(dst), n);
+            break;
+        case (static_cast<uint32_t>(SampleType::F32) << 4) | static_cast<uint32_t>(SampleType::S16): // 4
+            kernels.f32ToS16(f32(src), reinterpret_cast<int16_t*>(dst), n);
+            break;
+        case (static_cast<uint32_t>(SampleType::F32) << 4) | static_cast<uint32_t>(SampleType::S32): // 4
+            kernels.f32ToS32(f32(src), reinterpret_cast<int32_t*>(dst), n);
+            break;
+        default: {
+            size_t size = n * (srcType == SampleType::S16 ? sizeof(int16_t) : sizeof(int32_t));
+            (void)memcpy_s(dst, size, src, size);
+            break;
+        }
+    }
+}
+
+template <typename T>
+void InterleaveN(const uint8_t* const* planes, uint32_t channels, uint8_t* dst, size_t n)
+{
+    auto out = reinterpret_cast<T*>(dst);
+    for (uint32_t c = 0; c < channels; ++c) {
+        auto in = reinterpret_cast<const T*>(planes[c]);
+        for (size_t i = 0; i < n; ++i) {
+            out[i * channels + c] = in[i];
+        }
+    }
+}
+
+template <typename T>
+void DeinterleaveN(const uint8_t* src, uint32_t channels, uint8_t* const* planes, size_t n)
+{
+    auto in = reinterpret_cast<const T*>(src);
+    for (uint32_t c = 0; c < channels; ++c) {
+        auto out = reinterpret_cast<T*>(planes[c]);
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = in[i * channels + c];
+        }
+    }
+}
+
+void Interleave(const AudioKernels& kernels, uint32_t bytes, const uint8_t* const* planes, uint32_t channels,
+                uint8_t* dst, size_t n)
+{
+    if (channels == 1) {
+        (void)memcpy_s(dst, n * bytes, planes[0], n * bytes);
+    } else if (channels == 2 && bytes == sizeof(int16_t)) { // 2: stereo
+        kernels.interleave16x2(reinterpret_cast<const int16_t*>(planes[0]), reinterpret_cast<const int16_t*>(planes[1]),
+                               reinterpret_cast<int16_t*>(dst), n);
+    } else if (channels == 2) { // 2: stereo
+        kernels.interleave32x2(reinterpret_cast<const int32_t*>(planes[0]), reinterpret_cast<const int32_t*>(planes[1]),
+                               reinterpret_cast<int32_t*>(dst), n);
+    } else if (bytes == sizeof(int16_t)) {
+        InterleaveN<int16_t>(planes, channels, dst, n);
+    } else {
+        InterleaveN<int32_t>(planes, channels, dst, n);
+    }
+}
+
+void Deinterleave(const AudioKernels& kernels, uint32_t bytes, const uint8_t* src, uint32_t channels,
+                  uint8_t* const* planes, size_t n)
+{
+    if (channels == 1) {
+        (void)memcpy_s(planes[0], n * bytes, src, n * bytes);
+    } else if (channels == 2 && bytes == sizeof(int16_t)) { // 2: stereo
+        kernels.deinterleave16x2(reinterpret_cast<const int16_t*>(src), reinterpret_cast<int16_t*>(planes[0]),
+                                 reinterpret_cast<int16_t*>(planes[1]), n);
+    } else if (channels == 2) { // 2: stereo
+        kernels.deinterleave32x2(reinterpret_cast<const int32_t*>(src), reinterpret_cast<int32_t*>(planes[0]),
+                                 reinterpret_cast<int32_t*>(planes[1]), n);
+    } else if (bytes == sizeof(int16_t)) {
+        DeinterleaveN<int16_t>(src, channels, planes, n);
+    } else {
+        DeinterleaveN<int32_t>(src, channels, planes, n);
+    }
+}
+
+/**
+ * Works on blocks of frames, with the source planes in the planes member. An interleaved source is split into
+ * the first scratch area first, planes converted to the destination type go to the second one.
+ */
+class BlockConverter {
+public:
+    BlockConverter(const AudioKernels& kernels, const FormatInfo& in, const FormatInfo& out, uint32_t channels,
+                   const uint32_t* channelMap)
+        : kernels_(kernels), in_(in), out_(out), channels_(channels), channelMap_(channelMap)
+    {
+        blockSamples_ = SCRATCH_SIZE / (channels * sizeof(int32_t));
+    }
+
+    void Convert(const uint8_t* const* src, uint8_t* const* dst, size_t samples)
+    {
+        for (size_t done = 0; done < samples; done += blockSamples_) {
+            size_t n = std::min(blockSamples_, samples - done);
+            const uint8_t* planes[MAX_AUDIO_CONVERT_CHANNELS] = {nullptr};
+            if (in_.planar) {
+                for (uint32_t c = 0; c < channels_; ++c) {
+                    planes[c] = src[c] + done * in_.bytes;
+                }
+            } else {
+                uint8_t* split[MAX_AUDIO_CONVERT_CHANNELS] = {nullptr};
+                for (uint32_t c = 0; c < channels_; ++c) {
+                    split[c] = splitScratch_ + c * n * in_.bytes;
+                    planes[c] = split[c];
+                }
+                Deinterleave(kernels_, in_.bytes, src[0] + done * channels_ * in_.bytes, channels_, split, n);
+            }
+            if (out_.planar) {
+                for (uint32_t c = 0; c < channels_; ++c) {
+                    ConvertType(kernels_, in_.type, planes[SrcChannel(c)], out_.type, dst[c] + done * out_.bytes, n);
+                }
+                continue;
+            }
+            const uint8_t* converted[MAX_AUDIO_CONVERT_CHANNELS] = {nullptr};
+            for (uint32_t c = 0; c < channels_; ++c) {
+                if (in_.type == out_.type) {
+                    converted[c] = planes[SrcChannel(c)];
+                } else {
+                    uint8_t* plane = typeScratch_ + c * n * out_.bytes;
+                    ConvertType(kernels_, in_.type, planes[SrcChannel(c)], out_.type, plane, n);
+                    converted[c] = plane;
+                }
+            }
+            Interleave(kernels_, out_.bytes, converted, channels_, dst[0] + done * channels_ * out_.bytes, n);
+        }
+    }
+
+private:
+    uint32_t SrcChannel(uint32_t channel) const
+    {
+        return channelMap_ == nullptr ? channel : channelMap_[channel];
+    }
+
+    const AudioKernels& kernels_;
+    const FormatInfo& in_;
+    const FormatInfo& out_;
+    uint32_t channels_;
+    const uint32_t* channelMap_;
+    size_t blockSamples_ {0};
+    alignas(32) uint8_t splitScratch_[SCRATCH_SIZE] {};
+    alignas(32) uint8_t typeScratch_[SCRATCH_SIZE] {};
+};
+} // namespace
+
+bool IsAudioConvertSupported(Plugin::AudioSampleFormat srcFormat, Plugin::AudioSampleFormat dstFormat,
+                             uint32_t channels)
+{
+    FormatInfo in {};
+    FormatInfo out {};
+    return GetFormatInfo(srcFormat, in) && GetFormatInfo(dstFormat, out) && channels > 0 &&
+        channels <= MAX_AUDIO_CONVERT_CHANNELS;
+}
+
+uint32_t GetAudioConvertSampleBytes(Plugin::AudioSampleFormat format)
+{
+    FormatInfo info {};
+    return GetFormatInfo(format, info) ? info.bytes : 0;
+}
+
+bool ConvertAudioSamples(const uint8_t* const* src, Plugin::AudioSampleFormat srcFormat, uint8_t* const* dst,
+                         Plugin::AudioSampleFormat dstFormat, uint32_t channels, uint32_t samples,
+                         const uint32_t* channelMap)
+{
+    FormatInfo in {};
+    FormatInfo out {};
+    if (!GetFormatInfo(srcFormat, in) || !GetFormatInfo(dstFormat, out) || src == nullptr || dst == nullptr ||
+        channels == 0 || channels > MAX_AUDIO_CONVERT_CHANNELS) {
+        return false;
+    }
+    if (channelMap != nullptr) {
+        for (uint32_t c = 0; c < channels; ++c) {
+            if (channelMap[c] >= channels) {
+                return false;
+            }
+        }
+    }
+    if (samples == 0) {
+        return true;
+    }
+    const auto& kernels = GetKernels();
+    // the layout stays the same: a single pass over the data, or one per plane
+    if (!in.planar && !out.planar && (channelMap == nullptr || channels == 1)) {
+        ConvertType(kernels, in.type, src[0], out.type, dst[0], static_cast<size_t>(samples) * channels);
+        return true;
+    }
+    if (in.planar && out.planar) {
+        for (uint32_t c = 0; c < channels; ++c) {
+            ConvertType(kernels, in.type, src[channelMap == nullptr ? c : channelMap[c]], out.type, dst[c], samples);
+        }
+        return true;
+    }
+    if (!in.planar && in.type == out.type && channelMap == nullptr) {
+        Deinterleave(kernels, in.bytes, src[0], channels, dst, samples);
+        return true;
+    }
+    BlockConverter converter(kernels, in, out, channels, channelMap);
+    converter.Convert(src, dst, samples);
+    return true;
+}
+
+const char* GetAudioConvertIsa()
+{
+    return GetKernels().isa;
+}
+} // namespace Media
+} // namespace OHOS
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HISTREAMER_AUDIO_FORMAT_H
+#define HISTREAMER_AUDIO_FORMAT_H
+
+#include <cstdint>
+#include "plugin/common/plugin_audio_tags.h"
+
+namespace OHOS {
+namespace Media {
+/**
+ * Maximum channel count handled by ConvertAudioSamples.
+ */
+constexpr uint32_t MAX_AUDIO_CONVERT_CHANNELS = 64;
+
+/**
+ * Whether ConvertAudioSamples can convert between the two formats with that many channels. S16, S32 and F32 are
+ * supported, interleaved and planar, with up to MAX_AUDIO_CONVERT_CHANNELS channels. Anything else has to go
+ * through a resampler.
+ */
+bool IsAudioConvertSupported(Plugin::AudioSampleFormat srcFormat, Plugin::AudioSampleFormat dstFormat,
+                             uint32_t channels);
+
+/**
+ * Returns the size of one sample of one channel, or 0 if the format is not supported by ConvertAudioSamples.
+ */
+uint32_t GetAudioConvertSampleBytes(Plugin::AudioSampleFormat format);
+
+/**
+ * Converts PCM between sample formats and layouts, the sample rate is left as it is.
+ * The float formats use the [-1.0, 1.0) range; converting to integers rounds to nearest and saturates.
+ * The kernels are picked once at runtime from the instruction sets the cpu supports.
+ *
+ * @param src source planes, one per channel for planar formats, only src[0] is used for interleaved ones
+ * @param srcFormat source sample format
+ * @param dst destination planes, same convention as src. It must not overlap src.
+ * @param dstFormat destination sample format
+ * @param channels channel count of both source and destination
+ * @param samples samples per channel
+ * @param channelMap optional, destination channel i is taken from source channel channelMap[i]
+ * @return false if the formats, the channel count or the map are not supported
+ */
+bool ConvertAudioSamples(const uint8_t* const* src, Plugin::AudioSampleFormat srcFormat, uint8_t* const* dst,
+                         Plugin::AudioSampleFormat dstFormat, uint32_t channels, uint32_t samples,
+                         const uint32_t* channelMap = nullptr);
+
+/**
+ * Name of the kernel set picked at runtime, e.g. "avx2", for logging.
+ */
+const char* GetAudioConvertIsa();
+} // namespace Media
+} // namespace OHOS
+#endif // HISTREAMER_AUDIO_FORMAT_H
@@ -16,17 +16,35 @@
 #ifndef HISTREAMER_FOUNDATION_BUFFER_POOL_H
 #define HISTREAMER_FOUNDATION_BUFFER_POOL_H
 
+#include <array>
 #include <atomic>
-#include <list>
+#include <cstddef>
 #include <memory>
+#include <new>
 #include "constants.h"
 #include "foundation/osal/thread/condition_variable.h"
 #include "foundation/osal/thread/mutex.h"
 #include "foundation/osal/thread/scoped_lock.h"
+#include "foundation/osal/utils/util.h"
 #include "plugin/common/plugin_buffer.h"
 
 namespace OHOS {
 namespace Media {
+/**
+ * Fixed set of pre-allocated buffers shared between a producer and the consumers it pushes to.
+ *
+ * Buffers live in an index-addressed slot table that never shrinks while the pool is alive. Free buffers are
+ * kept in one lock-free index stack per size class, so allocating and recycling are a couple of CAS operations
+ * and never allocate. The mutex is only taken by AllocateBuffer() when it has to park, by the recycling side
+ * when it sees a parked allocator, and when the slot table grows.
+ *
+ * Buffers created by Init()/AddSizeClass() share one pre-faulted backing block per size class.
+ *
+ * Every buffer comes with room for the control block of the shared pointer it is handed out with, so allocating
+ * does not touch the heap either. A buffer is recycled when that control block is released, i.e. when the last
+ * shared and weak pointer to it is gone. Buffers do not keep the pool alive, those still out when it is destroyed
+ * are deleted one by one as they come back.
+ */
 template <typename T>
 class BufferPool : public std::enable_shared_from_this<BufferPool<T>> {
 public:
@@ -43,9 +61,13 @@ public:
         isActive_ = false;
         {
             OSAL::ScopedLock lock(mutex_);
-            cv_.NotifyOne();
+            cv_.NotifyAll();
         }
         FinishAllocInProgress();
+        DeleteFreeBuffers();
+        for (auto& chunk : chunks_) {
+            delete chunk.load(std::memory_order_relaxed);
+        }
     }
 
     static std::shared_ptr<BufferPool<T>> Create(size_t poolSize)
@@ -62,112 +84,428 @@ public:
         metaType_ = type;
         msgSize_ = msgSize;
         align_ = align;
-        freeBuffers_.clear();
-        for (size_t i = 0; i < poolSize_; ++i) {
-            auto buf = new Plugin::Buffer(type);
-            buf->AllocMemory(nullptr, msgSize);
-            freeBuffers_.emplace_back(std::unique_ptr<T>(buf));
+        // buffers still held outside are deleted instead of recycled, see Recycle()
+        generation_.fetch_add(1, std::memory_order_acq_rel);
+        DeleteFreeBuffers();
+        classCount_.store(0, std::memory_order_release);
+        slotCount_.store(0, std::memory_order_release);
+        freeCount_.store(0, std::memory_order_release);
+        size_t poolSize = poolSize_.load();
+        poolSize_ = 0;
+        AddSizeClass(msgSize, poolSize);
+    }
+
+    /**
+     * Adds bufferCnt buffers of msgSize bytes to the pool, so that outputs of different sizes can share one pool.
+     * The buffers are carved out of one block which is touched here, so that no page fault is taken on the
+     * data path.
+     */
+    bool AddSizeClass(size_t msgSize, size_t bufferCnt)
+    {
+        if (bufferCnt == 0) {
+            return true;
+        }
+        size_t sizeClass = FindOrAddSizeClass(msgSize);
+        if (sizeClass == INVALID_INDEX) {
+            return false;
         }
+        size_t stride = Plugin::AlignUp(msgSize, align_ > 0 ? align_ : DEFAULT_ALIGN);
+        size_t alignment = align_ > 0 ? align_ : 1;
+        size_t blockSize = stride * bufferCnt + alignment - 1;
+        std::shared_ptr<uint8_t> block(new (std::nothrow) uint8_t[blockSize], std::default_delete<uint8_t[]>());
+        if (block == nullptr) {
+            return false;
+        }
+        (void)memset_s(block.get(), blockSize, 0, blockSize);
+        size_t base = static_cast<size_t>(Plugin::AlignUp(reinterpret_cast<uintptr_t>(block.get()), alignment) -
+                                          reinterpret_cast<uintptr_t>(block.get()));
+        for (size_t i = 0; i < bufferCnt; ++i) {
+            auto buf = new T(metaType_);
+            buf->WrapMemoryPtr(std::shared_ptr<uint8_t>(block, block.get() + base + i * stride), msgSize, 0);
+            if (!AddBuffer(buf, sizeClass)) {
+                delete buf;
+                return false;
+            }
+            poolSize_++;
+        }
+        return true;
     }
 
     bool Append(std::unique_ptr<T> buffer)
     {
-        OSAL::ScopedLock lock(mutex_);
-        if (!isActive_ || freeBuffers_.size() >= poolSize_) {
+        if (!isActive_ || buffer == nullptr || freeCount_.load() >= poolSize_.load()) {
+            return false;
+        }
+        auto memory = buffer->GetMemory();
+        size_t sizeClass = FindOrAddSizeClass(memory != nullptr ? memory->GetCapacity() : 0);
+        if (sizeClass == INVALID_INDEX || !AddBuffer(buffer.get(), sizeClass)) {
             return false;
         }
-        freeBuffers_.emplace_back(std::move(buffer));
-        cv_.NotifyOne();
+        buffer.release();
         return true;
     }
 
     void SetActive(bool active)
     {
-        OSAL::ScopedLock lock(mutex_);
+        isActive_ = active;
         if (!active) {
-            cv_.NotifyOne();
+            OSAL::ScopedLock lock(mutex_);
+            cv_.NotifyAll();
         }
-        isActive_ = active;
     }
 
-    void RecycleBuffer(std::unique_ptr<T> buffer) const
+    std::shared_ptr<T> AllocateBuffer(size_t minSize = 0)
     {
-        OSAL::ScopedLock lock(mutex_);
-        freeBuffers_.emplace_back(std::move(buffer));
-        cv_.NotifyOne();
-    }
-
-    std::shared_ptr<T> AllocateBuffer()
-    {
-        OSAL::ScopedLock lock(mutex_);
         allocInProgress = true;
-        if (freeBuffers_.empty() && isActive_) {
-            cv_.Wait(lock, [this] { return !isActive_ || !freeBuffers_.empty(); });
-        }
         std::shared_ptr<T> buffer;
-        if (isActive_) {
-            buffer = AllocateBufferUnprotected();
+        for (int spin = 0; isActive_; ++spin) {
+            buffer = AllocateBufferNonBlocking(minSize);
+            if (buffer != nullptr || !HasSizeClass(minSize)) {
+                break; // no buffer of the pool would ever be big enough
+            }
+            if (spin < SPIN_COUNT) {
+                OSAL::CpuRelax();
+                continue;
+            }
+            OSAL::ScopedLock lock(mutex_);
+            waiters_.fetch_add(1, std::memory_order_seq_cst);
+            cv_.Wait(lock, [this, minSize] { return !isActive_ || HasFreeBuffer(minSize); });
+            waiters_.fetch_sub(1, std::memory_order_relaxed);
+            spin = 0;
+        }
+        {
+            OSAL::ScopedLock lock(mutex_);
+            allocInProgress = false;
+            cvFinishAlloc_.NotifyOne();
         }
-        allocInProgress = false;
-        cvFinishAlloc_.NotifyOne();
         return buffer;
     }
 
-    std::shared_ptr<T> AllocateBufferNonBlocking()
+    std::shared_ptr<T> AllocateBufferNonBlocking(size_t minSize = 0)
     {
-        OSAL::ScopedLock lock(mutex_);
-        if (freeBuffers_.empty() || !isActive_) {
+        if (!isActive_) {
             return nullptr;
         }
-        return AllocateBufferUnprotected();
+        size_t index = PopFree(minSize);
+        if (index == INVALID_INDEX) {
+            return nullptr;
+        }
+        return MakeShared(index);
     }
 
     std::shared_ptr<T> AllocateAppendBufferNonBlocking()
     {
-        OSAL::ScopedLock lock(mutex_);
         if (!isActive_) {
             return nullptr;
         }
-        if (freeBuffers_.empty()) {
-            poolSize_++;
-            auto buf = new Plugin::Buffer(metaType_);
-            buf->AllocMemory(nullptr, msgSize_);
-            freeBuffers_.emplace_back(std::unique_ptr<T>(buf));
+        size_t index = PopFree(0);
+        if (index != INVALID_INDEX) {
+            return MakeShared(index);
         }
-        return AllocateBufferUnprotected();
+        size_t sizeClass = FindOrAddSizeClass(msgSize_);
+        auto buf = new T(metaType_);
+        buf->AllocMemory(nullptr, msgSize_);
+        if (sizeClass == INVALID_INDEX || !AddBuffer(buf, sizeClass)) {
+            delete buf;
+            return nullptr;
+        }
+        poolSize_++;
+        index = PopFree(0);
+        return index == INVALID_INDEX ? nullptr : MakeShared(index);
     }
 
     size_t Size() const
     {
-        OSAL::ScopedLock lock(mutex_);
-        return freeBuffers_.size();
+        return freeCount_.load(std::memory_order_acquire);
     }
 
     size_t Capacity() const
     {
-        return poolSize_;
+        return poolSize_.load();
     }
 
     bool Empty() const
     {
-        OSAL::ScopedLock lock(mutex_);
-        return freeBuffers_.empty();
+        return Size() == 0;
     }
 
 private:
-    std::shared_ptr<T> AllocateBufferUnprotected()
-    {
-        std::weak_ptr<BufferPool<T>> weakRef(this->shared_from_this());
-        std::shared_ptr<T> sptr(freeBuffers_.front().release(), [weakRef](T* ptr) {
-            auto pool = weakRef.lock();
-            if (pool) {
-                pool->RecycleBuffer(std::unique_ptr<T>(ptr));
+    static constexpr size_t INVALID_INDEX = static_cast<size_t>(-1);
+    static constexpr uint32_t NIL = UINT32_MAX;
+    static constexpr size_t MAX_SIZE_CLASS = 8;
+    static constexpr size_t SLOTS_PER_CHUNK = 64;
+    static constexpr size_t MAX_CHUNKS = 64;
+    static constexpr size_t DEFAULT_ALIGN = 64;
+    static constexpr int SPIN_COUNT = 64;
+    static constexpr size_t REF_BLOCK_SIZE = 96;
+
+    struct Entry {
+        explicit Entry(T* buf) : buffer(buf)
+        {
+        }
+
+        T* buffer;
+        alignas(std::max_align_t) uint8_t refBlock[REF_BLOCK_SIZE]; // control block of the handed out pointer
+    };
+
+    /**
+     * Places the control block of a handed out pointer in its entry and recycles the entry when the control block
+     * is released, which is the last access to it. If the pool is gone by then, the entry is deleted instead.
+     */
+    template <typename U>
+    struct EntryAllocator {
+        using value_type = U;
+
+        EntryAllocator(std::weak_ptr<BufferPool<T>> pool, Entry* entry, size_t index, uint32_t generation)
+            : pool(std::move(pool)), entry(entry), index(index), generation(generation)
+        {
+        }
+
+        template <typename V>
+        EntryAllocator(const EntryAllocator<V>& other) // NOLINT: rebind
+            : pool(other.pool), entry(other.entry), index(other.index), generation(other.generation)
+        {
+        }
+
+        U* allocate(size_t n)
+        {
+            if (n * sizeof(U) <= sizeof(entry->refBlock) && alignof(U) <= alignof(std::max_align_t)) {
+                return reinterpret_cast<U*>(entry->refBlock);
+            }
+            return static_cast<U*>(::operator new(n * sizeof(U)));
+        }
+
+        void deallocate(U* ptr, size_t)
+        {
+            if (reinterpret_cast<uint8_t*>(ptr) != entry->refBlock) {
+                ::operator delete(ptr);
+            }
+            auto owner = pool.lock();
+            if (owner != nullptr) {
+                owner->Recycle(entry, index, generation);
             } else {
-                delete ptr;
+                delete entry->buffer;
+                delete entry; // holds the control block being released, nothing touches it after this
             }
-        });
-        freeBuffers_.pop_front();
-        return sptr;
+        }
+
+        template <typename V>
+        bool operator==(const EntryAllocator<V>& other) const
+        {
+            return entry == other.entry;
+        }
+
+        template <typename V>
+        bool operator!=(const EntryAllocator<V>& other) const
+        {
+            return entry != other.entry;
+        }
+
+        std::weak_ptr<BufferPool<T>> pool;
+        Entry* entry;
+        size_t index;
+        uint32_t generation;
+    };
+
+    struct Slot {
+        Entry* entry {nullptr}; // owned by the pool while the slot is in a free stack
+        size_t sizeClass {0};
+        std::atomic<uint32_t> next {NIL};
+    };
+
+    struct Chunk {
+        Slot slots[SLOTS_PER_CHUNK];
+    };
+
+    struct SizeClass {
+        size_t msgSize {0};
+        std::atomic<uint64_t> head {NIL}; // high 32 bits: ABA tag, low 32 bits: slot index
+    };
+
+    static uint64_t Pack(uint64_t tag, uint32_t index)
+    {
+        return (tag << 32) | index; // 32
+    }
+
+    static uint32_t IndexOf(uint64_t head)
+    {
+        return static_cast<uint32_t>(head & 0xFFFFFFFFu);
+    }
+
+    static uint64_t TagOf(uint64_t head)
+    {
+        return head >> 32; // 32
+    }
+
+    Slot& GetSlot(size_t index) const
+    {
+        return chunks_[index / SLOTS_PER_CHUNK].load(std::memory_order_acquire)->slots[index % SLOTS_PER_CHUNK];
+    }
+
+    size_t FindOrAddSizeClass(size_t msgSize)
+    {
+        size_t count = classCount_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            if (classes_[i].msgSize == msgSize) {
+                return i;
+            }
+        }
+        OSAL::ScopedLock lock(growMutex_);
+        count = classCount_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            if (classes_[i].msgSize == msgSize) {
+                return i;
+            }
+        }
+        if (count >= MAX_SIZE_CLASS) {
+            return INVALID_INDEX;
+        }
+        classes_[count].msgSize = msgSize;
+        classes_[count].head.store(NIL, std::memory_order_relaxed);
+        classCount_.store(count + 1, std::memory_order_release);
+        return count;
+    }
+
+    bool AddBuffer(T* buffer, size_t sizeClass)
+    {
+        auto entry = new (std::nothrow) Entry(buffer);
+        if (entry == nullptr) {
+            return false;
+        }
+        size_t index;
+        {
+            OSAL::ScopedLock lock(growMutex_);
+            index = slotCount_.load(std::memory_order_relaxed);
+            size_t chunk = index / SLOTS_PER_CHUNK;
+            if (chunk >= MAX_CHUNKS) {
+                delete entry;
+                return false;
+            }
+            if (chunks_[chunk].load(std::memory_order_relaxed) == nullptr) {
+                chunks_[chunk].store(new Chunk(), std::memory_order_release);
+            }
+            slotCount_.store(index + 1, std::memory_order_release);
+        }
+        Slot& slot = GetSlot(index);
+        slot.entry = entry;
+        slot.sizeClass = sizeClass;
+        PushFree(index);
+        return true;
+    }
+
+    void PushFree(size_t index)
+    {
+        Slot& slot = GetSlot(index);
+        std::atomic<uint64_t>& head = classes_[slot.sizeClass].head;
+        uint64_t old = head.load(std::memory_order_relaxed);
+        do {
+            slot.next.store(IndexOf(old), std::memory_order_relaxed);
+        } while (!head.compare_exchange_weak(old, Pack(TagOf(old) + 1, static_cast<uint32_t>(index)),
+                                             std::memory_order_release, std::memory_order_relaxed));
+        freeCount_.fetch_add(1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) > 0) {
+            OSAL::ScopedLock lock(mutex_);
+            cv_.NotifyAll();
+        }
+    }
+
+    size_t PopFreeFromClass(size_t classIndex)
+    {
+        std::atomic<uint64_t>& head = classes_[classIndex].head;
+        uint64_t old = head.load(std::memory_order_acquire);
+        while (IndexOf(old) != NIL) {
+            uint32_t next = GetSlot(IndexOf(old)).next.load(std::memory_order_relaxed);
+            if (head.compare_exchange_weak(old, Pack(TagOf(old) + 1, next), std::memory_order_acquire,
+                                           std::memory_order_acquire)) {
+                freeCount_.fetch_sub(1, std::memory_order_release);
+                return IndexOf(old);
+            }
+        }
+        return INVALID_INDEX;
+    }
+
+    // Pop from the smallest size class which can hold minSize bytes and still has free buffers.
+    size_t PopFree(size_t minSize)
+    {
+        size_t count = classCount_.load(std::memory_order_acquire);
+        while (true) {
+            size_t best = INVALID_INDEX;
+            for (size_t i = 0; i < count; ++i) {
+                if (classes_[i].msgSize >= minSize && IndexOf(classes_[i].head.load()) != NIL &&
+                    (best == INVALID_INDEX || classes_[i].msgSize < classes_[best].msgSize)) {
+                    best = i;
+                }
+            }
+            if (best == INVALID_INDEX) {
+                return INVALID_INDEX;
+            }
+            size_t index = PopFreeFromClass(best);
+            if (index != INVALID_INDEX) {
+                return index;
+            }
+        }
+    }
+
+    bool HasSizeClass(size_t minSize) const
+    {
+        if (minSize == 0) {
+            return true; // any buffer appended later will do
+        }
+        size_t count = classCount_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            if (classes_[i].msgSize >= minSize) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool HasFreeBuffer(size_t minSize) const
+    {
+        size_t count = classCount_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            if (classes_[i].msgSize >= minSize && IndexOf(classes_[i].head.load()) != NIL) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::shared_ptr<T> MakeShared(size_t index)
+    {
+        Slot& slot = GetSlot(index);
+        Entry* entry = slot.entry;
+        slot.entry = nullptr;
+        uint32_t generation = generation_.load(std::memory_order_acquire);
+        // the buffer goes back to the pool in EntryAllocator::deallocate(), the deleter has nothing to do
+        return std::shared_ptr<T>(entry->buffer, [](T*) {},
+                                  EntryAllocator<T>(this->shared_from_this(), entry, index, generation));
+    }
+
+    void Recycle(Entry* entry, size_t index, uint32_t generation)
+    {
+        if (generation != generation_.load(std::memory_order_acquire)) {
+            delete entry->buffer;
+            delete entry;
+            return;
+        }
+        GetSlot(index).entry = entry;
+        PushFree(index);
+    }
+
+    void DeleteFreeBuffers()
+    {
+        size_t count = classCount_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            size_t index;
+            while ((index = PopFreeFromClass(i)) != INVALID_INDEX) {
+                Slot& slot = GetSlot(index);
+                delete slot.entry->buffer;
+                delete slot.entry;
+                slot.entry = nullptr;
+            }
+        }
     }
 
     void FinishAllocInProgress()
@@ -181,13 +519,20 @@ private:
     mutable OSAL::Mutex mutex_;
     mutable OSAL::ConditionVariable cv_;
     mutable OSAL::ConditionVariable cvFinishAlloc_;
-    mutable std::list<std::unique_ptr<T>> freeBuffers_;
-    size_t poolSize_ {0};
+    OSAL::Mutex growMutex_;
+    mutable std::array<std::atomic<Chunk*>, MAX_CHUNKS> chunks_ {};
+    std::array<SizeClass, MAX_SIZE_CLASS> classes_ {};
+    std::atomic<size_t> classCount_ {0};
+    std::atomic<size_t> slotCount_ {0};
+    std::atomic<size_t> freeCount_ {0};
+    std::atomic<uint32_t> generation_ {0};
+    std::atomic<int> waiters_ {0};
+    std::atomic<size_t> poolSize_ {0};
     size_t msgSize_ {0};
     size_t align_ {0}; // 0: use default alignment.
     std::atomic<bool> isActive_;
     std::atomic<bool> allocInProgress;
-    Plugin::BufferMetaType metaType_;
+    Plugin::BufferMetaType metaType_ {Plugin::BufferMetaType::AUDIO};
 };
 } // namespace Media
 } // namespace OHOS
@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HISTREAMER_FOUNDATION_LOCK_FREE_QUEUE_H
+#define HISTREAMER_FOUNDATION_LOCK_FREE_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include "constants.h"
+#include "foundation/log.h"
+#include "foundation/osal/thread/condition_variable.h"
+#include "foundation/osal/thread/mutex.h"
+#include "foundation/osal/thread/scoped_lock.h"
+#include "foundation/osal/utils/util.h"
+
+namespace OHOS {
+namespace Media {
+/**
+ * Bounded lock-free queue with the same Push/Pop/SetActive semantics as BlockingQueue.
+ *
+ * It is meant for the filter-to-filter buffer hand-off, where there is one producer and one consumer thread.
+ * The fast path is a single compare-and-swap on each side. A blocked side spins for a short while, and parks on
+ * a condition variable only if the queue stays full/empty; the other side touches the mutex only when it sees
+ * a parked waiter. Clear() and SetActive() may be called from any thread, and a consumer may re-queue elements
+ * it popped, so slots are claimed with a per-slot sequence number rather than assuming strict SPSC usage.
+ */
+template <typename T>
+class LockFreeQueue {
+public:
+    explicit LockFreeQueue(std::string name, size_t capacity = DEFAULT_QUEUE_SIZE)
+        : name_(std::move(name)), capacity_(capacity), ringSize_(RoundUpPowerOfTwo(capacity)),
+          slots_(new Slot[ringSize_])
+    {
+        for (size_t i = 0; i < ringSize_; ++i) {
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+    ~LockFreeQueue() = default;
+
+    size_t Size() const
+    {
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t Capacity() const
+    {
+        return capacity_;
+    }
+
+    bool Empty() const
+    {
+        return Size() == 0;
+    }
+
+    bool Push(const T& value)
+    {
+        return PushUntil(value, -1);
+    }
+
+    bool Push(const T& value, int timeoutMs)
+    {
+        return PushUntil(value, timeoutMs < 0 ? 0 : timeoutMs);
+    }
+
+    T Pop()
+    {
+        return PopUntil(-1);
+    }
+
+    T Pop(int timeoutMs)
+    {
+        return PopUntil(timeoutMs < 0 ? 0 : timeoutMs);
+    }
+
+    void Clear()
+    {
+        T value;
+        while (TryPop(value)) {
+            value = T();
+        }
+        WakeUp(pushWaiters_, cvNotFull_);
+    }
+
+    void SetActive(bool active)
+    {
+        MEDIA_LOG_D("SetActive for " PUBLIC_LOG_S ": " PUBLIC_LOG_D32 ".", name_.c_str(), active);
+        isActive_.store(active, std::memory_order_seq_cst);
+        if (!active) {
+            Clear();
+            OSAL::ScopedLock lock(mutex_);
+            cvNotEmpty_.NotifyAll();
+            cvNotFull_.NotifyAll();
+        }
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq {0};
+        T value {};
+    };
+
+    static constexpr int SPIN_COUNT = 128;
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    static size_t RoundUpPowerOfTwo(size_t value)
+    {
+        size_t ret = 1;
+        while (ret < value) {
+            ret <<= 1;
+        }
+        return ret;
+    }
+
+    bool TryPush(const T& value)
+    {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            if (pos - head_.load(std::memory_order_acquire) >= capacity_) {
+                return false;
+            }
+            Slot& slot = slots_[pos & (ringSize_ - 1)];
+            size_t seq = slot.seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool TryPop(T& value)
+    {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[pos & (ringSize_ - 1)];
+            size_t seq = slot.seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(slot.value);
+                    slot.value = T();
+                    slot.seq.store(pos + ringSize_, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool HasData() const
+    {
+        size_t pos = head_.load(std::memory_order_acquire);
+        return slots_[pos & (ringSize_ - 1)].seq.load(std::memory_order_acquire) == pos + 1;
+    }
+
+    bool IsFull() const
+    {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire) >= capacity_;
+    }
+
+    // Park the calling thread until pred is true. Returns false if timeoutMs (>= 0) elapsed first.
+    template <typename Predicate>
+    bool Park(std::atomic<int>& waiters, OSAL::ConditionVariable& cv, int timeoutMs, Predicate pred)
+    {
+        OSAL::ScopedLock lock(mutex_);
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        bool ret = true;
+        if (timeoutMs < 0) {
+            cv.Wait(lock, pred);
+        } else {
+            ret = cv.WaitFor(lock, timeoutMs, pred);
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return ret;
+    }
+
+    void WakeUp(std::atomic<int>& waiters, OSAL::ConditionVariable& cv)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0) {
+            OSAL::ScopedLock lock(mutex_);
+            cv.NotifyAll();
+        }
+    }
+
+    bool PushUntil(const T& value, int timeoutMs)
+    {
+        for (int spin = 0;; ++spin) {
+            if (!isActive_.load(std::memory_order_acquire)) {
+                MEDIA_LOG_D("lock free queue " PUBLIC_LOG_S " is inactive for Push.", name_.c_str());
+                return false;
+            }
+            if (TryPush(value)) {
+                break;
+            }
+            if (spin < SPIN_COUNT) {
+                OSAL::CpuRelax();
+                continue;
+            }
+            MEDIA_LOG_D("lock free queue " PUBLIC_LOG_S " is full, waiting for pop.", name_.c_str());
+            if (!Park(pushWaiters_, cvNotFull_, timeoutMs, [this] { return !isActive_.load() || !IsFull(); })) {
+                if (!isActive_.load() || !TryPush(value)) {
+                    return false;
+                }
+                break;
+            }
+            spin = 0;
+        }
+        if (!isActive_.load(std::memory_order_seq_cst)) {
+            // deactivated while pushing, drop everything just like SetActive(false) does
+            Clear();
+            return false;
+        }
+        WakeUp(popWaiters_, cvNotEmpty_);
+        return true;
+    }
+
+    T PopUntil(int timeoutMs)
+    {
+        T value {};
+        for (int spin = 0;; ++spin) {
+            if (!isActive_.load(std::memory_order_acquire)) {
+                MEDIA_LOG_D("lock free queue " PUBLIC_LOG_S " is inactive.", name_.c_str());
+                return {};
+            }
+            if (TryPop(value)) {
+                break;
+            }
+            if (spin < SPIN_COUNT) {
+                OSAL::CpuRelax();
+                continue;
+            }
+            if (!Park(popWaiters_, cvNotEmpty_, timeoutMs, [this] { return !isActive_.load() || HasData(); })) {
+                if (!isActive_.load() || !TryPop(value)) {
+                    return {};
+                }
+                break;
+            }
+            spin = 0;
+        }
+        WakeUp(pushWaiters_, cvNotFull_);
+        return value;
+    }
+
+    std::string name_;
+    const size_t capacity_;
+    const size_t ringSize_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_ {0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_ {0};
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> isActive_ {true};
+    std::atomic<int> pushWaiters_ {0};
+    std::atomic<int> popWaiters_ {0};
+    OSAL::Mutex mutex_;
+    OSAL::ConditionVariable cvNotFull_;
+    OSAL::ConditionVariable cvNotEmpty_;
+};
+} // namespace Media
+} // namespace OHOS
+#endif // HISTREAMER_FOUNDATION_LOCK_FREE_QUEUE_H
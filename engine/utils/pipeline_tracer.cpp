@@ -0,0 +1,412 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define HST_LOG_TAG "PipelineTracer"
+
+#include "pipeline_tracer.h"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <pthread.h>
+#include <unistd.h>
+#include "foundation/log.h"
+#include "foundation/osal/thread/scoped_lock.h"
+
+namespace OHOS {
+namespace Media {
+namespace {
+constexpr int64_t NS_PER_US = 1000;
+constexpr int64_t NS_PER_MS = 1000000;
+constexpr double NS_PER_SECOND = 1e9;
+constexpr size_t THREAD_NAME_SIZE = 16;
+constexpr int US_FRACTION_DIGITS = 3;
+constexpr size_t MAX_RINGS = 64; // rings of exited threads are reused only beyond this count
+
+void AppendJsonString(std::string& out, const char* str)
+{
+    out += '"';
+    for (const char* ptr = str ? str : ""; *ptr != '\0'; ++ptr) {
+        auto ch = static_cast<unsigned char>(*ptr);
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += static_cast<char>(ch);
+        } else if (ch < 0x20) { // 0x20: control characters are dropped
+            out += ' ';
+        } else {
+            out += static_cast<char>(ch);
+        }
+    }
+    out += '"';
+}
+
+void AppendMicroseconds(std::string& out, int64_t ns)
+{
+    char buf[32]; // 32: enough for any int64 with fraction
+    auto len = snprintf(buf, sizeof(buf), "%" PRId64 ".%0*" PRId64, ns / NS_PER_US, US_FRACTION_DIGITS,
+                        ns % NS_PER_US);
+    if (len > 0) {
+        out.append(buf, std::min(static_cast<size_t>(len), sizeof(buf) - 1));
+    }
+}
+
+std::string GetCurrentThreadName()
+{
+#ifdef SUPPORT_PTHREAD_NAME
+    char name[THREAD_NAME_SIZE] = {0};
+    if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0 && name[0] != '\0') {
+        return name;
+    }
+#endif
+    return {};
+}
+} // namespace
+
+/**
+ * Single writer ring of spans. Every slot is guarded by a sequence number so that a reader running concurrently
+ * with the owner thread can tell the slots that were overwritten while it copied them.
+ */
+class PipelineTracer::Ring {
+public:
+    explicit Ring(uint32_t threadId) : slots_(new Slot[RING_CAPACITY])
+    {
+        Reset(threadId);
+    }
+
+    // called with the tracer mutex held
+    void Reset(uint32_t threadId)
+    {
+        threadId_ = threadId;
+        threadName_ = GetCurrentThreadName();
+        startPos_ = written_.load(std::memory_order_acquire);
+        owned_.store(true, std::memory_order_relaxed);
+    }
+
+    void Release()
+    {
+        owned_.store(false, std::memory_order_release);
+    }
+
+    bool IsOwned() const
+    {
+        return owned_.load(std::memory_order_acquire);
+    }
+
+    void Push(const char* name, const char* category, int64_t beginNs, int64_t durationNs, int64_t pts,
+              uint64_t bytes)
+    {
+        uint64_t pos = written_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[pos % RING_CAPACITY];
+        slot.seq.store(pos * 2 + 1, std::memory_order_relaxed); // 2, 1: odd while the slot is being written
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.category.store(category, std::memory_order_relaxed);
+        slot.beginNs.store(beginNs, std::memory_order_relaxed);
+        slot.durationNs.store(durationNs, std::memory_order_relaxed);
+        slot.pts.store(pts, std::memory_order_relaxed);
+        slot.bytes.store(bytes, std::memory_order_relaxed);
+        slot.seq.store(pos * 2 + 2, std::memory_order_release); // 2: even once the span at pos is complete
+        written_.store(pos + 1, std::memory_order_release);
+    }
+
+    // called with the tracer mutex held
+    void Read(std::vector<TraceEvent>& events) const
+    {
+        uint64_t end = written_.load(std::memory_order_acquire);
+        uint64_t begin = std::max(startPos_, end > RING_CAPACITY ? end - RING_CAPACITY : 0);
+        for (uint64_t pos = begin; pos < end; ++pos) {
+            const Slot& slot = slots_[pos % RING_CAPACITY];
+            uint64_t seq = slot.seq.load(std::memory_order_acquire);
+            TraceEvent event;
+            event.name = slot.name.load(std::memory_order_relaxed);
+            event.category = slot.category.load(std::memory_order_relaxed);
+            event.beginNs = slot.beginNs.load(std::memory_order_relaxed);
+            event.durationNs = slot.durationNs.load(std::memory_order_relaxed);
+            event.pts = slot.pts.load(std::memory_order_relaxed);
+            event.bytes = slot.bytes.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq != pos * 2 + 2 || slot.seq.load(std::memory_order_relaxed) != seq) { // 2: see Push
+                continue; // overwritten meanwhile
+            }
+            event.threadId = threadId_;
+            events.push_back(event);
+        }
+    }
+
+    // called with the tracer mutex held
+    void Clear()
+    {
+        startPos_ = written_.load(std::memory_order_acquire);
+    }
+
+    uint32_t GetThreadId() const
+    {
+        return threadId_;
+    }
+
+    const std::string& GetThreadName() const
+    {
+        return threadName_;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> seq {0};
+        std::atomic<const char*> name {nullptr};
+        std::atomic<const char*> category {nullptr};
+        std::atomic<int64_t> beginNs {0};
+        std::atomic<int64_t> durationNs {0};
+        std::atomic<int64_t> pts {-1};
+        std::atomic<uint64_t> bytes {0};
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<uint64_t> written_ {0};
+    std::atomic<bool> owned_ {false};
+    uint64_t startPos_ {0};
+    uint32_t threadId_ {0};
+    std::string threadName_ {};
+};
+
+PipelineTracer& PipelineTracer::Instance()
+{
+    static PipelineTracer tracer;
+    return tracer;
+}
+
+int64_t PipelineTracer::NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void PipelineTracer::SetEnabled(bool enabled)
+{
+    MEDIA_LOG_I("pipeline tracing " PUBLIC_LOG_S, enabled ? "enabled" : "disabled");
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+const char* PipelineTracer::Intern(const std::string& name)
+{
+    OSAL::ScopedLock lock(mutex_);
+    auto& entry = names_[name];
+    if (!entry) {
+        entry = std::unique_ptr<std::string>(new std::string(name));
+    }
+    return entry->c_str();
+}
+
+std::string PipelineTracer::NewScope(const std::string& prefix)
+{
+    static std::atomic<uint32_t> nextScopeId {1};
+    return prefix + "#" + std::to_string(nextScopeId.fetch_add(1, std::memory_order_relaxed));
+}
+
+std::shared_ptr<TraceCounters> PipelineTracer::GetCounters(const std::string& scope, const std::string& name)
+{
+    OSAL::ScopedLock lock(mutex_);
+    auto& entry = counters_[std::make_pair(scope, name)];
+    if (!entry.counters) {
+        entry.counters = std::make_shared<TraceCounters>();
+        entry.lastNs = NowNs();
+    }
+    return entry.counters;
+}
+
+void PipelineTracer::RemoveCounters(const std::string& scope)
+{
+    OSAL::ScopedLock lock(mutex_);
+    auto it = counters_.lower_bound(std::make_pair(scope, std::string()));
+    while (it != counters_.end() && it->first.first == scope) {
+        it = counters_.erase(it);
+    }
+}
+
+PipelineTracer::Ring* PipelineTracer::AcquireRing()
+{
+    // the ring goes back to the tracer when the thread exits, its spans stay exportable until the ring is reused
+    struct RingHolder {
+        std::shared_ptr<Ring> ring;
+        ~RingHolder()
+        {
+            if (ring) {
+                ring->Release();
+            }
+        }
+    };
+    thread_local RingHolder holder;
+    if (holder.ring) {
+        return holder.ring.get();
+    }
+    OSAL::ScopedLock lock(mutex_);
+    auto it = rings_.end();
+    if (rings_.size() >= MAX_RINGS) {
+        it = std::find_if(rings_.begin(), rings_.end(), [](const std::shared_ptr<Ring>& ring) {
+            return !ring->IsOwned();
+        });
+    }
+    if (it != rings_.end()) {
+        (*it)->Reset(nextThreadId_++);
+        holder.ring = *it;
+    } else {
+        holder.ring = std::make_shared<Ring>(nextThreadId_++);
+        rings_.push_back(holder.ring);
+    }
+    return holder.ring.get();
+}
+
+void PipelineTracer::Record(const char* name, const char* category, int64_t beginNs, int64_t endNs, int64_t pts,
+                            uint64_t bytes)
+{
+    if (!IsEnabled() || name == nullptr) {
+        return;
+    }
+    AcquireRing()->Push(name, category, beginNs, endNs - beginNs, pts, bytes);
+}
+
+std::vector<TraceEvent> PipelineTracer::Snapshot() const
+{
+    std::vector<TraceEvent> events;
+    {
+        OSAL::ScopedLock lock(mutex_);
+        for (const auto& ring : rings_) {
+            ring->Read(events);
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const TraceEvent& lhs, const TraceEvent& rhs) {
+        return lhs.beginNs < rhs.beginNs;
+    });
+    return events;
+}
+
+TraceCounterStats PipelineTracer::UpdateStats(const std::pair<std::string, std::string>& key, CounterEntry& entry,
+                                              int64_t now)
+{
+    TraceCounterStats stat;
+    stat.scope = key.first;
+    stat.name = key.second;
+    stat.buffers = entry.counters->buffers.load(std::memory_order_relaxed);
+    stat.bytes = entry.counters->bytes.load(std::memory_order_relaxed);
+    int64_t blockedNs = entry.counters->blockedNs.load(std::memory_order_relaxed);
+    stat.blockedMs = blockedNs / NS_PER_MS;
+    stat.queueDepth = entry.counters->queueDepth.load(std::memory_order_relaxed);
+    int64_t interval = now - entry.lastNs;
+    if (interval > 0) {
+        double seconds = static_cast<double>(interval) / NS_PER_SECOND;
+        stat.buffersPerSecond = static_cast<double>(stat.buffers - entry.lastBuffers) / seconds;
+        stat.bytesPerSecond = static_cast<double>(stat.bytes - entry.lastBytes) / seconds;
+        stat.blockedRatio = static_cast<double>(blockedNs - entry.lastBlockedNs) / static_cast<double>(interval);
+    }
+    entry.lastBuffers = stat.buffers;
+    entry.lastBytes = stat.bytes;
+    entry.lastBlockedNs = blockedNs;
+    entry.lastNs = now;
+    return stat;
+}
+
+std::vector<TraceCounterStats> PipelineTracer::GetCounterStats()
+{
+    std::vector<TraceCounterStats> stats;
+    int64_t now = NowNs();
+    OSAL::ScopedLock lock(mutex_);
+    for (auto& item : counters_) {
+        stats.push_back(UpdateStats(item.first, item.second, now));
+    }
+    return stats;
+}
+
+std::vector<TraceCounterStats> PipelineTracer::GetCounterStats(const std::string& scope)
+{
+    std::vector<TraceCounterStats> stats;
+    int64_t now = NowNs();
+    OSAL::ScopedLock lock(mutex_);
+    auto it = counters_.lower_bound(std::make_pair(scope, std::string()));
+    for (; it != counters_.end() && it->first.first == scope; ++it) {
+        stats.push_back(UpdateStats(it->first, it->second, now));
+    }
+    return stats;
+}
+
+std::string PipelineTracer::ExportChromeTrace() const
+{
+    auto events = Snapshot();
+    int64_t base = events.empty() ? 0 : events.front().beginNs;
+    auto pid = std::to_string(getpid());
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    {
+        OSAL::ScopedLock lock(mutex_);
+        for (const auto& ring : rings_) {
+            const auto& threadName = ring->GetThreadName();
+            out += first ? "\n" : ",\n";
+            first = false;
+            out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid +
+                   ",\"tid\":" + std::to_string(ring->GetThreadId()) + ",\"args\":{\"name\":";
+            AppendJsonString(out, threadName.empty() ?
+                ("thread" + std::to_string(ring->GetThreadId())).c_str() : threadName.c_str());
+            out += "}}";
+        }
+    }
+    for (const auto& event : events) {
+        out += first ? "\n" : ",\n";
+        first = false;
+        out += "{\"name\":";
+        AppendJsonString(out, event.name);
+        out += ",\"cat\":";
+        AppendJsonString(out, event.category);
+        out += ",\"ph\":\"X\",\"pid\":" + pid + ",\"tid\":" + std::to_string(event.threadId) + ",\"ts\":";
+        AppendMicroseconds(out, event.beginNs - base);
+        out += ",\"dur\":";
+        AppendMicroseconds(out, event.durationNs);
+        out += ",\"args\":{\"pts\":" + std::to_string(event.pts) + ",\"bytes\":" + std::to_string(event.bytes) +
+               "}}";
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+bool PipelineTracer::ExportChromeTrace(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        MEDIA_LOG_E("cannot open trace file " PUBLIC_LOG_S, path.c_str());
+        return false;
+    }
+    file << ExportChromeTrace();
+    return file.good();
+}
+
+void PipelineTracer::Clear()
+{
+    int64_t now = NowNs();
+    OSAL::ScopedLock lock(mutex_);
+    for (const auto& ring : rings_) {
+        ring->Clear();
+    }
+    for (auto& item : counters_) {
+        auto& entry = item.second;
+        entry.counters->buffers.store(0, std::memory_order_relaxed);
+        entry.counters->bytes.store(0, std::memory_order_relaxed);
+        entry.counters->blockedNs.store(0, std::memory_order_relaxed);
+        entry.counters->queueDepth.store(0, std::memory_order_relaxed);
+        entry.lastBuffers = 0;
+        entry.lastBytes = 0;
+        entry.lastBlockedNs = 0;
+        entry.lastNs = now;
+    }
+}
+} // namespace Media
+} // namespace OHOS
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HISTREAMER_PIPELINE_TRACER_H
+#define HISTREAMER_PIPELINE_TRACER_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "foundation/osal/thread/mutex.h"
+
+namespace OHOS {
+namespace Media {
+/**
+ * One finished span, as returned by PipelineTracer::Snapshot().
+ */
+struct TraceEvent {
+    const char* name {nullptr};
+    const char* category {nullptr};
+    uint32_t threadId {0};
+    int64_t beginNs {0};
+    int64_t durationNs {0};
+    int64_t pts {-1};
+    uint64_t bytes {0};
+};
+
+/**
+ * Live counters of one filter in one pipeline. They are updated whether tracing is enabled or not, the cost is a few
+ * relaxed atomic adds per buffer.
+ */
+struct TraceCounters {
+    std::atomic<uint64_t> buffers {0};
+    std::atomic<uint64_t> bytes {0};
+    std::atomic<int64_t> blockedNs {0};
+    std::atomic<uint32_t> queueDepth {0};
+
+    void AddBuffer(uint64_t size)
+    {
+        buffers.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    void AddBlocked(int64_t ns)
+    {
+        blockedNs.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    void SetQueueDepth(size_t depth)
+    {
+        queueDepth.store(static_cast<uint32_t>(depth), std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Counters of one filter together with the rates since the previous PipelineTracer::GetCounterStats() call.
+ */
+struct TraceCounterStats {
+    std::string scope;
+    std::string name;
+    uint64_t buffers {0};
+    uint64_t bytes {0};
+    int64_t blockedMs {0};
+    uint32_t queueDepth {0};
+    double buffersPerSecond {0.0};
+    double bytesPerSecond {0.0};
+    double blockedRatio {0.0}; // share of the interval spent blocked
+};
+
+/**
+ * Process wide tracer of the buffer flow through the pipelines.
+ *
+ * Ports, codec modes and sinks record one span per buffer. Each thread writes into its own fixed size ring, so
+ * recording is wait free; when a ring is full the oldest spans are overwritten. Recording is off by default and
+ * costs a single relaxed load then. The spans can be exported as Chrome trace json, which chrome://tracing and
+ * the Perfetto UI both open. Spans carry the buffer pts, so one frame can be followed from demuxer to sink.
+ */
+class PipelineTracer {
+public:
+    static constexpr size_t RING_CAPACITY = 4096;
+
+    static PipelineTracer& Instance();
+
+    PipelineTracer(const PipelineTracer&) = delete;
+    PipelineTracer& operator=(const PipelineTracer&) = delete;
+
+    void SetEnabled(bool enabled);
+
+    bool IsEnabled() const
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns a copy of name whose address stays valid for the lifetime of the process, to be used as span name.
+     */
+    const char* Intern(const std::string& name);
+
+    /**
+     * Returns a scope name that no other caller gets, such as "pipeline_core#3", to tell apart the counters of
+     * filters with the same name in different pipelines.
+     */
+    static std::string NewScope(const std::string& prefix);
+
+    /**
+     * Returns the counters of the named filter in the given scope, created on first use. The counters outlive
+     * RemoveCounters(), they are only no longer reported then.
+     */
+    std::shared_ptr<TraceCounters> GetCounters(const std::string& scope, const std::string& name);
+
+    /**
+     * Stops reporting the counters of the given scope, called when the pipeline owning the scope goes away.
+     */
+    void RemoveCounters(const std::string& scope);
+
+    void Record(const char* name, const char* category, int64_t beginNs, int64_t endNs, int64_t pts = -1,
+                uint64_t bytes = 0);
+
+    std::vector<TraceEvent> Snapshot() const;
+
+    std::vector<TraceCounterStats> GetCounterStats();
+
+    std::vector<TraceCounterStats> GetCounterStats(const std::string& scope);
+
+    std::string ExportChromeTrace() const;
+
+    bool ExportChromeTrace(const std::string& path) const;
+
+    /**
+     * Drops all recorded spans and resets the counters.
+     */
+    void Clear();
+
+    static int64_t NowNs();
+
+private:
+    class Ring;
+    struct CounterEntry {
+        std::shared_ptr<TraceCounters> counters;
+        uint64_t lastBuffers {0};
+        uint64_t lastBytes {0};
+        int64_t lastBlockedNs {0};
+        int64_t lastNs {0};
+    };
+
+    PipelineTracer() = default;
+    ~PipelineTracer() = default;
+    Ring* AcquireRing();
+    static TraceCounterStats UpdateStats(const std::pair<std::string, std::string>& key, CounterEntry& entry,
+                                         int64_t now);
+
+    std::atomic<bool> enabled_ {false};
+    mutable OSAL::Mutex mutex_ {};
+    std::vector<std::shared_ptr<Ring>> rings_ {};
+    std::map<std::string, std::unique_ptr<std::string>> names_ {};
+    std::map<std::pair<std::string, std::string>, CounterEntry> counters_ {}; // keyed by scope and filter name
+    uint32_t nextThreadId_ {1};
+};
+
+/**
+ * Records the lifetime of the scope as one span, if tracing is enabled when the scope is entered.
+ */
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category, int64_t pts = -1, uint64_t bytes = 0)
+        : name_(name), category_(category), pts_(pts), bytes_(bytes),
+          beginNs_(PipelineTracer::Instance().IsEnabled() ? PipelineTracer::NowNs() : -1)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (beginNs_ >= 0 && name_ != nullptr) {
+            PipelineTracer::Instance().Record(name_, category_, beginNs_, PipelineTracer::NowNs(), pts_, bytes_);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    const char* category_;
+    int64_t pts_;
+    uint64_t bytes_;
+    int64_t beginNs_;
+};
+
+/**
+ * Payload size of a pipeline buffer, for the counters and the span arguments.
+ */
+template <typename BufferPtr>
+inline uint64_t GetTraceBufferBytes(const BufferPtr& buffer)
+{
+    if (buffer == nullptr || buffer->IsEmpty()) {
+        return 0;
+    }
+    auto memory = buffer->GetMemory();
+    return memory ? memory->GetSize() : 0;
+}
+
+#define PIPELINE_TRACE_CONCAT_INNER(a, b) a##b
+#define PIPELINE_TRACE_CONCAT(a, b) PIPELINE_TRACE_CONCAT_INNER(a, b)
+#define PIPELINE_TRACE_SCOPE(name, category, ...)                                                                      \
+    OHOS::Media::TraceScope PIPELINE_TRACE_CONCAT(traceScope, __LINE__)(name, category, ##__VA_ARGS__)
+
+// span of one pipeline buffer, tagged with its pts and size
+#define PIPELINE_TRACE_BUFFER(name, category, buffer, bytes)                                                           \
+    PIPELINE_TRACE_SCOPE(name, category, (buffer) ? static_cast<int64_t>((buffer)->pts) : -1, bytes)
+} // namespace Media
+} // namespace OHOS
+#endif // HISTREAMER_PIPELINE_TRACER_H
@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define HST_LOG_TAG "RingBuffer"
+
+#include "ring_buffer.h"
+#include <algorithm>
+#include <new>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include "foundation/log.h"
+#include "foundation/osal/thread/scoped_lock.h"
+#include "securec.h"
+
+#if defined(__linux__) && defined(SYS_memfd_create)
+#define RING_BUFFER_MIRROR_SUPPORTED
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#endif
+
+namespace OHOS {
+namespace Media {
+RingBuffer::RingBuffer(size_t bufferSize) : bufferSize_(bufferSize)
+{
+}
+
+RingBuffer::~RingBuffer()
+{
+    Unmap();
+}
+
+bool RingBuffer::Init()
+{
+    FALSE_RETURN_V_MSG_E(bufferSize_ > 0, false, "ring buffer size is 0");
+    if (data_ != nullptr) {
+        return true;
+    }
+    if (MapMirrored()) {
+        return true;
+    }
+    heap_ = std::unique_ptr<uint8_t[]>(new (std::nothrow) uint8_t[bufferSize_]);
+    FALSE_RETURN_V_MSG_E(heap_ != nullptr, false, "can't allocate ring buffer of " PUBLIC_LOG_ZU, bufferSize_);
+    data_ = heap_.get();
+    capacity_ = bufferSize_;
+    return true;
+}
+
+bool RingBuffer::MapMirrored()
+{
+#ifdef RING_BUFFER_MIRROR_SUPPORTED
+    long pageSize = sysconf(_SC_PAGESIZE);
+    FALSE_RETURN_V(pageSize > 0, false);
+    auto page = static_cast<size_t>(pageSize);
+    size_t size = (bufferSize_ + page - 1) / page * page;
+    int fd = static_cast<int>(syscall(SYS_memfd_create, "hst_ring_buffer", MFD_CLOEXEC));
+    if (fd < 0) {
+        MEDIA_LOG_W("memfd_create failed, ring buffer is not mirrored");
+        return false;
+    }
+    void* addr = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        // reserve the whole range first, then map the same pages on both halves of it
+        addr = mmap(nullptr, size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0); // 2: two views
+    }
+    bool mapped = false;
+    if (addr != MAP_FAILED) {
+        auto base = static_cast<uint8_t*>(addr);
+        mapped = mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == base &&
+            mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == base + size;
+        if (!mapped) {
+            (void)munmap(addr, size * 2); // 2: two views
+        }
+    }
+    (void)close(fd);
+    if (!mapped) {
+        MEDIA_LOG_W("mapping the ring buffer twice failed, it is not mirrored");
+        return false;
+    }
+    data_ = static_cast<uint8_t*>(addr);
+    capacity_ = size;
+    mirrored_ = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void RingBuffer::Unmap()
+{
+#ifdef RING_BUFFER_MIRROR_SUPPORTED
+    if (mirrored_ && data_ != nullptr) {
+        (void)munmap(data_, capacity_ * 2); // 2: two views
+    }
+#endif
+    data_ = nullptr;
+    mirrored_ = false;
+}
+
+size_t RingBuffer::Available() const
+{
+    size_t head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+}
+
+void RingBuffer::WakeUp(std::atomic<int>& waiters, OSAL::ConditionVariable& cv)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) > 0) {
+        OSAL::ScopedLock lock(mutex_);
+        cv.NotifyAll();
+    }
+}
+
+uint8_t* RingBuffer::ReserveWrite(size_t size)
+{
+    if (data_ == nullptr || size == 0 || size > capacity_) {
+        return nullptr;
+    }
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    auto hasSpace = [this, tail, size] {
+        return capacity_ - (tail - head_.load(std::memory_order_acquire)) >= size;
+    };
+    while (!hasSpace()) {
+        if (!isActive_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        OSAL::ScopedLock lock(mutex_);
+        writeWaiters_.fetch_add(1, std::memory_order_seq_cst);
+        writeCondition_.Wait(lock, [this, &hasSpace] { return !isActive_.load() || hasSpace(); });
+        writeWaiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    if (!isActive_.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    size_t index = tail % capacity_;
+    reservedStaged_ = !mirrored_ && index + size > capacity_;
+    if (!reservedStaged_) {
+        return data_ + index;
+    }
+    if (stagingSize_ < size) {
+        staging_ = std::unique_ptr<uint8_t[]>(new (std::nothrow) uint8_t[size]);
+        stagingSize_ = staging_ ? size : 0;
+        FALSE_RETURN_V_MSG_E(staging_ != nullptr, nullptr, "can't allocate staging buffer");
+    }
+    return staging_.get();
+}
+
+void RingBuffer::CommitWrite(size_t size, uint64_t mediaOffset)
+{
+    if (data_ == nullptr || size == 0) {
+        CancelWrite();
+        return;
+    }
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (reservedStaged_) {
+        size_t index = tail % capacity_;
+        size_t first = std::min(size, capacity_ - index);
+        (void)memcpy_s(data_ + index, first, staging_.get(), first);
+        if (size > first) {
+            (void)memcpy_s(data_, size - first, staging_.get() + first, size - first);
+        }
+        reservedStaged_ = false;
+    }
+    if (resetOffset_.exchange(false, std::memory_order_acq_rel)) {
+        mediaOffset_.store(mediaOffset, std::memory_order_relaxed);
+        mediaPos_.store(tail, std::memory_order_relaxed);
+    }
+    tail_.store(tail + size, std::memory_order_release);
+    WakeUp(readWaiters_, readCondition_);
+}
+
+void RingBuffer::CancelWrite()
+{
+    // nothing reached the ring yet, a staged span is simply forgotten
+    reservedStaged_ = false;
+}
+
+const uint8_t* RingBuffer::PeekRead(size_t& size, int waitTimes)
+{
+    if (data_ == nullptr || size == 0) {
+        size = 0;
+        return nullptr;
+    }
+    while (Available() == 0 && waitTimes > 0 && isActive_.load(std::memory_order_acquire)) {
+        OSAL::ScopedLock lock(mutex_);
+        uint64_t seq = notifySeq_.load(std::memory_order_relaxed);
+        readWaiters_.fetch_add(1, std::memory_order_seq_cst);
+        readCondition_.Wait(lock, [this, seq] {
+            return !isActive_.load() || Available() > 0 || notifySeq_.load(std::memory_order_relaxed) != seq;
+        });
+        readWaiters_.fetch_sub(1, std::memory_order_relaxed);
+        waitTimes--;
+    }
+    size_t head = head_.load(std::memory_order_acquire);
+    size_t available = tail_.load(std::memory_order_acquire) - head;
+    if (!isActive_.load(std::memory_order_acquire) || available == 0) {
+        size = 0;
+        return nullptr;
+    }
+    size_t index = head % capacity_;
+    size = std::min(size, available);
+    if (!mirrored_) {
+        size = std::min(size, capacity_ - index);
+    }
+    peekHead_ = head;
+    return data_ + index;
+}
+
+bool RingBuffer::ConsumeRead(size_t size)
+{
+    size_t expected = peekHead_;
+    if (!head_.compare_exchange_strong(expected, peekHead_ + size, std::memory_order_acq_rel)) {
+        return false;
+    }
+    peekHead_ += size;
+    WakeUp(writeWaiters_, writeCondition_);
+    return true;
+}
+
+size_t RingBuffer::ReadBuffer(void* ptr, size_t readSize, int waitTimes)
+{
+    auto out = static_cast<uint8_t*>(ptr);
+    size_t total = 0;
+    while (total < readSize) {
+        size_t size = readSize - total;
+        auto span = PeekRead(size, total == 0 ? waitTimes : 0);
+        if (span == nullptr) {
+            break;
+        }
+        (void)memcpy_s(out + total, readSize - total, span, size);
+        if (!ConsumeRead(size)) {
+            break; // dropped while copying, what was copied is stale
+        }
+        total += size;
+    }
+    return total;
+}
+
+void RingBuffer::WriteBuffer(void* ptr, size_t writeSize, uint64_t mediaOffset)
+{
+    auto in = static_cast<const uint8_t*>(ptr);
+    while (writeSize > 0) {
+        size_t size = std::min(writeSize, capacity_);
+        auto span = ReserveWrite(size);
+        if (span == nullptr) {
+            return;
+        }
+        (void)memcpy_s(span, size, in, size);
+        CommitWrite(size, mediaOffset);
+        in += size;
+        writeSize -= size;
+        mediaOffset += size;
+    }
+}
+
+void RingBuffer::DropAll()
+{
+    resetOffset_.store(true, std::memory_order_release);
+    size_t head = head_.load(std::memory_order_acquire);
+    while (!head_.compare_exchange_weak(head, tail_.load(std::memory_order_acquire), std::memory_order_acq_rel)) {
+    }
+    OSAL::ScopedLock lock(mutex_);
+    notifySeq_.fetch_add(1, std::memory_order_relaxed);
+    readCondition_.NotifyAll();
+    writeCondition_.NotifyAll();
+}
+
+void RingBuffer::SetActive(bool active)
+{
+    isActive_.store(active, std::memory_order_release);
+    if (!active) {
+        DropAll();
+    }
+}
+
+size_t RingBuffer::GetSize()
+{
+    return Available();
+}
+
+size_t RingBuffer::GetCapacity() const
+{
+    return capacity_;
+}
+
+void RingBuffer::Clear()
+{
+    DropAll();
+}
+
+bool RingBuffer::Seek(uint64_t offset)
+{
+    size_t head = head_.load(std::memory_order_acquire);
+    size_t tail = tail_.load(std::memory_order_acquire);
+    auto delta = static_cast<std::ptrdiff_t>(head - mediaPos_.load(std::memory_order_relaxed));
+    uint64_t headOffset = mediaOffset_.load(std::memory_order_relaxed) + static_cast<int64_t>(delta);
+    MEDIA_LOG_I("Seek: buffer size " PUBLIC_LOG_ZU ", offset " PUBLIC_LOG_U64 ", mediaOffset " PUBLIC_LOG_U64,
+                tail - head, offset, headOffset);
+    bool result = false;
+    if (!resetOffset_.load(std::memory_order_acquire) && offset >= headOffset && offset - headOffset < tail - head) {
+        result = head_.compare_exchange_strong(head, head + static_cast<size_t>(offset - headOffset),
+                                               std::memory_order_acq_rel);
+    }
+    OSAL::ScopedLock lock(mutex_);
+    notifySeq_.fetch_add(1, std::memory_order_relaxed);
+    readCondition_.NotifyAll();
+    writeCondition_.NotifyAll();
+    return result;
+}
+
+bool RingBuffer::IsMirrored() const
+{
+    return mirrored_;
+}
+} // namespace Media
+} // namespace OHOS
@@ -17,6 +17,8 @@
 #define HISTREAMER_RING_BUFFER_H
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include "foundation/log.h"
 #include "foundation/cpp_ext/memory_ext.h"
@@ -27,123 +29,122 @@
 
 namespace OHOS {
 namespace Media {
+/**
+ * Byte ring buffer between one producer thread and one consumer thread.
+ *
+ * Besides the copying WriteBuffer()/ReadBuffer(), data can be produced and consumed in place:
+ * ReserveWrite()/CommitWrite() hand out writable space and PeekRead()/ConsumeRead() readable data. Where the
+ * platform allows it the storage is mapped twice back to back, so every span is contiguous even across the
+ * wrap-around; otherwise a reserved span crossing the end is staged and copied on commit, and a peeked span ends
+ * at the wrap-around.
+ *
+ * Head and tail are atomics, the producer and the consumer only meet on the mutex when one of them has to wait.
+ * SetActive(), Clear() and Seek() may be called from any thread; data they drop while the consumer holds a peeked
+ * span is reported by ConsumeRead() returning false.
+ */
 class RingBuffer {
 public:
-    explicit RingBuffer(size_t bufferSize) : bufferSize_(bufferSize)
-    {
-    }
-
-    ~RingBuffer() = default;
-
-    bool Init()
-    {
-        buffer_ = CppExt::make_unique<uint8_t[]>(bufferSize_);
-        return buffer_ != nullptr;
-    }
-
-    size_t ReadBuffer(void* ptr, size_t readSize, int waitTimes = 0)
-    {
-        OSAL::ScopedLock lck(writeMutex_);
-        if (!isActive_) {
-            return 0;
-        }
-        auto available = tail_ - head_;
-        while (waitTimes > 0 && available == 0) {
-            writeCondition_.Wait(lck);
-            if (!isActive_) {
-                return 0;
-            }
-            available = tail_ - head_;
-            waitTimes--;
-        }
-        available = (available > readSize) ? readSize : available;
-        size_t index = head_ % bufferSize_;
-        if (index + available < bufferSize_) {
-            (void)memcpy_s(ptr, available, buffer_.get() + index, available);
-        } else {
-            (void)memcpy_s(ptr, bufferSize_ - index, buffer_.get() + index, bufferSize_ - index);
-            (void)memcpy_s(((uint8_t*)ptr) + (bufferSize_ - index), available - (bufferSize_ - index), buffer_.get(),
-                           available - (bufferSize_ - index));
-        }
-        head_ += available;
-        mediaOffset_ += available;
-        writeCondition_.NotifyOne();
-        return available;
-    }
-
-    void WriteBuffer(void* ptr, size_t writeSize, uint64_t mediaOffset = 0)
-    {
-        OSAL::ScopedLock lck(writeMutex_);
-        if (!isActive_) {
-            return;
-        }
-        while (writeSize + tail_ > head_ + bufferSize_) {
-            writeCondition_.Wait(lck);
-            if (!isActive_) {
-                return;
-            }
-        }
-        size_t index = tail_ % bufferSize_;
-        if (index + writeSize < bufferSize_) {
-            (void)memcpy_s(buffer_.get() + index, writeSize, ptr, writeSize);
-        } else {
-            (void)memcpy_s(buffer_.get() + index, bufferSize_ - index, ptr, bufferSize_ - index);
-            (void)memcpy_s(buffer_.get(), writeSize - (bufferSize_ - index), ((uint8_t*)ptr) + bufferSize_ - index,
-                           writeSize - (bufferSize_ - index));
-        }
-        tail_ += writeSize;
-        if (head_ == 0) {
-            mediaOffset_ = mediaOffset;
-        }
-        writeCondition_.NotifyOne();
-    }
-
-    void SetActive(bool active)
-    {
-        OSAL::ScopedLock lck(writeMutex_);
-        isActive_ = active;
-        if (!active) {
-            head_ = 0;
-            tail_ = 0;
-            writeCondition_.NotifyOne();
-        }
-    }
-
-    size_t GetSize()
-    {
-        return (tail_ - head_);
-    }
-
-    void Clear()
-    {
-        OSAL::ScopedLock lck(writeMutex_);
-        head_ = 0;
-        tail_ = 0;
-        writeCondition_.NotifyOne();
-    }
-
-    bool Seek(uint64_t offset)
-    {
-        OSAL::ScopedLock lck(writeMutex_);
-        MEDIA_LOG_I("Seek: buffer size " PUBLIC_LOG_ZU ", offset " PUBLIC_LOG_U64
-                    ", mediaOffset_ " PUBLIC_LOG_U64, GetSize(), offset, mediaOffset_);
-        bool result = false;
-        if (offset >= mediaOffset_ && offset - mediaOffset_ < GetSize()) {
-            head_ += offset - mediaOffset_;
-            result = true;
-        }
-        writeCondition_.NotifyOne();
-        return result;
-    }
+    explicit RingBuffer(size_t bufferSize);
+
+    ~RingBuffer();
+
+    RingBuffer(const RingBuffer&) = delete;
+
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    bool Init();
+
+    /**
+     * Copies up to readSize bytes out of the buffer.
+     *
+     * @param waitTimes how many times to wait for a writer when the buffer is empty
+     * @return bytes read, 0 if inactive or still empty after waiting
+     */
+    size_t ReadBuffer(void* ptr, size_t readSize, int waitTimes = 0);
+
+    /**
+     * Copies writeSize bytes into the buffer, waiting for space as long as the buffer is active.
+     *
+     * @param mediaOffset media offset of the first byte, used by Seek()
+     */
+    void WriteBuffer(void* ptr, size_t writeSize, uint64_t mediaOffset = 0);
+
+    /**
+     * Waits until size contiguous bytes can be written.
+     *
+     * @return start of the writable span, nullptr if the buffer became inactive or size exceeds the capacity
+     */
+    uint8_t* ReserveWrite(size_t size);
+
+    /**
+     * Publishes size bytes of the span returned by the last ReserveWrite().
+     */
+    void CommitWrite(size_t size, uint64_t mediaOffset = 0);
+
+    /**
+     * Drops the span returned by the last ReserveWrite() without publishing any of it, same as CommitWrite(0).
+     */
+    void CancelWrite();
+
+    /**
+     * Returns the readable data in place, waiting up to waitTimes times for a writer when the buffer is empty.
+     *
+     * @param size in: the most bytes wanted, out: the size of the returned span
+     * @return start of the readable span, nullptr if there is nothing to read
+     */
+    const uint8_t* PeekRead(size_t& size, int waitTimes = 0);
+
+    /**
+     * Releases size bytes of the span returned by the last PeekRead().
+     *
+     * @return false if the span was dropped by Clear(), Seek() or SetActive(false) in the meantime
+     */
+    bool ConsumeRead(size_t size);
+
+    void SetActive(bool active);
+
+    size_t GetSize();
+
+    size_t GetCapacity() const;
+
+    void Clear();
+
+    bool Seek(uint64_t offset);
+
+    /**
+     * Whether the storage is double mapped, i.e. no span is ever split at the wrap-around.
+     */
+    bool IsMirrored() const;
+
 private:
+    bool MapMirrored();
+    void Unmap();
+    size_t Available() const;
+    void DropAll();
+    void WakeUp(std::atomic<int>& waiters, OSAL::ConditionVariable& cv);
+
     const size_t bufferSize_;
-    std::unique_ptr<uint8_t[]> buffer_;
-    size_t head_ {0}; // head
-    size_t tail_ {0}; // tail
-    OSAL::Mutex writeMutex_ {};
+    size_t capacity_ {0};
+    uint8_t* data_ {nullptr};
+    bool mirrored_ {false};
+    std::unique_ptr<uint8_t[]> heap_ {};
+    std::unique_ptr<uint8_t[]> staging_ {}; // reserved spans crossing the end when not mirrored
+    size_t stagingSize_ {0};
+    bool reservedStaged_ {false};
+    size_t peekHead_ {0};
+
+    std::atomic<size_t> head_ {0};
+    std::atomic<size_t> tail_ {0};
+    std::atomic<bool> isActive_ {true};
+    std::atomic<bool> resetOffset_ {true};
+    std::atomic<uint64_t> mediaOffset_ {0}; // media offset of the byte at mediaPos_
+    std::atomic<size_t> mediaPos_ {0};
+    std::atomic<uint64_t> notifySeq_ {0};
+    std::atomic<int> readWaiters_ {0};
+    std::atomic<int> writeWaiters_ {0};
+    OSAL::Mutex mutex_ {};
+    OSAL::ConditionVariable readCondition_ {};
     OSAL::ConditionVariable writeCondition_ {};
-    bool isActive_ {true};
-    uint64_t mediaOffset_ {0};
 };
 } // namespace Media
 } // namespace OHOS
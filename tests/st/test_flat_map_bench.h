@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <vector>
+#include "testngpp/testngpp.hpp"
+#include "foundation/cpp_ext/flat_map.h"
+#include "plugin/common/plugin_tags.h"
+
+using namespace OHOS::Media::Plugin;
+
+namespace {
+constexpr int BENCH_ROUNDS = 20000;
+const std::vector<Tag> BENCH_TAGS {
+    Tag::MIME, Tag::TRACK_ID, Tag::MEDIA_CODEC_CONFIG, Tag::AUDIO_CHANNELS, Tag::AUDIO_SAMPLE_RATE,
+    Tag::AUDIO_SAMPLE_FORMAT, Tag::AUDIO_SAMPLE_PER_FRAME, Tag::AUDIO_CHANNEL_LAYOUT, Tag::MEDIA_BITRATE,
+    Tag::MEDIA_DURATION, Tag::BITS_PER_CODED_SAMPLE, Tag::AUDIO_MPEG_VERSION,
+};
+
+// builds, copies and queries a track sized tag map, as negotiation does
+template <typename Map>
+int64_t BenchUs(uint64_t& checksum)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        Map map;
+        for (auto tag : BENCH_TAGS) {
+            map.insert({tag, static_cast<uint32_t>(round)});
+        }
+        Map copy = map;
+        for (auto tag : BENCH_TAGS) {
+            auto ite = copy.find(tag);
+            checksum += OHOS::Media::Plugin::AnyCast<uint32_t>(ite->second);
+        }
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+// Timings depend on the machine, so they are only reported, never asserted.
+// @fixture(tags=bench)
+FIXTURE(FlatMapBench)
+{
+    // @test(tags=bench)
+    TEST(Tag map against std map)
+    {
+        uint64_t flatChecksum = 0;
+        uint64_t treeChecksum = 0;
+        auto flatUs = BenchUs<TagMap>(flatChecksum);
+        auto treeUs = BenchUs<std::map<Tag, ValueType>>(treeChecksum);
+        ASSERT_EQ(treeChecksum, flatChecksum);
+        printf("%d rounds of %zu tags: FlatMap %lld us, std::map %lld us\n", BENCH_ROUNDS, BENCH_TAGS.size(),
+               static_cast<long long>(flatUs), static_cast<long long>(treeUs));
+    }
+};
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "foundation/cpp_ext/arena.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+using namespace CppExt;
+
+TEST(TestArena, allocations_are_aligned_and_grow_into_new_chunks)
+{
+    Arena arena(64); // 64: small chunks to force growing
+    auto first = arena.Allocate(3); // 3: odd size
+    auto second = arena.Allocate(sizeof(double), alignof(double));
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(second) % alignof(double));
+    EXPECT_NE(first, second);
+    auto large = static_cast<uint8_t*>(arena.Allocate(1000)); // 1000: larger than one chunk
+    large[999] = 1; // 999: the last byte is usable
+    EXPECT_EQ(3u + sizeof(double) + 1000u, arena.GetUsedSize()); // 3, 1000: sizes allocated above
+    EXPECT_GE(arena.GetReservedSize(), 1000u); // 1000: the large allocation
+}
+
+TEST(TestArena, reset_keeps_one_chunk_for_the_next_round)
+{
+    Arena arena(64); // 64: small chunks to force growing
+    for (int i = 0; i < 10; ++i) { // 10: allocations of the first round
+        (void)arena.Allocate(48); // 48: most of one chunk
+    }
+    auto reserved = arena.GetReservedSize();
+    arena.Reset();
+    EXPECT_EQ(0u, arena.GetUsedSize());
+    EXPECT_EQ(reserved, arena.GetReservedSize());
+    for (int i = 0; i < 10; ++i) { // 10: the same work again
+        (void)arena.Allocate(48); // 48
+    }
+    EXPECT_EQ(reserved, arena.GetReservedSize()); // served from the kept chunk
+}
+
+TEST(TestArena, containers_use_the_arena_or_the_heap)
+{
+    Arena arena;
+    {
+        std::map<int, int, std::less<int>, ArenaAllocator<std::pair<const int, int>>> map(&arena);
+        for (int i = 0; i < 100; ++i) { // 100: entries
+            map[i] = i;
+        }
+        EXPECT_EQ(99, map.rbegin()->second); // 99: the last value
+        EXPECT_GT(arena.GetUsedSize(), 100 * sizeof(int)); // 100: at least the values
+    }
+    arena.Reset();
+    std::vector<int, ArenaAllocator<int>> onHeap;
+    onHeap.assign(100, 1); // 100
+    EXPECT_EQ(nullptr, onHeap.get_allocator().GetArena());
+    EXPECT_EQ(0u, arena.GetUsedSize());
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
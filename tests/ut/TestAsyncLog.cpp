@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cinttypes>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "foundation/async_log.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+struct LoggedMessage {
+    uint8_t level;
+    std::string tag;
+    uint32_t threadId;
+    std::string message;
+};
+
+class TestAsyncLog : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        AsyncLogBackend::Flush();
+        AsyncLogBackend::SetRateLimit(0);
+        AsyncLogBackend::SetSink([this](uint8_t level, const char* tag, uint32_t threadId, const char* message) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            messages_.push_back({level, tag, threadId, message});
+        });
+    }
+
+    void TearDown() override
+    {
+        AsyncLogBackend::Flush();
+        AsyncLogBackend::SetSink(nullptr);
+        AsyncLogBackend::SetRateLimit(20); // 20: the default
+    }
+
+    std::vector<LoggedMessage> TakeMessages()
+    {
+        AsyncLogBackend::Flush();
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::move(messages_);
+    }
+
+    std::mutex mutex_;
+    std::vector<LoggedMessage> messages_;
+};
+
+enum class State {
+    IDLE,
+    RUNNING,
+};
+
+TEST_F(TestAsyncLog, arguments_are_formatted_later)
+{
+    static AsyncLogSite site {ASYNC_LOG_INFO, "TestTag",
+        "%{public}s %{public}" PRId32 " %{public}" PRIu64 " %{public}.2f %{public}d %c %x %5s|%-3d|%%"};
+    std::string name = "audioSink";
+    ASSERT_TRUE(AsyncLog(site, name.c_str(), -42, UINT64_MAX, 2.5, State::RUNNING, 'z', 255u, "ab", 7));
+    name = "overwritten"; // the string was copied when logging
+    auto messages = TakeMessages();
+    ASSERT_EQ(1u, messages.size());
+    EXPECT_EQ(ASYNC_LOG_INFO, messages[0].level);
+    EXPECT_EQ("TestTag", messages[0].tag);
+    EXPECT_EQ("audioSink -42 18446744073709551615 2.50 1 z ff    ab|7  |%", messages[0].message);
+}
+
+TEST_F(TestAsyncLog, unsupported_arguments_fall_back_to_sync_logging)
+{
+    static AsyncLogSite site {ASYNC_LOG_INFO, "TestTag", "%s"};
+    struct NotLoggable {
+        int value;
+    };
+    EXPECT_FALSE(AsyncLog(site, NotLoggable {1}));
+    EXPECT_FALSE(AsyncLog(site, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13)); // 13: one too many
+    EXPECT_TRUE(TakeMessages().empty());
+
+    // the check the log macros use to pick the way of logging does not evaluate the arguments
+    int evaluated = 0;
+    EXPECT_TRUE(decltype(AsyncLogArgsCheck(++evaluated, "text", State::IDLE, nullptr))::value);
+    EXPECT_FALSE(decltype(AsyncLogArgsCheck(++evaluated, NotLoggable {1}))::value);
+    EXPECT_EQ(0, evaluated);
+}
+
+TEST_F(TestAsyncLog, call_sites_are_rate_limited)
+{
+    AsyncLogBackend::SetRateLimit(5); // 5: messages per second and call site
+    static AsyncLogSite site {ASYNC_LOG_WARN, "TestTag", "buffer %d"};
+    static AsyncLogSite other {ASYNC_LOG_WARN, "TestTag", "other"};
+    for (int i = 0; i < 100; ++i) { // 100
+        ASSERT_TRUE(AsyncLog(site, i));
+    }
+    ASSERT_TRUE(AsyncLog(other));
+    auto messages = TakeMessages();
+    ASSERT_EQ(6u, messages.size()); // 6: 5 of site, 1 of other
+    EXPECT_EQ("buffer 4", messages[4].message); // 4: the last one admitted
+    EXPECT_EQ("other", messages[5].message); // 5: other has its own budget
+
+    site.windowStartNs = 0; // as if a second had passed
+    ASSERT_TRUE(AsyncLog(site, 100)); // 100
+    messages = TakeMessages();
+    ASSERT_EQ(1u, messages.size());
+    EXPECT_EQ("buffer 100 (95 suppressed)", messages[0].message);
+}
+
+TEST_F(TestAsyncLog, errors_are_not_rate_limited)
+{
+    AsyncLogBackend::SetRateLimit(5); // 5: messages per second and call site
+    static AsyncLogSite error {ASYNC_LOG_ERROR, "TestTag", "error %d"};
+    static AsyncLogSite fatal {ASYNC_LOG_FATAL, "TestTag", "fatal %d"};
+    for (int i = 0; i < 10; ++i) { // 10: twice the limit
+        ASSERT_TRUE(AsyncLog(error, i));
+        ASSERT_TRUE(AsyncLog(fatal, i));
+    }
+    auto messages = TakeMessages();
+    ASSERT_EQ(20u, messages.size()); // 20: all of both sites
+    EXPECT_EQ("fatal 9", messages[19].message); // 19: the last one
+}
+
+TEST_F(TestAsyncLog, messages_of_all_threads_are_ordered_by_time)
+{
+    static AsyncLogSite site {ASYNC_LOG_DEBUG, "TestTag", "%d %d"};
+    constexpr int threadCnt = 4;
+    constexpr int messageCnt = 50;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCnt; ++i) {
+        threads.emplace_back([i] {
+            for (int j = 0; j < messageCnt; ++j) {
+                (void)AsyncLog(site, i, j);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto messages = TakeMessages();
+    ASSERT_EQ(static_cast<size_t>(threadCnt * messageCnt), messages.size());
+    std::vector<int> next(threadCnt, 0);
+    for (const auto& message : messages) {
+        int thread = -1;
+        int index = -1;
+        ASSERT_EQ(2, sscanf(message.message.c_str(), "%d %d", &thread, &index)); // 2: both fields
+        ASSERT_EQ(next[thread]++, index); // in order within each thread
+    }
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
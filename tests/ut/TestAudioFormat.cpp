@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "utils/audio_format.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+using Plugin::AudioSampleFormat;
+
+constexpr uint32_t SAMPLES = 1027; // not a multiple of any vector width, the tails are covered as well
+
+template <typename T>
+std::vector<uint8_t*> SplitPlanes(std::vector<T>& data, uint32_t channels, uint32_t samples)
+{
+    std::vector<uint8_t*> planes(channels);
+    for (uint32_t c = 0; c < channels; ++c) {
+        planes[c] = reinterpret_cast<uint8_t*>(data.data() + c * samples);
+    }
+    return planes;
+}
+
+int16_t ToS16(float value)
+{
+    float scaled = std::min(std::max(value * 32768.0f, -32768.0f), 32767.0f); // 32768, 32767: s16 range
+    return static_cast<int16_t>(std::lrint(scaled));
+}
+
+TEST(TestAudioFormat, interleave_and_deinterleave_s16)
+{
+    for (uint32_t channels : {1u, 2u, 6u}) { // 1, 2, 6 channels
+        std::vector<int16_t> planar(SAMPLES * channels);
+        for (size_t i = 0; i < planar.size(); ++i) {
+            planar[i] = static_cast<int16_t>(i * 37 - 20000); // 37, 20000: spread over the whole range
+        }
+        std::vector<int16_t> interleaved(SAMPLES * channels);
+        auto src = SplitPlanes(planar, channels, SAMPLES);
+        uint8_t* dst[] = {reinterpret_cast<uint8_t*>(interleaved.data())};
+        ASSERT_TRUE(ConvertAudioSamples(src.data(), AudioSampleFormat::S16P, dst, AudioSampleFormat::S16, channels,
+                                        SAMPLES));
+        for (uint32_t i = 0; i < SAMPLES; ++i) {
+            for (uint32_t c = 0; c < channels; ++c) {
+                ASSERT_EQ(planar[c * SAMPLES + i], interleaved[i * channels + c]);
+            }
+        }
+        std::vector<int16_t> back(SAMPLES * channels);
+        auto backPlanes = SplitPlanes(back, channels, SAMPLES);
+        const uint8_t* in[] = {reinterpret_cast<const uint8_t*>(interleaved.data())};
+        ASSERT_TRUE(ConvertAudioSamples(in, AudioSampleFormat::S16, backPlanes.data(), AudioSampleFormat::S16P,
+                                        channels, SAMPLES));
+        EXPECT_EQ(planar, back);
+    }
+}
+
+TEST(TestAudioFormat, f32_planar_to_s16_rounds_and_saturates)
+{
+    constexpr uint32_t channels = 2;
+    std::vector<float> planar(SAMPLES * channels);
+    for (size_t i = 0; i < planar.size(); ++i) {
+        planar[i] = static_cast<float>(i) / SAMPLES - 1.1f; // 1.1: also go below -1.0 and above 1.0
+    }
+    planar[0] = 1.0f;
+    planar[1] = -1.0f;
+    planar[2] = 0.5f; // 2
+    planar[3] = 100.0f; // 3
+    std::vector<int16_t> interleaved(SAMPLES * channels);
+    auto src = SplitPlanes(planar, channels, SAMPLES);
+    uint8_t* dst[] = {reinterpret_cast<uint8_t*>(interleaved.data())};
+    ASSERT_TRUE(ConvertAudioSamples(src.data(), AudioSampleFormat::F32P, dst, AudioSampleFormat::S16, channels,
+                                    SAMPLES));
+    EXPECT_EQ(32767, interleaved[0]); // 32767: 1.0 saturates
+    EXPECT_EQ(-32768, interleaved[2]); // 2: second frame, -32768
+    EXPECT_EQ(16384, interleaved[4]); // 4: third frame, 16384
+    EXPECT_EQ(32767, interleaved[6]); // 6: fourth frame, 32767
+    for (uint32_t i = 0; i < SAMPLES; ++i) {
+        for (uint32_t c = 0; c < channels; ++c) {
+            ASSERT_EQ(ToS16(planar[c * SAMPLES + i]), interleaved[i * channels + c]);
+        }
+    }
+}
+
+TEST(TestAudioFormat, s16_round_trips_through_f32_and_s32)
+{
+    constexpr uint32_t channels = 2;
+    std::vector<int16_t> origin(SAMPLES * channels);
+    for (size_t i = 0; i < origin.size(); ++i) {
+        origin[i] = static_cast<int16_t>(i * 61 + 32768); // 61, 32768: wrap around the whole range
+    }
+    const uint8_t* in[] = {reinterpret_cast<const uint8_t*>(origin.data())};
+    std::vector<float> floats(SAMPLES * channels);
+    auto floatPlanes = SplitPlanes(floats, channels, SAMPLES);
+    ASSERT_TRUE(ConvertAudioSamples(in, AudioSampleFormat::S16, floatPlanes.data(), AudioSampleFormat::F32P,
+                                    channels, SAMPLES));
+    EXPECT_FLOAT_EQ(origin[0] / 32768.0f, floats[0]); // 32768: s16 scale
+    std::vector<int32_t> ints(SAMPLES * channels);
+    uint8_t* intOut[] = {reinterpret_cast<uint8_t*>(ints.data())};
+    std::vector<const uint8_t*> floatIn(floatPlanes.begin(), floatPlanes.end());
+    ASSERT_TRUE(ConvertAudioSamples(floatIn.data(), AudioSampleFormat::F32P, intOut, AudioSampleFormat::S32,
+                                    channels, SAMPLES));
+    for (size_t i = 0; i < origin.size(); ++i) {
+        ASSERT_EQ(static_cast<int32_t>(origin[i]) * 65536, ints[i]); // 65536: s16 in the upper half
+    }
+    std::vector<int16_t> back(SAMPLES * channels);
+    const uint8_t* intIn[] = {reinterpret_cast<const uint8_t*>(ints.data())};
+    uint8_t* backOut[] = {reinterpret_cast<uint8_t*>(back.data())};
+    ASSERT_TRUE(ConvertAudioSamples(intIn, AudioSampleFormat::S32, backOut, AudioSampleFormat::S16, channels,
+                                    SAMPLES));
+    EXPECT_EQ(origin, back);
+}
+
+TEST(TestAudioFormat, channel_map_reorders_channels)
+{
+    constexpr uint32_t channels = 3;
+    std::vector<int32_t> interleaved(SAMPLES * channels);
+    for (size_t i = 0; i < interleaved.size(); ++i) {
+        interleaved[i] = static_cast<int32_t>(i % channels) << 20; // 20: the value tells the channel
+    }
+    const uint32_t map[] = {2, 0, 0}; // 2, 0, 0: swap the outer channels, duplicate the first one
+    const uint8_t* in[] = {reinterpret_cast<const uint8_t*>(interleaved.data())};
+    std::vector<float> out(SAMPLES * channels);
+    uint8_t* dst[] = {reinterpret_cast<uint8_t*>(out.data())};
+    ASSERT_TRUE(ConvertAudioSamples(in, AudioSampleFormat::S32, dst, AudioSampleFormat::F32, channels, SAMPLES, map));
+    for (uint32_t i = 0; i < SAMPLES; ++i) {
+        for (uint32_t c = 0; c < channels; ++c) {
+            ASSERT_FLOAT_EQ(static_cast<float>(map[c] << 20) / 2147483648.0f, out[i * channels + c]); // 20, 2^31
+        }
+    }
+}
+
+TEST(TestAudioFormat, unsupported_input_is_rejected)
+{
+    std::vector<uint8_t> data(64); // 64
+    const uint8_t* in[] = {data.data()};
+    uint8_t* out[] = {data.data()};
+    EXPECT_FALSE(IsAudioConvertSupported(AudioSampleFormat::U8, AudioSampleFormat::S16, 2)); // 2: stereo
+    EXPECT_TRUE(IsAudioConvertSupported(AudioSampleFormat::F32P, AudioSampleFormat::S16, 2)); // 2: stereo
+    EXPECT_TRUE(IsAudioConvertSupported(AudioSampleFormat::S16, AudioSampleFormat::F32, MAX_AUDIO_CONVERT_CHANNELS));
+    EXPECT_FALSE(IsAudioConvertSupported(AudioSampleFormat::S16, AudioSampleFormat::F32,
+                                         MAX_AUDIO_CONVERT_CHANNELS + 1));
+    EXPECT_FALSE(IsAudioConvertSupported(AudioSampleFormat::S16, AudioSampleFormat::F32, 0));
+    EXPECT_EQ(0u, GetAudioConvertSampleBytes(AudioSampleFormat::S24));
+    EXPECT_FALSE(ConvertAudioSamples(in, AudioSampleFormat::U8, out, AudioSampleFormat::S16, 1, 8)); // 8
+    const uint32_t map[] = {1};
+    EXPECT_FALSE(ConvertAudioSamples(in, AudioSampleFormat::S16, out, AudioSampleFormat::F32, 1, 8, map)); // 8
+    EXPECT_NE(nullptr, GetAudioConvertIsa());
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+#include "foundation/osal/utils/util.h"
+#include "plugin/plugins/demuxer/common/audio_frame_index.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+using namespace Plugin;
+
+namespace {
+constexpr uint32_t FRAME_CNT = 1000;
+constexpr uint32_t MP3_SAMPLES = 1152;
+constexpr uint32_t AAC_SAMPLES = 1024;
+constexpr uint32_t ID3_SIZE = 300;
+
+struct Stream {
+    std::vector<uint8_t> data;
+    std::vector<uint64_t> frameOffsets;
+
+    AudioFrameIndex::ReadFunc GetReader(std::atomic<uint32_t>* reads = nullptr)
+    {
+        return [this, reads](uint64_t offset, uint8_t* buffer, size_t size) -> size_t {
+            if (reads != nullptr) {
+                ++*reads;
+            }
+            if (offset >= data.size()) {
+                return 0;
+            }
+            size = std::min<size_t>(size, data.size() - offset);
+            (void)memcpy(buffer, data.data() + offset, size);
+            return size;
+        };
+    }
+
+    uint64_t FrameAt(uint64_t sample, uint32_t samplesPerFrame) const
+    {
+        return frameOffsets[sample / samplesPerFrame];
+    }
+};
+
+void AppendMp3Frame(std::vector<uint8_t>& data, uint8_t bitrateIndex)
+{
+    static const uint32_t bitrates[] = {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320};
+    size_t size = 144 * bitrates[bitrateIndex] * 1000 / 44100; // 144: 1152 / 8, 1000: kbps, 44100: sample rate
+    size_t start = data.size();
+    data.resize(start + size, 0);
+    data[start] = 0xFF;
+    data[start + 1] = 0xFB; // 0xFB: mpeg 1 layer III without crc
+    data[start + 2] = static_cast<uint8_t>(bitrateIndex << 4); // 4: 44100 Hz, no padding
+}
+
+/**
+ * 300 bytes of ID3v2, a Xing frame, with or without a table of contents, then FRAME_CNT frames of 64, 128 and
+ * 320 kbps.
+ */
+Stream MakeVbrMp3(bool withToc)
+{
+    Stream stream;
+    stream.data.resize(ID3_SIZE, 0);
+    static const uint8_t bitrateIndexes[] = {5, 9, 14};
+    AppendMp3Frame(stream.data, 9); // 9: 128 kbps
+    size_t xingFrame = ID3_SIZE;
+    for (uint32_t i = 0; i < FRAME_CNT; ++i) {
+        stream.frameOffsets.push_back(stream.data.size());
+        AppendMp3Frame(stream.data, bitrateIndexes[(i * 7 / 3) % 3]); // 7, 3: a pattern without a short period
+    }
+    uint8_t* xing = stream.data.data() + xingFrame + 36; // 36: header and side info of mpeg 1 stereo
+    (void)memcpy(xing, "Xing", 4); // 4: tag
+    xing[7] = withToc ? 0x7 : 0x3; // 0x7: frames, bytes and toc, 0x3: frames and bytes
+    uint64_t bytes = stream.data.size() - xingFrame;
+    for (int i = 0; i < 4; ++i) { // 4: u32
+        xing[8 + i] = static_cast<uint8_t>(FRAME_CNT >> (24 - 8 * i)); // 8: after flags, 24, 8: big endian
+        xing[12 + i] = static_cast<uint8_t>(bytes >> (24 - 8 * i)); // 12: after frames, 24, 8: big endian
+    }
+    for (uint32_t percent = 0; withToc && percent < 100; ++percent) { // 100: toc entries
+        uint64_t offset = stream.frameOffsets[percent * FRAME_CNT / 100] - xingFrame; // 100: percent
+        xing[16 + percent] = static_cast<uint8_t>(offset * 256 / bytes); // 16: after bytes, 256: toc scale
+    }
+    return stream;
+}
+
+/**
+ * FRAME_CNT adts frames of different sizes, with some junk in the middle. If junkAcross is set, there is junk before
+ * the frame whose end or next header is past junkAcross as well.
+ */
+Stream MakeAdts(uint64_t junkAcross = 0)
+{
+    Stream stream;
+    for (uint32_t i = 0; i < FRAME_CNT; ++i) {
+        size_t size = 200 + (i * 37) % 300; // 200, 37, 300: sizes vary
+        if (i == FRAME_CNT / 2 || // 2: junk in the middle
+            (junkAcross > 0 && stream.data.size() + 100 + size + 7 > junkAcross)) { // 100: junk, 7: header
+            stream.data.resize(stream.data.size() + 100, 0); // 100: bytes of junk
+            junkAcross = i == FRAME_CNT / 2 ? junkAcross : 0; // 2: junk in the middle
+        }
+        size_t start = stream.data.size();
+        stream.frameOffsets.push_back(start);
+        stream.data.resize(start + size, 0x11);
+        uint8_t* header = stream.data.data() + start;
+        header[0] = 0xFF;
+        header[1] = 0xF1; // 0xF1: mpeg 4 without crc
+        header[2] = 0x50; // 0x50: aac lc, 44100 Hz
+        header[3] = static_cast<uint8_t>(0x80 | (size >> 11)); // 0x80: stereo, 11: high bits of the length
+        header[4] = static_cast<uint8_t>(size >> 3); // 3: middle bits of the length
+        header[5] = static_cast<uint8_t>(((size & 0x7) << 5) | 0x1F); // 5: low bits of the length, buffer fullness
+        header[6] = 0xFC; // 0xFC: one raw data block
+    }
+    return stream;
+}
+
+void WaitForScan(AudioFrameIndex& index)
+{
+    for (int i = 0; i < 200 && !index.IsScanDone(); ++i) { // 200: wait 2 seconds at most
+        OSAL::SleepFor(10); // 10: ms
+    }
+    ASSERT_TRUE(index.IsScanDone());
+}
+} // namespace
+
+TEST(TestAudioFrameIndex, parses_mpeg_audio_and_adts_headers)
+{
+    AudioFrameInfo info;
+    const uint8_t mp3Header[] = {0xFF, 0xFB, 0x92, 0x00}; // 0x92: 128 kbps, 44100 Hz, padding
+    ASSERT_TRUE(ParseAudioFrameHeader(AudioFrameFormat::MPEG_AUDIO, mp3Header, sizeof(mp3Header), info));
+    EXPECT_EQ(418u, info.size); // 418: 144 * 128000 / 44100 + 1
+    EXPECT_EQ(MP3_SAMPLES, info.samples);
+    EXPECT_EQ(44100u, info.sampleRate); // 44100: sample rate
+    EXPECT_EQ(128000u, info.bitrate); // 128000: bitrate
+    const uint8_t mpeg25Header[] = {0xFF, 0xE2, 0x40, 0xC0}; // 0xE2: mpeg 2.5 layer III, 0x40: 32 kbps, 11025 Hz
+    ASSERT_TRUE(ParseAudioFrameHeader(AudioFrameFormat::MPEG_AUDIO, mpeg25Header, sizeof(mpeg25Header), info));
+    EXPECT_EQ(11025u, info.sampleRate); // 11025: a quarter of 44100
+    EXPECT_EQ(576u, info.samples); // 576: samples of layer III of mpeg 2 and 2.5
+    EXPECT_EQ(208u, info.size); // 208: 72 * 32000 / 11025
+    const uint8_t freeFormat[] = {0xFF, 0xFB, 0x00, 0x00};
+    EXPECT_FALSE(ParseAudioFrameHeader(AudioFrameFormat::MPEG_AUDIO, freeFormat, sizeof(freeFormat), info));
+
+    auto adts = MakeAdts();
+    ASSERT_TRUE(ParseAudioFrameHeader(AudioFrameFormat::ADTS, adts.data.data(), adts.data.size(), info));
+    EXPECT_EQ(200u, info.size); // 200: size of the first frame
+    EXPECT_EQ(AAC_SAMPLES, info.samples);
+    EXPECT_EQ(44100u, info.sampleRate); // 44100: sample rate
+}
+
+TEST(TestAudioFrameIndex, vbr_mp3_seeks_hit_the_frame_once_scanned)
+{
+    auto stream = MakeVbrMp3(false);
+    std::atomic<uint32_t> reads {0};
+    AudioFrameIndex index(AudioFrameFormat::MPEG_AUDIO, stream.GetReader(&reads));
+    ASSERT_TRUE(index.Init(ID3_SIZE, stream.data.size()));
+    EXPECT_FALSE(index.HasToc());
+    EXPECT_EQ(static_cast<uint64_t>(FRAME_CNT) * MP3_SAMPLES, index.GetDurationSamples()); // from the xing header
+    uint32_t initReads = reads.load();
+    index.StartScan(stream.GetReader());
+    WaitForScan(index);
+    EXPECT_EQ(initReads, reads.load()); // the scan reads through its own reader
+    EXPECT_EQ(static_cast<uint64_t>(FRAME_CNT) * MP3_SAMPLES, index.GetDurationSamples());
+    uint64_t offset = 0;
+    uint64_t sample = 0;
+    for (uint64_t target = 0; target < FRAME_CNT * MP3_SAMPLES; target += 9973) { // 9973: not a frame multiple
+        ASSERT_TRUE(index.FindSeekPosition(target, offset, sample));
+        ASSERT_EQ(stream.FrameAt(target, MP3_SAMPLES), offset) << target;
+        ASSERT_EQ(target - target % MP3_SAMPLES, sample) << target;
+    }
+}
+
+TEST(TestAudioFrameIndex, vbr_mp3_seeks_use_the_xing_toc_without_a_scan)
+{
+    auto stream = MakeVbrMp3(true);
+    AudioFrameIndex index(AudioFrameFormat::MPEG_AUDIO, stream.GetReader());
+    ASSERT_TRUE(index.Init(ID3_SIZE, stream.data.size()));
+    EXPECT_TRUE(index.HasToc());
+    std::atomic<uint32_t> scanReads {0};
+    index.StartScan(stream.GetReader(&scanReads));
+    OSAL::SleepFor(50); // 50: ms, time enough for a scan to start
+    EXPECT_EQ(0u, scanReads.load());
+    EXPECT_FALSE(index.IsScanDone());
+    EXPECT_EQ(static_cast<uint64_t>(FRAME_CNT) * MP3_SAMPLES, index.GetDurationSamples()); // from the xing header
+    uint64_t offset = 0;
+    uint64_t sample = 0;
+    for (uint64_t target = MP3_SAMPLES; target < FRAME_CNT * MP3_SAMPLES; target += 99991) { // 99991: step
+        EXPECT_FALSE(index.FindSeekPosition(target, offset, sample));
+        auto frame = std::find(stream.frameOffsets.begin(), stream.frameOffsets.end(), offset);
+        ASSERT_NE(stream.frameOffsets.end(), frame) << "not at a frame boundary: " << offset;
+        int64_t error = (frame - stream.frameOffsets.begin()) - static_cast<int64_t>(target / MP3_SAMPLES);
+        EXPECT_LE(std::abs(error), 8) << target; // 8: frames, the toc has a resolution of 1/256 of the bytes
+    }
+}
+
+TEST(TestAudioFrameIndex, adts_seeks_hit_the_frame_across_junk)
+{
+    auto stream = MakeAdts();
+    AudioFrameIndex index(AudioFrameFormat::ADTS, stream.GetReader());
+    ASSERT_TRUE(index.Init(0, stream.data.size()));
+    index.StartScan(stream.GetReader());
+    WaitForScan(index);
+    EXPECT_EQ(static_cast<uint64_t>(FRAME_CNT) * AAC_SAMPLES, index.GetDurationSamples());
+    uint64_t offset = 0;
+    uint64_t sample = 0;
+    for (uint64_t target = 0; target < FRAME_CNT * AAC_SAMPLES; target += 7919) { // 7919: not a frame multiple
+        ASSERT_TRUE(index.FindSeekPosition(target, offset, sample));
+        ASSERT_EQ(stream.FrameAt(target, AAC_SAMPLES), offset) << target;
+        ASSERT_EQ(target - target % AAC_SAMPLES, sample) << target;
+    }
+}
+
+TEST(TestAudioFrameIndex, adts_seeks_hit_the_frame_after_junk_at_the_end_of_a_scan_chunk)
+{
+    auto stream = MakeAdts(64 * 1024); // 64 * 1024: size of the chunks the scan reads
+    AudioFrameIndex index(AudioFrameFormat::ADTS, stream.GetReader());
+    ASSERT_TRUE(index.Init(0, stream.data.size()));
+    index.StartScan(stream.GetReader());
+    WaitForScan(index);
+    EXPECT_EQ(static_cast<uint64_t>(FRAME_CNT) * AAC_SAMPLES, index.GetDurationSamples());
+    uint64_t offset = 0;
+    uint64_t sample = 0;
+    for (uint64_t target = 0; target < FRAME_CNT * AAC_SAMPLES; target += AAC_SAMPLES) {
+        ASSERT_TRUE(index.FindSeekPosition(target, offset, sample));
+        ASSERT_EQ(stream.FrameAt(target, AAC_SAMPLES), offset) << target;
+        ASSERT_EQ(target, sample) << target;
+    }
+}
+
+TEST(TestAudioFrameIndex, seeks_are_estimated_if_the_scan_cannot_read)
+{
+    auto stream = MakeAdts();
+    AudioFrameIndex index(AudioFrameFormat::ADTS, stream.GetReader());
+    ASSERT_TRUE(index.Init(0, stream.data.size()));
+    index.StartScan([](uint64_t, uint8_t*, size_t) -> size_t { return 0; });
+    OSAL::SleepFor(50); // 50: ms, time enough for the scan to give up
+    EXPECT_FALSE(index.IsScanDone());
+    EXPECT_LT(0u, index.GetDurationSamples()); // estimated from the first frame
+    uint64_t offset = 0;
+    uint64_t sample = 0;
+    uint64_t target = FRAME_CNT / 4 * AAC_SAMPLES; // 4: a quarter in
+    EXPECT_FALSE(index.FindSeekPosition(target, offset, sample));
+    EXPECT_NE(stream.frameOffsets.end(), std::find(stream.frameOffsets.begin(), stream.frameOffsets.end(), offset));
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
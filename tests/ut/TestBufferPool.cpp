@@ -19,6 +19,7 @@
 #define protected public
 #define UNIT_TEST 1
 
+#include <thread>
 #include <vector>
 
 #include "utils/buffer_pool.h"
@@ -55,6 +56,30 @@ TEST_F(BufferPoolTest, buffer_pool_recycle_succ)
     EXPECT_EQ(DEFAULT_POOL_SIZE, pool->Size());
 }
 
+TEST_F(BufferPoolTest, buffer_pool_recycles_when_the_last_reference_is_gone)
+{
+    auto buffPtr = pool->AllocateBuffer();
+    auto raw = buffPtr.get();
+    std::weak_ptr<AVBuffer> weak = buffPtr;
+    buffPtr.reset();
+    EXPECT_EQ(DEFAULT_POOL_SIZE - 1, pool->Size()); // the weak pointer still refers to its control block
+    weak.reset();
+    EXPECT_EQ(DEFAULT_POOL_SIZE, pool->Size());
+
+    // buffers which are out do not keep the pool alive, they are deleted when they come back
+    std::weak_ptr<BufferPool<AVBuffer>> weakPool = pool;
+    buffPtr = pool->AllocateBuffer();
+    EXPECT_EQ(raw, buffPtr.get());
+    std::weak_ptr<AVBuffer> orphan = buffPtr;
+    pool.reset();
+    EXPECT_TRUE(weakPool.expired());
+    ASSERT_NE(nullptr, buffPtr->GetMemory());
+    EXPECT_EQ(DEFAULT_FRAME_SIZE, buffPtr->GetMemory()->GetCapacity());
+    buffPtr.reset();
+    EXPECT_TRUE(orphan.expired());
+    orphan.reset();
+}
+
 TEST_F(BufferPoolTest, buffer_pool_return_nullptr_after_buffer_exhausted)
 {
     EXPECT_EQ(DEFAULT_POOL_SIZE, pool->Size());
@@ -66,4 +91,41 @@ TEST_F(BufferPoolTest, buffer_pool_return_nullptr_after_buffer_exhausted)
     EXPECT_EQ(true, pool->Empty());
     EXPECT_EQ(nullptr, pool->AllocateBufferNonBlocking());
 }
+TEST_F(BufferPoolTest, buffer_pool_allocate_from_best_fit_size_class)
+{
+    EXPECT_TRUE(pool->AddSizeClass(DEFAULT_FRAME_SIZE * 4, 1)); // 4
+    EXPECT_EQ(DEFAULT_POOL_SIZE + 1, pool->Size());
+    EXPECT_EQ(DEFAULT_POOL_SIZE + 1, pool->Capacity());
+    auto small = pool->AllocateBufferNonBlocking();
+    ASSERT_NE(nullptr, small);
+    EXPECT_EQ(static_cast<size_t>(DEFAULT_FRAME_SIZE), small->GetMemory()->GetCapacity());
+    auto big = pool->AllocateBufferNonBlocking(DEFAULT_FRAME_SIZE + 1);
+    ASSERT_NE(nullptr, big);
+    EXPECT_EQ(static_cast<size_t>(DEFAULT_FRAME_SIZE * 4), big->GetMemory()->GetCapacity()); // 4
+    EXPECT_EQ(nullptr, pool->AllocateBufferNonBlocking(DEFAULT_FRAME_SIZE + 1));
+    big.reset();
+    EXPECT_NE(nullptr, pool->AllocateBufferNonBlocking(DEFAULT_FRAME_SIZE + 1));
+}
+
+TEST_F(BufferPoolTest, buffer_pool_does_not_wait_for_a_size_no_class_has)
+{
+    EXPECT_EQ(nullptr, pool->AllocateBuffer(DEFAULT_FRAME_SIZE + 1));
+    EXPECT_EQ(DEFAULT_POOL_SIZE, pool->Size());
+}
+
+TEST_F(BufferPoolTest, buffer_pool_recycle_from_other_thread_wakes_allocator)
+{
+    std::vector<std::shared_ptr<AVBuffer>> buffers;
+    while (!pool->Empty()) {
+        buffers.emplace_back(pool->AllocateBuffer());
+    }
+    std::thread recycler([&buffers] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20)); // 20
+        buffers.clear();
+    });
+    auto buffer = pool->AllocateBuffer();
+    recycler.join();
+    EXPECT_NE(nullptr, buffer);
+    EXPECT_EQ(DEFAULT_POOL_SIZE - 1, pool->Size());
+}
 } // namespace
\ No newline at end of file
@@ -622,5 +622,109 @@ TEST(TestMergeMetaWithCapability, Merge_meta_with_capability_failed_Test)
     cap2.AppendIntervalKey<uint32_t>(CapabilityID::AUDIO_CHANNELS, 3, 8);
     Meta out3;
     ASSERT_FALSE(Pipeline::MergeMetaWithCapability(meta, cap2, out3));
+
+    Capability cap3("audio");
+    Meta out4;
+    ASSERT_FALSE(Pipeline::MergeMetaWithCapability(meta, cap3, out4));
+}
+
+TEST(TestNegotiationScope, scratch_memory_is_given_back_by_the_outermost_scope)
+{
+    Capability upstream(MEDIA_MIME_AUDIO_RAW);
+    upstream.AppendIntervalKey<uint32_t>(CapabilityID::AUDIO_CHANNELS, 2, 8);
+    upstream.AppendDiscreteKeys<uint32_t>(CapabilityID::AUDIO_SAMPLE_RATE, {8000, 16000, 44100, 48000});
+    Capability mismatch(MEDIA_MIME_AUDIO_RAW);
+    mismatch.AppendFixedKey<uint32_t>(CapabilityID::AUDIO_CHANNELS, 10);
+    Capability match(MEDIA_MIME_AUDIO_RAW);
+    match.AppendDiscreteKeys<uint32_t>(CapabilityID::AUDIO_SAMPLE_RATE, {44100, 48000, 96000});
+    CapabilitySet capSet = {mismatch, match};
+
+    Capability out;
+    ASSERT_EQ(nullptr, Pipeline::NegotiationScope::GetArena());
+    {
+        Pipeline::NegotiationScope outer;
+        auto arena = Pipeline::NegotiationScope::GetArena();
+        ASSERT_NE(nullptr, arena);
+        {
+            Pipeline::NegotiationScope inner;
+            ASSERT_EQ(arena, Pipeline::NegotiationScope::GetArena());
+            ASSERT_TRUE(Pipeline::ApplyCapabilitySet(upstream, capSet, out));
+        }
+        ASSERT_GT(arena->GetUsedSize(), 0u); // the nested scope doesn't reset
+    }
+    ASSERT_EQ(nullptr, Pipeline::NegotiationScope::GetArena());
+
+    // the result is on the heap and outlives the scope
+    ASSERT_EQ(MEDIA_MIME_AUDIO_RAW, out.mime);
+    ASSERT_EQ(2u, out.keys.size());
+    auto rates = Plugin::AnyCast<Plugin::DiscreteCapability<uint32_t>>(out.keys[CapabilityID::AUDIO_SAMPLE_RATE]);
+    ASSERT_EQ((Plugin::DiscreteCapability<uint32_t> {44100, 48000}), rates);
+}
+
+TEST(TestCompiledCapability, prefilter_never_rejects_a_merge)
+{
+    Capability wildcard {"*"};
+    Capability audioWildcard {"audio/*"};
+    Capability wrong {"wrong"};
+    Capability raw {MEDIA_MIME_AUDIO_RAW};
+    Capability mpeg {MEDIA_MIME_AUDIO_MPEG};
+    Capability rawUpper {"AUDIO/RAW"};
+    Capability rawFixed {MEDIA_MIME_AUDIO_RAW};
+    rawFixed.AppendFixedKey<uint32_t>(CapabilityID::AUDIO_SAMPLE_RATE, 44100);
+    Capability rawInterval {MEDIA_MIME_AUDIO_RAW};
+    rawInterval.AppendIntervalKey<uint32_t>(CapabilityID::AUDIO_SAMPLE_RATE, 8000, 48000);
+    Capability rawLowInterval {MEDIA_MIME_AUDIO_RAW};
+    rawLowInterval.AppendIntervalKey<uint32_t>(CapabilityID::AUDIO_SAMPLE_RATE, 3000, 4000);
+    Capability rawList {MEDIA_MIME_AUDIO_RAW};
+    rawList.AppendDiscreteKeys<uint32_t>(CapabilityID::AUDIO_SAMPLE_RATE, {1000, 2000, 44100});
+    Capability rawOtherList {MEDIA_MIME_AUDIO_RAW};
+    rawOtherList.AppendDiscreteKeys<uint32_t>(CapabilityID::AUDIO_SAMPLE_RATE, {1000, 2000, 4100});
+    Capability rawChannels {MEDIA_MIME_AUDIO_RAW};
+    rawChannels.AppendFixedKey<uint32_t>(CapabilityID::AUDIO_CHANNELS, 2);
+    rawChannels.AppendFixedKey<AudioSampleFormat>(CapabilityID::AUDIO_SAMPLE_FORMAT, AudioSampleFormat::S16);
+    Capability rawFloat {MEDIA_MIME_AUDIO_RAW};
+    rawFloat.AppendDiscreteKeys<AudioSampleFormat>(CapabilityID::AUDIO_SAMPLE_FORMAT,
+                                                   {AudioSampleFormat::F32, AudioSampleFormat::F32P});
+    std::vector<Capability> caps = {wildcard, audioWildcard, wrong, raw, mpeg, rawUpper, rawFixed, rawInterval,
+                                    rawLowInterval, rawList, rawOtherList, rawChannels, rawFloat};
+
+    size_t rejected = 0;
+    for (const auto& origin : caps) {
+        auto compiledOrigin = Pipeline::CompileCapability(origin);
+        for (const auto& other : caps) {
+            Capability out;
+            bool merged = Pipeline::MergeCapability(origin, other, out);
+            bool mayMerge = Pipeline::MayMergeCapability(compiledOrigin, Pipeline::CompileCapability(other));
+            ASSERT_TRUE(!merged || mayMerge) << origin.mime << " " << other.mime;
+            rejected += mayMerge ? 0 : 1;
+        }
+    }
+    ASSERT_GT(rejected, 0u);
+    ASSERT_FALSE(Pipeline::MayMergeCapability(Pipeline::CompileCapability(mpeg), Pipeline::CompileCapability(raw)));
+    ASSERT_FALSE(Pipeline::MayMergeCapability(Pipeline::CompileCapability(rawLowInterval),
+                                              Pipeline::CompileCapability(rawInterval)));
+    ASSERT_FALSE(Pipeline::MayMergeCapability(Pipeline::CompileCapability(rawChannels),
+                                              Pipeline::CompileCapability(rawFloat)));
+}
+
+TEST(TestCompiledCapability, same_capabilities_compile_the_same)
+{
+    Capability first {MEDIA_MIME_AUDIO_RAW};
+    first.AppendDiscreteKeys<uint32_t>(CapabilityID::AUDIO_SAMPLE_RATE, {8000, 44100});
+    first.AppendFixedKey<uint32_t>(CapabilityID::AUDIO_CHANNELS, 2);
+    Capability second {MEDIA_MIME_AUDIO_RAW};
+    second.AppendFixedKey<uint32_t>(CapabilityID::AUDIO_CHANNELS, 2);
+    second.AppendDiscreteKeys<uint32_t>(CapabilityID::AUDIO_SAMPLE_RATE, {8000, 44100});
+    Capability third {MEDIA_MIME_AUDIO_RAW};
+    third.AppendFixedKey<uint32_t>(CapabilityID::AUDIO_CHANNELS, 1);
+    third.AppendDiscreteKeys<uint32_t>(CapabilityID::AUDIO_SAMPLE_RATE, {8000, 44100});
+
+    auto compiledFirst = Pipeline::CompileCapability(first);
+    auto compiledSecond = Pipeline::CompileCapability(second);
+    auto compiledThird = Pipeline::CompileCapability(third);
+    ASSERT_TRUE(compiledFirst.complete);
+    ASSERT_EQ(compiledFirst.hash, compiledSecond.hash);
+    ASSERT_TRUE(Pipeline::IsSameCapability(compiledFirst, compiledSecond));
+    ASSERT_FALSE(Pipeline::IsSameCapability(compiledFirst, compiledThird));
 }
 }
\ No newline at end of file
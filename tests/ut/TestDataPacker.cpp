@@ -165,6 +165,36 @@ TEST_F(TestDataPacker, can_get_data_from_two_buffers)
     ASSERT_EQ(15, bufferOut->GetMemory()->GetSize());
     ASSERT_STREQ("1234567890abcde", (const char*)(bufferOut->GetMemory()->GetReadOnlyData()));
 }
+TEST_F(TestDataPacker, can_share_data_in_one_buffer_without_copy)
+{
+    auto bufferPtr = CreateBuffer(10);
+    dataPacker->PushData(bufferPtr, 0);
+    auto bufferOut = std::make_shared<AVBuffer>();
+    ASSERT_TRUE(dataPacker->GetRange(3, 4, bufferOut));
+    ASSERT_EQ(1, bufferOut->GetMemoryCount());
+    ASSERT_EQ(4, bufferOut->GetMemory()->GetSize());
+    ASSERT_EQ(bufferPtr->GetMemory()->GetReadOnlyData() + 3, bufferOut->GetMemory()->GetReadOnlyData());
+    ASSERT_TRUE(bufferOut->GetMemory()->IsReadOnly());
+    ASSERT_EQ(nullptr, bufferOut->GetMemory()->GetWritableAddr(1));
+    ASSERT_FALSE(bufferPtr->GetMemory()->IsReadOnly());
+}
+
+TEST_F(TestDataPacker, can_share_data_spanning_two_buffers_and_keep_it_after_remove)
+{
+    dataPacker->PushData(CreateBuffer(10), 0);
+    dataPacker->PushData(CreateBuffer(10, 10), 10);
+    auto bufferOut = std::make_shared<AVBuffer>();
+    ASSERT_TRUE(dataPacker->GetRange(8, 4, bufferOut));
+    ASSERT_EQ(2, bufferOut->GetMemoryCount());
+    ASSERT_EQ(0, memcmp("90", bufferOut->GetMemory(0)->GetReadOnlyData(), 2));
+    ASSERT_EQ(0, memcmp("ab", bufferOut->GetMemory(1)->GetReadOnlyData(), 2));
+
+    auto bufferOut2 = std::make_shared<AVBuffer>();
+    ASSERT_TRUE(dataPacker->GetRange(15, 2, bufferOut2));
+    ASSERT_STREQ("DataPacker (offset 15, size 5, buffer count 1)", dataPacker->ToString().c_str());
+    ASSERT_EQ(0, memcmp("ab", bufferOut->GetMemory(1)->GetReadOnlyData(), 2));
+    ASSERT_EQ(0, memcmp("fg", bufferOut2->GetMemory()->GetReadOnlyData(), 2));
+}
 } // namespace Test
 } // namespace Media
 } // namespace OHOS
\ No newline at end of file
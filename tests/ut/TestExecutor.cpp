@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#define private public
+#define protected public
+
+#include <atomic>
+#include <memory>
+#include "foundation/osal/thread/executor.h"
+#include "foundation/osal/thread/task.h"
+#include "foundation/osal/utils/util.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+TEST(TestExecutor, run_all_submitted_jobs)
+{
+    constexpr int count = 10000;
+    std::atomic<int> done {0};
+    {
+        OSAL::Executor executor(4); // 4 workers
+        for (int i = 0; i < count; ++i) {
+            executor.Submit([&done] { done++; }, i % 2 ? OSAL::ThreadPriority::LOW : OSAL::ThreadPriority::HIGH);
+        }
+        while (done.load() < count) {
+            OSAL::SleepFor(1);
+        }
+    }
+    EXPECT_EQ(count, done.load());
+}
+
+TEST(TestExecutor, pooled_task_pause_resume_and_stop)
+{
+    std::atomic<int> iterations {0};
+    auto task = std::make_shared<OSAL::Task>("pooledTask", [&iterations] { iterations++; },
+                                             OSAL::ThreadPriority::HIGH, true);
+    task->Start();
+    while (iterations.load() < 100) { // 100
+        OSAL::SleepFor(1);
+    }
+    task->Pause();
+    EXPECT_EQ(false, task->scheduled_);
+    int paused = iterations.load();
+    OSAL::SleepFor(20); // 20
+    EXPECT_EQ(paused, iterations.load());
+    task->Start();
+    while (iterations.load() < paused + 100) { // 100
+        OSAL::SleepFor(1);
+    }
+    task->Stop();
+    EXPECT_EQ(false, task->scheduled_);
+    task->Start();
+    task->StopAsync();
+    task.reset();
+}
+
+TEST(TestExecutor, many_pooled_tasks_share_the_pool)
+{
+    constexpr int taskNum = 64;
+    std::atomic<int> iterations[taskNum] {};
+    std::vector<std::shared_ptr<OSAL::Task>> tasks;
+    for (int i = 0; i < taskNum; ++i) {
+        auto& counter = iterations[i];
+        tasks.emplace_back(std::make_shared<OSAL::Task>("pooledTask", [&counter] { counter++; },
+                                                        OSAL::ThreadPriority::NORMAL, true));
+        tasks.back()->Start();
+    }
+    for (int i = 0; i < taskNum; ++i) {
+        while (iterations[i].load() < 10) { // 10
+            OSAL::SleepFor(1);
+        }
+    }
+    for (auto& task : tasks) {
+        task->Stop();
+    }
+    EXPECT_GE(iterations[taskNum - 1].load(), 10); // 10
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#if !defined(WIN32) && !defined(__LITEOS_M__)
+#include <unistd.h>
+#endif
+#include "plugin/common/media_source.h"
+#include "plugin/common/plugin_buffer.h"
+#include "plugin/plugins/source/file_source/file_source_plugin.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+using namespace Plugin;
+using namespace Plugin::FileSource;
+
+namespace {
+constexpr size_t FILE_SIZE = 100000;
+
+class FileSourcePluginTest : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        fileName_ = "./file_source_plugin_test.bin";
+        for (size_t i = 0; i < FILE_SIZE; ++i) {
+            data_.push_back(static_cast<uint8_t>(i % 251)); // 251: a prime, so that misplaced reads show
+        }
+        FILE* file = fopen(fileName_.c_str(), "wb");
+        ASSERT_NE(nullptr, file);
+        ASSERT_EQ(FILE_SIZE, fwrite(data_.data(), 1, data_.size(), file));
+        fclose(file);
+        plugin_ = std::make_shared<FileSourcePlugin>("FileSource");
+        ASSERT_EQ(Status::OK, plugin_->Init());
+        ASSERT_EQ(Status::OK, plugin_->SetSource(std::make_shared<MediaSource>("file://" + fileName_)));
+    }
+
+    void TearDown() override
+    {
+        plugin_.reset();
+        (void)remove(fileName_.c_str());
+    }
+
+    void ExpectData(const std::shared_ptr<Memory>& memory, size_t offset)
+    {
+        ASSERT_LE(offset + memory->GetSize(), data_.size());
+        EXPECT_EQ(0, memcmp(data_.data() + offset, memory->GetReadOnlyData(), memory->GetSize()));
+    }
+
+    std::string fileName_;
+    std::vector<uint8_t> data_;
+    std::shared_ptr<FileSourcePlugin> plugin_;
+};
+} // namespace
+
+TEST_F(FileSourcePluginTest, reads_into_the_memory_of_the_buffer)
+{
+    auto buffer = std::make_shared<Buffer>();
+    auto memory = buffer->AllocMemory(nullptr, 1000); // 1000: bytes
+    ASSERT_EQ(Status::OK, plugin_->Read(buffer, 1000)); // 1000: bytes
+    EXPECT_EQ(memory, buffer->GetMemory());
+    EXPECT_EQ(1000u, memory->GetSize()); // 1000: bytes
+    EXPECT_FALSE(memory->IsReadOnly());
+    ExpectData(memory, 0);
+}
+
+TEST_F(FileSourcePluginTest, hands_out_the_file_as_read_only_memory_without_buffer_memory)
+{
+    ASSERT_EQ(Status::OK, plugin_->SeekTo(FILE_SIZE - 3000)); // 3000: bytes before the end
+    std::shared_ptr<Buffer> buffer = std::make_shared<Buffer>();
+    ASSERT_EQ(Status::OK, plugin_->Read(buffer, 4096)); // 4096: more than what is left
+    auto memory = buffer->GetMemory();
+    ASSERT_NE(nullptr, memory);
+    EXPECT_EQ(3000u, memory->GetSize()); // 3000: what is left
+    ExpectData(memory, FILE_SIZE - 3000); // 3000: bytes before the end
+    std::shared_ptr<Buffer> eos = std::make_shared<Buffer>();
+    EXPECT_EQ(Status::END_OF_STREAM, plugin_->Read(eos, 1));
+#if !defined(WIN32) && !defined(__LITEOS_M__)
+    EXPECT_TRUE(memory->IsReadOnly());
+    EXPECT_EQ(nullptr, memory->GetWritableAddr(1));
+    uint8_t byte = 0;
+    EXPECT_EQ(0u, memory->Write(&byte, 1, 0));
+    auto view = std::make_shared<Buffer>();
+    ASSERT_NE(nullptr, view->WrapMemorySlice(memory, 10, 10)); // 10: offset and size of the view
+    EXPECT_TRUE(view->GetMemory()->IsReadOnly());
+#endif
+
+    // the memory keeps the file data alive after the source is gone
+    plugin_.reset();
+    ExpectData(memory, FILE_SIZE - 3000); // 3000: bytes before the end
+}
+
+#if !defined(WIN32) && !defined(__LITEOS_M__)
+TEST_F(FileSourcePluginTest, reads_a_truncated_file_without_touching_the_mapping)
+{
+    std::shared_ptr<Buffer> buffer = std::make_shared<Buffer>();
+    ASSERT_EQ(Status::OK, plugin_->Read(buffer, 1000)); // 1000: bytes
+    ASSERT_EQ(0, truncate(fileName_.c_str(), 2000)); // 2000: the new size of the file
+    std::shared_ptr<Buffer> tail = std::make_shared<Buffer>();
+    ASSERT_EQ(Status::OK, plugin_->Read(tail, 4096)); // 4096: more than what is left
+    ASSERT_NE(nullptr, tail->GetMemory());
+    EXPECT_EQ(1000u, tail->GetMemory()->GetSize()); // 1000: what is left after truncation
+    ExpectData(tail->GetMemory(), 1000); // 1000: bytes read before
+    std::shared_ptr<Buffer> eos = std::make_shared<Buffer>();
+    EXPECT_EQ(Status::END_OF_STREAM, plugin_->Read(eos, 1));
+    EXPECT_NE(Status::OK, plugin_->SeekTo(FILE_SIZE - 3000)); // 3000: bytes before the old end
+}
+#endif
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
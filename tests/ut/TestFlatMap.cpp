@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "foundation/cpp_ext/flat_map.h"
+#include "plugin/common/plugin_tags.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+using namespace OHOS::Media::Plugin;
+
+TEST(TestFlatMap, keeps_keys_sorted_and_unique)
+{
+    CppExt::FlatMap<int, std::string> map {{3, "three"}, {1, "one"}, {2, "two"}, {1, "uno"}}; // 1: duplicate
+    ASSERT_EQ(3u, map.size()); // 3
+    int last = 0;
+    for (const auto& item : map) {
+        ASSERT_LT(last, item.first);
+        last = item.first;
+    }
+    EXPECT_EQ("one", map.at(1));
+
+    auto res = map.insert({0, "zero"});
+    EXPECT_TRUE(res.second);
+    EXPECT_EQ(map.begin(), res.first);
+    res = map.insert(std::make_pair(2, "dos")); // 2: exists, not replaced
+    EXPECT_FALSE(res.second);
+    EXPECT_EQ("two", res.first->second);
+    res = map.insert_or_assign(2, "dos"); // 2: replaced
+    EXPECT_FALSE(res.second);
+    EXPECT_EQ("dos", map.at(2));
+    map[5] = "five"; // 5
+    EXPECT_EQ(5u, map.size()); // 5
+    EXPECT_EQ(1u, map.count(5)); // 5
+    EXPECT_EQ(0u, map.count(4)); // 4
+    EXPECT_EQ(map.end(), map.find(4)); // 4
+    EXPECT_THROW(map.at(4), std::out_of_range); // 4
+
+    EXPECT_EQ(1u, map.erase(0));
+    EXPECT_EQ(0u, map.erase(0));
+    map.erase(map.find(3)); // 3
+    std::vector<int> keys;
+    for (const auto& item : map) {
+        keys.push_back(item.first);
+    }
+    EXPECT_EQ((std::vector<int> {1, 2, 5}), keys);
+    map.clear();
+    EXPECT_TRUE(map.empty());
+}
+
+TEST(TestFlatMap, tag_map_holds_any_values)
+{
+    TagMap tags;
+    tags.insert({Tag::MIME, std::string("audio/mpeg")});
+    tags.insert({Tag::AUDIO_SAMPLE_RATE, static_cast<uint32_t>(44100)}); // 44100
+    tags[Tag::TRACK_ID] = static_cast<uint32_t>(1);
+    auto ite = tags.find(Tag::AUDIO_SAMPLE_RATE);
+    ASSERT_NE(std::end(tags), ite);
+    EXPECT_EQ(44100u, AnyCast<uint32_t>(ite->second)); // 44100
+    EXPECT_EQ("audio/mpeg", AnyCast<std::string>(tags.at(Tag::MIME)));
+    TagMap copy = tags;
+    copy.erase(Tag::MIME);
+    EXPECT_EQ(3u, tags.size()); // 3
+    EXPECT_EQ(2u, copy.size()); // 2
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
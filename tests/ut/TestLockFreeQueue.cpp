@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#define private public
+#define protected public
+
+#include <memory>
+#include <thread>
+#include "utils/lock_free_queue.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+TEST(TestLockFreeQueue, push_pop_keeps_fifo_order)
+{
+    LockFreeQueue<int> queue("test", 3); // 3
+    EXPECT_TRUE(queue.Empty());
+    EXPECT_TRUE(queue.Push(1));
+    EXPECT_TRUE(queue.Push(2)); // 2
+    EXPECT_TRUE(queue.Push(3)); // 3
+    EXPECT_EQ(3, queue.Size()); // 3
+    EXPECT_FALSE(queue.Push(4, 10)); // 4, timeout 10 ms
+    EXPECT_EQ(1, queue.Pop());
+    EXPECT_EQ(2, queue.Pop());  // 2
+    EXPECT_EQ(3, queue.Pop(10)); // 3, timeout 10 ms
+    EXPECT_EQ(0, queue.Pop(10)); // timeout 10 ms
+}
+
+TEST(TestLockFreeQueue, inactive_queue_drops_data_and_wakes_waiter)
+{
+    LockFreeQueue<std::shared_ptr<int>> queue("test", 2); // 2
+    auto data = std::make_shared<int>(1);
+    EXPECT_TRUE(queue.Push(data));
+    EXPECT_EQ(2, data.use_count()); // 2
+    std::thread consumer([&queue] {
+        queue.Pop();
+        EXPECT_EQ(nullptr, queue.Pop());
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // 50
+    queue.SetActive(false);
+    consumer.join();
+    EXPECT_EQ(1, data.use_count());
+    EXPECT_FALSE(queue.Push(data));
+    queue.SetActive(true);
+    EXPECT_TRUE(queue.Push(data));
+    queue.Clear();
+    EXPECT_TRUE(queue.Empty());
+    EXPECT_EQ(1, data.use_count());
+}
+
+TEST(TestLockFreeQueue, producer_consumer_transfer_all_elements)
+{
+    constexpr int count = 100000;
+    LockFreeQueue<int> queue("test", 8); // 8
+    std::thread producer([&queue] {
+        for (int i = 1; i <= count; ++i) {
+            queue.Push(i);
+        }
+    });
+    int64_t sum = 0;
+    int last = 0;
+    bool ordered = true;
+    for (int i = 0; i < count; ++i) {
+        int value = queue.Pop();
+        ordered = ordered && (value == last + 1);
+        last = value;
+        sum += value;
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(static_cast<int64_t>(count) * (count + 1) / 2, sum); // 2
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
@@ -13,6 +13,9 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
 #include <gtest/gtest.h>
 
 #define private public
@@ -121,6 +124,58 @@ TEST(TestMeta, update_meta)
     ASSERT_TRUE(meta.GetInt32(MetaID::AUDIO_CHANNELS, oChannel));
     ASSERT_EQ(channels2, oChannel);
 }
+
+TEST(TestMeta, copies_share_items_until_modified)
+{
+    Meta meta;
+    meta.SetString(MetaID::MIME, "audio/mpeg");
+    meta.SetUint32(MetaID::TRACK_ID, 1);
+    Meta copy = meta;
+    ASSERT_EQ(meta.items_, copy.items_);
+    ASSERT_EQ(meta.GetData(MetaID::MIME), copy.GetData(MetaID::MIME));
+
+    copy.SetUint32(MetaID::TRACK_ID, 2); // 2
+    ASSERT_NE(meta.items_, copy.items_);
+    uint32_t trackId = 0;
+    ASSERT_TRUE(meta.GetUint32(MetaID::TRACK_ID, trackId));
+    ASSERT_EQ(1u, trackId);
+    ASSERT_TRUE(copy.GetUint32(MetaID::TRACK_ID, trackId));
+    ASSERT_EQ(2u, trackId);
+
+    Meta other = meta;
+    other.Clear();
+    ASSERT_TRUE(other.Empty());
+    ASSERT_FALSE(meta.Empty());
+    other = meta;
+    ASSERT_TRUE(other.Remove(MetaID::MIME));
+    std::string mime;
+    ASSERT_TRUE(meta.GetString(MetaID::MIME, mime));
+    ASSERT_EQ("audio/mpeg", mime);
+}
+
+TEST(TestMeta, update_of_empty_meta_shares_items)
+{
+    Meta meta;
+    uint8_t config[] = {1, 2, 3};
+    meta.SetPointer(MetaID::MEDIA_CODEC_CONFIG, config, sizeof(config));
+    meta.SetUint32(MetaID::AUDIO_SAMPLE_RATE, 44100); // 44100
+    Meta track;
+    track.Update(meta);
+    ASSERT_EQ(meta.items_, track.items_);
+    track.SetUint32(MetaID::AUDIO_SAMPLE_RATE, 48000); // 48000
+    uint32_t sampleRate = 0;
+    ASSERT_TRUE(meta.GetUint32(MetaID::AUDIO_SAMPLE_RATE, sampleRate));
+    ASSERT_EQ(44100u, sampleRate); // 44100
+    void* out = nullptr;
+    size_t size = 0;
+    ASSERT_TRUE(track.GetPointer(MetaID::MEDIA_CODEC_CONFIG, &out, size));
+    ASSERT_EQ(sizeof(config), size);
+    ASSERT_EQ(0, memcmp(config, out, size));
+    delete[] static_cast<uint8_t*>(out);
+    std::vector<MetaID> ids {MetaID::AUDIO_SAMPLE_RATE, MetaID::MEDIA_CODEC_CONFIG};
+    std::sort(ids.begin(), ids.end());
+    ASSERT_EQ(ids, track.GetMetaIDs());
+}
 } // namespace Test
 } // namespace Media
 } // namespace OHOS
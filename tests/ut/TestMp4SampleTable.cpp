@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "plugin/plugins/demuxer/minimp4_demuxer/mp4_sample_table.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+using namespace Plugin::Minimp4;
+
+namespace {
+using Bytes = std::vector<uint8_t>;
+
+constexpr uint32_t SAMPLE_CNT = 500 + 3 * 834; // 500 in chunks of 5, the rest in chunks of 3
+constexpr uint32_t FIRST_RUN_CHUNKS = 100;
+constexpr uint32_t CHUNK_GAP = 16;
+constexpr uint32_t SYNC_INTERVAL = 10;
+
+void PutU16(Bytes& bytes, uint32_t value)
+{
+    bytes.push_back(static_cast<uint8_t>(value >> 8)); // 8: big endian
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+void PutU32(Bytes& bytes, uint32_t value)
+{
+    PutU16(bytes, value >> 16); // 16: high half first
+    PutU16(bytes, value & 0xFFFF);
+}
+
+void PutU64(Bytes& bytes, uint64_t value)
+{
+    PutU32(bytes, static_cast<uint32_t>(value >> 32)); // 32: high word first
+    PutU32(bytes, static_cast<uint32_t>(value));
+}
+
+void Append(Bytes& bytes, const Bytes& more)
+{
+    bytes.insert(bytes.end(), more.begin(), more.end());
+}
+
+Bytes Box(const std::string& type, const Bytes& payload)
+{
+    Bytes box;
+    PutU32(box, static_cast<uint32_t>(payload.size() + 8)); // 8: size and type
+    box.insert(box.end(), type.begin(), type.end());
+    Append(box, payload);
+    return box;
+}
+
+Bytes FullBoxHeader(uint32_t entryCount)
+{
+    Bytes bytes(4, 0); // 4: version and flags
+    PutU32(bytes, entryCount);
+    return bytes;
+}
+
+Bytes Hdlr(const std::string& handler)
+{
+    Bytes payload(8, 0); // 8: version, flags and pre defined
+    payload.insert(payload.end(), handler.begin(), handler.end());
+    payload.resize(payload.size() + 13, 0); // 13: reserved and an empty name
+    return Box("hdlr", payload);
+}
+
+Bytes Mdhd(uint32_t timeScale, uint32_t duration)
+{
+    Bytes payload(12, 0); // 12: version, flags, creation and modification time
+    PutU32(payload, timeScale);
+    PutU32(payload, duration);
+    payload.resize(payload.size() + 4, 0); // 4: language and pre defined
+    return Box("mdhd", payload);
+}
+
+Bytes Stsd()
+{
+    Bytes esds(4, 0); // 4: version and flags
+    Bytes decoderConfig {0x04, 17, 0x40, 0x15, 0, 0, 0}; // 17: length, 0x40: aac, 0x15: audio stream
+    PutU32(decoderConfig, 0);      // max bitrate
+    PutU32(decoderConfig, 128000); // 128000: avg bitrate
+    Append(decoderConfig, {0x05, 2, 0x12, 0x10}); // 2: length, 0x12 0x10: aac lc, 44100 Hz, stereo
+    Append(esds, {0x03, static_cast<uint8_t>(3 + decoderConfig.size()), 0, 1, 0}); // 3: es id and flags
+    Append(esds, decoderConfig);
+
+    Bytes mp4a(6, 0); // 6: reserved
+    PutU16(mp4a, 1);  // data reference index
+    mp4a.resize(mp4a.size() + 8, 0); // 8: reserved
+    PutU16(mp4a, 2);  // 2: channel count
+    PutU16(mp4a, 16); // 16: sample size
+    PutU32(mp4a, 0);  // pre defined and reserved
+    PutU32(mp4a, 44100u << 16); // 44100: sample rate, 16: 16.16 fixed point
+    Append(mp4a, Box("esds", esds));
+
+    Bytes payload = FullBoxHeader(1);
+    Append(payload, Box("mp4a", mp4a));
+    return Box("stsd", payload);
+}
+
+class Mp4File {
+public:
+    Mp4File()
+    {
+        for (uint32_t i = 0; i < SAMPLE_CNT; ++i) {
+            sizes.push_back(100 + i % 7); // 100, 7: sizes vary
+            deltas.push_back(1000 + i % 3); // 1000, 3: so that each sample needs a stts entry
+        }
+        Append(data, Box("ftyp", {'M', '4', 'A', ' ', 0, 0, 0, 0}));
+
+        // the mdat with a 64 bit size before the moov, chunks are CHUNK_GAP bytes apart
+        Bytes mdat;
+        std::vector<uint64_t> chunkOffsets;
+        uint64_t mdatPayload = data.size() + 16; // 16: header with a 64 bit size
+        uint64_t dts = 0;
+        for (uint32_t sample = 0; sample < SAMPLE_CNT;) {
+            chunkOffsets.push_back(mdatPayload + mdat.size());
+            uint32_t samplesPerChunk = chunkOffsets.size() <= FIRST_RUN_CHUNKS ? 5 : 3; // 5, 3: samples per chunk
+            for (uint32_t i = 0; i < samplesPerChunk; ++i, ++sample) {
+                offsets.push_back(mdatPayload + mdat.size());
+                dtss.push_back(dts);
+                dts += deltas[sample];
+                mdat.resize(mdat.size() + sizes[sample], static_cast<uint8_t>(sample));
+            }
+            mdat.resize(mdat.size() + CHUNK_GAP, 0xFF);
+        }
+        PutU32(data, 1); // 1: 64 bit size follows the type
+        Append(data, {'m', 'd', 'a', 't'});
+        PutU64(data, mdat.size() + 16); // 16: header with a 64 bit size
+        Append(data, mdat);
+
+        Bytes stbl = Stsd();
+        Bytes stts = FullBoxHeader(SAMPLE_CNT);
+        for (auto delta : deltas) {
+            PutU32(stts, 1);
+            PutU32(stts, delta);
+        }
+        Append(stbl, Box("stts", stts));
+        Bytes stsc = FullBoxHeader(2); // 2: runs of chunks
+        Append(stsc, {0, 0, 0, 1, 0, 0, 0, 5, 0, 0, 0, 1}); // 5: samples per chunk from chunk 1
+        PutU32(stsc, FIRST_RUN_CHUNKS + 1);
+        Append(stsc, {0, 0, 0, 3, 0, 0, 0, 1}); // 3: samples per chunk
+        Append(stbl, Box("stsc", stsc));
+        Bytes stsz(8, 0); // 8: version, flags and a sample size of 0
+        PutU32(stsz, SAMPLE_CNT);
+        for (auto size : sizes) {
+            PutU32(stsz, size);
+        }
+        Append(stbl, Box("stsz", stsz));
+        Bytes stco = FullBoxHeader(chunkOffsets.size());
+        for (auto offset : chunkOffsets) {
+            PutU32(stco, static_cast<uint32_t>(offset));
+        }
+        Append(stbl, Box("stco", stco));
+        Bytes stss = FullBoxHeader((SAMPLE_CNT + SYNC_INTERVAL - 1) / SYNC_INTERVAL);
+        for (uint32_t sample = 0; sample < SAMPLE_CNT; sample += SYNC_INTERVAL) {
+            PutU32(stss, sample + 1);
+        }
+        Append(stbl, Box("stss", stss));
+
+        Bytes videoMdia = Mdhd(90000, 0); // 90000: video time scale
+        Append(videoMdia, Hdlr("vide"));
+        Bytes audioMdia = Mdhd(44100, static_cast<uint32_t>(dts)); // 44100: time scale
+        Append(audioMdia, Hdlr("soun"));
+        Append(audioMdia, Box("minf", Box("stbl", stbl)));
+        Bytes moov = Box("trak", Box("mdia", videoMdia));
+        Append(moov, Box("trak", Box("mdia", audioMdia)));
+        moovSize = moov.size();
+        Append(data, Box("moov", moov));
+    }
+
+    Mp4SampleTable::ReadFunc GetReader()
+    {
+        return [this](uint64_t offset, uint8_t* buffer, size_t size) {
+            if (offset + size > data.size()) {
+                return false;
+            }
+            readBytes += size;
+            (void)memcpy(buffer, data.data() + offset, size);
+            return true;
+        };
+    }
+
+    Bytes data;
+    size_t moovSize {0};
+    size_t readBytes {0};
+    std::vector<uint32_t> sizes;
+    std::vector<uint32_t> deltas;
+    std::vector<uint64_t> offsets;
+    std::vector<uint64_t> dtss;
+};
+} // namespace
+
+TEST(TestMp4SampleTable, finds_the_moov_after_the_mdat_and_reads_only_small_boxes)
+{
+    Mp4File file;
+    Mp4SampleTable table(file.GetReader());
+    ASSERT_TRUE(table.FindMoov(file.data.size()));
+    EXPECT_EQ(file.moovSize, table.GetMoovSize());
+    ASSERT_TRUE(table.Open());
+    EXPECT_LT(file.readBytes, 1024u); // 1024: the tables take far more than that
+    auto& track = table.GetTrack();
+    EXPECT_EQ(44100u, track.timeScale); // 44100: time scale
+    EXPECT_EQ(file.dtss.back() + file.deltas.back(), track.duration);
+    EXPECT_EQ(SAMPLE_CNT, track.sampleCount);
+    EXPECT_EQ(2u, track.channelCount); // 2: stereo
+    EXPECT_EQ(44100u, track.sampleRate); // 44100: sample rate
+    EXPECT_EQ(0x40u, track.objectTypeIndication); // 0x40: aac
+    EXPECT_EQ(128000u, track.avgBitrate); // 128000: avg bitrate
+    EXPECT_EQ((std::vector<uint8_t> {0x12, 0x10}), track.dsi);
+}
+
+TEST(TestMp4SampleTable, samples_are_found_in_order_and_at_random)
+{
+    Mp4File file;
+    Mp4SampleTable table(file.GetReader());
+    ASSERT_TRUE(table.FindMoov(file.data.size()));
+    ASSERT_TRUE(table.Open());
+    Mp4Sample sample;
+    for (uint32_t i = 0; i < SAMPLE_CNT; ++i) {
+        ASSERT_TRUE(table.GetSample(i, sample));
+        ASSERT_EQ(file.offsets[i], sample.offset) << i;
+        ASSERT_EQ(file.sizes[i], sample.size) << i;
+        ASSERT_EQ(file.dtss[i], sample.dts) << i;
+    }
+    for (int64_t i = SAMPLE_CNT - 1; i >= 0; i -= 37) { // 37: a stride that hits every kind of position
+        ASSERT_TRUE(table.GetSample(static_cast<uint32_t>(i), sample));
+        ASSERT_EQ(file.offsets[i], sample.offset) << i;
+        ASSERT_EQ(file.dtss[i], sample.dts) << i;
+    }
+    EXPECT_FALSE(table.GetSample(SAMPLE_CNT, sample));
+}
+
+TEST(TestMp4SampleTable, seeks_to_the_sync_sample_before)
+{
+    Mp4File file;
+    Mp4SampleTable table(file.GetReader());
+    ASSERT_TRUE(table.FindMoov(file.data.size()));
+    ASSERT_TRUE(table.Open());
+    EXPECT_EQ(0u, table.FindSeekSample(0));
+    for (uint32_t i = 0; i < SAMPLE_CNT; i += 13) { // 13: not a multiple of the sync interval
+        ASSERT_EQ(i - i % SYNC_INTERVAL, table.FindSeekSample(file.dtss[i] + 1)) << i;
+    }
+    uint32_t lastSync = (SAMPLE_CNT - 1) - (SAMPLE_CNT - 1) % SYNC_INTERVAL;
+    EXPECT_EQ(lastSync, table.FindSeekSample(file.dtss.back() * 2)); // 2: after the end
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
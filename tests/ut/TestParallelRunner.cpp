@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "foundation/osal/utils/util.h"
+#include "pipeline/core/parallel_runner.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+using namespace Pipeline;
+
+TEST(TestParallelRunner, jobs_run_after_their_dependencies)
+{
+    // source -> demuxer -> (audio decoder -> audio sink, video decoder -> video sink), prepared sinks first
+    std::mutex mutex;
+    std::vector<std::string> order;
+    ParallelRunner runner;
+    auto add = [&](const std::string& name) {
+        return runner.AddJob(name, [&, name] {
+            OSAL::SleepFor(5); // 5: ms, long enough for the branches to overlap
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(name);
+            return ErrorCode::SUCCESS;
+        });
+    };
+    auto source = add("source");
+    auto demuxer = add("demuxer");
+    auto audioDecoder = add("audioDecoder");
+    auto audioSink = add("audioSink");
+    auto videoDecoder = add("videoDecoder");
+    auto videoSink = add("videoSink");
+    runner.AddDependency(source, demuxer);
+    runner.AddDependency(demuxer, audioDecoder);
+    runner.AddDependency(demuxer, videoDecoder);
+    runner.AddDependency(audioDecoder, audioSink);
+    runner.AddDependency(videoDecoder, videoSink);
+    ASSERT_EQ(ErrorCode::SUCCESS, runner.Run());
+
+    auto position = [&order](const std::string& name) {
+        return std::find(order.begin(), order.end(), name) - order.begin();
+    };
+    ASSERT_EQ(6u, order.size()); // 6: all jobs
+    EXPECT_LT(position("audioSink"), position("audioDecoder"));
+    EXPECT_LT(position("videoSink"), position("videoDecoder"));
+    EXPECT_LT(position("audioDecoder"), position("demuxer"));
+    EXPECT_LT(position("videoDecoder"), position("demuxer"));
+    EXPECT_EQ("source", order.back());
+    ASSERT_EQ(6u, runner.GetTimings().size()); // 6: all jobs
+    // the two branches run side by side: 4 levels of 5 ms rather than 6 jobs one after another
+    EXPECT_LT(runner.GetTotalUs(), 29000); // 29000: less than 6 * 5 ms
+}
+
+TEST(TestParallelRunner, no_job_is_started_after_a_failure)
+{
+    std::atomic<int> runs {0};
+    ParallelRunner runner(1); // 1: the calling thread only, so the order is fixed
+    auto failing = runner.AddJob("failing", [&runs] {
+        runs++;
+        return ErrorCode::ERROR_UNSUPPORTED_FORMAT;
+    });
+    auto dependent = runner.AddJob("dependent", [&runs] {
+        runs++;
+        return ErrorCode::SUCCESS;
+    });
+    (void)runner.AddJob("independent", [&runs] {
+        runs++;
+        return ErrorCode::SUCCESS;
+    });
+    runner.AddDependency(dependent, failing);
+    EXPECT_EQ(ErrorCode::ERROR_UNSUPPORTED_FORMAT, runner.Run());
+    EXPECT_EQ(1, runs.load());
+    ASSERT_EQ(1u, runner.GetTimings().size());
+    EXPECT_EQ("failing", runner.GetTimings()[0].name);
+}
+
+TEST(TestParallelRunner, a_cycle_is_reported)
+{
+    ParallelRunner runner;
+    auto first = runner.AddJob("first", [] { return ErrorCode::SUCCESS; });
+    auto second = runner.AddJob("second", [] { return ErrorCode::SUCCESS; });
+    runner.AddDependency(first, second);
+    runner.AddDependency(second, first);
+    EXPECT_EQ(ErrorCode::ERROR_INVALID_OPERATION, runner.Run());
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+#include "utils/pipeline_tracer.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+class TestPipelineTracer : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        PipelineTracer::Instance().Clear();
+        PipelineTracer::Instance().SetEnabled(true);
+    }
+
+    void TearDown() override
+    {
+        PipelineTracer::Instance().SetEnabled(false);
+        PipelineTracer::Instance().Clear();
+    }
+};
+
+TEST_F(TestPipelineTracer, nothing_is_recorded_when_disabled)
+{
+    auto& tracer = PipelineTracer::Instance();
+    tracer.SetEnabled(false);
+    {
+        PIPELINE_TRACE_SCOPE(tracer.Intern("disabled"), "test");
+    }
+    EXPECT_TRUE(tracer.Snapshot().empty());
+}
+
+TEST_F(TestPipelineTracer, spans_of_all_threads_are_exported)
+{
+    auto& tracer = PipelineTracer::Instance();
+    const char* name = tracer.Intern("demuxer.default");
+    EXPECT_EQ(name, tracer.Intern("demuxer.default"));
+    constexpr int threadCnt = 4;
+    constexpr int spanCnt = 100;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCnt; ++i) {
+        threads.emplace_back([name, i] {
+            for (int j = 0; j < spanCnt; ++j) {
+                PIPELINE_TRACE_SCOPE(name, "port", i * spanCnt + j, 16); // 16: bytes
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto events = PipelineTracer::Instance().Snapshot();
+    ASSERT_EQ(static_cast<size_t>(threadCnt * spanCnt), events.size());
+    for (size_t i = 1; i < events.size(); ++i) {
+        ASSERT_LE(events[i - 1].beginNs, events[i].beginNs);
+        ASSERT_GE(events[i].durationNs, 0);
+        ASSERT_EQ(16u, events[i].bytes); // 16: bytes
+    }
+    auto json = tracer.ExportChromeTrace();
+    EXPECT_EQ(0u, json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+    EXPECT_NE(std::string::npos, json.find("\"name\":\"demuxer.default\",\"cat\":\"port\",\"ph\":\"X\""));
+    EXPECT_NE(std::string::npos, json.find("\"args\":{\"pts\":399,\"bytes\":16}"));
+    EXPECT_NE(std::string::npos, json.find("\"ph\":\"M\""));
+}
+
+TEST_F(TestPipelineTracer, full_ring_keeps_the_newest_spans)
+{
+    auto& tracer = PipelineTracer::Instance();
+    const char* name = tracer.Intern("videosink.render");
+    int64_t total = PipelineTracer::RING_CAPACITY + 10; // 10: wrap around
+    for (int64_t i = 0; i < total; ++i) {
+        tracer.Record(name, "sink", i, i + 1, i);
+    }
+    auto events = tracer.Snapshot();
+    ASSERT_EQ(PipelineTracer::RING_CAPACITY, events.size());
+    EXPECT_EQ(10, events.front().pts); // 10: the oldest ones are overwritten
+    EXPECT_EQ(total - 1, events.back().pts);
+    tracer.Clear();
+    EXPECT_TRUE(tracer.Snapshot().empty());
+}
+
+TEST_F(TestPipelineTracer, counters_report_totals_and_rates)
+{
+    auto& tracer = PipelineTracer::Instance();
+    auto scope = PipelineTracer::NewScope("player");
+    auto counters = tracer.GetCounters(scope, "audiosink");
+    EXPECT_EQ(counters, tracer.GetCounters(scope, "audiosink"));
+    counters->AddBuffer(100); // 100: bytes
+    counters->AddBuffer(300); // 300: bytes
+    counters->AddBlocked(2000000); // 2000000: 2 ms
+    counters->SetQueueDepth(3); // 3: buffers queued
+    std::this_thread::sleep_for(std::chrono::milliseconds(10)); // 10: let some time pass for the rates
+    auto stats = tracer.GetCounterStats(scope);
+    ASSERT_EQ(1u, stats.size());
+    auto it = stats.begin();
+    EXPECT_EQ(scope, it->scope);
+    EXPECT_EQ("audiosink", it->name);
+    EXPECT_EQ(2u, it->buffers); // 2: buffers
+    EXPECT_EQ(400u, it->bytes); // 400: bytes
+    EXPECT_EQ(2, it->blockedMs); // 2: ms
+    EXPECT_EQ(3u, it->queueDepth); // 3: buffers queued
+    EXPECT_GT(it->buffersPerSecond, 0.0);
+    EXPECT_GT(it->bytesPerSecond, it->buffersPerSecond);
+    EXPECT_GT(it->blockedRatio, 0.0);
+    EXPECT_LT(it->blockedRatio, 1.0);
+    tracer.RemoveCounters(scope);
+}
+
+TEST_F(TestPipelineTracer, counters_of_pipelines_are_kept_apart)
+{
+    auto& tracer = PipelineTracer::Instance();
+    auto first = PipelineTracer::NewScope("player");
+    auto second = PipelineTracer::NewScope("player");
+    EXPECT_NE(first, second);
+    tracer.GetCounters(first, "audiosink")->AddBuffer(100); // 100: bytes
+    tracer.GetCounters(second, "audiosink")->AddBuffer(200); // 200: bytes
+    auto firstStats = tracer.GetCounterStats(first);
+    ASSERT_EQ(1u, firstStats.size());
+    EXPECT_EQ(100u, firstStats[0].bytes); // 100: bytes
+    auto secondStats = tracer.GetCounterStats(second);
+    ASSERT_EQ(1u, secondStats.size());
+    EXPECT_EQ(200u, secondStats[0].bytes); // 200: bytes
+
+    auto counters = tracer.GetCounters(first, "audiosink");
+    tracer.RemoveCounters(first);
+    EXPECT_TRUE(tracer.GetCounterStats(first).empty());
+    EXPECT_EQ(1u, tracer.GetCounterStats(second).size());
+    counters->AddBuffer(1); // 1: the filter may still count after its pipeline is gone
+    tracer.RemoveCounters(second);
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <memory>
+#include "plugin/common/plugin_buffer.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+using namespace OHOS::Media::Plugin;
+
+TEST(TestPluginBuffer, default_buffer_places_meta_memory_and_payload_in_one_block)
+{
+    auto buffer = Buffer::CreateDefaultBuffer(BufferMetaType::VIDEO, 1000, nullptr, 64); // 1000, 64
+    ASSERT_NE(nullptr, buffer);
+    ASSERT_EQ(1u, buffer->GetMemoryCount());
+    ASSERT_FALSE(buffer->IsEmpty());
+    auto memory = buffer->GetMemory();
+    ASSERT_NE(nullptr, memory);
+    EXPECT_EQ(nullptr, buffer->GetMemory(1));
+    EXPECT_EQ(1000u, memory->GetCapacity()); // 1000
+    auto addr = memory->GetWritableAddr(1000); // 1000
+    ASSERT_NE(nullptr, addr);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(addr) % 64); // 64: the alignment
+    (void)memset(addr, 0x5a, 1000); // 0x5a, 1000: the whole payload is writable
+    auto base = reinterpret_cast<const uint8_t*>(buffer.get());
+    EXPECT_GT(reinterpret_cast<const uint8_t*>(addr), base);
+    EXPECT_LT(reinterpret_cast<const uint8_t*>(addr), base + 4096); // 4096: right behind the buffer
+    auto meta = buffer->GetBufferMeta();
+    ASSERT_NE(nullptr, meta);
+    EXPECT_EQ(BufferMetaType::VIDEO, meta->GetType());
+
+    // the memory and the meta share the count of the buffer
+    std::weak_ptr<Buffer> weak = buffer;
+    buffer.reset();
+    EXPECT_FALSE(weak.expired());
+    memory.reset();
+    EXPECT_FALSE(weak.expired());
+    meta.reset();
+    EXPECT_TRUE(weak.expired());
+}
+
+TEST(TestPluginBuffer, slice_keeps_the_block_alive)
+{
+    auto buffer = Buffer::CreateDefaultBuffer(BufferMetaType::AUDIO, 100); // 100
+    auto memory = buffer->GetMemory();
+    for (uint8_t i = 0; i < 100; ++i) { // 100
+        ASSERT_EQ(1u, memory->Write(&i, 1));
+    }
+    Buffer other;
+    auto slice = other.WrapMemorySlice(memory, 10, 20); // 10, 20
+    ASSERT_NE(nullptr, slice);
+    std::weak_ptr<Buffer> weak = buffer;
+    memory.reset();
+    buffer.reset();
+    EXPECT_FALSE(weak.expired());
+    EXPECT_EQ(10, other.GetMemory()->GetReadOnlyData()[0]); // 10: first byte of the slice
+    EXPECT_EQ(29, other.GetMemory()->GetReadOnlyData()[19]); // 29, 19: last byte of the slice
+}
+
+TEST(TestPluginBuffer, reset_reuses_meta_and_keeps_further_memories)
+{
+    auto buffer = std::make_shared<Buffer>(BufferMetaType::AUDIO);
+    ASSERT_TRUE(buffer->IsEmpty());
+    ASSERT_NE(nullptr, buffer->AllocMemory(nullptr, 10)); // 10
+    uint8_t extra[4] = {0};
+    ASSERT_NE(nullptr, buffer->WrapMemory(extra, sizeof(extra), sizeof(extra)));
+    ASSERT_EQ(2u, buffer->GetMemoryCount()); // 2
+    EXPECT_EQ(sizeof(extra), buffer->GetMemory(1)->GetSize());
+    EXPECT_EQ(nullptr, buffer->GetMemory(2)); // 2
+
+    auto meta = buffer->GetBufferMeta().get();
+    meta->SetMeta(Tag::MEDIA_POSITION, static_cast<uint32_t>(5)); // 5
+    std::static_pointer_cast<AudioBufferMeta>(buffer->GetBufferMeta())->samples = 1024; // 1024
+    buffer->pts = 1;
+    buffer->Reset();
+    EXPECT_EQ(meta, buffer->GetBufferMeta().get());
+    EXPECT_FALSE(meta->GetMeta(Tag::MEDIA_POSITION).HasValue());
+    EXPECT_EQ(0u, std::static_pointer_cast<AudioBufferMeta>(buffer->GetBufferMeta())->samples);
+    EXPECT_EQ(0u, buffer->pts);
+
+    auto held = buffer->GetBufferMeta();
+    buffer->Reset();
+    EXPECT_NE(held, buffer->GetBufferMeta()); // still referenced, so it is replaced
+}
+
+TEST(TestPluginBuffer, reset_replaces_a_held_meta_of_the_block)
+{
+    auto buffer = Buffer::CreateDefaultBuffer(BufferMetaType::AUDIO, 100); // 100
+    auto meta = buffer->GetBufferMeta().get();
+    buffer->pts = 1;
+    buffer->Reset();
+    EXPECT_EQ(meta, buffer->GetBufferMeta().get());
+    EXPECT_EQ(0u, buffer->pts);
+
+    auto held = buffer->GetBufferMeta();
+    held->SetMeta(Tag::MEDIA_POSITION, static_cast<uint32_t>(5)); // 5
+    buffer->Reset();
+    EXPECT_NE(held, buffer->GetBufferMeta()); // still referenced, so it is replaced
+    EXPECT_FALSE(buffer->GetBufferMeta()->GetMeta(Tag::MEDIA_POSITION).HasValue());
+    EXPECT_TRUE(held->GetMeta(Tag::MEDIA_POSITION).HasValue());
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
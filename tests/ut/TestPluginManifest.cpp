@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "plugin/common/plugin_audio_tags.h"
+#include "plugin/core/plugin_manifest.h"
+#include "plugin/interface/codec_plugin.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+using namespace Plugin;
+
+namespace {
+const std::string MANIFEST_PATH = "./ut_plugins.manifest";
+
+PluginManifestEntry MakeEntry(int64_t modifyTime)
+{
+    auto packageDef = std::make_shared<PackageDef>();
+    packageDef->pkgVersion = 1;
+    packageDef->name = "FFmpegAudioDecoders";
+    packageDef->licenseType = LicenseType::LGPL;
+    auto info = std::make_shared<PluginInfo>();
+    info->apiVersion = 0x10002; // 0x10002: api version 1.2
+    info->pluginType = PluginType::CODEC;
+    info->name = "ffmpegAuDec_mp3";
+    info->description = "adapter for ffmpeg,\nwith a line break";
+    info->rank = 100; // 100: rank
+    info->extra[PLUGIN_INFO_EXTRA_CODEC_TYPE] = CodecType::AUDIO_DECODER;
+    info->extra[PLUGIN_INFO_EXTRA_EXTENSIONS] = std::vector<std::string> {"mp3", "mpeg audio"};
+    Capability inCap {"audio/mpeg"};
+    inCap.AppendFixedKey<uint32_t>(Capability::Key::AUDIO_MPEG_VERSION, 1);
+    inCap.AppendIntervalKey<uint32_t>(Capability::Key::AUDIO_MPEG_LAYER, 1, 3); // 3: layer 3
+    inCap.AppendDiscreteKeys<uint32_t>(Capability::Key::AUDIO_SAMPLE_RATE, {8000, 44100, 48000});
+    info->inCaps.push_back(inCap);
+    Capability outCap {"audio/raw"};
+    outCap.AppendDiscreteKeys<AudioSampleFormat>(Capability::Key::AUDIO_SAMPLE_FORMAT,
+                                                 {AudioSampleFormat::S16, AudioSampleFormat::F32P});
+    outCap.AppendFixedKey<AudioChannelLayout>(Capability::Key::AUDIO_CHANNEL_LAYOUT, AudioChannelLayout::STEREO);
+    info->outCaps.push_back(outCap);
+    PluginManifestEntry entry("libhistreamer_plugin_FFmpegAudioDecoders.so", "FFmpegAudioDecoders",
+                              123456, modifyTime); // 123456: file size
+    entry.plugins.push_back({packageDef, info});
+    return entry;
+}
+} // namespace
+
+TEST(TestPluginManifest, plugin_infos_survive_saving_and_loading)
+{
+    PluginManifest manifest;
+    ASSERT_TRUE(manifest.Update(MakeEntry(1000))); // 1000: modify time
+    ASSERT_TRUE(manifest.IsChanged());
+    ASSERT_TRUE(manifest.Save(MANIFEST_PATH));
+
+    PluginManifest loaded;
+    ASSERT_TRUE(loaded.Load(MANIFEST_PATH));
+    EXPECT_FALSE(loaded.IsChanged());
+    EXPECT_EQ(nullptr, loaded.Find("libhistreamer_plugin_FFmpegAudioDecoders.so", 123456, 1001)); // modified later
+    auto entry = loaded.Find("libhistreamer_plugin_FFmpegAudioDecoders.so", 123456, 1000); // 123456, 1000: as saved
+    ASSERT_NE(nullptr, entry);
+    EXPECT_EQ("FFmpegAudioDecoders", entry->registerName);
+    ASSERT_EQ(1u, entry->plugins.size());
+    EXPECT_EQ(LicenseType::LGPL, entry->plugins[0].packageDef->licenseType);
+    const auto& info = *entry->plugins[0].info;
+    EXPECT_EQ("adapter for ffmpeg,\nwith a line break", info.description);
+    EXPECT_EQ(PluginType::CODEC, info.pluginType);
+    EXPECT_EQ(CodecType::AUDIO_DECODER, AnyCast<CodecType>(info.extra.at(PLUGIN_INFO_EXTRA_CODEC_TYPE)));
+    EXPECT_EQ((std::vector<std::string> {"mp3", "mpeg audio"}),
+              AnyCast<std::vector<std::string>>(info.extra.at(PLUGIN_INFO_EXTRA_EXTENSIONS)));
+    ASSERT_EQ(1u, info.inCaps.size());
+    const auto& inKeys = info.inCaps[0].keys;
+    EXPECT_EQ(1u, AnyCast<uint32_t>(inKeys.at(Capability::Key::AUDIO_MPEG_VERSION)));
+    EXPECT_EQ((std::pair<uint32_t, uint32_t> {1, 3}), // 3: layer 3
+              (AnyCast<std::pair<uint32_t, uint32_t>>(inKeys.at(Capability::Key::AUDIO_MPEG_LAYER))));
+    EXPECT_EQ((std::vector<uint32_t> {8000, 44100, 48000}),
+              AnyCast<std::vector<uint32_t>>(inKeys.at(Capability::Key::AUDIO_SAMPLE_RATE)));
+    ASSERT_EQ(1u, info.outCaps.size());
+    EXPECT_EQ("audio/raw", info.outCaps[0].mime);
+    EXPECT_EQ(AudioChannelLayout::STEREO,
+              AnyCast<AudioChannelLayout>(info.outCaps[0].keys.at(Capability::Key::AUDIO_CHANNEL_LAYOUT)));
+    (void)std::remove(MANIFEST_PATH.c_str());
+}
+
+TEST(TestPluginManifest, unknown_value_types_and_broken_files_are_not_used)
+{
+    PluginManifest manifest;
+    auto entry = MakeEntry(1000); // 1000: modify time
+    entry.plugins[0].info->extra["unknown"] = 1.5; // 1.5: double is no type of any plugin definition
+    EXPECT_FALSE(manifest.Update(entry));
+    EXPECT_EQ(nullptr, manifest.Find(entry.libName, entry.fileSize, entry.modifyTime));
+
+    ASSERT_TRUE(manifest.Update(MakeEntry(1000))); // 1000: modify time
+    manifest.Retain({"libhistreamer_plugin_other.so"});
+    EXPECT_EQ(nullptr, manifest.Find(entry.libName, entry.fileSize, entry.modifyTime));
+
+    {
+        std::ofstream file(MANIFEST_PATH, std::ios::out | std::ios::trunc);
+        file << "HiStreamerPluginManifest 1 1\nlibrary 3:lib";
+    }
+    PluginManifest broken;
+    EXPECT_FALSE(broken.Load(MANIFEST_PATH));
+    EXPECT_TRUE(broken.IsChanged()); // to be rewritten
+    (void)std::remove(MANIFEST_PATH.c_str());
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
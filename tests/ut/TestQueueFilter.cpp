@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "foundation/osal/utils/util.h"
+#include "pipeline/filters/queue/queue_filter.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+using namespace Pipeline;
+
+namespace {
+class CollectingFilter : public FilterBase {
+public:
+    explicit CollectingFilter(const std::string& name) : FilterBase(name)
+    {
+    }
+
+    ErrorCode PushData(const std::string& inPort, const AVBufferPtr& buffer, int64_t offset) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pts.push_back(buffer->pts);
+        return ErrorCode::SUCCESS;
+    }
+
+    std::vector<uint64_t> GetPts()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return pts;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<uint64_t> pts;
+};
+
+class EventCollector : public EventReceiver {
+public:
+    void OnEvent(const Event& event) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (event.type == EventType::EVENT_QUEUE_FILL_LEVEL) {
+            states.push_back(Plugin::AnyCast<QueueFillLevel>(event.param).state);
+        }
+    }
+
+    std::mutex mutex;
+    std::vector<QueueFillState> states;
+};
+
+AVBufferPtr MakeBuffer(uint64_t pts, uint32_t flag = 0)
+{
+    auto buffer = std::make_shared<AVBuffer>();
+    buffer->AllocMemory(nullptr, 1024); // 1024: bytes
+    buffer->GetMemory()->UpdateDataSize(1024); // 1024: bytes
+    buffer->pts = pts;
+    buffer->flag = flag;
+    return buffer;
+}
+
+class UtTestQueueFilter : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        source.Init(&events, nullptr);
+        queue.Init(&events, nullptr);
+        sink.Init(&events, nullptr);
+        source.GetOutPort(PORT_NAME_DEFAULT)->Connect(queue.GetInPort(PORT_NAME_DEFAULT));
+        queue.GetInPort(PORT_NAME_DEFAULT)->Connect(source.GetOutPort(PORT_NAME_DEFAULT));
+        queue.GetOutPort(PORT_NAME_DEFAULT)->Connect(sink.GetInPort(PORT_NAME_DEFAULT));
+        sink.GetInPort(PORT_NAME_DEFAULT)->Connect(queue.GetOutPort(PORT_NAME_DEFAULT));
+    }
+
+    void TearDown() override
+    {
+        (void)queue.Stop();
+    }
+
+    void WaitForBuffers(size_t count)
+    {
+        for (int i = 0; i < 100 && sink.GetPts().size() < count; ++i) { // 100: wait 1 second at most
+            OSAL::SleepFor(10); // 10: ms
+        }
+    }
+
+    EventCollector events;
+    CollectingFilter source {"source"};
+    QueueFilter queue {"queue"};
+    CollectingFilter sink {"sink"};
+};
+} // namespace
+
+TEST_F(UtTestQueueFilter, buffers_pass_in_order_once_started)
+{
+    ASSERT_EQ(ErrorCode::SUCCESS, queue.Prepare());
+    for (uint64_t pts = 0; pts < 3; ++pts) { // 3: buffers
+        ASSERT_EQ(ErrorCode::SUCCESS, queue.PushData(PORT_NAME_DEFAULT, MakeBuffer(pts), -1));
+    }
+    EXPECT_EQ(3u, queue.GetFillLevel().buffers); // 3: nothing is pushed downstream before the start
+    EXPECT_TRUE(sink.GetPts().empty());
+    ASSERT_EQ(ErrorCode::SUCCESS, queue.Start());
+    WaitForBuffers(3); // 3: buffers
+    EXPECT_EQ((std::vector<uint64_t> {0, 1, 2}), sink.GetPts());
+    EXPECT_EQ(0u, queue.GetFillLevel().buffers);
+    EXPECT_EQ(QueueFillState::EMPTY, queue.GetFillLevel().state);
+}
+
+TEST_F(UtTestQueueFilter, leaky_upstream_drops_the_pushed_buffers)
+{
+    queue.SetLimits({2, 0, 0}); // 2: buffers
+    queue.SetLeakyMode(QueueLeakyMode::UPSTREAM);
+    ASSERT_EQ(ErrorCode::SUCCESS, queue.Prepare());
+    for (uint64_t pts = 0; pts < 4; ++pts) { // 4: buffers
+        ASSERT_EQ(ErrorCode::SUCCESS, queue.PushData(PORT_NAME_DEFAULT, MakeBuffer(pts), -1));
+    }
+    EXPECT_EQ(2u, queue.GetDroppedCount());
+    EXPECT_EQ(2u, queue.GetFillLevel().buffers); // 2: the limit
+    {
+        std::lock_guard<std::mutex> lock(events.mutex);
+        EXPECT_EQ((std::vector<QueueFillState> {QueueFillState::FILLING, QueueFillState::FULL}), events.states);
+    }
+    ASSERT_EQ(ErrorCode::SUCCESS, queue.Start());
+    // eos is never dropped, it waits for room instead
+    ASSERT_EQ(ErrorCode::SUCCESS, queue.PushData(PORT_NAME_DEFAULT, MakeBuffer(4, BUFFER_FLAG_EOS), -1)); // 4: pts
+    WaitForBuffers(3); // 3: buffers
+    EXPECT_EQ((std::vector<uint64_t> {0, 1, 4}), sink.GetPts());
+    EXPECT_EQ(2u, queue.GetDroppedCount());
+}
+
+TEST_F(UtTestQueueFilter, leaky_downstream_drops_the_oldest_buffers)
+{
+    queue.SetLimits({0, 0, 2 * HST_SECOND}); // 2: seconds
+    queue.SetLeakyMode(QueueLeakyMode::DOWNSTREAM);
+    ASSERT_EQ(ErrorCode::SUCCESS, queue.Prepare());
+    for (uint64_t second = 0; second < 5; ++second) { // 5: buffers one second apart
+        ASSERT_EQ(ErrorCode::SUCCESS, queue.PushData(PORT_NAME_DEFAULT, MakeBuffer(second * HST_SECOND), -1));
+    }
+    EXPECT_EQ(2u, queue.GetDroppedCount());
+    auto level = queue.GetFillLevel();
+    EXPECT_EQ(QueueFillState::FULL, level.state);
+    EXPECT_EQ(2 * HST_SECOND, level.duration); // 2: seconds
+    EXPECT_EQ(3u * 1024, level.bytes); // 3, 1024: buffers of 1024 bytes
+    EXPECT_EQ(100u, level.percent); // 100: full
+    ASSERT_EQ(ErrorCode::SUCCESS, queue.Start());
+    WaitForBuffers(3); // 3: buffers
+    EXPECT_EQ((std::vector<uint64_t> {2 * HST_SECOND, 3 * HST_SECOND, 4 * HST_SECOND}), sink.GetPts());
+}
+
+TEST_F(UtTestQueueFilter, a_starving_queue_of_the_group_lets_the_others_overrun)
+{
+    QueueFilter otherQueue {"otherQueue"};
+    CollectingFilter otherSink {"otherSink"};
+    otherQueue.Init(&events, nullptr);
+    otherSink.Init(&events, nullptr);
+    otherQueue.GetOutPort(PORT_NAME_DEFAULT)->Connect(otherSink.GetInPort(PORT_NAME_DEFAULT));
+    otherSink.GetInPort(PORT_NAME_DEFAULT)->Connect(otherQueue.GetOutPort(PORT_NAME_DEFAULT));
+    auto group = std::make_shared<QueueGroup>();
+    queue.SetGroup(group);
+    otherQueue.SetGroup(group);
+    queue.SetLimits({2, 0, 0}); // 2: buffers
+    ASSERT_EQ(ErrorCode::SUCCESS, queue.Prepare());
+    otherQueue.GetInPort(PORT_NAME_DEFAULT)->Connect(source.GetOutPort(PORT_NAME_DEFAULT));
+    ASSERT_EQ(ErrorCode::SUCCESS, otherQueue.Prepare());
+    for (uint64_t pts = 0; pts < 2; ++pts) { // 2: the limit
+        ASSERT_EQ(ErrorCode::SUCCESS, queue.PushData(PORT_NAME_DEFAULT, MakeBuffer(pts), -1));
+    }
+
+    // blocks until the other queue starts and runs empty
+    std::thread pusher([this] { (void)queue.PushData(PORT_NAME_DEFAULT, MakeBuffer(2), -1); }); // 2: pts
+    OSAL::SleepFor(20); // 20: ms
+    EXPECT_EQ(2u, queue.GetFillLevel().buffers); // 2: the limit
+    EXPECT_FALSE(group->HasStarvingQueue());
+    ASSERT_EQ(ErrorCode::SUCCESS, otherQueue.Start());
+    pusher.join();
+    EXPECT_TRUE(group->HasStarvingQueue());
+    for (uint64_t pts = 3; pts < 2 * QueueGroup::OVERRUN_FACTOR; ++pts) { // 3: next pts, 2: the limit
+        ASSERT_EQ(ErrorCode::SUCCESS, queue.PushData(PORT_NAME_DEFAULT, MakeBuffer(pts), -1));
+    }
+    EXPECT_EQ(2u * QueueGroup::OVERRUN_FACTOR, queue.GetFillLevel().buffers); // 2: the limit
+
+    // the end of stream ends the starving
+    ASSERT_EQ(ErrorCode::SUCCESS, otherQueue.PushData(PORT_NAME_DEFAULT, MakeBuffer(0, BUFFER_FLAG_EOS), -1));
+    for (int i = 0; i < 100 && otherSink.GetPts().empty(); ++i) { // 100: wait 1 second at most
+        OSAL::SleepFor(10); // 10: ms
+    }
+    EXPECT_FALSE(group->HasStarvingQueue());
+    (void)otherQueue.Stop();
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "utils/ring_buffer.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+constexpr size_t RING_SIZE = 1000;
+
+TEST(TestRingBuffer, write_and_read_across_the_wrap_around)
+{
+    RingBuffer ring(RING_SIZE);
+    ASSERT_TRUE(ring.Init());
+    ASSERT_GE(ring.GetCapacity(), RING_SIZE);
+    std::vector<uint8_t> in(ring.GetCapacity() - 10); // 10: so that the second write wraps
+    for (size_t i = 0; i < in.size(); ++i) {
+        in[i] = static_cast<uint8_t>(i);
+    }
+    std::vector<uint8_t> out(in.size());
+    for (int round = 0; round < 3; ++round) { // 3: wrap a few times
+        ring.WriteBuffer(in.data(), in.size());
+        EXPECT_EQ(in.size(), ring.GetSize());
+        EXPECT_EQ(in.size(), ring.ReadBuffer(out.data(), out.size()));
+        EXPECT_EQ(in, out);
+        EXPECT_EQ(0u, ring.GetSize());
+    }
+    EXPECT_EQ(0u, ring.ReadBuffer(out.data(), out.size()));
+}
+
+TEST(TestRingBuffer, reserved_and_peeked_spans_are_contiguous)
+{
+    RingBuffer ring(RING_SIZE);
+    ASSERT_TRUE(ring.Init());
+    size_t capacity = ring.GetCapacity();
+    size_t half = capacity / 2 + 1; // 2, 1: the second span crosses the end
+    for (int round = 0; round < 4; ++round) { // 4: wrap a few times
+        auto span = ring.ReserveWrite(half);
+        ASSERT_NE(nullptr, span);
+        for (size_t i = 0; i < half; ++i) {
+            span[i] = static_cast<uint8_t>(round + i);
+        }
+        ring.CommitWrite(half);
+        size_t size = half;
+        auto data = ring.PeekRead(size);
+        ASSERT_NE(nullptr, data);
+        if (ring.IsMirrored()) {
+            ASSERT_EQ(half, size);
+        }
+        std::vector<uint8_t> out(data, data + size);
+        ASSERT_TRUE(ring.ConsumeRead(size));
+        if (size < half) {
+            size_t rest = half - size;
+            auto second = ring.PeekRead(rest);
+            ASSERT_NE(nullptr, second);
+            ASSERT_EQ(half - size, rest);
+            out.insert(out.end(), second, second + rest);
+            ASSERT_TRUE(ring.ConsumeRead(rest));
+        }
+        for (size_t i = 0; i < half; ++i) {
+            ASSERT_EQ(static_cast<uint8_t>(round + i), out[i]);
+        }
+    }
+    EXPECT_EQ(nullptr, ring.ReserveWrite(capacity + 1));
+}
+
+TEST(TestRingBuffer, cancelled_reservation_publishes_nothing)
+{
+    RingBuffer ring(RING_SIZE);
+    ASSERT_TRUE(ring.Init());
+    size_t capacity = ring.GetCapacity();
+    std::vector<uint8_t> in(capacity - 10); // 10: so that the reservation below crosses the end
+    ring.WriteBuffer(in.data(), in.size());
+    ASSERT_EQ(in.size(), ring.ReadBuffer(in.data(), in.size()));
+    ring.Clear(); // the next commit starts the media offsets again
+
+    auto span = ring.ReserveWrite(20); // 20
+    ASSERT_NE(nullptr, span);
+    memset(span, 0xff, 20); // 0xff, 20: garbage a failed producer left behind
+    ring.CancelWrite();
+    EXPECT_EQ(0u, ring.GetSize());
+    size_t size = 1;
+    EXPECT_EQ(nullptr, ring.PeekRead(size));
+
+    std::vector<uint8_t> next(20); // 20
+    for (size_t i = 0; i < next.size(); ++i) {
+        next[i] = static_cast<uint8_t>(i);
+    }
+    ring.WriteBuffer(next.data(), next.size(), 2000); // 2000: the cancelled span kept no media offset
+    EXPECT_TRUE(ring.Seek(2000)); // 2000
+    std::vector<uint8_t> out(next.size());
+    ASSERT_EQ(next.size(), ring.ReadBuffer(out.data(), out.size()));
+    EXPECT_EQ(next, out);
+}
+
+TEST(TestRingBuffer, spsc_stream_stays_in_order)
+{
+    RingBuffer ring(RING_SIZE);
+    ASSERT_TRUE(ring.Init());
+    constexpr size_t total = 1 << 20; // 1 << 20: 1 MiB through a 1 KB ring
+    std::thread producer([&ring] {
+        size_t written = 0;
+        size_t chunk = 1;
+        while (written < total) {
+            size_t size = std::min(total - written, chunk);
+            auto span = ring.ReserveWrite(size);
+            ASSERT_NE(nullptr, span);
+            for (size_t i = 0; i < size; ++i) {
+                span[i] = static_cast<uint8_t>((written + i) * 7); // 7: not a power of two
+            }
+            ring.CommitWrite(size);
+            written += size;
+            chunk = chunk % 300 + 17; // 300, 17: sizes that do not divide the capacity
+        }
+    });
+    size_t read = 0;
+    while (read < total) {
+        size_t size = 512; // 512
+        auto span = ring.PeekRead(size, 1);
+        if (span == nullptr) {
+            continue;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(static_cast<uint8_t>((read + i) * 7), span[i]); // 7: see the producer
+        }
+        ASSERT_TRUE(ring.ConsumeRead(size));
+        read += size;
+    }
+    producer.join();
+    EXPECT_EQ(0u, ring.GetSize());
+}
+
+TEST(TestRingBuffer, seek_clear_and_deactivate)
+{
+    RingBuffer ring(RING_SIZE);
+    ASSERT_TRUE(ring.Init());
+    std::vector<uint8_t> in(100); // 100
+    for (size_t i = 0; i < in.size(); ++i) {
+        in[i] = static_cast<uint8_t>(i);
+    }
+    ring.WriteBuffer(in.data(), 50, 1000); // 50, 1000: media offset of the first byte
+    ring.WriteBuffer(in.data() + 50, 50, 1050); // 50, 1050: the next chunk
+    EXPECT_FALSE(ring.Seek(999)); // 999: before the buffered range
+    EXPECT_FALSE(ring.Seek(1100)); // 1100: after it
+    EXPECT_TRUE(ring.Seek(1060)); // 1060: inside
+    uint8_t out = 0;
+    ASSERT_EQ(1u, ring.ReadBuffer(&out, 1));
+    EXPECT_EQ(60, out); // 60: the byte at media offset 1060
+    EXPECT_TRUE(ring.Seek(1070)); // 1070: still buffered
+
+    size_t size = 10; // 10
+    ASSERT_NE(nullptr, ring.PeekRead(size));
+    ring.Clear();
+    EXPECT_FALSE(ring.ConsumeRead(size));
+    EXPECT_EQ(0u, ring.GetSize());
+    ring.WriteBuffer(in.data(), 10, 5000); // 10, 5000: offsets restart after a clear
+    EXPECT_TRUE(ring.Seek(5005)); // 5005
+    ASSERT_EQ(1u, ring.ReadBuffer(&out, 1));
+    EXPECT_EQ(5, out); // 5
+
+    ring.SetActive(false);
+    EXPECT_EQ(0u, ring.GetSize());
+    EXPECT_EQ(nullptr, ring.ReserveWrite(1));
+    ring.WriteBuffer(in.data(), 10); // 10: dropped
+    EXPECT_EQ(0u, ring.ReadBuffer(&out, 1, 1));
+    ring.SetActive(true);
+    ring.WriteBuffer(in.data(), 10); // 10
+    EXPECT_EQ(10u, ring.GetSize()); // 10
+}
+
+TEST(TestRingBuffer, inactive_ring_wakes_a_blocked_writer)
+{
+    RingBuffer ring(RING_SIZE);
+    ASSERT_TRUE(ring.Init());
+    std::vector<uint8_t> in(ring.GetCapacity());
+    ring.WriteBuffer(in.data(), in.size());
+    std::thread writer([&ring, &in] {
+        ring.WriteBuffer(in.data(), 1); // blocks, the ring is full
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // 20: let the writer block
+    ring.SetActive(false);
+    writer.join();
+    EXPECT_EQ(0u, ring.GetSize());
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
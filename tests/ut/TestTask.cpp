@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#define private public
+#define protected public
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include "foundation/osal/thread/task.h"
+#include "foundation/osal/utils/util.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+TEST(TestTask, paused_task_reacts_to_stop_without_polling)
+{
+    std::atomic<int> iterations {0};
+    auto task = std::make_shared<OSAL::Task>("pausedTask", [&iterations] {
+        iterations++;
+        OSAL::SleepFor(1);
+    });
+    task->Start();
+    while (iterations.load() < 3) { // 3
+        OSAL::SleepFor(1);
+    }
+    task->Pause();
+    int paused = iterations.load();
+    OSAL::SleepFor(20); // 20
+    EXPECT_EQ(paused, iterations.load());
+    auto begin = std::chrono::steady_clock::now();
+    task->StopAsync();
+    while (task->runningState_.load() != OSAL::Task::RunningState::STOPPED) {
+        OSAL::SleepFor(1);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+    EXPECT_LT(elapsed.count(), 200); // 200: well below the former 500 ms wakeup period
+    EXPECT_EQ(paused, iterations.load());
+    task.reset();
+}
+
+TEST(TestTask, resume_and_stop_from_pause)
+{
+    std::atomic<int> iterations {0};
+    OSAL::Task task("resumedTask", [&iterations] {
+        iterations++;
+        OSAL::SleepFor(1);
+    });
+    for (int round = 0; round < 10; ++round) { // 10: rounds
+        task.Start();
+        int started = iterations.load();
+        while (iterations.load() < started + 2) { // 2: iterations per round
+            OSAL::SleepFor(1);
+        }
+        task.Pause();
+    }
+    task.Stop();
+    EXPECT_GE(iterations.load(), 20); // 20: 10 rounds of 2
+}
+
+#if defined(__linux__) && defined(CPU_SETSIZE)
+TEST(TestTask, schedule_is_applied_before_and_after_start)
+{
+    std::atomic<long> tid {0};
+    std::atomic<int> iterations {0};
+    OSAL::Task task("scheduledTask", [&tid, &iterations] {
+        tid = static_cast<long>(syscall(SYS_gettid));
+        iterations++;
+        OSAL::SleepFor(1);
+    });
+    OSAL::ThreadSchedule schedule;
+    schedule.policy = OSAL::SchedPolicy::OTHER;
+    schedule.nice = 5; // 5: lowering the priority needs no permission
+    schedule.cpus = {0};
+    task.ApplySchedulePolicy({{"otherTask", {}}, {"scheduledTask", schedule}});
+    task.Start();
+    while (iterations.load() < 2) { // 2
+        OSAL::SleepFor(1);
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    ASSERT_EQ(0, pthread_getaffinity_np(task.loop_.id_, sizeof(cpus), &cpus));
+    EXPECT_EQ(1, CPU_COUNT(&cpus));
+    EXPECT_TRUE(CPU_ISSET(0, &cpus));
+    EXPECT_EQ(5, getpriority(PRIO_PROCESS, static_cast<id_t>(tid.load()))); // 5: see above
+
+    schedule.nice = 7; // 7: changed while running
+    schedule.cpus = {};
+    task.SetSchedule(schedule);
+    EXPECT_EQ(7, getpriority(PRIO_PROCESS, static_cast<id_t>(tid.load()))); // 7
+    task.Stop();
+}
+#endif
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#define private public
+#define protected public
+
+#include "foundation/osal/thread/mutex.h"
+#include "foundation/osal/thread/scoped_lock.h"
+#include "foundation/osal/utils/util.h"
+#include "pipeline/filters/demux/type_finder.h"
+#include "plugin/core/plugin_info.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+using namespace Pipeline;
+
+namespace {
+constexpr size_t DATA_SIZE = 64 * 1024; // 64 * 1024: more than the probe window
+constexpr size_t SNIFF_SIZE = 16;
+const std::string URI_SUFFIX = "bin";
+
+struct FakeSniffer {
+    int prob;
+    int delayMs;
+};
+
+class TypeFinderTest : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        data_.assign(DATA_SIZE, 0);
+        sniffers_.clear();
+        {
+            OSAL::ScopedLock lock(mutex_);
+            sniffed_.clear();
+        }
+        typeFinder_ = std::make_shared<TypeFinder>();
+        typeFinder_->pluginRegistryChanged_ = false; // the plugins added by the tests, not those registered
+        typeFinder_->sniffer_ = [this](const std::string& name, std::shared_ptr<Plugin::DataSourceHelper> source) {
+            return Sniff(name, source);
+        };
+        typeFinder_->isPluginLoaded_ = [this](const std::string& name) { return unloaded_.count(name) == 0; };
+    }
+
+    /// Plugins are added in the order of their ranks, highest first.
+    void AddPlugin(const std::string& name, uint32_t rank, std::vector<std::string> extensions, int prob,
+                   int delayMs = 0)
+    {
+        auto info = std::make_shared<Plugin::PluginInfo>();
+        info->pluginType = Plugin::PluginType::DEMUXER;
+        info->name = name;
+        info->rank = rank;
+        info->extra[PLUGIN_INFO_EXTRA_EXTENSIONS] = std::move(extensions);
+        typeFinder_->plugins_.push_back(info);
+        sniffers_[name] = {prob, delayMs};
+    }
+
+    std::string FindMediaType()
+    {
+        typeFinder_->Init(URI_SUFFIX, data_.size(),
+            [this](uint64_t offset, size_t size) { return offset + size <= data_.size(); },
+            [this](uint64_t offset, size_t size, AVBufferPtr& buffer) {
+                ++peeks_;
+                if (offset + size > data_.size()) {
+                    return false;
+                }
+                auto memory = buffer->GetMemory();
+                if (memory == nullptr) {
+                    memory = buffer->AllocMemory(nullptr, size);
+                }
+                memory->Reset();
+                return memory->Write(data_.data() + offset, size, 0) == size;
+            });
+        return typeFinder_->FindMediaType();
+    }
+
+    std::vector<std::string> GetSniffed()
+    {
+        OSAL::ScopedLock lock(mutex_);
+        return sniffed_;
+    }
+
+    std::vector<uint8_t> data_ {};
+    std::set<std::string> unloaded_ {};
+    std::atomic<int> peeks_ {0};
+    std::shared_ptr<TypeFinder> typeFinder_ {nullptr};
+
+private:
+    int Sniff(const std::string& name, const std::shared_ptr<Plugin::DataSourceHelper>& source)
+    {
+        {
+            OSAL::ScopedLock lock(mutex_);
+            sniffed_.push_back(name);
+        }
+        // like the sniffers of the plugins, some of them read more than once
+        for (uint64_t offset : {0, 1024}) { // 1024: a second read further in
+            auto buffer = std::make_shared<Plugin::Buffer>();
+            buffer->AllocMemory(nullptr, SNIFF_SIZE);
+            if (source->ReadAt(offset, buffer, SNIFF_SIZE) != Plugin::Status::OK ||
+                memcmp(buffer->GetMemory()->GetReadOnlyData(), data_.data() + offset, SNIFF_SIZE) != 0) {
+                return 0;
+            }
+        }
+        const auto& sniffer = sniffers_.at(name);
+        if (sniffer.delayMs > 0) {
+            OSAL::SleepFor(sniffer.delayMs);
+        }
+        return sniffer.prob;
+    }
+
+    std::map<std::string, FakeSniffer> sniffers_ {};
+    OSAL::Mutex mutex_ {};
+    std::vector<std::string> sniffed_ {};
+};
+} // namespace
+
+TEST_F(TypeFinderTest, sniffers_share_one_probe_window)
+{
+    AddPlugin("first", 300, {"mp4"}, 0); // 300: rank
+    AddPlugin("second", 200, {"mkv"}, 80); // 200: rank, 80: probability
+    AddPlugin("third", 100, {"flv"}, 0); // 100: rank
+    EXPECT_EQ("second", FindMediaType());
+    EXPECT_EQ(3u, GetSniffed().size()); // 3: all of them
+    EXPECT_EQ(1, peeks_.load());
+}
+
+TEST_F(TypeFinderTest, plugin_of_the_magic_prefix_is_tried_first)
+{
+    (void)memcpy(data_.data(), "ID3", 3); // 3: tag length
+    AddPlugin("wavDemuxer", 200, {"wav"}, 100); // 200: rank, 100: probability
+    AddPlugin("mp3Demuxer", 100, {"mp3"}, 100); // 100: rank, 100: probability
+    EXPECT_EQ("mp3Demuxer", FindMediaType());
+    EXPECT_EQ(std::vector<std::string> {"mp3Demuxer"}, GetSniffed());
+}
+
+TEST_F(TypeFinderTest, parallel_sniffers_are_picked_in_plugin_order)
+{
+    for (int i = 0; i < 5; ++i) { // 5: rounds, the slow sniffer must win each time
+        SetUp();
+        AddPlugin("slowSure", 300, {"mp4"}, 100, 30); // 300: rank, 100: probability, 30: ms
+        AddPlugin("fastSure", 200, {"mkv"}, 100); // 200: rank, 100: probability
+        AddPlugin("fastLikely", 100, {"flv"}, 60); // 100: rank, 60: probability
+        EXPECT_EQ("slowSure", FindMediaType());
+        EXPECT_EQ(3u, GetSniffed().size()); // 3: all of them
+    }
+}
+
+TEST_F(TypeFinderTest, unloaded_libraries_are_sniffed_only_with_a_hint)
+{
+    AddPlugin("loaded", 300, {"mp4"}, 100); // 300: rank, 100: probability
+    AddPlugin("lazyHinted", 200, {URI_SUFFIX}, 0); // 200: rank
+    AddPlugin("lazy", 100, {"flv"}, 100); // 100: rank, 100: probability
+    unloaded_ = {"lazyHinted", "lazy"};
+    EXPECT_EQ("loaded", FindMediaType());
+    auto sniffed = GetSniffed();
+    EXPECT_EQ(2u, sniffed.size()); // 2: the loaded and the hinted one
+    EXPECT_EQ(sniffed.end(), std::find(sniffed.begin(), sniffed.end(), "lazy"));
+}
+
+TEST_F(TypeFinderTest, unloaded_libraries_are_sniffed_if_nothing_else_is_sure)
+{
+    AddPlugin("loaded", 200, {"mp4"}, 30); // 200: rank, 30: probability
+    AddPlugin("lazy", 100, {"flv"}, 100); // 100: rank, 100: probability
+    unloaded_ = {"lazy"};
+    EXPECT_EQ("lazy", FindMediaType());
+    EXPECT_EQ(2u, GetSniffed().size()); // 2: both
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
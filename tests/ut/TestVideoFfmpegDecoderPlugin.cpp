@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include <cstring>
+#include "common/any.h"
+#define private public
+#define protected public
+
+#ifdef VIDEO_SUPPORT
+#include "plugin/plugins/ffmpeg_adapter/video_decoder/video_ffmpeg_decoder_plugin.h"
+
+PLUGIN_EXPORT OHOS::Media::Plugin::Status register_FFmpegVideoDecoders(
+    const std::shared_ptr<OHOS::Media::Plugin::PackageRegister>& pkgReg);
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+using namespace Plugin;
+using namespace Plugin::Ffmpeg;
+
+namespace {
+struct AcceptAllRegister : PackageRegister {
+    Status AddPlugin(const PluginDefBase& def) override
+    {
+        return Status::OK;
+    }
+
+    Status AddPackage(const PackageDef& def) override
+    {
+        return Status::OK;
+    }
+};
+
+constexpr uint32_t DIRECT_WIDTH = 128; // 128: chroma rows stay aligned for any ffmpeg stride alignment
+constexpr uint32_t DIRECT_HEIGHT = 64; // 64: h264 coded height is only two rows taller
+constexpr size_t DIRECT_CAPACITY = DIRECT_WIDTH * DIRECT_HEIGHT * 2; // 2: room for the planes and the over read
+constexpr size_t DIRECT_ALIGN = 64; // 64: the largest address alignment ffmpeg asks for
+
+std::shared_ptr<AVFrame> MakeFrame(uint32_t width, uint32_t height)
+{
+    auto frame = std::shared_ptr<AVFrame>(av_frame_alloc(), [](AVFrame* fp) { av_frame_free(&fp); });
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width = static_cast<int32_t>(width);
+    frame->height = static_cast<int32_t>(height);
+    return frame;
+}
+
+std::shared_ptr<Buffer> MakeVideoBuffer()
+{
+    auto buffer = std::make_shared<Buffer>(BufferMetaType::VIDEO);
+    buffer->AllocMemory(nullptr, DIRECT_CAPACITY, DIRECT_ALIGN);
+    return buffer;
+}
+} // namespace
+
+class VideoFfmpegDecoderPluginTest : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        // fills the codecs the plugin looks up by its name
+        ASSERT_EQ(Status::OK, register_FFmpegVideoDecoders(std::make_shared<AcceptAllRegister>()));
+        plugin = std::make_shared<VideoFfmpegDecoderPlugin>("videodecoder_h264");
+        ASSERT_EQ(Status::OK, plugin->Init());
+    }
+
+    void TearDown() override
+    {
+        plugin->Deinit();
+    }
+
+    void PrepareYuv(uint32_t width, uint32_t height)
+    {
+        ASSERT_EQ(Status::OK, plugin->SetParameter(Tag::VIDEO_WIDTH, width));
+        ASSERT_EQ(Status::OK, plugin->SetParameter(Tag::VIDEO_HEIGHT, height));
+        ASSERT_EQ(Status::OK, plugin->SetParameter(Tag::VIDEO_PIXEL_FORMAT, VideoPixelFormat::YUV420P));
+        ASSERT_EQ(Status::OK, plugin->Prepare());
+        plugin->avCodecContext_->width = static_cast<int32_t>(width);
+        plugin->avCodecContext_->height = static_cast<int32_t>(height);
+    }
+
+    std::shared_ptr<VideoFfmpegDecoderPlugin> plugin;
+};
+
+TEST_F(VideoFfmpegDecoderPluginTest, decode_threads_are_applied_to_the_codec_context)
+{
+    ASSERT_EQ(Status::OK, plugin->SetParameter(Tag::VIDEO_DECODE_THREAD_COUNT, static_cast<uint32_t>(4))); // 4
+    ASSERT_EQ(Status::OK, plugin->SetParameter(Tag::VIDEO_DECODE_THREAD_TYPE, VideoDecodeThreadType::SLICE));
+    ValueType value;
+    ASSERT_EQ(Status::OK, plugin->GetParameter(Tag::VIDEO_DECODE_THREAD_COUNT, value));
+    EXPECT_EQ(4u, AnyCast<uint32_t>(value)); // 4
+    ASSERT_EQ(Status::OK, plugin->Prepare());
+    ASSERT_NE(nullptr, plugin->avCodecContext_);
+    EXPECT_EQ(4, plugin->avCodecContext_->thread_count); // 4
+    EXPECT_EQ(FF_THREAD_SLICE, plugin->avCodecContext_->thread_type);
+}
+
+TEST_F(VideoFfmpegDecoderPluginTest, decode_threads_default_to_auto_and_are_capped)
+{
+    ASSERT_EQ(Status::OK, plugin->SetParameter(Tag::VIDEO_DECODE_THREAD_COUNT, static_cast<uint32_t>(100))); // 100
+    ASSERT_EQ(Status::OK, plugin->Prepare());
+    EXPECT_EQ(16, plugin->avCodecContext_->thread_count); // 16: at most
+    EXPECT_EQ(FF_THREAD_FRAME | FF_THREAD_SLICE, plugin->avCodecContext_->thread_type);
+}
+
+TEST_F(VideoFfmpegDecoderPluginTest, decode_thread_parameters_of_a_wrong_type_are_rejected)
+{
+    EXPECT_EQ(Status::ERROR_INVALID_PARAMETER, plugin->SetParameter(Tag::VIDEO_DECODE_THREAD_COUNT, 4)); // 4
+    EXPECT_EQ(Status::ERROR_INVALID_PARAMETER,
+              plugin->SetParameter(Tag::VIDEO_DECODE_THREAD_TYPE, static_cast<uint32_t>(1)));
+    ValueType value;
+    EXPECT_NE(Status::OK, plugin->GetParameter(Tag::VIDEO_DECODE_THREAD_COUNT, value));
+}
+
+TEST_F(VideoFfmpegDecoderPluginTest, frames_of_the_output_layout_are_copied_plane_by_plane)
+{
+    constexpr uint32_t width = 100; // 100: the output stride is wider than the picture
+    PrepareYuv(width, DIRECT_HEIGHT);
+    auto& frame = plugin->cachedFrame_;
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width = static_cast<int32_t>(width);
+    frame->height = static_cast<int32_t>(DIRECT_HEIGHT);
+    ASSERT_GE(av_frame_get_buffer(frame.get(), 0), 0);
+    for (int32_t plane = 0; plane < 3; ++plane) { // 3: yuv planes
+        int32_t rows = plane == 0 ? frame->height : frame->height / 2; // 2: chroma subsampling
+        for (int32_t row = 0; row < rows; ++row) {
+            memset(frame->data[plane] + row * frame->linesize[plane], (plane << 6) + row, frame->linesize[plane]); // 6
+        }
+    }
+    auto buffer = MakeVideoBuffer();
+    ASSERT_EQ(Status::OK, plugin->FillFrameBuffer(buffer));
+    EXPECT_EQ(nullptr, plugin->swsCtx_); // no scaler for a plain copy
+
+    auto meta = ReinterpretPointerCast<VideoBufferMeta>(buffer->GetBufferMeta());
+    const std::vector<uint32_t> strides {112, 56, 56}; // 112: width aligned to 16, 56: half of it
+    EXPECT_EQ(strides, meta->stride);
+    auto data = buffer->GetMemory()->GetReadOnlyData();
+    EXPECT_EQ(strides[0] * DIRECT_HEIGHT * 3 / 2, buffer->GetMemory()->GetSize()); // 3 / 2: yuv 4:2:0
+    const uint8_t* planeStart = data;
+    for (int32_t plane = 0; plane < 3; ++plane) { // 3: yuv planes
+        int32_t rows = plane == 0 ? frame->height : frame->height / 2; // 2: chroma subsampling
+        int32_t cols = plane == 0 ? frame->width : (frame->width + 1) / 2; // 2: chroma subsampling
+        for (int32_t row = 0; row < rows; ++row) {
+            auto line = planeStart + row * strides[plane];
+            ASSERT_EQ(static_cast<uint8_t>((plane << 6) + row), line[0]); // 6: as filled above
+            ASSERT_EQ(static_cast<uint8_t>((plane << 6) + row), line[cols - 1]); // 6: as filled above
+        }
+        planeStart += strides[plane] * rows;
+    }
+}
+
+TEST_F(VideoFfmpegDecoderPluginTest, direct_buffers_are_lent_until_ffmpeg_drops_them)
+{
+    PrepareYuv(DIRECT_WIDTH, DIRECT_HEIGHT);
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    for (int i = 0; i < 3; ++i) { // 3: one more than the reserved buffers
+        buffers.push_back(MakeVideoBuffer());
+        plugin->QueueOutputBuffer(buffers.back(), 0);
+    }
+    auto frame = MakeFrame(DIRECT_WIDTH, DIRECT_HEIGHT);
+    ASSERT_EQ(0, plugin->GetDirectBuffer(plugin->avCodecContext_.get(), frame.get()));
+    EXPECT_EQ(2u, plugin->outBufferQ_.Size()); // 2: the reserved ones stay for the copy path
+    ASSERT_EQ(1u, plugin->directBuffers_.size());
+    ASSERT_NE(nullptr, frame->buf[0]);
+    EXPECT_EQ(frame->buf[0]->data, frame->data[0]);
+    EXPECT_EQ(buffers[0]->GetMemory()->GetReadOnlyData(), frame->data[0]);
+
+    // the reserve is never lent
+    auto another = MakeFrame(DIRECT_WIDTH, DIRECT_HEIGHT);
+    EXPECT_NE(0, plugin->GetDirectBuffer(plugin->avCodecContext_.get(), another.get()));
+    EXPECT_EQ(2u, plugin->outBufferQ_.Size()); // 2: untouched
+
+    // the first output hands the buffer on, a duplicate output of the same picture is copied
+    ASSERT_GE(av_frame_ref(plugin->cachedFrame_.get(), frame.get()), 0);
+    EXPECT_EQ(buffers[0], plugin->TakeDirectBuffer());
+    EXPECT_EQ(nullptr, plugin->TakeDirectBuffer());
+    av_frame_unref(plugin->cachedFrame_.get());
+    EXPECT_EQ(1u, plugin->directBuffers_.size());
+
+    // the free callback releases the entry once the last frame reference is gone
+    frame.reset();
+    EXPECT_TRUE(plugin->directBuffers_.empty());
+}
+
+TEST_F(VideoFfmpegDecoderPluginTest, cropped_or_resized_direct_frames_are_copied)
+{
+    PrepareYuv(DIRECT_WIDTH, DIRECT_HEIGHT);
+    for (int i = 0; i < 3; ++i) { // 3: one more than the reserved buffers
+        plugin->QueueOutputBuffer(MakeVideoBuffer(), 0);
+    }
+    auto frame = MakeFrame(DIRECT_WIDTH, DIRECT_HEIGHT);
+    ASSERT_EQ(0, plugin->GetDirectBuffer(plugin->avCodecContext_.get(), frame.get()));
+
+    ASSERT_GE(av_frame_ref(plugin->cachedFrame_.get(), frame.get()), 0);
+    plugin->cachedFrame_->data[0] += plugin->cachedFrame_->linesize[0]; // cropped top row
+    EXPECT_EQ(nullptr, plugin->TakeDirectBuffer());
+    av_frame_unref(plugin->cachedFrame_.get());
+
+    ASSERT_GE(av_frame_ref(plugin->cachedFrame_.get(), frame.get()), 0);
+    plugin->cachedFrame_->height -= 2; // 2: cropped bottom rows
+    EXPECT_EQ(nullptr, plugin->TakeDirectBuffer());
+    av_frame_unref(plugin->cachedFrame_.get());
+
+    frame.reset();
+    EXPECT_TRUE(plugin->directBuffers_.empty());
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS
+#endif
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2022-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "plugin/common/plugin_buffer.h"
+#include "plugin/common/plugin_time.h"
+#include "plugin/plugins/demuxer/wav_demuxer/wav_demuxer_plugin.h"
+
+namespace OHOS {
+namespace Media {
+namespace Test {
+using namespace Plugin;
+using namespace Plugin::WavPlugin;
+
+namespace {
+using Bytes = std::vector<uint8_t>;
+
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr uint32_t CHANNELS = 2;
+constexpr uint32_t BLOCK_ALIGN = 6;  // 24 bit stereo
+constexpr uint32_t BYTE_RATE = SAMPLE_RATE * BLOCK_ALIGN;
+constexpr size_t BLOCK_SIZE = BYTE_RATE / 10; // 10: blocks of 100 ms
+constexpr size_t CACHE_SIZE = 64 * 1024;      // of the buffers cached by the source
+
+void PutLe(Bytes& bytes, uint64_t value, int size)
+{
+    for (int i = 0; i < size; ++i) {
+        bytes.push_back(static_cast<uint8_t>(value >> (8 * i))); // 8: little endian
+    }
+}
+
+void PutChunk(Bytes& bytes, const std::string& id, const Bytes& payload)
+{
+    bytes.insert(bytes.end(), id.begin(), id.end());
+    PutLe(bytes, payload.size(), 4); // 4: u32
+    bytes.insert(bytes.end(), payload.begin(), payload.end());
+    if (payload.size() & 1) {
+        bytes.push_back(0);
+    }
+}
+
+Bytes FmtPayload()
+{
+    Bytes fmt;
+    PutLe(fmt, 1, 2);            // 1, 2: pcm, u16
+    PutLe(fmt, CHANNELS, 2);     // 2: u16
+    PutLe(fmt, SAMPLE_RATE, 4);  // 4: u32
+    PutLe(fmt, BYTE_RATE, 4);    // 4: u32
+    PutLe(fmt, BLOCK_ALIGN, 2);  // 2: u16
+    PutLe(fmt, 24, 2);           // 24: bits per sample, 2: u16
+    return fmt;
+}
+
+/**
+ * A file made of a header and a generated payload, so that it can be far bigger than the memory. The data is handed
+ * out as views of cached buffers of CACHE_SIZE bytes when the read buffer has no memory, like the stream source does.
+ */
+class WavSource : public DataSource {
+public:
+    WavSource(Bytes header, uint64_t size) : header_(std::move(header)), size_(size)
+    {
+    }
+
+    static uint8_t ByteAt(uint64_t offset)
+    {
+        return static_cast<uint8_t>(offset % 251); // 251: a prime, so that misplaced blocks show
+    }
+
+    Status ReadAt(int64_t offset, std::shared_ptr<Buffer>& buffer, size_t expectedLen) override
+    {
+        auto position = static_cast<uint64_t>(offset);
+        if (position >= size_) {
+            return Status::END_OF_STREAM;
+        }
+        uint64_t end = std::min<uint64_t>(position + expectedLen, size_);
+        if (!buffer->IsEmpty()) {
+            auto memory = buffer->GetMemory();
+            for (; position < end; ++position) {
+                uint8_t byte = position < header_.size() ? header_[position] : ByteAt(position);
+                memory->Write(&byte, 1);
+            }
+            return Status::OK;
+        }
+        while (position < end) {
+            uint64_t cacheStart = position - position % CACHE_SIZE;
+            auto size = static_cast<size_t>(std::min<uint64_t>(end - position, cacheStart + CACHE_SIZE - position));
+            buffer->WrapMemorySlice(GetCache(cacheStart)->GetMemory(), position - cacheStart, size);
+            position += size;
+        }
+        ++viewReads;
+        return Status::OK;
+    }
+
+    Status GetSize(size_t& size) override
+    {
+        size = size_;
+        return Status::OK;
+    }
+
+    bool IsCached(const uint8_t* data)
+    {
+        return std::any_of(caches_.begin(), caches_.end(),
+                           [data](const std::pair<const uint64_t, std::shared_ptr<Buffer>>& cache) {
+            const uint8_t* start = cache.second->GetMemory()->GetReadOnlyData();
+            return data >= start && data < start + CACHE_SIZE;
+        });
+    }
+
+    int viewReads {0};
+
+private:
+    std::shared_ptr<Buffer> GetCache(uint64_t start)
+    {
+        auto& cache = caches_[start];
+        if (cache == nullptr) {
+            cache = Buffer::CreateDefaultBuffer(BufferMetaType::AUDIO, CACHE_SIZE);
+            auto size = static_cast<size_t>(std::min<uint64_t>(CACHE_SIZE, size_ - start));
+            Bytes data(size);
+            for (size_t i = 0; i < size; ++i) {
+                data[i] = start + i < header_.size() ? header_[start + i] : ByteAt(start + i);
+            }
+            cache->GetMemory()->Write(data.data(), size);
+        }
+        return cache;
+    }
+
+    Bytes header_;
+    uint64_t size_;
+    std::map<uint64_t, std::shared_ptr<Buffer>> caches_ {};
+};
+
+Bytes BroadcastWavHeader(uint32_t dataSize)
+{
+    Bytes header {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E'};
+    PutChunk(header, "bext", Bytes(603, 0x42)); // 603: an odd size, the chunk is padded
+    PutChunk(header, "fmt ", FmtPayload());
+    PutChunk(header, "LIST", Bytes(40, 0x43));  // 40: an info list
+    header.insert(header.end(), {'d', 'a', 't', 'a'});
+    PutLe(header, dataSize, 4); // 4: u32
+    return header;
+}
+
+Bytes Rf64Header(uint64_t dataSize)
+{
+    Bytes header {'R', 'F', '6', '4', 0xFF, 0xFF, 0xFF, 0xFF, 'W', 'A', 'V', 'E'};
+    Bytes ds64;
+    PutLe(ds64, dataSize + 100, 8); // 100: about the size of the header, 8: u64
+    PutLe(ds64, dataSize, 8);       // 8: u64
+    PutLe(ds64, dataSize / BLOCK_ALIGN, 8); // 8: u64
+    PutLe(ds64, 0, 4);              // 4: no table
+    PutChunk(header, "ds64", ds64);
+    PutChunk(header, "fmt ", FmtPayload());
+    header.insert(header.end(), {'d', 'a', 't', 'a', 0xFF, 0xFF, 0xFF, 0xFF});
+    return header;
+}
+
+void ExpectPayload(const std::shared_ptr<Memory>& memory, uint64_t offset)
+{
+    const uint8_t* data = memory->GetReadOnlyData();
+    for (size_t i = 0; i < memory->GetSize(); ++i) {
+        ASSERT_EQ(WavSource::ByteAt(offset + i), data[i]) << "at " << offset + i;
+    }
+}
+} // namespace
+
+TEST(TestWavDemuxerPlugin, walks_the_chunks_and_reads_views_of_100_ms)
+{
+    constexpr uint32_t dataSize = BYTE_RATE * 3; // 3: seconds
+    auto header = BroadcastWavHeader(dataSize);
+    auto source = std::make_shared<WavSource>(header, header.size() + dataSize + 1000); // 1000: a trailing chunk
+    WavDemuxerPlugin plugin("WavDemuxer");
+    ASSERT_EQ(Status::OK, plugin.SetDataSource(source));
+    MediaInfo mediaInfo;
+    ASSERT_EQ(Status::OK, plugin.GetMediaInfo(mediaInfo));
+    ASSERT_EQ(1u, mediaInfo.tracks.size());
+    auto& track = mediaInfo.tracks[0];
+    EXPECT_EQ(3 * HST_SECOND, Plugin::AnyCast<uint64_t>(track[Tag::MEDIA_DURATION])); // 3: seconds
+    EXPECT_EQ(SAMPLE_RATE / 10, Plugin::AnyCast<uint32_t>(track[Tag::AUDIO_SAMPLE_PER_FRAME])); // 10: 100 ms
+    EXPECT_EQ(AudioSampleFormat::S24, Plugin::AnyCast<AudioSampleFormat>(track[Tag::AUDIO_SAMPLE_FORMAT]));
+
+    uint64_t offset = header.size();
+    int64_t pts = 0;
+    int views = 0;
+    for (;;) {
+        Buffer buffer;
+        Status status = plugin.ReadFrame(buffer, 0);
+        if (status == Status::END_OF_STREAM) {
+            break;
+        }
+        ASSERT_EQ(Status::OK, status);
+        ASSERT_EQ(1u, buffer.GetMemoryCount());
+        auto memory = buffer.GetMemory();
+        ASSERT_EQ(BLOCK_SIZE, memory->GetSize());
+        EXPECT_EQ(pts, buffer.pts);
+        ExpectPayload(memory, offset);
+        views += source->IsCached(memory->GetReadOnlyData()) ? 1 : 0;
+        offset += memory->GetSize();
+        pts += 100 * HST_MSECOND; // 100: ms per block
+    }
+    EXPECT_EQ(header.size() + dataSize, offset); // the trailing chunk is not played
+    EXPECT_GT(views, 0); // the blocks within a cached buffer are not copied
+}
+
+TEST(TestWavDemuxerPlugin, rf64_over_4_gib_seeks_exactly)
+{
+    constexpr uint64_t dataSize = 5ULL * 1024 * 1024 * 1024 - 5ULL * 1024 * 1024 * 1024 % BLOCK_ALIGN; // 5 GiB
+    auto header = Rf64Header(dataSize);
+    auto source = std::make_shared<WavSource>(header, header.size() + dataSize);
+    WavDemuxerPlugin plugin("WavDemuxer");
+    ASSERT_EQ(Status::OK, plugin.SetDataSource(source));
+    MediaInfo mediaInfo;
+    ASSERT_EQ(Status::OK, plugin.GetMediaInfo(mediaInfo));
+    auto duration = Plugin::AnyCast<uint64_t>(mediaInfo.tracks[0][Tag::MEDIA_DURATION]);
+    EXPECT_EQ(dataSize / BYTE_RATE * HST_SECOND + dataSize % BYTE_RATE * HST_SECOND / BYTE_RATE, duration);
+
+    // 5 hours, 1 ms and a bit into the file, i.e. well over 4 GiB
+    int64_t target = 5 * 3600 * HST_SECOND + HST_MSECOND + 7; // 5, 3600: hours, 7: not on a sample frame
+    ASSERT_EQ(Status::OK, plugin.SeekTo(-1, target, SeekMode::SEEK_PREVIOUS_SYNC));
+    uint64_t position = 5ULL * 3600 * BYTE_RATE + BYTE_RATE / 1000; // 5, 3600: hours, 1000: 1 ms
+    Buffer buffer;
+    ASSERT_EQ(Status::OK, plugin.ReadFrame(buffer, 0));
+    EXPECT_EQ(static_cast<int64_t>(5 * 3600 * HST_SECOND + HST_MSECOND), buffer.pts); // 5, 3600: on a sample frame
+    ExpectPayload(buffer.GetMemory(), header.size() + position);
+
+    auto afterEnd = static_cast<int64_t>(duration) * 2; // 2: after the end
+    ASSERT_EQ(Status::OK, plugin.SeekTo(-1, afterEnd, SeekMode::SEEK_PREVIOUS_SYNC));
+    Buffer end;
+    EXPECT_EQ(Status::END_OF_STREAM, plugin.ReadFrame(end, 0));
+}
+
+TEST(TestWavDemuxerPlugin, gathers_blocks_across_cached_buffers_and_drops_a_partial_frame)
+{
+    // the size is left at 0 as by a recorder that stopped early, the file ends in the middle of a sample frame
+    auto header = BroadcastWavHeader(0);
+    uint64_t fileSize = CACHE_SIZE * 4 + 4; // 4: cached buffers, 4: bytes of a partial sample frame
+    auto source = std::make_shared<WavSource>(header, fileSize);
+    WavDemuxerPlugin plugin("WavDemuxer");
+    ASSERT_EQ(Status::OK, plugin.SetDataSource(source));
+    MediaInfo mediaInfo;
+    ASSERT_EQ(Status::OK, plugin.GetMediaInfo(mediaInfo));
+    uint64_t offset = header.size();
+    uint64_t end = fileSize - (fileSize - header.size()) % BLOCK_ALIGN;
+    for (;;) {
+        Buffer buffer;
+        Status status = plugin.ReadFrame(buffer, 0);
+        if (status == Status::END_OF_STREAM) {
+            break;
+        }
+        ASSERT_EQ(Status::OK, status);
+        ASSERT_EQ(1u, buffer.GetMemoryCount());
+        auto memory = buffer.GetMemory();
+        ASSERT_EQ(0u, memory->GetSize() % BLOCK_ALIGN);
+        ExpectPayload(memory, offset);
+        offset += memory->GetSize();
+    }
+    EXPECT_EQ(end, offset);
+
+    // a buffer with memory is filled in place, no more than its capacity
+    ASSERT_EQ(Status::OK, plugin.SeekTo(-1, 0, SeekMode::SEEK_PREVIOUS_SYNC));
+    auto buffer = Buffer::CreateDefaultBuffer(BufferMetaType::AUDIO, 1000); // 1000: not a multiple of the frame
+    int viewReads = source->viewReads;
+    ASSERT_EQ(Status::OK, plugin.ReadFrame(*buffer, 0));
+    EXPECT_EQ(viewReads, source->viewReads);
+    EXPECT_EQ(1000u - 1000 % BLOCK_ALIGN, buffer->GetMemory()->GetSize()); // 1000: capacity
+    ExpectPayload(buffer->GetMemory(), header.size());
+}
+} // namespace Test
+} // namespace Media
+} // namespace OHOS